@@ -96,13 +96,15 @@ glusterfs_ctx_defaults_init (glusterfs_ctx_t *ctx)
 		goto err;
 	}
 
-	/* frame_mem_pool size 112 * 4k */
-	pool->frame_mem_pool = mem_pool_new (call_frame_t, 4096);
+	/* frame_mem_pool size 184 * 1k, frames beyond the slab of a
+	   stack only */
+	pool->frame_mem_pool = mem_pool_new (call_frame_t, 1024);
 	if (!pool->frame_mem_pool) {
 		goto err;
 	}
-	/* stack_mem_pool size 256 * 1024 */
-	pool->stack_mem_pool = mem_pool_new (call_stack_t, 1024);
+	/* stack_mem_pool size 4.8k * 512, with the slab of
+	   CALL_STACK_FRAME_SLAB frames */
+	pool->stack_mem_pool = mem_pool_new (call_stack_t, 512);
 	if (!pool->stack_mem_pool) {
 		goto err;
 	}
@@ -515,6 +517,48 @@ out:
 }
 
 
+int
+glfs_set_event_threads (struct glfs *fs, int count)
+{
+	if (count < 1) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fs->ctx->cmd_args.event_threads = count;
+
+	return 0;
+}
+
+
+int
+glfs_set_iobuf_mem_policy (struct glfs *fs, const char *hugepages, int numa)
+{
+	gf_iobuf_hugepages_t policy = GF_IOBUF_HUGEPAGES_NONE;
+
+	if (!hugepages)
+		policy = GF_IOBUF_HUGEPAGES_NONE;
+	else if (strcmp (hugepages, "thp") == 0)
+		policy = GF_IOBUF_HUGEPAGES_THP;
+	else if (strcmp (hugepages, "hugetlb") == 0)
+		policy = GF_IOBUF_HUGEPAGES_HUGETLB;
+	else {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fs->ctx->cmd_args.iobuf_hugepages = policy;
+	fs->ctx->cmd_args.iobuf_numa = !!numa;
+
+	if (iobuf_pool_set_mem_policy (fs->ctx->iobuf_pool, policy, !!numa)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+
 int
 glfs_init_wait (struct glfs *fs)
 {
@@ -576,6 +620,10 @@ glfs_init_common (struct glfs *fs)
 	if (ret)
 		return ret;
 
+	if (fs->ctx->cmd_args.event_threads)
+		event_reconfigure_threads (fs->ctx->event_pool,
+					   fs->ctx->cmd_args.event_threads);
+
 	ret = gf_thread_create (&fs->poller, NULL, glfs_poller, fs);
 	if (ret)
 		return ret;
@@ -666,6 +714,10 @@ glfs_fini (struct glfs *fs)
 
         glfs_subvol_done (fs, subvol);
 
+        /* nothing may be left queued for the log file */
+        ctx->log.async = 0;
+        gf_log_flush ();
+
         if (ctx->log.logfile)
                 fclose (ctx->log.logfile);
 
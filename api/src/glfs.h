@@ -193,6 +193,66 @@ int glfs_set_volfile_server (glfs_t *fs, const char *transport,
 int glfs_set_logging (glfs_t *fs, const char *logfile, int loglevel);
 
 
+/*
+  SYNOPSIS
+
+  glfs_set_event_threads: Specify the number of network event threads.
+
+  DESCRIPTION
+
+  This function sets how many threads dispatch socket events (RPC replies
+  from bricks and the management daemon) for the virtual mount. It must
+  be called before glfs_init(). The default is a single thread.
+
+  PARAMETERS
+
+  @fs: The 'virtual mount' object to be configured.
+
+  @count: Number of event dispatcher threads, at least 1.
+
+  RETURN VALUES
+
+   0 : Success.
+  -1 : Failure. @errno will be set with the type of failure.
+
+*/
+
+int glfs_set_event_threads (glfs_t *fs, int count);
+
+
+/*
+  SYNOPSIS
+
+  glfs_set_iobuf_mem_policy: Specify how the memory of I/O buffers is backed.
+
+  DESCRIPTION
+
+  This function selects huge pages and NUMA-local placement for the
+  arenas I/O buffers are carved from, like the --iobuf-hugepages and
+  --iobuf-numa options of glusterfs. Only arenas the pool adds after
+  the call follow the policy, so call it right after glfs_new().
+
+  PARAMETERS
+
+  @fs: The 'virtual mount' object to be configured.
+
+  @hugepages: "thp" for transparent huge pages, "hugetlb" for the hugetlb
+              pool (falling back to transparent huge pages when it is
+              empty), or NULL for normal pages.
+
+  @numa: Non-zero to allocate arenas on the NUMA node of the thread
+         creating them, and prefer the caller's node when picking one.
+
+  RETURN VALUES
+
+   0 : Success.
+  -1 : Failure. @errno will be set with the type of failure.
+
+*/
+
+int glfs_set_iobuf_mem_policy (glfs_t *fs, const char *hugepages, int numa);
+
+
 /*
   SYNOPSIS
 
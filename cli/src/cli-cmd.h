@@ -70,6 +70,9 @@ typedef struct cli_profile_info_ {
         double min_latency;
         double max_latency;
         double avg_latency;
+        uint64_t p50_latency;
+        uint64_t p90_latency;
+        uint64_t p99_latency;
         char   *fop_name;
         double percentage_avg_latency;
 } cli_profile_info_t;
@@ -4612,6 +4612,22 @@ cmd_profile_volume_brick_out (dict_t *dict, int count, int interval)
                 snprintf (key, sizeof (key), "%d-%d-%d-maxlatency", count,
                           interval, i);
                 ret = dict_get_double (dict, key, &profile_info[i].max_latency);
+
+                /* percentiles are only sent by bricks with histograms */
+                memset (key, 0, sizeof (key));
+                snprintf (key, sizeof (key), "%d-%d-%d-p50latency", count,
+                          interval, i);
+                ret = dict_get_uint64 (dict, key, &profile_info[i].p50_latency);
+
+                memset (key, 0, sizeof (key));
+                snprintf (key, sizeof (key), "%d-%d-%d-p90latency", count,
+                          interval, i);
+                ret = dict_get_uint64 (dict, key, &profile_info[i].p90_latency);
+
+                memset (key, 0, sizeof (key));
+                snprintf (key, sizeof (key), "%d-%d-%d-p99latency", count,
+                          interval, i);
+                ret = dict_get_uint64 (dict, key, &profile_info[i].p99_latency);
                 profile_info[i].fop_name = (char *)gf_fop_list[i];
 
                 total_percentage_latency +=
@@ -4697,21 +4713,27 @@ cmd_profile_volume_brick_out (dict_t *dict, int count, int interval)
                 if (profile_info[i].fop_hits == 0)
                         continue;
                 if (is_header_printed == 0) {
-                        cli_out ("%10s %13s %13s %13s %14s %11s", "%-latency",
-                                 "Avg-latency", "Min-Latency", "Max-Latency",
-                                 "No. of calls", "Fop");
-                        cli_out ("%10s %13s %13s %13s %14s %11s", "---------",
+                        cli_out ("%10s %13s %13s %13s %13s %13s %13s %14s %11s",
+                                 "%-latency", "Avg-latency", "Min-Latency",
+                                 "Max-Latency", "P50-Latency", "P90-Latency",
+                                 "P99-Latency", "No. of calls", "Fop");
+                        cli_out ("%10s %13s %13s %13s %13s %13s %13s %14s %11s",
+                                 "---------", "-----------", "-----------",
                                  "-----------", "-----------", "-----------",
-                                 "------------", "----");
+                                 "-----------", "------------", "----");
                         is_header_printed = 1;
                 }
                 if (profile_info[i].fop_hits) {
                         cli_out ("%10.2lf %10.2lf us %10.2lf us %10.2lf us"
-                                 " %14"PRId64" %11s",
+                                 " %10"PRIu64" us %10"PRIu64" us %10"PRIu64
+                                 " us %14"PRId64" %11s",
                                  profile_info[i].percentage_avg_latency,
                                  profile_info[i].avg_latency,
                                  profile_info[i].min_latency,
                                  profile_info[i].max_latency,
+                                 profile_info[i].p50_latency,
+                                 profile_info[i].p90_latency,
+                                 profile_info[i].p99_latency,
                                  profile_info[i].fop_hits,
                                  profile_info[i].fop_name);
                 }
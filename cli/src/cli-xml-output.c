@@ -2047,6 +2047,9 @@ cli_xml_output_vol_profile_stats (xmlTextWriterPtr writer, dict_t *dict,
         double                  avg_latency = 0.0;
         double                  max_latency = 0.0;
         double                  min_latency = 0.0;
+        uint64_t                pct_latency = 0;
+        char                   *percentiles[] = {"p50", "p90", "p99", "p999"};
+        int                     j = 0;
         uint64_t                duration = 0;
         uint64_t                total_read = 0;
         uint64_t                total_write = 0;
@@ -2161,6 +2164,20 @@ cli_xml_output_vol_profile_stats (xmlTextWriterPtr writer, dict_t *dict,
                         (writer, (xmlChar *)"maxLatency", "%f", max_latency);
                 XML_RET_CHECK_AND_GOTO (ret, out);
 
+                for (j = 0; j < 4; j++) {
+                        memset (key, 0, sizeof (key));
+                        snprintf (key, sizeof (key), "%d-%d-%d-%slatency",
+                                  brick_index, interval, i, percentiles[j]);
+                        if (dict_get_uint64 (dict, key, &pct_latency))
+                                continue;
+                        snprintf (key, sizeof (key), "%sLatency",
+                                  percentiles[j]);
+                        ret = xmlTextWriterWriteFormatElement
+                                (writer, (xmlChar *)key, "%"PRIu64,
+                                 pct_latency);
+                        XML_RET_CHECK_AND_GOTO (ret, out);
+                }
+
                 /* </fop> */
                 ret = xmlTextWriterEndElement (writer);
                 XML_RET_CHECK_AND_GOTO (ret, out);
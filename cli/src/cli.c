@@ -117,12 +117,14 @@ glusterfs_ctx_defaults_init (glusterfs_ctx_t *ctx)
         if (!pool)
                 return -1;
 
-        /* frame_mem_pool size 112 * 64 */
-        pool->frame_mem_pool = mem_pool_new (call_frame_t, 32);
+        /* frame_mem_pool size 184 * 16, frames beyond the slab of a stack
+           only */
+        pool->frame_mem_pool = mem_pool_new (call_frame_t, 16);
         if (!pool->frame_mem_pool)
                 return -1;
 
-        /* stack_mem_pool size 256 * 128 */
+        /* stack_mem_pool size 4.8k * 16, with the slab of
+           CALL_STACK_FRAME_SLAB frames */
         pool->stack_mem_pool = mem_pool_new (call_stack_t, 16);
 
         if (!pool->stack_mem_pool)
@@ -0,0 +1,131 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* checksum-bm: throughput of the rsync checksums rchecksum computes for
+   every block of a diff self-heal: the weak checksum (portable loop and
+   the implementation picked for this CPU) and the MD5 and murmur3 strong
+   checksums.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <openssl/md5.h>
+
+#include "glusterfs.h"
+#include "common-utils.h"
+#include "checksum.h"
+
+struct checksum_bm_config {
+        size_t  block;
+        int     megabytes;
+};
+
+static struct checksum_bm_config config = {
+        .block     = 128 * GF_UNIT_KB,
+        .megabytes = 1024,
+};
+
+static double
+checksum_bm_now (void)
+{
+        struct timeval tv = {0, };
+
+        gettimeofday (&tv, NULL);
+
+        return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void
+checksum_bm_report (const char *name, double start, uint64_t sink)
+{
+        double elapsed = checksum_bm_now () - start;
+
+        printf ("%-16s: %d MB in %.3f s, %.1f MB/s (%"PRIx64")\n", name,
+                config.megabytes, elapsed,
+                elapsed ? config.megabytes / elapsed : 0, sink);
+}
+
+static void
+usage (const char *prog)
+{
+        fprintf (stderr, "usage: %s [-b block-size-KB] [-m megabytes]\n",
+                 prog);
+        exit (1);
+}
+
+int
+main (int argc, char *argv[])
+{
+        unsigned char   *buf    = NULL;
+        unsigned char    sum[MD5_DIGEST_LENGTH];
+        uint64_t         sink   = 0;
+        uint64_t         blocks = 0;
+        uint64_t         i      = 0;
+        double           start  = 0;
+        char             name[32];
+        int              opt    = 0;
+
+        while ((opt = getopt (argc, argv, "b:m:")) != -1) {
+                switch (opt) {
+                case 'b':
+                        config.block = atoi (optarg) * GF_UNIT_KB;
+                        break;
+                case 'm':
+                        config.megabytes = atoi (optarg);
+                        break;
+                default:
+                        usage (argv[0]);
+                }
+        }
+
+        if (optind != argc || config.block == 0 || config.megabytes <= 0)
+                usage (argv[0]);
+
+        buf = malloc (config.block);
+        if (!buf)
+                return 1;
+        for (i = 0; i < config.block; i++)
+                buf[i] = random ();
+
+        blocks = ((uint64_t) config.megabytes * GF_UNIT_MB) / config.block;
+
+        start = checksum_bm_now ();
+        for (i = 0, sink = 0; i < blocks; i++)
+                sink += gf_rsync_weak_checksum_generic (buf, config.block);
+        checksum_bm_report ("weak (generic)", start, sink);
+
+        snprintf (name, sizeof (name), "weak (%s)",
+                  gf_rsync_weak_checksum_impl ());
+        start = checksum_bm_now ();
+        for (i = 0, sink = 0; i < blocks; i++)
+                sink += gf_rsync_weak_checksum (buf, config.block);
+        checksum_bm_report (name, start, sink);
+
+        start = checksum_bm_now ();
+        for (i = 0, sink = 0; i < blocks; i++) {
+                gf_rsync_strong_checksum (buf, config.block, sum);
+                sink += sum[0];
+        }
+        checksum_bm_report ("strong (md5)", start, sink);
+
+        start = checksum_bm_now ();
+        for (i = 0, sink = 0; i < blocks; i++) {
+                gf_rsync_murmur3_checksum (buf, config.block, sum);
+                sink += sum[0];
+        }
+        checksum_bm_report ("strong (murmur3)", start, sink);
+
+        free (buf);
+
+        return 0;
+}
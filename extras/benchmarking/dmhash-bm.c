@@ -0,0 +1,219 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* dmhash-bm: the DHT name hash, one name at a time and batched the way
+   readdir replies are hashed, against a copy of the original round loop.
+
+   Names are random, of random length up to -l bytes, in batches of -n
+   (one readdirp reply).  Every result is checked against the reference
+   implementation first, since any difference would move files between
+   bricks.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "hashfn.h"
+
+#define DM_DELTA 0x9E3779B9
+
+struct dmhash_bm_config {
+        int     names;
+        int     maxlen;
+        int     passes;
+};
+
+static struct dmhash_bm_config config = {
+        .names     = 512,
+        .maxlen    = 32,
+        .passes    = 20000,
+};
+
+/* gf_dm_hashfn as it was before the unrolled and batched versions */
+static void
+ref_dm_round (int rounds, uint32_t *array, uint32_t *h0, uint32_t *h1)
+{
+        uint32_t sum = 0;
+        int      n = rounds;
+        uint32_t b0 = *h0;
+        uint32_t b1 = *h1;
+
+        do {
+                sum += DM_DELTA;
+                b0  += ((b1 << 4) + array[0])
+                        ^ (b1 + sum)
+                        ^ ((b1 >> 5) + array[1]);
+                b1  += ((b0 << 4) + array[2])
+                        ^ (b0 + sum)
+                        ^ ((b0 >> 5) + array[3]);
+        } while (--n);
+
+        *h0 += b0;
+        *h1 += b1;
+}
+
+static uint32_t
+ref_dm_hashfn (const char *msg, int len)
+{
+        uint32_t  h0 = 0x9464a485;
+        uint32_t  h1 = 0x542e1a94;
+        uint32_t  array[4];
+        uint32_t  pad = 0;
+        int       i = 0;
+        int       j = 0;
+        int       full_words = len / 4;
+        int       full_bytes = len;
+        uint32_t *intmsg = (uint32_t *) msg;
+
+        pad = (uint32_t) len | ((uint32_t) len << 8);
+        pad |= pad << 16;
+
+        for (i = 0; i < len / 16; i++) {
+                for (j = 0; j < 4; j++) {
+                        array[j] = *intmsg++;
+                        full_words--;
+                        full_bytes -= 4;
+                }
+                ref_dm_round (6, array, &h0, &h1);
+        }
+
+        for (j = 0; j < 4; j++) {
+                if (full_words) {
+                        array[j] = *intmsg++;
+                        full_words--;
+                        full_bytes -= 4;
+                } else {
+                        array[j] = pad;
+                        while (full_bytes) {
+                                array[j] <<= 8;
+                                array[j] |= msg[len - full_bytes];
+                                full_bytes--;
+                        }
+                }
+        }
+        ref_dm_round (10, array, &h0, &h1);
+
+        return h0 ^ h1;
+}
+
+static double
+dmhash_bm_now (void)
+{
+        struct timeval tv = {0, };
+
+        gettimeofday (&tv, NULL);
+
+        return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void
+dmhash_bm_report (const char *name, double start, uint32_t sink)
+{
+        double   elapsed = dmhash_bm_now () - start;
+        double   total   = (double) config.names * config.passes;
+
+        printf ("%-10s: %.0f names in %.3f s, %.1f Mnames/s (%08x)\n", name,
+                total, elapsed, elapsed ? total / elapsed / 1000000 : 0,
+                sink);
+}
+
+static void
+usage (const char *prog)
+{
+        fprintf (stderr, "usage: %s [-n names-per-batch] [-l max-name-len] "
+                 "[-p passes]\n", prog);
+        exit (1);
+}
+
+int
+main (int argc, char *argv[])
+{
+        const char  **names  = NULL;
+        int          *lens   = NULL;
+        uint32_t     *hashes = NULL;
+        uint32_t      sink   = 0;
+        double        start  = 0;
+        int           opt    = 0;
+        int           i      = 0;
+        int           j      = 0;
+        int           p      = 0;
+        char         *name   = NULL;
+
+        while ((opt = getopt (argc, argv, "n:l:p:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        config.names = atoi (optarg);
+                        break;
+                case 'l':
+                        config.maxlen = atoi (optarg);
+                        break;
+                case 'p':
+                        config.passes = atoi (optarg);
+                        break;
+                default:
+                        usage (argv[0]);
+                }
+        }
+
+        if (optind != argc || config.names <= 0 || config.maxlen <= 0 ||
+            config.passes <= 0)
+                usage (argv[0]);
+
+        names = calloc (config.names, sizeof (*names));
+        lens = calloc (config.names, sizeof (*lens));
+        hashes = calloc (config.names, sizeof (*hashes));
+        if (!names || !lens || !hashes)
+                return 1;
+
+        for (i = 0; i < config.names; i++) {
+                lens[i] = 1 + random () % config.maxlen;
+                name = malloc (lens[i] + 1);
+                if (!name)
+                        return 1;
+                for (j = 0; j < lens[i]; j++)
+                        name[j] = 1 + random () % 255;
+                name[j] = '\0';
+                names[i] = name;
+        }
+
+        gf_dm_hashfn_batch (names, lens, hashes, config.names);
+        for (i = 0; i < config.names; i++) {
+                if ((hashes[i] != ref_dm_hashfn (names[i], lens[i])) ||
+                    (gf_dm_hashfn (names[i], lens[i]) != hashes[i])) {
+                        fprintf (stderr, "hash mismatch for name %d\n", i);
+                        return 1;
+                }
+        }
+
+        start = dmhash_bm_now ();
+        for (p = 0, sink = 0; p < config.passes; p++)
+                for (i = 0; i < config.names; i++)
+                        sink += ref_dm_hashfn (names[i], lens[i]);
+        dmhash_bm_report ("reference", start, sink);
+
+        start = dmhash_bm_now ();
+        for (p = 0, sink = 0; p < config.passes; p++)
+                for (i = 0; i < config.names; i++)
+                        sink += gf_dm_hashfn (names[i], lens[i]);
+        dmhash_bm_report ("single", start, sink);
+
+        start = dmhash_bm_now ();
+        for (p = 0, sink = 0; p < config.passes; p++) {
+                gf_dm_hashfn_batch (names, lens, hashes, config.names);
+                for (i = 0; i < config.names; i++)
+                        sink += hashes[i];
+        }
+        dmhash_bm_report ("batch", start, sink);
+
+        return 0;
+}
@@ -0,0 +1,222 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* hashtable-bm: concurrent lookups in an rbthash table and in a chash table
+   holding the same page-offset keys io-cache uses, to compare the two.
+
+   Every thread does a fixed number of lookups of random present keys. With
+   -w, that percentage of the operations instead removes a key and inserts
+   it back, so readers also contend with writers.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "glusterfs.h"
+#include "globals.h"
+#include "rbthash.h"
+#include "chash.h"
+
+#define HASHTABLE_BM_PAGE_SHIFT 17
+
+struct hashtable_bm_config {
+        int               threads;
+        int               entries;
+        int               ops;
+        int               buckets;
+        int               stripes;
+        int               writes;
+        rbthash_table_t  *rbt;
+        chash_table_t    *cht;
+};
+
+static struct hashtable_bm_config config = {
+        .threads   = 64,
+        .entries   = 65536,
+        .ops       = 1000000,
+        .buckets   = 1,
+        .stripes   = 16,
+        .writes    = 0,
+};
+
+static off_t *offsets;
+static int    use_chash;
+
+static uint32_t
+hashtable_bm_hashfn (void *data, int len)
+{
+        return (*(off_t *)data) >> HASHTABLE_BM_PAGE_SHIFT;
+}
+
+static void *
+hashtable_bm_worker (void *arg)
+{
+        unsigned int  seed  = (unsigned long) arg;
+        uint64_t      found = 0;
+        off_t        *key   = NULL;
+        void         *data  = NULL;
+        int           i     = 0;
+
+        for (i = 0; i < config.ops; i++) {
+                key = &offsets[rand_r (&seed) % config.entries];
+
+                if (config.writes && (rand_r (&seed) % 100) < config.writes) {
+                        if (use_chash) {
+                                data = chash_remove (config.cht, key,
+                                                     sizeof (*key));
+                                if (data)
+                                        chash_insert (config.cht, data, key,
+                                                      sizeof (*key));
+                        } else {
+                                data = rbthash_remove (config.rbt, key,
+                                                       sizeof (*key));
+                                if (data)
+                                        rbthash_insert (config.rbt, data, key,
+                                                        sizeof (*key));
+                        }
+                        continue;
+                }
+
+                if (use_chash)
+                        data = chash_get (config.cht, key, sizeof (*key));
+                else
+                        data = rbthash_get (config.rbt, key, sizeof (*key));
+                if (data)
+                        found++;
+        }
+
+        return (void *)(long) found;
+}
+
+static double
+hashtable_bm_run (const char *name)
+{
+        pthread_t       *tids    = NULL;
+        struct timeval   start   = {0, };
+        struct timeval   end     = {0, };
+        double           elapsed = 0;
+        uint64_t         total   = 0;
+        uint64_t         found   = 0;
+        void            *ret     = NULL;
+        int              i       = 0;
+
+        tids = calloc (config.threads, sizeof (*tids));
+        if (!tids)
+                exit (1);
+
+        gettimeofday (&start, NULL);
+        for (i = 0; i < config.threads; i++)
+                pthread_create (&tids[i], NULL, hashtable_bm_worker,
+                                (void *)(long)(i + 1));
+        for (i = 0; i < config.threads; i++) {
+                pthread_join (tids[i], &ret);
+                found += (long) ret;
+        }
+        gettimeofday (&end, NULL);
+
+        elapsed = (end.tv_sec - start.tv_sec) +
+                  (end.tv_usec - start.tv_usec) / 1000000.0;
+        total = (uint64_t) config.threads * config.ops;
+
+        printf ("%-8s: %d thread(s), %"PRIu64" ops (%"PRIu64" hits) in "
+                "%.3f s, %.2f Mops/s\n", name, config.threads, total, found,
+                elapsed, elapsed ? total / elapsed / 1000000 : 0);
+
+        free (tids);
+
+        return elapsed;
+}
+
+static void
+usage (const char *prog)
+{
+        fprintf (stderr, "usage: %s [-t threads] [-n entries] [-o ops] "
+                 "[-b rbthash-buckets] [-s chash-stripes] [-w write%%]\n",
+                 prog);
+        exit (1);
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t *ctx     = NULL;
+        int              opt     = 0;
+        int              i       = 0;
+
+        while ((opt = getopt (argc, argv, "t:n:o:b:s:w:")) != -1) {
+                switch (opt) {
+                case 't':
+                        config.threads = atoi (optarg);
+                        break;
+                case 'n':
+                        config.entries = atoi (optarg);
+                        break;
+                case 'o':
+                        config.ops = atoi (optarg);
+                        break;
+                case 'b':
+                        config.buckets = atoi (optarg);
+                        break;
+                case 's':
+                        config.stripes = atoi (optarg);
+                        break;
+                case 'w':
+                        config.writes = atoi (optarg);
+                        break;
+                default:
+                        usage (argv[0]);
+                }
+        }
+
+        if (optind != argc || config.threads <= 0 || config.entries <= 0 ||
+            config.ops <= 0 || config.buckets <= 0 || config.stripes <= 0 ||
+            config.writes < 0 || config.writes > 100)
+                usage (argv[0]);
+
+        ctx = glusterfs_ctx_new ();
+        if (!ctx || glusterfs_globals_init (ctx))
+                return 1;
+        THIS->ctx = ctx;
+        INIT_LIST_HEAD (&ctx->mempool_list);
+
+        offsets = calloc (config.entries, sizeof (*offsets));
+        if (!offsets)
+                return 1;
+
+        config.rbt = rbthash_table_init (config.buckets, hashtable_bm_hashfn,
+                                         NULL, config.entries, NULL);
+        config.cht = chash_table_init (config.stripes, config.entries,
+                                       hashtable_bm_hashfn, NULL);
+        if (!config.rbt || !config.cht)
+                return 1;
+
+        for (i = 0; i < config.entries; i++) {
+                offsets[i] = (off_t) i << HASHTABLE_BM_PAGE_SHIFT;
+                rbthash_insert (config.rbt, &offsets[i], &offsets[i],
+                                sizeof (offsets[i]));
+                chash_insert (config.cht, &offsets[i], &offsets[i],
+                              sizeof (offsets[i]));
+        }
+
+        use_chash = 0;
+        hashtable_bm_run ("rbthash");
+        use_chash = 1;
+        hashtable_bm_run ("chash");
+
+        rbthash_table_destroy (config.rbt);
+        chash_table_destroy (config.cht);
+        free (offsets);
+
+        return 0;
+}
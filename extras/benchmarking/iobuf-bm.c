@@ -0,0 +1,191 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* iobuf-bm: sequential 1MB reads of a file into iobufs, to compare the
+   arena memory policies (normal pages, transparent huge pages, hugetlb
+   pages, NUMA local arenas) with each other.
+
+   Every thread reads the whole file once per pass, 1MB at a time, into
+   an iobuf taken from the pool and sums the buffer the way a consumer
+   copying the data out would.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "glusterfs.h"
+#include "globals.h"
+#include "iobuf.h"
+
+#define IOBUF_BM_BLOCK (1 * GF_UNIT_MB)
+
+struct iobuf_bm_config {
+        char                  *path;
+        int                    threads;
+        int                    passes;
+        gf_iobuf_hugepages_t   hugepages;
+        gf_boolean_t           numa;
+        struct iobuf_pool     *pool;
+};
+
+static struct iobuf_bm_config config = {
+        .threads   = 1,
+        .passes    = 4,
+};
+
+static uint64_t total_bytes;
+static pthread_mutex_t total_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void *
+iobuf_bm_reader (void *arg)
+{
+        struct iobuf *iobuf  = NULL;
+        uint64_t      bytes  = 0;
+        uint64_t      sum    = 0;
+        off_t         offset = 0;
+        ssize_t       ret    = 0;
+        ssize_t       i      = 0;
+        int           fd     = -1;
+        int           pass   = 0;
+
+        fd = open (config.path, O_RDONLY);
+        if (fd < 0) {
+                fprintf (stderr, "open(%s): %s\n", config.path,
+                         strerror (errno));
+                return NULL;
+        }
+
+        for (pass = 0; pass < config.passes; pass++) {
+                offset = 0;
+                for (;;) {
+                        iobuf = iobuf_get2 (config.pool, IOBUF_BM_BLOCK);
+                        if (!iobuf) {
+                                fprintf (stderr, "iobuf_get2 failed\n");
+                                goto out;
+                        }
+
+                        ret = pread (fd, iobuf->ptr, IOBUF_BM_BLOCK, offset);
+                        if (ret <= 0) {
+                                iobuf_unref (iobuf);
+                                break;
+                        }
+
+                        for (i = 0; i < ret; i += sizeof (uint64_t))
+                                sum += *(uint64_t *)(iobuf->ptr + i);
+
+                        iobuf_unref (iobuf);
+                        offset += ret;
+                        bytes += ret;
+                }
+        }
+out:
+        close (fd);
+
+        pthread_mutex_lock (&total_lock);
+        {
+                total_bytes += bytes;
+        }
+        pthread_mutex_unlock (&total_lock);
+
+        /* keep the summing loop from being optimized away */
+        return (void *)(long)(sum & 1);
+}
+
+static void
+usage (const char *prog)
+{
+        fprintf (stderr, "usage: %s [-t threads] [-p passes] "
+                 "[-H thp|hugetlb] [-n] file\n", prog);
+        exit (1);
+}
+
+int
+main (int argc, char *argv[])
+{
+        glusterfs_ctx_t *ctx     = NULL;
+        pthread_t       *tids    = NULL;
+        struct timeval   start   = {0, };
+        struct timeval   end     = {0, };
+        double           elapsed = 0;
+        uint64_t         total_mb = 0;
+        int              opt     = 0;
+        int              i       = 0;
+
+        while ((opt = getopt (argc, argv, "t:p:H:n")) != -1) {
+                switch (opt) {
+                case 't':
+                        config.threads = atoi (optarg);
+                        break;
+                case 'p':
+                        config.passes = atoi (optarg);
+                        break;
+                case 'H':
+                        if (!strcmp (optarg, "thp"))
+                                config.hugepages = GF_IOBUF_HUGEPAGES_THP;
+                        else if (!strcmp (optarg, "hugetlb"))
+                                config.hugepages = GF_IOBUF_HUGEPAGES_HUGETLB;
+                        else
+                                usage (argv[0]);
+                        break;
+                case 'n':
+                        config.numa = _gf_true;
+                        break;
+                default:
+                        usage (argv[0]);
+                }
+        }
+
+        if (optind != argc - 1 || config.threads <= 0 || config.passes <= 0)
+                usage (argv[0]);
+        config.path = argv[optind];
+
+        ctx = glusterfs_ctx_new ();
+        if (!ctx || glusterfs_globals_init (ctx))
+                return 1;
+        THIS->ctx = ctx;
+        INIT_LIST_HEAD (&ctx->mempool_list);
+
+        config.pool = iobuf_pool_new ();
+        if (!config.pool)
+                return 1;
+        iobuf_pool_set_mem_policy (config.pool, config.hugepages, config.numa);
+
+        tids = calloc (config.threads, sizeof (*tids));
+        if (!tids)
+                return 1;
+
+        gettimeofday (&start, NULL);
+        for (i = 0; i < config.threads; i++)
+                pthread_create (&tids[i], NULL, iobuf_bm_reader, NULL);
+        for (i = 0; i < config.threads; i++)
+                pthread_join (tids[i], NULL);
+        gettimeofday (&end, NULL);
+
+        elapsed = (end.tv_sec - start.tv_sec) +
+                  (end.tv_usec - start.tv_usec) / 1000000.0;
+
+        total_mb = total_bytes / GF_UNIT_MB;
+        printf ("%s: %d thread(s), %"PRIu64" MB in %.3f s, %.1f MB/s\n",
+                (config.hugepages == GF_IOBUF_HUGEPAGES_HUGETLB) ? "hugetlb" :
+                (config.hugepages == GF_IOBUF_HUGEPAGES_THP) ? "thp" :
+                "normal", config.threads, total_mb, elapsed,
+                elapsed ? total_mb / elapsed : 0);
+
+        iobuf_pool_destroy (config.pool);
+        free (tids);
+
+        return 0;
+}
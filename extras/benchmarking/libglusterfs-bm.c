@@ -0,0 +1,474 @@
+/*
+   Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* libglusterfs-bm: the hot paths of libglusterfs under 1..N threads,
+   without a volume: dict set/get/serialize, inode link/find/unref, iobuf
+   get/unref, mem_pool get/put, fd table get/lookup/put, timer arm/cancel
+   and call-stub create/destroy.
+
+   Every case runs with 1, 2, 4 ... threads up to -t, each thread doing -n
+   operations on objects shared the way the translators share them (one
+   inode table, one iobuf pool, one fd table ...).  One line is printed per
+   case and thread count, whitespace separated and in a fixed order, so the
+   output of two commits can be compared with diff or a spreadsheet:
+
+       case threads ops seconds ns/op
+
+   ns/op is wall clock time divided by the operations of all threads.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "glusterfs.h"
+#include "globals.h"
+#include "xlator.h"
+#include "dict.h"
+#include "inode.h"
+#include "fd.h"
+#include "iobuf.h"
+#include "mem-pool.h"
+#include "timer.h"
+#include "stack.h"
+#include "call-stub.h"
+
+#define LGBM_DICT_KEYS 8
+#define LGBM_POOL_COUNT 4096   /* as glusterfsd sizes the dict pools */
+
+struct lgbm_config {
+        int                   threads;
+        int                   ops;
+        const char           *only;
+        glusterfs_ctx_t      *ctx;
+        xlator_t             *xl;
+        inode_table_t        *itable;
+        inode_t              *inode;
+        fdtable_t            *fdtable;
+        struct iobuf_pool    *iobuf_pool;
+        struct mem_pool      *mem_pool;
+};
+
+static struct lgbm_config config = {
+        .threads   = 8,
+        .ops       = 100000,
+};
+
+struct lgbm_case {
+        const char   *name;
+        int         (*run) (int thread);
+};
+
+/* every case returns non-zero on failure, which is reported and makes
+   the exit status non-zero */
+
+static int
+lgbm_dict (int thread)
+{
+        dict_t   *dict = NULL;
+        char      key[LGBM_DICT_KEYS][16];
+        char     *buf  = NULL;
+        char     *str  = NULL;
+        int64_t   val  = 0;
+        u_int     len  = 0;
+        int       i    = 0;
+        int       k    = 0;
+
+        for (k = 0; k < LGBM_DICT_KEYS; k++)
+                snprintf (key[k], sizeof (key[k]), "key-%d", k);
+
+        for (i = 0; i < config.ops; i++) {
+                dict = dict_new ();
+                if (!dict)
+                        return -1;
+
+                for (k = 0; k < LGBM_DICT_KEYS; k += 2) {
+                        if (dict_set_str (dict, key[k], "value") ||
+                            dict_set_int64 (dict, key[k + 1], i))
+                                return -1;
+                }
+                for (k = 0; k < LGBM_DICT_KEYS; k += 2) {
+                        if (dict_get_str (dict, key[k], &str) ||
+                            dict_get_int64 (dict, key[k + 1], &val))
+                                return -1;
+                }
+
+                if (dict_allocate_and_serialize (dict, &buf, &len))
+                        return -1;
+
+                GF_FREE (buf);
+                dict_unref (dict);
+        }
+
+        return 0;
+}
+
+static int
+lgbm_inode (int thread)
+{
+        inode_t      *inode  = NULL;
+        inode_t      *linked = NULL;
+        inode_t      *found  = NULL;
+        struct iatt   iatt   = {0, };
+        char          name[64];
+        int           i      = 0;
+
+        iatt.ia_type = IA_IFREG;
+
+        for (i = 0; i < config.ops; i++) {
+                snprintf (name, sizeof (name), "t%d-%d", thread, i);
+                uuid_generate (iatt.ia_gfid);
+
+                inode = inode_new (config.itable);
+                if (!inode)
+                        return -1;
+
+                linked = inode_link (inode, config.itable->root, name, &iatt);
+                inode_unref (inode);
+                if (!linked)
+                        return -1;
+                inode_lookup (linked);
+
+                found = inode_find (config.itable, iatt.ia_gfid);
+                if (found != linked)
+                        return -1;
+                inode_unref (found);
+
+                inode_unlink (linked, config.itable->root, name);
+                inode_forget (linked, 1);
+                inode_unref (linked);
+        }
+
+        return 0;
+}
+
+static int
+lgbm_iobuf (int thread)
+{
+        struct iobuf *iobuf = NULL;
+        int           i     = 0;
+
+        for (i = 0; i < config.ops; i++) {
+                iobuf = iobuf_get2 (config.iobuf_pool, 128 * GF_UNIT_KB);
+                if (!iobuf)
+                        return -1;
+                iobuf_unref (iobuf);
+        }
+
+        return 0;
+}
+
+static int
+lgbm_mem_pool (int thread)
+{
+        void *ptr = NULL;
+        int   i   = 0;
+
+        for (i = 0; i < config.ops; i++) {
+                ptr = mem_get (config.mem_pool);
+                if (!ptr)
+                        return -1;
+                mem_put (ptr);
+        }
+
+        return 0;
+}
+
+static int
+lgbm_fd (int thread)
+{
+        fd_t     *fd    = NULL;
+        fd_t     *found = NULL;
+        int32_t   fdno  = 0;
+        int       i     = 0;
+
+        for (i = 0; i < config.ops; i++) {
+                fd = fd_create (config.inode, 0);
+                if (!fd)
+                        return -1;
+
+                fdno = gf_fd_unused_get (config.fdtable, fd);
+                if (fdno < 0)
+                        return -1;
+
+                found = gf_fd_fdptr_get (config.fdtable, fdno);
+                if (found != fd)
+                        return -1;
+                fd_unref (found);
+
+                gf_fd_put (config.fdtable, fdno);
+        }
+
+        return 0;
+}
+
+static void
+lgbm_timer_cbk (void *data)
+{
+}
+
+static int
+lgbm_timer (int thread)
+{
+        gf_timer_t      *timer = NULL;
+        struct timespec  delta = {3600, 0};
+        int              i     = 0;
+
+        for (i = 0; i < config.ops; i++) {
+                /* spread the expiry over the wheel the way rpc timeouts and
+                   reconnects are */
+                delta.tv_nsec = (i % 1000) * 1000000;
+
+                timer = gf_timer_call_after (config.ctx, delta, lgbm_timer_cbk,
+                                             NULL);
+                if (!timer)
+                        return -1;
+                gf_timer_call_cancel (config.ctx, timer);
+        }
+
+        return 0;
+}
+
+static int32_t
+lgbm_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+        return 0;
+}
+
+static int
+lgbm_call_stub (int thread)
+{
+        call_frame_t *frame = NULL;
+        call_stub_t  *stub  = NULL;
+        loc_t         loc   = {0, };
+        int           i     = 0;
+
+        frame = create_frame (config.xl, config.ctx->pool);
+        if (!frame)
+                return -1;
+
+        loc.path = "/dir/file";
+        loc.name = "file";
+        loc.inode = config.inode;
+        loc.parent = config.itable->root;
+
+        for (i = 0; i < config.ops; i++) {
+                stub = fop_lookup_stub (frame, lgbm_lookup, &loc, NULL);
+                if (!stub)
+                        return -1;
+                call_stub_destroy (stub);
+        }
+
+        STACK_DESTROY (frame->root);
+
+        return 0;
+}
+
+static struct lgbm_case cases[] = {
+        { "dict",       lgbm_dict },
+        { "inode",      lgbm_inode },
+        { "iobuf",      lgbm_iobuf },
+        { "mem_pool",   lgbm_mem_pool },
+        { "fd",         lgbm_fd },
+        { "timer",      lgbm_timer },
+        { "call_stub",  lgbm_call_stub },
+        { NULL, NULL }
+};
+
+struct lgbm_thread {
+        pthread_t          tid;
+        int                thread;
+        struct lgbm_case  *bm;
+        int                ret;
+};
+
+static void *
+lgbm_thread (void *arg)
+{
+        struct lgbm_thread *t = arg;
+
+        THIS = config.xl;
+
+        t->ret = t->bm->run (t->thread);
+
+        return NULL;
+}
+
+static int
+lgbm_run (struct lgbm_case *bm, int threads)
+{
+        struct lgbm_thread *t       = NULL;
+        struct timeval      start   = {0, };
+        struct timeval      end     = {0, };
+        double              elapsed = 0;
+        uint64_t            ops     = 0;
+        int                 ret     = 0;
+        int                 i       = 0;
+
+        t = calloc (threads, sizeof (*t));
+        if (!t)
+                return -1;
+
+        gettimeofday (&start, NULL);
+        for (i = 0; i < threads; i++) {
+                t[i].thread = i;
+                t[i].bm = bm;
+                pthread_create (&t[i].tid, NULL, lgbm_thread, &t[i]);
+        }
+        for (i = 0; i < threads; i++) {
+                pthread_join (t[i].tid, NULL);
+                ret |= t[i].ret;
+        }
+        gettimeofday (&end, NULL);
+
+        elapsed = (end.tv_sec - start.tv_sec) +
+                  (end.tv_usec - start.tv_usec) / 1000000.0;
+        ops = (uint64_t) config.ops * threads;
+
+        if (ret)
+                fprintf (stderr, "%s: failed with %d thread(s)\n", bm->name,
+                         threads);
+        else
+                printf ("%-10s %3d %10"PRIu64" %8.3f %10.1f\n", bm->name,
+                        threads, ops, elapsed, elapsed * 1e9 / ops);
+
+        free (t);
+
+        return ret;
+}
+
+static int
+lgbm_setup (void)
+{
+        glusterfs_ctx_t *ctx = NULL;
+        xlator_t        *xl  = NULL;
+
+        ctx = glusterfs_ctx_new ();
+        if (!ctx || glusterfs_globals_init (ctx))
+                return -1;
+        THIS->ctx = ctx;
+        INIT_LIST_HEAD (&ctx->mempool_list);
+
+        ctx->pool = calloc (1, sizeof (*ctx->pool));
+        if (!ctx->pool)
+                return -1;
+        INIT_LIST_HEAD (&ctx->pool->all_frames);
+        LOCK_INIT (&ctx->pool->lock);
+        ctx->pool->frame_mem_pool = mem_pool_new (call_frame_t, 4096);
+        ctx->pool->stack_mem_pool = mem_pool_new (call_stack_t, 1024);
+        ctx->stub_mem_pool = mem_pool_new (call_stub_t, 1024);
+        ctx->dict_pool = mem_pool_new (dict_t, LGBM_POOL_COUNT);
+        ctx->dict_pair_pool = mem_pool_new (data_pair_t, LGBM_POOL_COUNT);
+        ctx->dict_data_pool = mem_pool_new (data_t, LGBM_POOL_COUNT);
+        if (!ctx->pool->frame_mem_pool || !ctx->pool->stack_mem_pool ||
+            !ctx->stub_mem_pool || !ctx->dict_pool ||
+            !ctx->dict_pair_pool || !ctx->dict_data_pool)
+                return -1;
+
+        /* the translator owning the inode table, fds and frames */
+        xl = calloc (1, sizeof (*xl));
+        if (!xl)
+                return -1;
+        xl->name = "libglusterfs-bm";
+        xl->type = "benchmark";
+        xl->ctx = ctx;
+        xl->graph = calloc (1, sizeof (*xl->graph));
+        if (!xl->graph)
+                return -1;
+        THIS = xl;
+
+        config.ctx = ctx;
+        config.xl = xl;
+
+        config.itable = inode_table_new (0, xl);
+        if (!config.itable)
+                return -1;
+        config.inode = inode_new (config.itable);
+        config.fdtable = gf_fd_fdtable_alloc ();
+        config.iobuf_pool = iobuf_pool_new ();
+        config.mem_pool = mem_pool_new (call_frame_t, 1024);
+        if (!config.inode || !config.fdtable || !config.iobuf_pool ||
+            !config.mem_pool)
+                return -1;
+        ctx->iobuf_pool = config.iobuf_pool;
+
+        return 0;
+}
+
+static void
+usage (const char *prog)
+{
+        struct lgbm_case *bm = NULL;
+
+        fprintf (stderr, "usage: %s [-t max-threads] [-n ops-per-thread] "
+                 "[case]\ncases:", prog);
+        for (bm = cases; bm->name; bm++)
+                fprintf (stderr, " %s", bm->name);
+        fprintf (stderr, "\n");
+        exit (1);
+}
+
+int
+main (int argc, char *argv[])
+{
+        struct lgbm_case *bm      = NULL;
+        int               threads = 0;
+        int               opt     = 0;
+        int               ret     = 0;
+
+        while ((opt = getopt (argc, argv, "t:n:")) != -1) {
+                switch (opt) {
+                case 't':
+                        config.threads = atoi (optarg);
+                        break;
+                case 'n':
+                        config.ops = atoi (optarg);
+                        break;
+                default:
+                        usage (argv[0]);
+                }
+        }
+
+        if (optind < argc - 1 || config.threads <= 0 || config.ops <= 0)
+                usage (argv[0]);
+        if (optind == argc - 1) {
+                config.only = argv[optind];
+                for (bm = cases; bm->name; bm++)
+                        if (!strcmp (config.only, bm->name))
+                                break;
+                if (!bm->name)
+                        usage (argv[0]);
+        }
+
+        if (lgbm_setup ()) {
+                fprintf (stderr, "setting up libglusterfs failed\n");
+                return 1;
+        }
+
+        printf ("# case threads ops seconds ns/op\n");
+
+        for (bm = cases; bm->name; bm++) {
+                if (config.only && strcmp (config.only, bm->name))
+                        continue;
+
+                for (threads = 1; ; threads *= 2) {
+                        if (threads > config.threads)
+                                threads = config.threads;
+                        ret |= lgbm_run (bm, threads);
+                        if (threads == config.threads)
+                                break;
+                }
+        }
+
+        return ret ? 1 : 0;
+}
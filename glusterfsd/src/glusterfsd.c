@@ -61,6 +61,7 @@
 #include "globals.h"
 #include "statedump.h"
 #include "latency.h"
+#include "metrics.h"
 #include "glusterfsd-mem-types.h"
 #include "syscall.h"
 #include "call-stub.h"
@@ -109,6 +110,12 @@ static struct argp_option gf_options[] = {
         {"log-file", ARGP_LOG_FILE_KEY, "LOGFILE", 0,
          "File to use for logging [default: "
          DEFAULT_LOG_FILE_DIRECTORY "/" PACKAGE_NAME ".log" "]"},
+        {"log-sync", ARGP_LOG_SYNC_KEY, 0, 0,
+         "Write log messages from the logging thread instead of a "
+         "background log writer"},
+        {"log-rate-limit", ARGP_LOG_RATE_LIMIT_KEY, "N", 0,
+         "Drop log messages beyond N per second and thread "
+         "[default: 0, no limit]"},
 
         {0, 0, 0, 0, "Advanced Options:"},
         {"volfile-server-port", ARGP_VOLFILE_SERVER_PORT_KEY, "PORT", 0,
@@ -165,6 +172,19 @@ static struct argp_option gf_options[] = {
          "Brick Port to be registered with Gluster portmapper" },
 	{"fopen-keep-cache", ARGP_FOPEN_KEEP_CACHE_KEY, "BOOL", OPTION_ARG_OPTIONAL,
 	 "Do not purge the cache on file open"},
+        {"event-threads", ARGP_EVENT_THREADS_KEY, "N", 0,
+         "Number of threads dispatching network events [default: 1]"},
+        {"graph-init-threads", ARGP_GRAPH_INIT_THREADS_KEY, "N", 0,
+         "Number of threads initializing translators of a graph, 1 to "
+         "initialize them one by one [default: 8]"},
+        {"iobuf-hugepages", ARGP_IOBUF_HUGEPAGES_KEY, "thp|hugetlb", 0,
+         "Back I/O buffer arenas with huge pages"},
+        {"iobuf-numa", ARGP_IOBUF_NUMA_KEY, 0, 0,
+         "Allocate I/O buffer arenas on the NUMA node of the allocating "
+         "thread"},
+        {"metrics-socket", ARGP_METRICS_SOCKET_KEY, "PATH", 0,
+         "Write a JSON snapshot of the process counters to every connection "
+         "on unix socket PATH"},
 
         {0, 0, 0, 0, "Fuse options:"},
         {"direct-io-mode", ARGP_DIRECT_IO_MODE_KEY, "BOOL", OPTION_ARG_OPTIONAL,
@@ -839,6 +859,22 @@ parse_opts (int key, char *arg, struct argp_state *state)
                 cmd_args->log_file = gf_strdup (arg);
                 break;
 
+        case ARGP_LOG_SYNC_KEY:
+                cmd_args->log_sync = 1;
+                break;
+
+        case ARGP_LOG_RATE_LIMIT_KEY:
+                n = 0;
+
+                if (gf_string2uint_base10 (arg, &n) == 0) {
+                        cmd_args->log_rate_limit = n;
+                        break;
+                }
+
+                argp_failure (state, -1, 0,
+                              "unknown log rate limit %s", arg);
+                break;
+
         case ARGP_VOLFILE_SERVER_PORT_KEY:
                 n = 0;
 
@@ -1022,6 +1058,46 @@ parse_opts (int key, char *arg, struct argp_state *state)
 
 		break;
 
+        case ARGP_EVENT_THREADS_KEY:
+                if (!gf_string2int (arg, &cmd_args->event_threads) &&
+                    cmd_args->event_threads > 0)
+                        break;
+
+                argp_failure (state, -1, 0,
+                              "unknown event threads count %s", arg);
+                break;
+
+        case ARGP_GRAPH_INIT_THREADS_KEY:
+                if (!gf_string2int (arg, &cmd_args->graph_init_threads) &&
+                    cmd_args->graph_init_threads > 0)
+                        break;
+
+                argp_failure (state, -1, 0,
+                              "unknown graph init threads count %s", arg);
+                break;
+
+        case ARGP_IOBUF_HUGEPAGES_KEY:
+                if (strcmp (arg, "thp") == 0) {
+                        cmd_args->iobuf_hugepages = GF_IOBUF_HUGEPAGES_THP;
+                        break;
+                }
+                if (strcmp (arg, "hugetlb") == 0) {
+                        cmd_args->iobuf_hugepages = GF_IOBUF_HUGEPAGES_HUGETLB;
+                        break;
+                }
+
+                argp_failure (state, -1, 0,
+                              "unknown iobuf hugepages setting \"%s\"", arg);
+                break;
+
+        case ARGP_IOBUF_NUMA_KEY:
+                cmd_args->iobuf_numa = 1;
+                break;
+
+        case ARGP_METRICS_SOCKET_KEY:
+                cmd_args->metrics_socket = gf_strdup (arg);
+                break;
+
 	case ARGP_GID_TIMEOUT_KEY:
 		if (!gf_string2int(arg, &cmd_args->gid_timeout))
 			break;
@@ -1242,15 +1318,17 @@ glusterfs_ctx_defaults_init (glusterfs_ctx_t *ctx)
         INIT_LIST_HEAD (&ctx->pool->all_frames);
         LOCK_INIT (&ctx->pool->lock);
 
-        /* frame_mem_pool size 112 * 4k */
-        ctx->pool->frame_mem_pool = mem_pool_new (call_frame_t, 4096);
+        /* frame_mem_pool size 184 * 1k, frames beyond the slab of a
+           stack only */
+        ctx->pool->frame_mem_pool = mem_pool_new (call_frame_t, 1024);
         if (!ctx->pool->frame_mem_pool) {
                 gf_log ("", GF_LOG_CRITICAL,
                         "ERROR: glusterfs frame pool creation failed");
                 goto out;
         }
-        /* stack_mem_pool size 256 * 1024 */
-        ctx->pool->stack_mem_pool = mem_pool_new (call_stack_t, 1024);
+        /* stack_mem_pool size 4.8k * 512, with the slab of
+           CALL_STACK_FRAME_SLAB frames */
+        ctx->pool->stack_mem_pool = mem_pool_new (call_stack_t, 512);
         if (!ctx->pool->stack_mem_pool) {
                 gf_log ("", GF_LOG_CRITICAL,
                         "ERROR: glusterfs stack pool creation failed");
@@ -1858,6 +1936,10 @@ glusterfs_volumes_init (glusterfs_ctx_t *ctx)
                         goto out;
         }
 
+        /* not fatal, the process is of use without it */
+        if (cmd_args->metrics_socket)
+                gf_metrics_listen (ctx, cmd_args->metrics_socket);
+
         if (cmd_args->volfile_server) {
                 ret = glusterfs_mgmt_init (ctx);
                 /* return, do not emancipate() yet */
@@ -1942,6 +2024,13 @@ main (int argc, char *argv[])
 
         gf_proc_dump_init();
 
+        /* the pool exists since glusterfs_ctx_defaults_init(), only arenas
+           added from now on follow the policy */
+        if (ctx->cmd_args.iobuf_hugepages || ctx->cmd_args.iobuf_numa)
+                iobuf_pool_set_mem_policy (ctx->iobuf_pool,
+                                           ctx->cmd_args.iobuf_hugepages,
+                                           ctx->cmd_args.iobuf_numa);
+
         ret = create_fuse_mount (ctx);
         if (ret)
                 goto out;
@@ -1961,6 +2050,10 @@ main (int argc, char *argv[])
         if (ret)
                 goto out;
 
+        if (ctx->cmd_args.event_threads)
+                event_reconfigure_threads (ctx->event_pool,
+                                           ctx->cmd_args.event_threads);
+
         ret = event_dispatch (ctx->event_pool);
 
 out:
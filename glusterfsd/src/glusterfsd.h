@@ -84,6 +84,13 @@ enum argp_option_keys {
 	ARGP_FUSE_MOUNTOPTS_KEY		  = 164,
         ARGP_FUSE_USE_READDIRP_KEY        = 165,
 	ARGP_AUX_GFID_MOUNT_KEY		  = 166,
+        ARGP_EVENT_THREADS_KEY            = 167,
+        ARGP_IOBUF_HUGEPAGES_KEY          = 168,
+        ARGP_IOBUF_NUMA_KEY               = 169,
+        ARGP_LOG_SYNC_KEY                 = 170,
+        ARGP_LOG_RATE_LIMIT_KEY           = 171,
+        ARGP_METRICS_SOCKET_KEY           = 172,
+        ARGP_GRAPH_INIT_THREADS_KEY       = 173,
 };
 
 struct _gfd_vol_top_priv_t {
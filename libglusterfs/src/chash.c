@@ -0,0 +1,479 @@
+/*
+  Copyright (c) 2008-2012 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#include "chash.h"
+#include "locking.h"
+#include "mem-pool.h"
+#include "logging.h"
+#include "statedump.h"
+
+#include <pthread.h>
+#include <string.h>
+
+/* Callers' hash functions are often an identity on small integers (page
+ * numbers, inode numbers), so spread the bits before the upper ones are
+ * used to pick a stripe.  Zero is reserved for empty slots. */
+static inline uint32_t
+chash_mix (uint32_t h)
+{
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+
+        return h ? h : 1;
+}
+
+
+static inline struct chash_stripe *
+chash_hash_stripe (chash_table_t *tbl, uint32_t hash)
+{
+        if (tbl->nstripes == 1)
+                return &tbl->stripes[0];
+
+        return &tbl->stripes[hash >> tbl->stripe_shift];
+}
+
+
+static inline void *
+chash_slot_key (struct chash_slot *slot)
+{
+        if (slot->keylen <= CHASH_INLINE_KEYLEN)
+                return slot->k.inline_key;
+
+        return slot->k.key;
+}
+
+
+static inline void
+chash_slot_clear (struct chash_slot *slot)
+{
+        if (slot->keylen > CHASH_INLINE_KEYLEN)
+                GF_FREE (slot->k.key);
+
+        memset (slot, 0, sizeof (*slot));
+}
+
+
+static inline int
+chash_slot_match (struct chash_slot *slot, uint32_t hash, void *key,
+                  int keylen)
+{
+        return ((slot->hash == hash) && (slot->keylen == keylen) &&
+                (memcmp (chash_slot_key (slot), key, keylen) == 0));
+}
+
+
+/* Returns the slot holding @key, or the empty slot where it would go. */
+static struct chash_slot *
+__chash_probe (struct chash_stripe *stripe, uint32_t hash, void *key,
+               int keylen)
+{
+        struct chash_slot *slot = NULL;
+        uint32_t           i    = 0;
+
+        for (i = hash & stripe->mask; ; i = (i + 1) & stripe->mask) {
+                slot = &stripe->slots[i];
+                if (!slot->hash || chash_slot_match (slot, hash, key, keylen))
+                        break;
+        }
+
+        return slot;
+}
+
+
+static int
+__chash_stripe_grow (struct chash_stripe *stripe)
+{
+        struct chash_slot *slots   = NULL;
+        struct chash_slot *slot    = NULL;
+        uint32_t           mask    = 0;
+        uint32_t           i       = 0;
+        uint32_t           j       = 0;
+
+        mask = (stripe->mask << 1) | 1;
+        slots = GF_CALLOC (mask + 1, sizeof (*slots),
+                           gf_common_mt_chash_slots);
+        if (!slots)
+                return -1;
+
+        for (i = 0; i <= stripe->mask; i++) {
+                slot = &stripe->slots[i];
+                if (!slot->hash)
+                        continue;
+
+                for (j = slot->hash & mask; slots[j].hash;
+                     j = (j + 1) & mask)
+                        ;
+                slots[j] = *slot;
+        }
+
+        GF_FREE (stripe->slots);
+        stripe->slots = slots;
+        stripe->mask = mask;
+        stripe->resizes++;
+
+        return 0;
+}
+
+
+/*
+ * chash_table_init - Initialize a concurrent hash table
+ * @stripes - Number of lock stripes, rounded up to a power of two
+ * @expected_entries - Entries to size the table for; it grows past this
+ * @hfunc   - hashing function
+ * @dfunc   - destroyer for data still in the table at destroy time
+ */
+chash_table_t *
+chash_table_init (int stripes, unsigned long expected_entries,
+                  chash_hasher_t hfunc, chash_data_destroyer_t dfunc)
+{
+        chash_table_t   *newtab  = NULL;
+        unsigned long    perslot = 0;
+        uint32_t         nslots  = CHASH_MIN_SLOTS;
+        int              bits    = 0;
+        int              i       = 0;
+
+        if (!hfunc) {
+                gf_log (GF_CHASH, GF_LOG_ERROR, "Hash function not given");
+                return NULL;
+        }
+
+        if (stripes > CHASH_MAX_STRIPES)
+                stripes = CHASH_MAX_STRIPES;
+        while ((1 << bits) < stripes)
+                bits++;
+
+        newtab = GF_CALLOC (1, sizeof (*newtab), gf_common_mt_chash_table_t);
+        if (!newtab)
+                return NULL;
+
+        newtab->nstripes = 1 << bits;
+        newtab->stripe_shift = 32 - bits;
+        newtab->hashfunc = hfunc;
+        newtab->dfunc = dfunc;
+
+        /* keep each stripe at most 3/4 full for the expected load */
+        perslot = (expected_entries * 4 / 3) / newtab->nstripes + 1;
+        while (nslots < perslot)
+                nslots <<= 1;
+
+        newtab->stripes = GF_CALLOC (newtab->nstripes,
+                                     sizeof (struct chash_stripe),
+                                     gf_common_mt_chash_stripe);
+        if (!newtab->stripes)
+                goto err;
+
+        for (i = 0; i < newtab->nstripes; i++) {
+                newtab->stripes[i].slots = GF_CALLOC (nslots,
+                                                      sizeof (struct chash_slot),
+                                                      gf_common_mt_chash_slots);
+                if (!newtab->stripes[i].slots) {
+                        gf_log (GF_CHASH, GF_LOG_ERROR, "Failed to allocate "
+                                "hash table stripe");
+                        goto err;
+                }
+                newtab->stripes[i].mask = nslots - 1;
+                pthread_rwlock_init (&newtab->stripes[i].lock, NULL);
+        }
+
+        gf_log (GF_CHASH, GF_LOG_TRACE, "Inited hash table: stripes: %d, "
+                "slots per stripe: %u", newtab->nstripes, nslots);
+
+        return newtab;
+
+err:
+        if (newtab->stripes) {
+                while (--i >= 0) {
+                        pthread_rwlock_destroy (&newtab->stripes[i].lock);
+                        GF_FREE (newtab->stripes[i].slots);
+                }
+                GF_FREE (newtab->stripes);
+        }
+        GF_FREE (newtab);
+
+        return NULL;
+}
+
+
+int
+chash_insert (chash_table_t *tbl, void *data, void *key, int keylen)
+{
+        struct chash_stripe *stripe = NULL;
+        struct chash_slot   *slot   = NULL;
+        void                *kcopy  = NULL;
+        uint32_t             hash   = 0;
+        int                  ret    = -1;
+
+        if ((!tbl) || (!data) || (!key) || (keylen <= 0))
+                return -1;
+
+        hash = chash_mix (tbl->hashfunc (key, keylen));
+        stripe = chash_hash_stripe (tbl, hash);
+
+        if (keylen > CHASH_INLINE_KEYLEN) {
+                kcopy = GF_CALLOC (keylen, sizeof (char), gf_common_mt_char);
+                if (!kcopy)
+                        return -1;
+                memcpy (kcopy, key, keylen);
+        }
+
+        pthread_rwlock_wrlock (&stripe->lock);
+        {
+                if (((stripe->count + 1) * 4 > (stripe->mask + 1) * 3) &&
+                    (__chash_stripe_grow (stripe) != 0)) {
+                        gf_log (GF_CHASH, GF_LOG_ERROR, "Failed to grow "
+                                "hash table stripe");
+                        goto unlock;
+                }
+
+                slot = __chash_probe (stripe, hash, key, keylen);
+                if (slot->hash) {
+                        gf_log (GF_CHASH, GF_LOG_DEBUG, "Key already "
+                                "present");
+                        goto unlock;
+                }
+
+                slot->hash = hash;
+                slot->keylen = keylen;
+                slot->data = data;
+                if (kcopy) {
+                        slot->k.key = kcopy;
+                        kcopy = NULL;
+                } else {
+                        memcpy (slot->k.inline_key, key, keylen);
+                }
+                stripe->count++;
+                ret = 0;
+        }
+unlock:
+        pthread_rwlock_unlock (&stripe->lock);
+
+        GF_FREE (kcopy);
+
+        return ret;
+}
+
+
+void *
+chash_get (chash_table_t *tbl, void *key, int keylen)
+{
+        struct chash_stripe *stripe = NULL;
+        struct chash_slot   *slot   = NULL;
+        void                *data   = NULL;
+        uint32_t             hash   = 0;
+
+        if ((!tbl) || (!key))
+                return NULL;
+
+        hash = chash_mix (tbl->hashfunc (key, keylen));
+        stripe = chash_hash_stripe (tbl, hash);
+
+        pthread_rwlock_rdlock (&stripe->lock);
+        {
+                slot = __chash_probe (stripe, hash, key, keylen);
+                data = slot->data;
+        }
+        pthread_rwlock_unlock (&stripe->lock);
+
+        return data;
+}
+
+
+void *
+chash_remove (chash_table_t *tbl, void *key, int keylen)
+{
+        struct chash_stripe *stripe  = NULL;
+        struct chash_slot   *slot    = NULL;
+        void                *dataref = NULL;
+        uint32_t             hash    = 0;
+        uint32_t             i       = 0;
+        uint32_t             j       = 0;
+        uint32_t             home    = 0;
+
+        if ((!tbl) || (!key))
+                return NULL;
+
+        hash = chash_mix (tbl->hashfunc (key, keylen));
+        stripe = chash_hash_stripe (tbl, hash);
+
+        pthread_rwlock_wrlock (&stripe->lock);
+        {
+                slot = __chash_probe (stripe, hash, key, keylen);
+                if (!slot->hash)
+                        goto unlock;
+
+                dataref = slot->data;
+                chash_slot_clear (slot);
+                stripe->count--;
+
+                /* Backward shift: pull later members of the probe run into
+                 * the hole unless their home slot lies after it. */
+                i = slot - stripe->slots;
+                for (j = (i + 1) & stripe->mask; stripe->slots[j].hash;
+                     j = (j + 1) & stripe->mask) {
+                        home = stripe->slots[j].hash & stripe->mask;
+                        if ((i <= j) ? ((home > i) && (home <= j))
+                                     : ((home > i) || (home <= j)))
+                                continue;
+
+                        stripe->slots[i] = stripe->slots[j];
+                        memset (&stripe->slots[j], 0, sizeof (*slot));
+                        i = j;
+                }
+        }
+unlock:
+        pthread_rwlock_unlock (&stripe->lock);
+
+        return dataref;
+}
+
+
+void *
+chash_replace (chash_table_t *tbl, void *key, int keylen, void *newdata)
+{
+        struct chash_stripe *stripe  = NULL;
+        struct chash_slot   *slot    = NULL;
+        void                *olddata = NULL;
+        uint32_t             hash    = 0;
+
+        if ((!tbl) || (!key) || (!newdata))
+                return NULL;
+
+        hash = chash_mix (tbl->hashfunc (key, keylen));
+        stripe = chash_hash_stripe (tbl, hash);
+
+        pthread_rwlock_wrlock (&stripe->lock);
+        {
+                slot = __chash_probe (stripe, hash, key, keylen);
+                if (slot->hash) {
+                        olddata = slot->data;
+                        slot->data = newdata;
+                }
+        }
+        pthread_rwlock_unlock (&stripe->lock);
+
+        return olddata;
+}
+
+
+uint64_t
+chash_count (chash_table_t *tbl)
+{
+        uint64_t count = 0;
+        int      i     = 0;
+
+        if (!tbl)
+                return 0;
+
+        for (i = 0; i < tbl->nstripes; i++)
+                count += tbl->stripes[i].count;
+
+        return count;
+}
+
+
+void
+chash_table_destroy (chash_table_t *tbl)
+{
+        struct chash_stripe *stripe = NULL;
+        int                  i      = 0;
+        uint32_t             j      = 0;
+
+        if (!tbl)
+                return;
+
+        for (i = 0; i < tbl->nstripes; i++) {
+                stripe = &tbl->stripes[i];
+                for (j = 0; j <= stripe->mask; j++) {
+                        if (!stripe->slots[j].hash)
+                                continue;
+                        if (tbl->dfunc)
+                                tbl->dfunc (stripe->slots[j].data);
+                        chash_slot_clear (&stripe->slots[j]);
+                }
+                pthread_rwlock_destroy (&stripe->lock);
+                GF_FREE (stripe->slots);
+        }
+
+        GF_FREE (tbl->stripes);
+        GF_FREE (tbl);
+}
+
+
+/*
+ * chash_table_traverse - call @traverse on every entry in the table
+ *
+ * Each stripe is read-locked while it is walked, so @traverse must not call
+ * back into the table.  With @nonblocking set, stripes that are being
+ * written are skipped rather than waited for, which is what statedump needs.
+ * Returns the number of stripes skipped.
+ */
+int
+chash_table_traverse (chash_table_t *tbl, chash_traverse_t traverse,
+                      void *mydata, gf_boolean_t nonblocking)
+{
+        struct chash_stripe *stripe  = NULL;
+        int                  skipped = 0;
+        int                  i       = 0;
+        uint32_t             j       = 0;
+
+        if ((tbl == NULL) || (traverse == NULL))
+                goto out;
+
+        for (i = 0; i < tbl->nstripes; i++) {
+                stripe = &tbl->stripes[i];
+
+                if (!nonblocking) {
+                        pthread_rwlock_rdlock (&stripe->lock);
+                } else if (pthread_rwlock_tryrdlock (&stripe->lock) != 0) {
+                        skipped++;
+                        continue;
+                }
+
+                for (j = 0; j <= stripe->mask; j++) {
+                        if (stripe->slots[j].hash)
+                                traverse (stripe->slots[j].data, mydata);
+                }
+
+                pthread_rwlock_unlock (&stripe->lock);
+        }
+
+out:
+        return skipped;
+}
+
+
+void
+chash_table_dump (chash_table_t *tbl, const char *prefix)
+{
+        char     key[GF_DUMP_MAX_BUF_LEN];
+        uint64_t slots   = 0;
+        uint64_t resizes = 0;
+        int      i       = 0;
+
+        if (!tbl)
+                return;
+
+        for (i = 0; i < tbl->nstripes; i++) {
+                slots += tbl->stripes[i].mask + 1;
+                resizes += tbl->stripes[i].resizes;
+        }
+
+        gf_proc_dump_build_key (key, prefix, "stripes");
+        gf_proc_dump_write (key, "%d", tbl->nstripes);
+        gf_proc_dump_build_key (key, prefix, "slots");
+        gf_proc_dump_write (key, "%"PRIu64, slots);
+        gf_proc_dump_build_key (key, prefix, "entries");
+        gf_proc_dump_write (key, "%"PRIu64, chash_count (tbl));
+        gf_proc_dump_build_key (key, prefix, "resizes");
+        gf_proc_dump_write (key, "%"PRIu64, resizes);
+}
@@ -0,0 +1,98 @@
+/*
+  Copyright (c) 2008-2012 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef __CHASH_TABLE_H_
+#define __CHASH_TABLE_H_
+
+#include "locking.h"
+#include "mem-pool.h"
+#include "logging.h"
+#include "common-utils.h"
+
+#include <pthread.h>
+
+/*
+ * Concurrent hash table.
+ *
+ * The table is split into a power-of-two number of stripes, each of them an
+ * independent open-addressed (linear probing) array guarded by its own
+ * read-write lock.  The upper bits of the hash pick the stripe, the lower
+ * bits pick the slot, so a stripe grows on its own without stopping lookups
+ * in the others.  Removal uses backward shifting, so there are no tombstones
+ * and probe sequences never degrade over time.
+ *
+ * Keys up to CHASH_INLINE_KEYLEN bytes are stored in the slot itself; longer
+ * keys are copied to the heap.
+ */
+
+#define GF_CHASH                "chash"
+#define CHASH_INLINE_KEYLEN     16
+#define CHASH_MAX_STRIPES       256
+#define CHASH_MIN_SLOTS         8
+
+typedef uint32_t (*chash_hasher_t) (void *key, int keylen);
+typedef void (*chash_data_destroyer_t) (void *data);
+typedef void (*chash_traverse_t) (void *data, void *mydata);
+
+struct chash_slot {
+        uint32_t         hash;          /* 0 marks an empty slot */
+        int              keylen;
+        union {
+                char     inline_key[CHASH_INLINE_KEYLEN];
+                void    *key;
+        } k;
+        void            *data;
+};
+
+struct chash_stripe {
+        pthread_rwlock_t   lock;
+        uint32_t           mask;        /* number of slots - 1 */
+        uint32_t           count;
+        uint32_t           resizes;
+        struct chash_slot *slots;
+};
+
+typedef struct chash_table {
+        int                     nstripes;
+        int                     stripe_shift;
+        chash_hasher_t          hashfunc;
+        chash_data_destroyer_t  dfunc;
+        struct chash_stripe    *stripes;
+} chash_table_t;
+
+extern chash_table_t *
+chash_table_init (int stripes, unsigned long expected_entries,
+                  chash_hasher_t hfunc, chash_data_destroyer_t dfunc);
+
+extern int
+chash_insert (chash_table_t *tbl, void *data, void *key, int keylen);
+
+extern void *
+chash_get (chash_table_t *tbl, void *key, int keylen);
+
+extern void *
+chash_remove (chash_table_t *tbl, void *key, int keylen);
+
+extern void *
+chash_replace (chash_table_t *tbl, void *key, int keylen, void *newdata);
+
+extern uint64_t
+chash_count (chash_table_t *tbl);
+
+extern void
+chash_table_destroy (chash_table_t *tbl);
+
+extern int
+chash_table_traverse (chash_table_t *tbl, chash_traverse_t traverse,
+                      void *mydata, gf_boolean_t nonblocking);
+
+extern void
+chash_table_dump (chash_table_t *tbl, const char *prefix);
+#endif
@@ -10,28 +10,32 @@
 
 #include <openssl/md5.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "glusterfs.h"
+#include "checksum.h"
+
+#if defined(__x86_64__) && defined(__GNUC__) && \
+        ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define GF_RSYNC_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
 
 /*
- * The "weak" checksum required for the rsync algorithm,
- * adapted from the rsync source code. The following comment
- * appears there:
+ * The weak checksum is the rsync rolling checksum:
  *
- * "a simple 32 bit checksum that can be upadted from either end
- *  (inspired by Mark Adler's Adler-32 checksum)"
+ *    s1 = sum (buf[i])
+ *    s2 = sum ((len - i) * buf[i])
  *
- * Note: these functions are only called to compute checksums on
- * pathnames; they don't need to handle arbitrarily long strings of
- * data. Thus int32_t and uint32_t are sufficient
+ * both modulo 2^32.  Bricks compare each other's results during self-heal,
+ * so every implementation below must return exactly the same value.
  */
 
 uint32_t
-gf_rsync_weak_checksum (unsigned char *buf, size_t len)
+gf_rsync_weak_checksum_generic (unsigned char *buf, size_t len)
 {
         int32_t i = 0;
         uint32_t s1, s2;
-
         uint32_t csum;
 
         s1 = s2 = 0;
@@ -41,25 +45,252 @@ gf_rsync_weak_checksum (unsigned char *buf, size_t len)
                         s1 += buf[i+0] + buf[i+1] + buf[i+2] + buf[i+3];
                 }
         }
-
         for (; i < len; i++) {
                 s1 += buf[i];
                 s2 += s1;
         }
-
         csum = (s1 & 0xffff) + (s2 << 16);
 
         return csum;
 }
 
+#ifdef GF_RSYNC_CHECKSUM_X86
 
-/*
- * The "strong" checksum required for the rsync algorithm,
- * adapted from the rsync source code.
- */
+static inline uint32_t
+gf_rsync_hsum_epi32 (__m128i v)
+{
+        v = _mm_add_epi32 (v, _mm_shuffle_epi32 (v, _MM_SHUFFLE (1, 0, 3, 2)));
+        v = _mm_add_epi32 (v, _mm_shuffle_epi32 (v, _MM_SHUFFLE (2, 3, 0, 1)));
+
+        return _mm_cvtsi128_si32 (v);
+}
+
+/* Per 16 byte block: s2 += 16 * s1 + sum ((16 - j) * b[j]); s1 += sum (b[j]).
+ * vps collects s1 as it stood before each block, so the 16 * s1 term is
+ * applied once at the end. */
+static uint32_t __attribute__ ((target ("ssse3")))
+gf_rsync_weak_checksum_ssse3 (unsigned char *buf, size_t len)
+{
+        const __m128i zero    = _mm_setzero_si128 ();
+        const __m128i ones    = _mm_set1_epi16 (1);
+        const __m128i weights = _mm_setr_epi8 (16, 15, 14, 13, 12, 11, 10, 9,
+                                               8, 7, 6, 5, 4, 3, 2, 1);
+        __m128i       vs1     = zero;
+        __m128i       vs2     = zero;
+        __m128i       vps     = zero;
+        __m128i       v;
+        uint32_t      s1      = 0;
+        uint32_t      s2      = 0;
+        size_t        i       = 0;
+
+        for (; i + 16 <= len; i += 16) {
+                v = _mm_loadu_si128 ((__m128i *)(buf + i));
+                vps = _mm_add_epi32 (vps, vs1);
+                vs1 = _mm_add_epi32 (vs1, _mm_sad_epu8 (v, zero));
+                vs2 = _mm_add_epi32 (vs2, _mm_madd_epi16 (
+                                     _mm_maddubs_epi16 (v, weights), ones));
+        }
+
+        s1 = gf_rsync_hsum_epi32 (vs1);
+        s2 = (gf_rsync_hsum_epi32 (vps) << 4) + gf_rsync_hsum_epi32 (vs2);
+
+        for (; i < len; i++) {
+                s1 += buf[i];
+                s2 += s1;
+        }
+
+        return (s1 & 0xffff) + (s2 << 16);
+}
+
+static uint32_t __attribute__ ((target ("avx2")))
+gf_rsync_weak_checksum_avx2 (unsigned char *buf, size_t len)
+{
+        const __m256i zero    = _mm256_setzero_si256 ();
+        const __m256i ones    = _mm256_set1_epi16 (1);
+        const __m256i weights = _mm256_setr_epi8 (32, 31, 30, 29, 28, 27, 26,
+                                                  25, 24, 23, 22, 21, 20, 19,
+                                                  18, 17, 16, 15, 14, 13, 12,
+                                                  11, 10, 9, 8, 7, 6, 5, 4, 3,
+                                                  2, 1);
+        __m256i       vs1     = zero;
+        __m256i       vs2     = zero;
+        __m256i       vps     = zero;
+        __m256i       v;
+        uint32_t      s1      = 0;
+        uint32_t      s2      = 0;
+        size_t        i       = 0;
+
+        for (; i + 32 <= len; i += 32) {
+                v = _mm256_loadu_si256 ((__m256i *)(buf + i));
+                vps = _mm256_add_epi32 (vps, vs1);
+                vs1 = _mm256_add_epi32 (vs1, _mm256_sad_epu8 (v, zero));
+                vs2 = _mm256_add_epi32 (vs2, _mm256_madd_epi16 (
+                                        _mm256_maddubs_epi16 (v, weights),
+                                        ones));
+        }
+
+        s1 = gf_rsync_hsum_epi32 (_mm_add_epi32 (
+                                  _mm256_castsi256_si128 (vs1),
+                                  _mm256_extracti128_si256 (vs1, 1)));
+        s2 = (gf_rsync_hsum_epi32 (_mm_add_epi32 (
+                                   _mm256_castsi256_si128 (vps),
+                                   _mm256_extracti128_si256 (vps, 1))) << 5) +
+             gf_rsync_hsum_epi32 (_mm_add_epi32 (
+                                  _mm256_castsi256_si128 (vs2),
+                                  _mm256_extracti128_si256 (vs2, 1)));
+
+        for (; i < len; i++) {
+                s1 += buf[i];
+                s2 += s1;
+        }
+
+        return (s1 & 0xffff) + (s2 << 16);
+}
+
+#endif /* GF_RSYNC_CHECKSUM_X86 */
+
+static uint32_t (*gf_rsync_weak_checksum_fn) (unsigned char *, size_t);
+static const char *gf_rsync_weak_checksum_name;
+
+static void
+gf_rsync_weak_checksum_select (void)
+{
+        const char *name = "generic";
+        uint32_t (*fn) (unsigned char *, size_t) =
+                gf_rsync_weak_checksum_generic;
+
+#ifdef GF_RSYNC_CHECKSUM_X86
+        __builtin_cpu_init ();
+        if (__builtin_cpu_supports ("avx2")) {
+                fn = gf_rsync_weak_checksum_avx2;
+                name = "avx2";
+        } else if (__builtin_cpu_supports ("ssse3")) {
+                fn = gf_rsync_weak_checksum_ssse3;
+                name = "ssse3";
+        }
+#endif
+        gf_rsync_weak_checksum_name = name;
+        gf_rsync_weak_checksum_fn = fn;
+}
+
+const char *
+gf_rsync_weak_checksum_impl (void)
+{
+        if (!gf_rsync_weak_checksum_fn)
+                gf_rsync_weak_checksum_select ();
+
+        return gf_rsync_weak_checksum_name;
+}
+
+uint32_t
+gf_rsync_weak_checksum (unsigned char *buf, size_t len)
+{
+        if (!gf_rsync_weak_checksum_fn)
+                gf_rsync_weak_checksum_select ();
+
+        return gf_rsync_weak_checksum_fn (buf, len);
+}
 
 void
 gf_rsync_strong_checksum (unsigned char *data, size_t len, unsigned char *md5)
 {
         MD5(data, len, md5);
 }
+
+/*
+ * MurmurHash3 x64_128 (seed 0), read and written little-endian so that
+ * bricks on different architectures agree.  It is not a cryptographic hash;
+ * it is only used when the client asks for it.
+ */
+
+#define GF_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline uint64_t
+gf_murmur3_load64 (const unsigned char *p)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        uint64_t v;
+
+        memcpy (&v, p, sizeof (v));
+        return v;
+#else
+        return ((uint64_t) p[0]) | ((uint64_t) p[1] << 8) |
+               ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24) |
+               ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) |
+               ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+#endif
+}
+
+static inline uint64_t
+gf_murmur3_fmix64 (uint64_t k)
+{
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+
+        return k;
+}
+
+void
+gf_rsync_murmur3_checksum (unsigned char *data, size_t len,
+                           unsigned char *sum)
+{
+        const uint64_t       c1   = 0x87c37b91114253d5ULL;
+        const uint64_t       c2   = 0x4cf5ad432745937fULL;
+        const unsigned char *tail = NULL;
+        uint64_t             h1   = 0;
+        uint64_t             h2   = 0;
+        uint64_t             k1   = 0;
+        uint64_t             k2   = 0;
+        size_t               i    = 0;
+
+        for (i = 0; i + 16 <= len; i += 16) {
+                k1 = gf_murmur3_load64 (data + i);
+                k2 = gf_murmur3_load64 (data + i + 8);
+
+                k1 *= c1; k1 = GF_ROTL64 (k1, 31); k1 *= c2; h1 ^= k1;
+                h1 = GF_ROTL64 (h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+                k2 *= c2; k2 = GF_ROTL64 (k2, 33); k2 *= c1; h2 ^= k2;
+                h2 = GF_ROTL64 (h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+        }
+
+        tail = data + i;
+        k1 = k2 = 0;
+
+        switch (len & 15) {
+        case 15: k2 ^= ((uint64_t) tail[14]) << 48;
+        case 14: k2 ^= ((uint64_t) tail[13]) << 40;
+        case 13: k2 ^= ((uint64_t) tail[12]) << 32;
+        case 12: k2 ^= ((uint64_t) tail[11]) << 24;
+        case 11: k2 ^= ((uint64_t) tail[10]) << 16;
+        case 10: k2 ^= ((uint64_t) tail[9]) << 8;
+        case 9:  k2 ^= ((uint64_t) tail[8]);
+                 k2 *= c2; k2 = GF_ROTL64 (k2, 33); k2 *= c1; h2 ^= k2;
+        case 8:  k1 ^= ((uint64_t) tail[7]) << 56;
+        case 7:  k1 ^= ((uint64_t) tail[6]) << 48;
+        case 6:  k1 ^= ((uint64_t) tail[5]) << 40;
+        case 5:  k1 ^= ((uint64_t) tail[4]) << 32;
+        case 4:  k1 ^= ((uint64_t) tail[3]) << 24;
+        case 3:  k1 ^= ((uint64_t) tail[2]) << 16;
+        case 2:  k1 ^= ((uint64_t) tail[1]) << 8;
+        case 1:  k1 ^= ((uint64_t) tail[0]);
+                 k1 *= c1; k1 = GF_ROTL64 (k1, 31); k1 *= c2; h1 ^= k1;
+        }
+
+        h1 ^= len;
+        h2 ^= len;
+        h1 += h2;
+        h2 += h1;
+        h1 = gf_murmur3_fmix64 (h1);
+        h2 = gf_murmur3_fmix64 (h2);
+        h1 += h2;
+        h2 += h1;
+
+        for (i = 0; i < 8; i++) {
+                sum[i] = (h1 >> (i * 8)) & 0xff;
+                sum[i + 8] = (h2 >> (i * 8)) & 0xff;
+        }
+}
@@ -11,10 +11,29 @@
 #ifndef __CHECKSUM_H__
 #define __CHECKSUM_H__
 
+/*
+ * rchecksum xdata key through which a client asks for a strong checksum
+ * other than MD5.  A brick that honours the request echoes the key back in
+ * its reply; a reply without it carries an MD5 digest.  Both digests are
+ * MD5_DIGEST_LENGTH bytes long.
+ */
+#define GF_RSYNC_STRONG_HASH_KEY        "glusterfs.rchecksum.strong-hash"
+#define GF_RSYNC_STRONG_HASH_MD5        "md5"
+#define GF_RSYNC_STRONG_HASH_MURMUR3    "murmur3"
+
 uint32_t
 gf_rsync_weak_checksum (unsigned char *buf, size_t len);
 
+uint32_t
+gf_rsync_weak_checksum_generic (unsigned char *buf, size_t len);
+
+const char *
+gf_rsync_weak_checksum_impl (void);
+
 void
 gf_rsync_strong_checksum (unsigned char *buf, size_t len, unsigned char *sum);
 
+void
+gf_rsync_murmur3_checksum (unsigned char *buf, size_t len, unsigned char *sum);
+
 #endif /* __CHECKSUM_H__ */
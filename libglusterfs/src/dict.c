@@ -30,6 +30,8 @@
 #include "byte-order.h"
 #include "globals.h"
 
+#define DICT_INDEX_MIN_SIZE 32
+
 data_t *
 get_new_data ()
 {
@@ -44,42 +46,25 @@ get_new_data ()
         return data;
 }
 
+static int __dict_index_resize (dict_t *this, uint32_t size);
+
 dict_t *
 get_new_dict_full (int size_hint)
 {
-        dict_t *dict = mem_get0 (THIS->ctx->dict_pool);
+        dict_t   *dict = mem_get0 (THIS->ctx->dict_pool);
+        uint32_t  size = DICT_INDEX_MIN_SIZE;
 
         if (!dict) {
                 return NULL;
         }
 
-        dict->hash_size = size_hint;
-        if (size_hint == 1) {
-                /*
-                 * This is the only case we ever see currently.  If we ever
-                 * need to support resizing the hash table, the resize function
-                 * will have to take into account the possibility that
-                 * "members" is not separately allocated (i.e. don't just call
-                 * realloc() blindly.
-                 */
-                dict->members = &dict->members_internal;
-        }
-        else {
-                /*
-                 * We actually need to allocate space for size_hint *pointers*
-                 * but we actually allocate space for one *structure*.  Since
-                 * a data_pair_t consists of five pointers, we're wasting four
-                 * pointers' worth for N=1, and will overrun what we allocated
-                 * for N>5.  If anybody ever starts using size_hint, we'll need
-                 * to fix this.
-                 */
-                GF_ASSERT (size_hint <=
-                           (sizeof(data_pair_t) / sizeof(data_pair_t *)));
-                dict->members = mem_get0 (THIS->ctx->dict_pair_pool);
-                if (!dict->members) {
-                        mem_put (dict);
-                        return NULL;
-                }
+        /* small dicts never need the index, for the others build it right
+           away instead of growing it key by key. Without it lookups are
+           only slower, so an allocation failure is not fatal here */
+        if (size_hint > DICT_INLINE_PAIRS) {
+                while (size < 2 * size_hint)
+                        size *= 2;
+                __dict_index_resize (dict, size);
         }
 
         LOCK_INIT (&dict->lock);
@@ -148,6 +133,9 @@ data_destroy (data_t *data)
                         }
                 }
 
+                if (data->backing)
+                        data_unref (data->backing);
+
                 data->len = 0xbabababa;
                 if (!data->is_const)
                         mem_put (data);
@@ -188,26 +176,211 @@ err_out:
         return NULL;
 }
 
+static inline uint32_t
+dict_key_hash (char *key)
+{
+        return SuperFastHash (key, strlen (key));
+}
+
+
+static void
+__dict_index_place (data_pair_t **index, uint32_t size, data_pair_t *pair)
+{
+        uint32_t i = pair->key_hash & (size - 1);
+
+        while (index[i])
+                i = (i + 1) & (size - 1);
+
+        index[i] = pair;
+}
+
+
+static int
+__dict_index_resize (dict_t *this, uint32_t size)
+{
+        data_pair_t **index = NULL;
+        data_pair_t  *pair  = NULL;
+
+        index = GF_CALLOC (size, sizeof (*index), gf_common_mt_dict_index_t);
+        if (!index)
+                return -1;
+
+        for (pair = this->members_list; pair; pair = pair->next)
+                __dict_index_place (index, size, pair);
+
+        GF_FREE (this->index);
+        this->index = index;
+        this->index_size = size;
+
+        return 0;
+}
+
+
+/* called with @pair already on members_list and counted */
+static void
+__dict_index_add (dict_t *this, data_pair_t *pair)
+{
+        if (this->unhashed)
+                return;
+
+        if (this->index && (this->count * 2 <= this->index_size)) {
+                __dict_index_place (this->index, this->index_size, pair);
+                return;
+        }
+
+        if (!this->index && this->count <= DICT_INLINE_PAIRS)
+                return;
+
+        if (__dict_index_resize (this, this->index ? this->index_size * 2 :
+                                 DICT_INDEX_MIN_SIZE) == 0)
+                return;
+
+        /* a full index would never terminate a probe, fall back to the
+           linear scan */
+        GF_FREE (this->index);
+        this->index = NULL;
+        this->index_size = 0;
+}
+
+
+static void
+__dict_index_del (dict_t *this, data_pair_t *pair)
+{
+        data_pair_t **index = this->index;
+        uint32_t      mask  = this->index_size - 1;
+        uint32_t      i     = 0;
+        uint32_t      j     = 0;
+        uint32_t      home  = 0;
+
+        if (!index)
+                return;
+
+        i = pair->key_hash & mask;
+        while (index[i] != pair)
+                i = (i + 1) & mask;
+
+        /* backward shift the rest of the probe run into the hole, so that
+           no tombstones are needed */
+        for (j = (i + 1) & mask; index[j]; j = (j + 1) & mask) {
+                home = index[j]->key_hash & mask;
+                if (((j > i) && (home <= i || home > j)) ||
+                    ((j < i) && (home <= i && home > j))) {
+                        index[i] = index[j];
+                        i = j;
+                }
+        }
+
+        index[i] = NULL;
+}
+
+
+static void
+__dict_rehash (dict_t *this)
+{
+        data_pair_t *pair = NULL;
+        uint32_t     size = DICT_INDEX_MIN_SIZE;
+
+        for (pair = this->members_list; pair; pair = pair->next)
+                pair->key_hash = dict_key_hash (pair->key);
+
+        this->unhashed = 0;
+
+        if (this->index || this->count > DICT_INLINE_PAIRS) {
+                while (size < 2 * this->count)
+                        size *= 2;
+                if (__dict_index_resize (this, size) != 0) {
+                        /* the old index misses the new pairs */
+                        GF_FREE (this->index);
+                        this->index = NULL;
+                        this->index_size = 0;
+                }
+        }
+}
+
+
 static data_pair_t *
-_dict_lookup (dict_t *this, char *key)
+__dict_find (dict_t *this, char *key, uint32_t hash)
 {
-        if (!this || !key) {
-                gf_log_callingfn ("dict", GF_LOG_WARNING,
-                                  "!this || !key (%s)", key);
+        data_pair_t *pair = NULL;
+        uint32_t     mask = 0;
+        uint32_t     i    = 0;
+
+        if (this->unhashed)
+                __dict_rehash (this);
+
+        if (!this->index) {
+                for (pair = this->members_list; pair; pair = pair->next) {
+                        if (pair->key_hash == hash && !strcmp (pair->key, key))
+                                return pair;
+                }
                 return NULL;
         }
 
-        int hashval = SuperFastHash (key, strlen (key)) % this->hash_size;
-        data_pair_t *pair;
-
-        for (pair = this->members[hashval]; pair != NULL; pair = pair->hash_next) {
-                if (pair->key && !strcmp (pair->key, key))
+        mask = this->index_size - 1;
+        for (i = hash & mask; this->index[i]; i = (i + 1) & mask) {
+                pair = this->index[i];
+                if (pair->key_hash == hash && !strcmp (pair->key, key))
                         return pair;
         }
 
         return NULL;
 }
 
+
+static data_pair_t *
+__dict_pair_get (dict_t *this)
+{
+        int slot = 0;
+
+        slot = ffs (~this->inline_used) - 1;
+        if (slot >= 0 && slot < DICT_INLINE_PAIRS) {
+                this->inline_used |= (1 << slot);
+                return &this->inline_pairs[slot];
+        }
+
+        return mem_get (THIS->ctx->dict_pair_pool);
+}
+
+
+/* keys of pairs from dict_unserialize_nocopy() point into the backing
+   buffer */
+static inline gf_boolean_t
+__dict_key_borrowed (dict_t *this, char *key)
+{
+        return (this->backing && key >= this->backing->data &&
+                key < this->backing->data + this->backing->len);
+}
+
+
+static void
+__dict_pair_put (dict_t *this, data_pair_t *pair)
+{
+        if (pair->key != pair->key_inline &&
+            !__dict_key_borrowed (this, pair->key))
+                GF_FREE (pair->key);
+
+        if (pair >= this->inline_pairs &&
+            pair < this->inline_pairs + DICT_INLINE_PAIRS) {
+                this->inline_used &= ~(1 << (pair - this->inline_pairs));
+                return;
+        }
+
+        mem_put (pair);
+}
+
+
+static data_pair_t *
+_dict_lookup (dict_t *this, char *key)
+{
+        if (!this || !key) {
+                gf_log_callingfn ("dict", GF_LOG_WARNING,
+                                  "!this || !key (%s)", key);
+                return NULL;
+        }
+
+        return __dict_find (this, key, dict_key_hash (key));
+}
+
 int32_t
 dict_lookup (dict_t *this, char *key, data_t **data)
 {
@@ -234,10 +407,10 @@ dict_lookup (dict_t *this, char *key, data_t **data)
 static int32_t
 _dict_set (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
 {
-        int hashval;
         data_pair_t *pair;
         char key_free = 0;
-        int tmp = 0;
+        uint32_t hash = 0;
+        size_t keylen = 0;
         int ret = 0;
 
         if (!key) {
@@ -249,12 +422,14 @@ _dict_set (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
                 key_free = 1;
         }
 
-        tmp = SuperFastHash (key, strlen (key));
-        hashval = (tmp % this->hash_size);
+        this->pristine = 0;
+
+        keylen = strlen (key);
+        hash = SuperFastHash (key, keylen);
 
         /* Search for a existing key if 'replace' is asked for */
         if (replace) {
-                pair = _dict_lookup (this, key);
+                pair = __dict_find (this, key, hash);
 
                 if (pair) {
                         data_t *unref_data = pair->value;
@@ -267,17 +442,11 @@ _dict_set (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
                 }
         }
 
-        if (this->free_pair_in_use) {
-                pair = mem_get0 (THIS->ctx->dict_pair_pool);
-                if (!pair) {
-                        if (key_free)
-                                GF_FREE (key);
-                        return -1;
-                }
-        }
-        else {
-                pair = &this->free_pair;
-                this->free_pair_in_use = _gf_true;
+        pair = __dict_pair_get (this);
+        if (!pair) {
+                if (key_free)
+                        GF_FREE (key);
+                return -1;
         }
 
         if (key_free) {
@@ -285,25 +454,23 @@ _dict_set (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
                 pair->key = key;
                 key_free = 0;
         }
+        else if (keylen < DICT_KEY_INLINE_LEN) {
+                pair->key = pair->key_inline;
+                memcpy (pair->key, key, keylen + 1);
+        }
         else {
-                pair->key = (char *) GF_CALLOC (1, strlen (key) + 1,
+                pair->key = (char *) GF_CALLOC (1, keylen + 1,
                                                 gf_common_mt_char);
                 if (!pair->key) {
-                        if (pair == &this->free_pair) {
-                                this->free_pair_in_use = _gf_false;
-                        }
-                        else {
-                                mem_put (pair);
-                        }
+                        pair->key = pair->key_inline;
+                        __dict_pair_put (this, pair);
                         return -1;
                 }
-                strcpy (pair->key, key);
+                memcpy (pair->key, key, keylen + 1);
         }
+        pair->key_hash = hash;
         pair->value = data_ref (value);
 
-        pair->hash_next = this->members[hashval];
-        this->members[hashval] = pair;
-
         pair->next = this->members_list;
         pair->prev = NULL;
         if (this->members_list)
@@ -311,8 +478,8 @@ _dict_set (dict_t *this, char *key, data_t *value, gf_boolean_t replace)
         this->members_list = pair;
         this->count++;
 
-        if (key_free)
-                GF_FREE (key);
+        __dict_index_add (this, pair);
+
         return 0;
 }
 
@@ -386,6 +553,8 @@ dict_get (dict_t *this, char *key)
 void
 dict_del (dict_t *this, char *key)
 {
+        data_pair_t *pair = NULL;
+
         if (!this || !key) {
                 gf_log_callingfn ("dict", GF_LOG_WARNING,
                                   "!this || key=%s", key);
@@ -394,40 +563,24 @@ dict_del (dict_t *this, char *key)
 
         LOCK (&this->lock);
 
-        int hashval = SuperFastHash (key, strlen (key)) % this->hash_size;
-        data_pair_t *pair = this->members[hashval];
-        data_pair_t *prev = NULL;
+        pair = __dict_find (this, key, dict_key_hash (key));
+        if (pair) {
+                this->pristine = 0;
 
-        while (pair) {
-                if (strcmp (pair->key, key) == 0) {
-                        if (prev)
-                                prev->hash_next = pair->hash_next;
-                        else
-                                this->members[hashval] = pair->hash_next;
+                __dict_index_del (this, pair);
 
-                        data_unref (pair->value);
+                data_unref (pair->value);
 
-                        if (pair->prev)
-                                pair->prev->next = pair->next;
-                        else
-                                this->members_list = pair->next;
+                if (pair->prev)
+                        pair->prev->next = pair->next;
+                else
+                        this->members_list = pair->next;
 
-                        if (pair->next)
-                                pair->next->prev = pair->prev;
+                if (pair->next)
+                        pair->next->prev = pair->prev;
 
-                        GF_FREE (pair->key);
-                        if (pair == &this->free_pair) {
-                                this->free_pair_in_use = _gf_false;
-                        }
-                        else {
-                                mem_put (pair);
-                        }
-                        this->count--;
-                        break;
-                }
-
-                prev = pair;
-                pair = pair->hash_next;
+                __dict_pair_put (this, pair);
+                this->count--;
         }
 
         UNLOCK (&this->lock);
@@ -451,16 +604,14 @@ dict_destroy (dict_t *this)
         while (prev) {
                 pair = pair->next;
                 data_unref (prev->value);
-                GF_FREE (prev->key);
-                if (prev != &this->free_pair) {
-                        mem_put (prev);
-                }
+                __dict_pair_put (this, prev);
                 prev = pair;
         }
 
-        if (this->members != &this->members_internal) {
-                mem_put (this->members);
-        }
+        GF_FREE (this->index);
+
+        if (this->backing)
+                data_unref (this->backing);
 
         GF_FREE (this->extra_free);
         free (this->extra_stdfree);
@@ -1226,7 +1377,7 @@ dict_copy (dict_t *dict,
         }
 
         if (!new)
-                new = get_new_dict_full (dict->hash_size);
+                new = get_new_dict_full (dict->count);
 
         dict_foreach (dict, _copy, new);
 
@@ -2261,6 +2412,11 @@ _dict_serialized_length (dict_t *this)
         int len            = 0;
         data_pair_t * pair = NULL;
 
+        if (this->pristine) {
+                ret = this->backing->len;
+                goto out;
+        }
+
         len = DICT_HDR_LEN;
         count = this->count;
 
@@ -2341,6 +2497,13 @@ _dict_serialize (dict_t *this, char *buf)
         }
 
 
+        /* nothing changed since dict_unserialize_nocopy() */
+        if (this->pristine) {
+                memcpy (buf, this->backing->data, this->backing->len);
+                ret = 0;
+                goto out;
+        }
+
         count = this->count;
         if (count < 0) {
                 gf_log ("dict", GF_LOG_ERROR, "count (%d) < 0!", count);
@@ -2593,6 +2756,172 @@ out:
 }
 
 
+/**
+ * dict_unserialize_nocopy - unserialize a buffer into a dict, without copying
+ *                           the keys and values out of it
+ *
+ * @buf:      buf containing serialized dict, allocated with GF_MALLOC (or
+ *            with malloc if @stdalloc is set). The dict takes it over in
+ *            any case, it is freed once the dict and all the values taken
+ *            from it are gone.
+ * @size:     size of the @buf
+ * @fill:     dict to fill in
+ * @stdalloc: @buf is to be released with free ()
+ *
+ * The keys are only hashed when the dict is first searched, so that dicts
+ * which are just passed along do not pay for it.
+ *
+ * @return: success: 0
+ *          failure: -errno
+ */
+
+int32_t
+dict_unserialize_nocopy (char *buf, int32_t size, dict_t **fill,
+                         gf_boolean_t stdalloc)
+{
+        char        *end     = NULL;
+        dict_t      *dict    = NULL;
+        data_t      *backing = NULL;
+        data_t      *value   = NULL;
+        data_pair_t *pair    = NULL;
+        char        *key     = NULL;
+        int          ret     = -EINVAL;
+        int32_t      count   = 0;
+        int32_t      keylen  = 0;
+        int32_t      vallen  = 0;
+        int32_t      hostord = 0;
+        int          i       = 0;
+
+        if (!buf || size <= 0 || !fill || !*fill) {
+                gf_log_callingfn ("dict", GF_LOG_ERROR,
+                                  "buf (%p), size (%d) or fill is invalid",
+                                  buf, size);
+                goto err;
+        }
+
+        dict = *fill;
+
+        /* a dict only borrows from one buffer */
+        if (dict->backing) {
+                ret = dict_unserialize (buf, size, fill);
+                goto err;
+        }
+
+        backing = get_new_data ();
+        if (!backing) {
+                ret = -ENOMEM;
+                goto err;
+        }
+        backing->data = buf;
+        backing->len = size;
+        backing->is_stdalloc = stdalloc;
+
+        end = buf + size;
+
+        LOCK (&dict->lock);
+        {
+                /* from here on @buf is released along with the dict */
+                dict->backing = data_ref (backing);
+
+                if (buf + DICT_HDR_LEN > end) {
+                        gf_log ("dict", GF_LOG_ERROR, "undersized buffer "
+                                "passed (%d)", size);
+                        goto unlock;
+                }
+                memcpy (&hostord, buf, sizeof (hostord));
+                count = ntoh32 (hostord);
+                buf += DICT_HDR_LEN;
+
+                if (count < 0) {
+                        gf_log ("dict", GF_LOG_ERROR,
+                                "count (%d) <= 0", count);
+                        goto unlock;
+                }
+
+                for (i = 0; i < count; i++) {
+                        if (buf + DICT_DATA_HDR_KEY_LEN +
+                            DICT_DATA_HDR_VAL_LEN > end) {
+                                gf_log ("dict", GF_LOG_ERROR, "undersized "
+                                        "buffer passed (%d)", size);
+                                goto unlock;
+                        }
+                        memcpy (&hostord, buf, sizeof (hostord));
+                        keylen = ntoh32 (hostord);
+                        buf += DICT_DATA_HDR_KEY_LEN;
+                        memcpy (&hostord, buf, sizeof (hostord));
+                        vallen = ntoh32 (hostord);
+                        buf += DICT_DATA_HDR_VAL_LEN;
+
+                        if (keylen < 0 || vallen < 0 ||
+                            keylen >= end - buf ||
+                            vallen > end - (buf + keylen + 1)) {
+                                gf_log ("dict", GF_LOG_ERROR, "undersized "
+                                        "buffer passed (%d)", size);
+                                goto unlock;
+                        }
+
+                        key = buf;
+                        if (key[keylen] != '\0') {
+                                gf_log ("dict", GF_LOG_ERROR,
+                                        "key is not terminated");
+                                goto unlock;
+                        }
+                        buf += keylen + 1;
+
+                        value = get_new_data ();
+                        pair = __dict_pair_get (dict);
+                        if (!value || !pair) {
+                                if (value)
+                                        mem_put (value);
+                                if (pair) {
+                                        pair->key = pair->key_inline;
+                                        __dict_pair_put (dict, pair);
+                                }
+                                ret = -ENOMEM;
+                                goto unlock;
+                        }
+
+                        value->len = vallen;
+                        value->data = buf;
+                        value->is_static = 1;
+                        value->backing = data_ref (backing);
+                        buf += vallen;
+
+                        pair->key = key;
+                        pair->value = data_ref (value);
+
+                        pair->next = dict->members_list;
+                        pair->prev = NULL;
+                        if (dict->members_list)
+                                dict->members_list->prev = pair;
+                        dict->members_list = pair;
+                        dict->count++;
+                        dict->unhashed = 1;
+                }
+
+                /* serializing the dict again is a plain copy as long as
+                   it is left alone */
+                if (buf == end && dict->count == count)
+                        dict->pristine = 1;
+
+                ret = 0;
+        }
+unlock:
+        UNLOCK (&dict->lock);
+
+        data_unref (backing);
+
+        return ret;
+err:
+        if (stdalloc)
+                free (buf);
+        else
+                GF_FREE (buf);
+
+        return ret;
+}
+
+
 /**
  * dict_allocate_and_serialize - serialize a dictionary into an allocated buffer
  *
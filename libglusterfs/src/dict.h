@@ -62,6 +62,28 @@ typedef struct _data_pair data_pair_t;
                                                                         \
         } while (0)
 
+/* same as GF_PROTOCOL_DICT_UNSERIALIZE, except that @buff, which has to
+   be malloc()ed (as the XDR decoder does), is handed over to the dict
+   instead of being copied, and is reset to NULL even on failure */
+#define GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY(xl,to,buff,len,ret,ope,labl) do { \
+                if (!len)                                               \
+                        break;                                          \
+                to = dict_new();                                        \
+                GF_VALIDATE_OR_GOTO (xl->name, to, labl);               \
+                                                                        \
+                ret = dict_unserialize_nocopy (buff, len, &to, 1);      \
+                buff = NULL;                                            \
+                if (ret < 0) {                                          \
+                        gf_log (xl->name, GF_LOG_WARNING,               \
+                                "failed to unserialize dictionary (%s)", \
+                                (#to));                                 \
+                                                                        \
+                        ope = EINVAL;                                   \
+                        goto labl;                                      \
+                }                                                       \
+                                                                        \
+        } while (0)
+
 struct _data {
         unsigned char  is_static:1;
         unsigned char  is_const:1;
@@ -70,29 +92,44 @@ struct _data {
         char          *data;
         int32_t        refcount;
         gf_lock_t      lock;
+        /* buffer @data points into, see dict_unserialize_nocopy() */
+        data_t        *backing;
 };
 
+/* the first DICT_INLINE_PAIRS pairs of a dict live in the dict itself,
+   and keys shorter than DICT_KEY_INLINE_LEN in their pair */
+#define DICT_INLINE_PAIRS        8
+#define DICT_KEY_INLINE_LEN      32
+
 struct _data_pair {
-        struct _data_pair *hash_next;
         struct _data_pair *prev;
         struct _data_pair *next;
         data_t            *value;
         char              *key;
+        uint32_t           key_hash;
+        char               key_inline[DICT_KEY_INLINE_LEN];
 };
 
 struct _dict {
         unsigned char   is_static:1;
-        int32_t         hash_size;
+        /* keys of pairs from dict_unserialize_nocopy() are hashed on the
+           first lookup */
+        unsigned char   unhashed:1;
+        /* @backing is still the serialized form of the dict */
+        unsigned char   pristine:1;
         int32_t         count;
         int32_t         refcount;
-        data_pair_t   **members;
         data_pair_t    *members_list;
         char           *extra_free;
         char           *extra_stdfree;
         gf_lock_t       lock;
-        data_pair_t    *members_internal;
-        data_pair_t     free_pair;
-        gf_boolean_t    free_pair_in_use;
+        /* open addressing index of the pairs, only built once the dict
+           outgrows a linear scan of the inline pairs */
+        data_pair_t   **index;
+        uint32_t        index_size;
+        uint32_t        inline_used;
+        data_pair_t     inline_pairs[DICT_INLINE_PAIRS];
+        data_t         *backing;
 };
 
 
@@ -111,6 +148,8 @@ int dict_reset (dict_t *dict);
 int32_t dict_serialized_length (dict_t *dict);
 int32_t dict_serialize (dict_t *dict, char *buf);
 int32_t dict_unserialize (char *buf, int32_t size, dict_t **fill);
+int32_t dict_unserialize_nocopy (char *buf, int32_t size, dict_t **fill,
+                                 gf_boolean_t stdalloc);
 
 int32_t dict_allocate_and_serialize (dict_t *this, char **buf, u_int *length);
 
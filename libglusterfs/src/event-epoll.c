@@ -30,6 +30,9 @@
 #ifdef HAVE_SYS_EPOLL_H
 #include <sys/epoll.h>
 
+/* events fetched per epoll_wait when there is a single dispatcher */
+#define EVENT_EPOLL_BATCH 64
+
 
 static int
 __event_getindex (struct event_pool *event_pool, int fd, int idx)
@@ -94,6 +97,8 @@ event_pool_new_epoll (int count)
 
         event_pool->count = count;
 
+        event_pool->eventthreadcount = 1;
+
         pthread_mutex_init (&event_pool->mutex, NULL);
         pthread_cond_init (&event_pool->cond, NULL);
 
@@ -138,6 +143,8 @@ event_register_epoll (struct event_pool *event_pool, int fd,
                 event_pool->reg[idx].events = EPOLLPRI;
                 event_pool->reg[idx].handler = handler;
                 event_pool->reg[idx].data = data;
+                event_pool->reg[idx].gen = ++event_pool->gen;
+                event_pool->reg[idx].in_handler = 0;
 
                 switch (poll_in) {
                 case 1:
@@ -173,7 +180,7 @@ event_register_epoll (struct event_pool *event_pool, int fd,
 
                 event_pool->changed = 1;
 
-                epoll_event.events = event_pool->reg[idx].events;
+                epoll_event.events = event_pool->reg[idx].events | EPOLLONESHOT;
                 ev_data->fd = fd;
                 ev_data->idx = idx;
 
@@ -244,7 +251,14 @@ event_unregister_epoll (struct event_pool *event_pool, int fd, int idx_hint)
                         goto unlock;
                 }
 
-                epoll_event.events = event_pool->reg[lastidx].events;
+                /* an fd being handled is disarmed; it gets its new index
+                 * when the dispatcher re-arms it after the handler returns
+                 */
+                if (event_pool->reg[lastidx].in_handler)
+                        goto move;
+
+                epoll_event.events = event_pool->reg[lastidx].events |
+                                     EPOLLONESHOT;
                 ev_data->fd = event_pool->reg[lastidx].fd;
                 ev_data->idx = idx;
 
@@ -258,6 +272,7 @@ event_unregister_epoll (struct event_pool *event_pool, int fd, int idx_hint)
                         goto unlock;
                 }
 
+move:
                 /* just replace the unregistered idx by last one */
                 event_pool->reg[idx] = event_pool->reg[lastidx];
                 event_pool->used--;
@@ -327,7 +342,16 @@ event_select_on_epoll (struct event_pool *event_pool, int fd, int idx_hint,
                         break;
                 }
 
-                epoll_event.events = event_pool->reg[idx].events;
+                if (event_pool->reg[idx].in_handler) {
+                        /* re-arming now would let another dispatcher
+                           thread pick up this fd; the new events are
+                           applied when the current handler returns */
+                        ret = 0;
+                        goto unlock;
+                }
+
+                epoll_event.events = event_pool->reg[idx].events |
+                                     EPOLLONESHOT;
                 ev_data->fd = fd;
                 ev_data->idx = idx;
 
@@ -355,7 +379,10 @@ event_dispatch_epoll_handler (struct event_pool *event_pool,
         event_handler_t     handler = NULL;
         void               *data = NULL;
         int                 idx = -1;
+        int                 gen = -1;
         int                 ret = -1;
+        struct epoll_event  epoll_event = {0, };
+        struct event_data  *ev_data = (void *)&epoll_event.data;
 
 
         event_data = (void *)&events[i].data;
@@ -374,30 +401,78 @@ event_dispatch_epoll_handler (struct event_pool *event_pool,
                         goto unlock;
                 }
 
+                /* event_select_on() re-armed the fd while another
+                   thread still had the event in hand. That thread
+                   re-arms the fd once it is done, so just drop this one.
+                */
+                if (event_pool->reg[idx].in_handler)
+                        goto unlock;
+
                 handler = event_pool->reg[idx].handler;
                 data = event_pool->reg[idx].data;
+                gen = event_pool->reg[idx].gen;
+                event_pool->reg[idx].in_handler = 1;
         }
 unlock:
         pthread_mutex_unlock (&event_pool->mutex);
 
-        if (handler)
-                ret = handler (event_data->fd, event_data->idx, data,
-                               (events[i].events & (EPOLLIN|EPOLLPRI)),
-                               (events[i].events & (EPOLLOUT)),
-                               (events[i].events & (EPOLLERR|EPOLLHUP)));
+        if (!handler)
+                return ret;
+
+        ret = handler (event_data->fd, idx, data,
+                       (events[i].events & (EPOLLIN|EPOLLPRI)),
+                       (events[i].events & (EPOLLOUT)),
+                       (events[i].events & (EPOLLERR|EPOLLHUP)));
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                idx = __event_getindex (event_pool, event_data->fd, idx);
+
+                /* fd was unregistered (and possibly re-registered by
+                   someone else) from within the handler */
+                if (idx == -1 || event_pool->reg[idx].gen != gen)
+                        goto post_unlock;
+
+                event_pool->reg[idx].in_handler = 0;
+
+                epoll_event.events = event_pool->reg[idx].events |
+                                     EPOLLONESHOT;
+                ev_data->fd = event_data->fd;
+                ev_data->idx = idx;
+
+                if (epoll_ctl (event_pool->fd, EPOLL_CTL_MOD, ev_data->fd,
+                               &epoll_event) == -1) {
+                        gf_log ("epoll", GF_LOG_ERROR,
+                                "failed to re-arm fd(=%d) (%s)",
+                                ev_data->fd, strerror (errno));
+                }
+        }
+post_unlock:
+        pthread_mutex_unlock (&event_pool->mutex);
+
         return ret;
 }
 
 
-static int
-event_dispatch_epoll (struct event_pool *event_pool)
+static void *
+event_dispatch_epoll_worker (void *data)
 {
-        struct epoll_event *events = NULL;
-        int                 size = 0;
-        int                 i = 0;
-        int                 ret = -1;
+        struct epoll_event        events[EVENT_EPOLL_BATCH];
+        struct event_thread_data *poller = NULL;
+        struct event_pool        *event_pool = NULL;
+        int                       myid = 0;
+        int                       maxevents = 1;
+        int                       size = 0;
+        int                       i = 0;
+        int                       ret = -1;
 
-        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+        GF_VALIDATE_OR_GOTO ("event", data, out);
+
+        poller = data;
+        event_pool = poller->event_pool;
+        myid = poller->id;
+
+        gf_log ("epoll", GF_LOG_DEBUG, "started dispatcher thread %d", myid);
 
         while (1) {
                 pthread_mutex_lock (&event_pool->mutex);
@@ -406,27 +481,24 @@ event_dispatch_epoll (struct event_pool *event_pool)
                                 pthread_cond_wait (&event_pool->cond,
                                                    &event_pool->mutex);
 
-                        if (event_pool->used > event_pool->evcache_size) {
-                                GF_FREE (event_pool->evcache);
-
-                                event_pool->evcache = events = NULL;
-
-                                event_pool->evcache_size =
-                                        event_pool->used + 256;
-
-                                events = GF_CALLOC (event_pool->evcache_size,
-                                                    sizeof (struct epoll_event),
-                                                    gf_common_mt_epoll_event);
-                                if (!events)
-                                        break;
-
-                                event_pool->evcache = events;
+                        /* threads beyond the configured count retire;
+                           the first dispatcher thread never does */
+                        if (myid && myid >= event_pool->eventthreadcount) {
+                                poller->running = 0;
+                                event_pool->activethreadcount--;
+                                pthread_mutex_unlock (&event_pool->mutex);
+                                break;
                         }
+
+                        /* with a single dispatcher, batching is fair. With
+                           several, fetch one event at a time so that an
+                           idle thread can pick up the next ready fd */
+                        maxevents = (event_pool->eventthreadcount > 1) ?
+                                1 : EVENT_EPOLL_BATCH;
                 }
                 pthread_mutex_unlock (&event_pool->mutex);
 
-                ret = epoll_wait (event_pool->fd, event_pool->evcache,
-                                  event_pool->evcache_size, -1);
+                ret = epoll_wait (event_pool->fd, events, maxevents, -1);
 
                 if (ret == 0)
                         /* timeout */
@@ -439,14 +511,112 @@ event_dispatch_epoll (struct event_pool *event_pool)
                 size = ret;
 
                 for (i = 0; i < size; i++) {
-                        if (!events || !events[i].events)
+                        if (!events[i].events)
                                 continue;
 
                         ret = event_dispatch_epoll_handler (event_pool,
                                                             events, i);
                 }
+
+                if (size > 0)
+                        poller->events += size;
         }
 
+        gf_log ("epoll", GF_LOG_DEBUG, "exited dispatcher thread %d", myid);
+out:
+        return NULL;
+}
+
+
+/* caller holds event_pool->mutex */
+static int
+__event_spawn_pollers (struct event_pool *event_pool)
+{
+        int  i = 0;
+        int  ret = 0;
+
+        for (i = 1; i < event_pool->eventthreadcount; i++) {
+                if (event_pool->pollers[i].running)
+                        continue;
+
+                event_pool->pollers[i].event_pool = event_pool;
+                event_pool->pollers[i].id = i;
+
+                ret = gf_thread_create (&event_pool->pollers[i].thread, NULL,
+                                        event_dispatch_epoll_worker,
+                                        &event_pool->pollers[i]);
+                if (ret) {
+                        gf_log ("epoll", GF_LOG_WARNING,
+                                "failed to start dispatcher thread %d (%s)",
+                                i, strerror (ret));
+                        event_pool->eventthreadcount = i;
+                        break;
+                }
+
+                pthread_detach (event_pool->pollers[i].thread);
+                event_pool->pollers[i].running = 1;
+                event_pool->activethreadcount++;
+        }
+
+        return ret;
+}
+
+
+static int
+event_dispatch_epoll (struct event_pool *event_pool)
+{
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->pollers[0].event_pool = event_pool;
+                event_pool->pollers[0].id = 0;
+                event_pool->pollers[0].thread = pthread_self ();
+                event_pool->pollers[0].running = 1;
+                event_pool->activethreadcount = 1;
+
+                __event_spawn_pollers (event_pool);
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        /* the calling thread becomes dispatcher 0 */
+        event_dispatch_epoll_worker (&event_pool->pollers[0]);
+
+out:
+        return -1;
+}
+
+
+static int
+event_reconfigure_threads_epoll (struct event_pool *event_pool, int count)
+{
+        int  ret = 0;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        if (count < 1)
+                count = 1;
+        if (count > EVENT_MAX_THREADS)
+                count = EVENT_MAX_THREADS;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                if (count == event_pool->eventthreadcount)
+                        goto unlock;
+
+                gf_log ("epoll", GF_LOG_INFO,
+                        "changing dispatcher thread count from %d to %d",
+                        event_pool->eventthreadcount, count);
+
+                event_pool->eventthreadcount = count;
+
+                /* once dispatching has begun, start the extra threads
+                   now. Surplus threads retire on their next wakeup. */
+                if (event_pool->pollers[0].running)
+                        ret = __event_spawn_pollers (event_pool);
+        }
+unlock:
+        pthread_mutex_unlock (&event_pool->mutex);
 out:
         return ret;
 }
@@ -457,7 +627,8 @@ struct event_ops event_ops_epoll = {
         .event_register   = event_register_epoll,
         .event_select_on  = event_select_on_epoll,
         .event_unregister = event_unregister_epoll,
-        .event_dispatch   = event_dispatch_epoll
+        .event_dispatch   = event_dispatch_epoll,
+        .event_reconfigure_threads = event_reconfigure_threads_epoll
 };
 
 #endif
@@ -93,6 +93,7 @@ event_pool_new_poll (int count)
                 return NULL;
 
         event_pool->count = count;
+        event_pool->eventthreadcount = 1;
         event_pool->reg = GF_CALLOC (event_pool->count,
                                      sizeof (*event_pool->reg),
                                      gf_common_mt_reg);
@@ -415,6 +416,15 @@ event_dispatch_poll (struct event_pool *event_pool)
 
         GF_VALIDATE_OR_GOTO ("event", event_pool, out);
 
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->pollers[0].event_pool = event_pool;
+                event_pool->pollers[0].thread = pthread_self ();
+                event_pool->pollers[0].running = 1;
+                event_pool->activethreadcount = 1;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
         while (1) {
                 size = event_dispatch_poll_resize (event_pool, ufds, size);
                 ufds = event_pool->evcache;
@@ -435,6 +445,8 @@ event_dispatch_poll (struct event_pool *event_pool)
 
                         event_dispatch_poll_handler (event_pool, ufds, i);
                 }
+
+                event_pool->pollers[0].events += ret;
         }
 
 out:
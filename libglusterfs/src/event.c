@@ -20,6 +20,7 @@
 #include "event.h"
 #include "mem-pool.h"
 #include "common-utils.h"
+#include "statedump.h"
 
 #ifndef _CONFIG_H
 #define _CONFIG_H
@@ -115,3 +116,57 @@ event_dispatch (struct event_pool *event_pool)
 out:
         return ret;
 }
+
+
+int
+event_reconfigure_threads (struct event_pool *event_pool, int count)
+{
+        int ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        if (!event_pool->ops->event_reconfigure_threads) {
+                gf_log ("event", GF_LOG_INFO, "event backend supports "
+                        "only one dispatcher thread, ignoring count %d",
+                        count);
+                ret = 0;
+                goto out;
+        }
+
+        ret = event_pool->ops->event_reconfigure_threads (event_pool, count);
+out:
+        return ret;
+}
+
+
+void
+event_pool_dump (struct event_pool *event_pool)
+{
+        char  key[GF_DUMP_MAX_BUF_LEN] = {0,};
+        int   i = 0;
+
+        if (!event_pool)
+                return;
+
+        if (pthread_mutex_trylock (&event_pool->mutex))
+                return;
+
+        gf_proc_dump_add_section ("event-pool");
+        gf_proc_dump_write ("registered_fds", "%d", event_pool->used);
+        gf_proc_dump_write ("configured_threads", "%d",
+                            (event_pool->eventthreadcount > 0) ?
+                            event_pool->eventthreadcount : 1);
+        gf_proc_dump_write ("active_threads", "%d",
+                            event_pool->activethreadcount);
+
+        for (i = 0; i < EVENT_MAX_THREADS; i++) {
+                if (!event_pool->pollers[i].running)
+                        continue;
+
+                gf_proc_dump_build_key (key, "thread", "%d.events_handled", i);
+                gf_proc_dump_write (key, "%"PRIu64,
+                                    event_pool->pollers[i].events);
+        }
+
+        pthread_mutex_unlock (&event_pool->mutex);
+}
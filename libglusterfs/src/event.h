@@ -17,6 +17,9 @@
 #endif
 
 #include <pthread.h>
+#include <stdint.h>
+
+#define EVENT_MAX_THREADS  32
 
 struct event_pool;
 struct event_ops;
@@ -26,6 +29,14 @@ struct event_data {
 } __attribute__ ((__packed__, __may_alias__));
 
 
+struct event_thread_data {
+	struct event_pool *event_pool;
+	int                id;
+	pthread_t          thread;
+	int                running;
+	uint64_t           events;   /* events handled by this thread */
+};
+
 typedef int (*event_handler_t) (int fd, int idx, void *data,
 				int poll_in, int poll_out, int poll_err);
 
@@ -41,16 +52,24 @@ struct event_pool {
 		int events;
 		void *data;
 		event_handler_t handler;
+		int gen;          /* distinguishes re-registrations of an fd */
+		int in_handler;   /* a dispatcher thread owns this fd */
 	} *reg;
 
 	int used;
 	int changed;
+	int gen;
 
 	pthread_mutex_t mutex;
 	pthread_cond_t cond;
 
 	void *evcache;
 	int evcache_size;
+
+	/* dispatcher threads sharing the epoll fd */
+	int eventthreadcount;
+	int activethreadcount;
+	struct event_thread_data pollers[EVENT_MAX_THREADS];
 };
 
 struct event_ops {
@@ -66,6 +85,9 @@ struct event_ops {
         int (*event_unregister) (struct event_pool *event_pool, int fd, int idx);
 
         int (*event_dispatch) (struct event_pool *event_pool);
+
+        int (*event_reconfigure_threads) (struct event_pool *event_pool,
+                                          int count);
 };
 
 struct event_pool * event_pool_new (int count);
@@ -76,5 +98,7 @@ int event_register (struct event_pool *event_pool, int fd,
 		    void *data, int poll_in, int poll_out);
 int event_unregister (struct event_pool *event_pool, int fd, int idx);
 int event_dispatch (struct event_pool *event_pool);
+int event_reconfigure_threads (struct event_pool *event_pool, int count);
+void event_pool_dump (struct event_pool *event_pool);
 
 #endif /* _EVENT_H_ */
@@ -28,6 +28,44 @@ gf_fd_fdtable_expand (fdtable_t *fdtable, uint32_t nr);
 fd_t *
 __fd_ref (fd_t *fd);
 
+
+static inline struct fdtable_readers *
+gf_fd_fdtable_reader_slot (fdtable_t *fdtable)
+{
+        uint32_t hash = 0;
+
+        hash = (uint32_t) ((unsigned long) pthread_self () >> 12);
+        hash *= 0x9E3779B1;
+
+        return &fdtable->readers[hash >> (32 - GF_FDTABLE_READER_SHIFT)];
+}
+
+
+/* Waits until no lookup can still see an entry cleared, or an array
+ * replaced, before the call.  A lookup that read the epoch just before it
+ * was advanced may count itself under the old epoch after the wait for it
+ * is over, hence the second round.  Called with fdtable->lock held.
+ */
+static void
+__gf_fd_fdtable_synchronize (fdtable_t *fdtable)
+{
+        volatile int32_t *count = NULL;
+        int               round = 0;
+        int               idx = 0;
+        int               i = 0;
+
+        for (round = 0; round < 2; round++) {
+                idx = __sync_fetch_and_add (&fdtable->epoch, 1) & 1;
+
+                for (i = 0; i < GF_FDTABLE_READER_SLOTS; i++) {
+                        count = &fdtable->readers[i].count[idx];
+                        while (*count)
+                                sched_yield ();
+                }
+        }
+}
+
+
 static int
 gf_fd_chain_fd_entries (fdentry_t *entries, uint32_t startidx,
                         uint32_t endcount)
@@ -56,6 +94,7 @@ static int
 gf_fd_fdtable_expand (fdtable_t *fdtable, uint32_t nr)
 {
         fdentry_t   *oldfds = NULL;
+        fdentry_t   *newfds = NULL;
         uint32_t     oldmax_fds = -1;
         int          ret = -1;
 
@@ -72,28 +111,35 @@ gf_fd_fdtable_expand (fdtable_t *fdtable, uint32_t nr)
         oldfds = fdtable->fdentries;
         oldmax_fds = fdtable->max_fds;
 
-        fdtable->fdentries = GF_CALLOC (nr, sizeof (fdentry_t),
-                                        gf_common_mt_fdentry_t);
-        if (!fdtable->fdentries) {
+        newfds = GF_CALLOC (nr, sizeof (fdentry_t), gf_common_mt_fdentry_t);
+        if (!newfds) {
                 ret = ENOMEM;
                 goto out;
         }
-        fdtable->max_fds = nr;
 
         if (oldfds) {
                 uint32_t cpy = oldmax_fds * sizeof (fdentry_t);
-                memcpy (fdtable->fdentries, oldfds, cpy);
+                memcpy (newfds, oldfds, cpy);
         }
 
-        gf_fd_chain_fd_entries (fdtable->fdentries, oldmax_fds,
-                                fdtable->max_fds);
+        gf_fd_chain_fd_entries (newfds, oldmax_fds, nr);
+
+        /* lookups read max_fds before fdentries, so publish the array
+           first: a lookup allowed by the new max_fds sees the new array */
+        fdtable->fdentries = newfds;
+        __sync_synchronize ();
+        fdtable->max_fds = nr;
 
         /* Now that expansion is done, we must update the fd list
          * head pointer so that the fd allocation functions can continue
          * using the expanded table.
          */
         fdtable->first_free = oldmax_fds;
-        GF_FREE (oldfds);
+
+        if (oldfds) {
+                __gf_fd_fdtable_synchronize (fdtable);
+                GF_FREE (oldfds);
+        }
         ret = 0;
 out:
         return ret;
@@ -121,22 +167,33 @@ gf_fd_fdtable_alloc (void)
 }
 
 
+/* hands the table's references over to the caller and empties the table
+   in place, lookups may still be reading it */
 static fdentry_t *
 __gf_fd_fdtable_get_all_fds (fdtable_t *fdtable, uint32_t *count)
 {
         fdentry_t       *fdentries = NULL;
+        uint32_t         i = 0;
 
         if (count == NULL) {
                 gf_log_callingfn ("fd", GF_LOG_WARNING, "!count");
                 goto out;
         }
 
-        fdentries = fdtable->fdentries;
-        fdtable->fdentries = GF_CALLOC (fdtable->max_fds, sizeof (fdentry_t),
-                                        gf_common_mt_fdentry_t);
+        fdentries = GF_CALLOC (fdtable->max_fds, sizeof (fdentry_t),
+                               gf_common_mt_fdentry_t);
+        if (fdentries == NULL)
+                goto out;
+
+        for (i = 0; i < fdtable->max_fds; i++) {
+                fdentries[i].fd = fdtable->fdentries[i].fd;
+                fdtable->fdentries[i].fd = NULL;
+        }
         gf_fd_chain_fd_entries (fdtable->fdentries, 0, fdtable->max_fds);
+        fdtable->first_free = 0;
         *count = fdtable->max_fds;
 
+        __gf_fd_fdtable_synchronize (fdtable);
 out:
         return fdentries;
 }
@@ -265,6 +322,8 @@ gf_fd_unused_get (fdtable_t *fdtable, fd_t *fdptr)
                         fd = fdtable->first_free;
                         fdtable->first_free = fde->next_free;
                         fde->next_free = GF_FDENTRY_ALLOCATED;
+                        /* lookups see a fully set up fd */
+                        __sync_synchronize ();
                         fde->fd = fdptr;
                 } else {
                         /* If this is true, there is something
@@ -337,6 +396,8 @@ gf_fd_put (fdtable_t *fdtable, int32_t fd)
                 fde->fd = NULL;
                 fde->next_free = fdtable->first_free;
                 fdtable->first_free = fd;
+
+                __gf_fd_fdtable_synchronize (fdtable);
         }
 unlock_out:
         pthread_mutex_unlock (&fdtable->lock);
@@ -385,6 +446,8 @@ gf_fdptr_put (fdtable_t *fdtable, fd_t *fd)
                 fde->fd = NULL;
                 fde->next_free = fdtable->first_free;
                 fdtable->first_free = i;
+
+                __gf_fd_fdtable_synchronize (fdtable);
         }
 unlock_out:
         pthread_mutex_unlock (&fdtable->lock);
@@ -398,7 +461,9 @@ unlock_out:
 fd_t *
 gf_fd_fdptr_get (fdtable_t *fdtable, int64_t fd)
 {
-        fd_t *fdptr = NULL;
+        struct fdtable_readers *readers = NULL;
+        fd_t                   *fdptr = NULL;
+        int                     idx = 0;
 
         if (fdtable == NULL || fd < 0) {
                 gf_log_callingfn ("fd", GF_LOG_ERROR, "invalid argument");
@@ -406,20 +471,25 @@ gf_fd_fdptr_get (fdtable_t *fdtable, int64_t fd)
                 return NULL;
         }
 
-        if (!(fd < fdtable->max_fds)) {
+        if (!(fd < *(volatile uint32_t *)&fdtable->max_fds)) {
                 gf_log_callingfn ("fd", GF_LOG_ERROR, "invalid argument");
                 errno = EINVAL;
                 return NULL;
         }
 
-        pthread_mutex_lock (&fdtable->lock);
+        /* no lock: the table holds a reference on the fd until the lookups
+           counted here are over, see __gf_fd_fdtable_synchronize() */
+        readers = gf_fd_fdtable_reader_slot (fdtable);
+        idx = *(volatile uint32_t *)&fdtable->epoch & 1;
+
+        __sync_fetch_and_add (&readers->count[idx], 1);
         {
-                fdptr = fdtable->fdentries[fd].fd;
+                fdptr = ((volatile fdentry_t *)fdtable->fdentries)[fd].fd;
                 if (fdptr) {
                         fd_ref (fdptr);
                 }
         }
-        pthread_mutex_unlock (&fdtable->lock);
+        __sync_fetch_and_sub (&readers->count[idx], 1);
 
         return fdptr;
 }
@@ -428,27 +498,23 @@ gf_fd_fdptr_get (fdtable_t *fdtable, int64_t fd)
 fd_t *
 __fd_ref (fd_t *fd)
 {
-        ++fd->refcount;
+        __sync_fetch_and_add (&fd->refcount, 1);
 
         return fd;
 }
 
 
+/* Taking a reference needs no lock: whoever takes it already holds one,
+   or found the fd in a table or inode list which holds one. */
 fd_t *
 fd_ref (fd_t *fd)
 {
-        fd_t *refed_fd = NULL;
-
         if (!fd) {
                 gf_log_callingfn ("fd", GF_LOG_ERROR, "null fd");
                 return NULL;
         }
 
-        LOCK (&fd->inode->lock);
-        refed_fd = __fd_ref (fd);
-        UNLOCK (&fd->inode->lock);
-
-        return refed_fd;
+        return __fd_ref (fd);
 }
 
 
@@ -457,9 +523,7 @@ __fd_unref (fd_t *fd)
 {
         GF_ASSERT (fd->refcount);
 
-        --fd->refcount;
-
-        if (fd->refcount == 0) {
+        if (__sync_sub_and_fetch (&fd->refcount, 1) == 0) {
                 list_del_init (&fd->inode_list);
         }
 
@@ -531,12 +595,25 @@ void
 fd_unref (fd_t *fd)
 {
         int32_t refcount = 0;
+        int32_t old = 0;
 
         if (!fd) {
                 gf_log_callingfn ("fd", GF_LOG_ERROR, "fd is NULL");
                 return;
         }
 
+        /* only the last reference is dropped under inode->lock, which
+           takes the fd off the inode's list before __fd_lookup() can find
+           it there with no reference left */
+        refcount = fd->refcount;
+        while (refcount > 1) {
+                old = __sync_val_compare_and_swap (&fd->refcount, refcount,
+                                                   refcount - 1);
+                if (old == refcount)
+                        return;
+                refcount = old;
+        }
+
         LOCK (&fd->inode->lock);
         {
                 __fd_unref (fd);
@@ -44,7 +44,8 @@ struct _fd_ctx {
 struct _fd {
         uint64_t          pid;
 	int32_t           flags;
-        int32_t           refcount;
+        int32_t           refcount; /* atomic; dropping the last reference
+                                       takes inode->lock */
         struct list_head  inode_list;
         struct _inode    *inode;
         gf_lock_t         lock; /* used ONLY for manipulating
@@ -64,12 +65,28 @@ struct fd_table_entry {
 typedef struct fd_table_entry fdentry_t;
 
 
+/* gf_fd_fdptr_get() takes no lock.  A lookup counts itself in a reader
+ * slot, picked by thread, for the current epoch while it reads fdentries.
+ * Writers, serialized by fdtable->lock, advance the epoch and wait for the
+ * lookups counted under the previous ones before dropping the table's
+ * reference to an fd they took out or freeing an array they replaced.
+ */
+#define GF_FDTABLE_READER_SHIFT 3
+#define GF_FDTABLE_READER_SLOTS (1 << GF_FDTABLE_READER_SHIFT)
+
+struct fdtable_readers {
+        int32_t         count[2];       /* lookups in flight, by epoch */
+        char            pad[56];        /* a cache line per slot */
+};
+
 struct _fdtable {
         int             refcount;
         uint32_t        max_fds;
         pthread_mutex_t lock;
         fdentry_t       *fdentries;
         int             first_free;
+        uint32_t        epoch;
+        struct fdtable_readers readers[GF_FDTABLE_READER_SLOTS];
 };
 typedef struct _fdtable fdtable_t;
 
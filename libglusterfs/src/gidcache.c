@@ -10,6 +10,7 @@
 
 #include "gidcache.h"
 #include "mem-pool.h"
+#include "statedump.h"
 
 /*
  * We treat this as a very simple set-associative LRU cache, with entries aged
@@ -17,19 +18,37 @@
  * details to worry about.
  */
 #define BUCKET_START(p,n)       ((p) + ((n) * AUX_GID_CACHE_ASSOC))
+#define BUCKET_SHARD(c,n)       (&(c)->gc_shards[(n) % AUX_GID_CACHE_SHARDS])
+
+static unsigned int gid_cache_nbuckets(uint32_t size)
+{
+	unsigned int nbuckets = size / AUX_GID_CACHE_ASSOC;
+
+	return nbuckets ? nbuckets : 1;
+}
 
 /*
  * Initialize the cache.
  */
 int gid_cache_init(gid_cache_t *cache, uint32_t timeout)
 {
+	int i;
+
 	if (!cache)
 		return -1;
 
+	memset(cache, 0, sizeof(*cache));
+
+	cache->gc_nbuckets = AUX_GID_CACHE_BUCKETS;
+	cache->gc_cache = GF_CALLOC(AUX_GID_CACHE_SIZE, sizeof(gid_list_t),
+				    gf_common_mt_gid_cache_t);
+	if (!cache->gc_cache)
+		return -1;
+
 	LOCK_INIT(&cache->gc_lock);
 	cache->gc_max_age = timeout;
-	cache->gc_nbuckets = AUX_GID_CACHE_BUCKETS;
-	memset(cache->gc_cache, 0, sizeof(gid_list_t) * AUX_GID_CACHE_SIZE);
+	for (i = 0; i < AUX_GID_CACHE_SHARDS; i++)
+		pthread_rwlock_init(&cache->gc_shards[i].gs_lock, NULL);
 
 	return 0;
 }
@@ -42,82 +61,22 @@ int gid_cache_reconf(gid_cache_t *cache, uint32_t timeout)
         if (!cache)
                 return -1;
 
-        LOCK(&cache->gc_lock);
         cache->gc_max_age = timeout;
-        UNLOCK(&cache->gc_lock);
 
         return 0;
 }
 
 /*
- * Look up an ID in the cache. If found, return the actual cache entry to avoid
- * an additional allocation and memory copy. The caller should copy the data and
- * release (unlock) the cache as soon as possible.
- */
-const gid_list_t *gid_cache_lookup(gid_cache_t *cache, uint64_t id)
-{
-	int bucket;
-	int i;
-	time_t now;
-	const gid_list_t *agl;
-
-	LOCK(&cache->gc_lock);
-	now = time(NULL);
-	bucket = id % cache->gc_nbuckets;
-	agl = BUCKET_START(cache->gc_cache, bucket);
-	for (i = 0; i < AUX_GID_CACHE_ASSOC; i++, agl++) {
-		if (!agl->gl_list)
-			continue;
-		if (agl->gl_id != id)
-			continue;
-
-		/*
-		 * We don't put new entries in the cache when expiration=0, but
-		 * there might be entries still in there if expiration was
-		 * changed very recently.  Writing the check this way ensures
-		 * that they're not used.
-		 */
-		if (now < agl->gl_deadline) {
-			return agl;
-		}
-
-		/*
-		 * We're not going to find any more UID matches, and reaping
-		 * is handled further down to maintain LRU order.
-		 */
-		break;
-	}
-	UNLOCK(&cache->gc_lock);
-	return NULL;
-}
-
-/*
- * Release an entry found via lookup.
+ * Store @gl at the MRU end of @bucket, reusing an entry already allocated to
+ * this id or evicting the LRU entry if the bucket is full.  Returns 1 if a
+ * different id had to be evicted.  The caller holds the bucket's shard lock.
  */
-void gid_cache_release(gid_cache_t *cache, const gid_list_t *agl)
-{
-	UNLOCK(&cache->gc_lock);
-}
-
-/*
- * Add a new list entry to the cache. If an entry for this ID already exists,
- * update it.
- */
-int gid_cache_add(gid_cache_t *cache, gid_list_t *gl)
+static int __gid_cache_insert(gid_list_t *bucket_start, gid_list_t *gl,
+			      time_t deadline)
 {
-	gid_list_t *agl;
-	int bucket;
+	gid_list_t *agl = bucket_start;
+	int evicted = 0;
 	int i;
-	time_t now;
-
-	if (!gl || !gl->gl_list)
-		return -1;
-
-	if (!cache->gc_max_age)
-		return 0;
-
-	LOCK(&cache->gc_lock);
-	now = time(NULL);
 
 	/*
 	 * Scan for the first free entry or one that matches this id. The id
@@ -134,8 +93,6 @@ int gid_cache_add(gid_cache_t *cache, gid_list_t *gl)
 	 * deadline and is pushed forward to reside as the last populated entry in
 	 * the bucket.
 	 */
-	bucket = gl->gl_id % cache->gc_nbuckets;
-	agl = BUCKET_START(cache->gc_cache, bucket);
 	for (i = 0; i < AUX_GID_CACHE_ASSOC; ++i, ++agl) {
 		if (agl->gl_id == gl->gl_id)
 			break;
@@ -163,8 +120,9 @@ int gid_cache_add(gid_cache_t *cache, gid_list_t *gl)
 	if (i >= AUX_GID_CACHE_ASSOC) {
 		/* cache full, evict the first (LRU) entry */
 		i = 0;
-		agl = BUCKET_START(cache->gc_cache, bucket);
+		agl = bucket_start;
 		GF_FREE(agl->gl_list);
+		evicted = 1;
 	} else if (agl->gl_list) {
 		/* evict the old entry we plan to reuse */
 		GF_FREE(agl->gl_list);
@@ -184,9 +142,236 @@ int gid_cache_add(gid_cache_t *cache, gid_list_t *gl)
 	agl->gl_id = gl->gl_id;
 	agl->gl_count = gl->gl_count;
 	agl->gl_list = gl->gl_list;
-	agl->gl_deadline = now + cache->gc_max_age;
+	agl->gl_deadline = deadline;
+
+	return evicted;
+}
 
+/*
+ * Change the number of entries the cache can hold.  Cached lists are carried
+ * over to the new geometry as far as they fit.
+ */
+int gid_cache_resize(gid_cache_t *cache, uint32_t size)
+{
+	gid_list_t *new_cache;
+	gid_list_t *old_cache;
+	gid_list_t *agl;
+	unsigned int nbuckets;
+	unsigned int old_nbuckets;
+	unsigned int bucket;
+	int i;
+
+	if (!cache)
+		return -1;
+
+	nbuckets = gid_cache_nbuckets(size);
+	if (nbuckets == cache->gc_nbuckets)
+		return 0;
+
+	new_cache = GF_CALLOC(nbuckets * AUX_GID_CACHE_ASSOC,
+			      sizeof(gid_list_t), gf_common_mt_gid_cache_t);
+	if (!new_cache)
+		return -1;
+
+	LOCK(&cache->gc_lock);
+	for (i = 0; i < AUX_GID_CACHE_SHARDS; i++)
+		pthread_rwlock_wrlock(&cache->gc_shards[i].gs_lock);
+
+	old_cache = cache->gc_cache;
+	old_nbuckets = cache->gc_nbuckets;
+
+	/* oldest entries first, so each new bucket keeps its LRU order */
+	for (i = 0; i < AUX_GID_CACHE_ASSOC; i++) {
+		for (bucket = 0; bucket < old_nbuckets; bucket++) {
+			agl = BUCKET_START(old_cache, bucket) + i;
+			if (!agl->gl_list)
+				continue;
+			__gid_cache_insert(BUCKET_START(new_cache,
+					   agl->gl_id % nbuckets), agl,
+					   agl->gl_deadline);
+		}
+	}
+
+	cache->gc_cache = new_cache;
+	cache->gc_nbuckets = nbuckets;
+
+	for (i = AUX_GID_CACHE_SHARDS - 1; i >= 0; i--)
+		pthread_rwlock_unlock(&cache->gc_shards[i].gs_lock);
 	UNLOCK(&cache->gc_lock);
 
+	GF_FREE(old_cache);
+
+	return 0;
+}
+
+/*
+ * Free the cached lists and the cache itself.  The cache must no longer be
+ * in use, gid_cache_init() has to be called before it is used again.
+ */
+void gid_cache_destroy(gid_cache_t *cache)
+{
+	unsigned int i;
+
+	if (!cache || !cache->gc_cache)
+		return;
+
+	for (i = 0; i < cache->gc_nbuckets * AUX_GID_CACHE_ASSOC; i++)
+		GF_FREE(cache->gc_cache[i].gl_list);
+
+	GF_FREE(cache->gc_cache);
+	cache->gc_cache = NULL;
+	cache->gc_nbuckets = 0;
+
+	LOCK_DESTROY(&cache->gc_lock);
+	for (i = 0; i < AUX_GID_CACHE_SHARDS; i++)
+		pthread_rwlock_destroy(&cache->gc_shards[i].gs_lock);
+}
+
+/*
+ * Read-lock the shard owning @id's bucket.  The geometry cannot change while
+ * any shard lock is held, so recheck it once the lock is taken.
+ */
+static gid_cache_shard_t *gid_cache_rdlock(gid_cache_t *cache, uint64_t id,
+					   int *bucket)
+{
+	gid_cache_shard_t *shard;
+	unsigned int nbuckets;
+
+	for (;;) {
+		nbuckets = cache->gc_nbuckets;
+		shard = BUCKET_SHARD(cache, id % nbuckets);
+		pthread_rwlock_rdlock(&shard->gs_lock);
+		if (nbuckets == cache->gc_nbuckets)
+			break;
+		pthread_rwlock_unlock(&shard->gs_lock);
+	}
+
+	*bucket = id % nbuckets;
+	return shard;
+}
+
+/*
+ * Look up an ID in the cache. If found, return the actual cache entry to avoid
+ * an additional allocation and memory copy. The caller should copy the data and
+ * release (unlock) the cache as soon as possible.
+ */
+const gid_list_t *gid_cache_lookup(gid_cache_t *cache, uint64_t id)
+{
+	gid_cache_shard_t *shard;
+	int bucket;
+	int i;
+	time_t now;
+	const gid_list_t *agl;
+
+	shard = gid_cache_rdlock(cache, id, &bucket);
+	now = time(NULL);
+	agl = BUCKET_START(cache->gc_cache, bucket);
+	for (i = 0; i < AUX_GID_CACHE_ASSOC; i++, agl++) {
+		if (!agl->gl_list)
+			continue;
+		if (agl->gl_id != id)
+			continue;
+
+		/*
+		 * We don't put new entries in the cache when expiration=0, but
+		 * there might be entries still in there if expiration was
+		 * changed very recently.  Writing the check this way ensures
+		 * that they're not used.
+		 */
+		if (now < agl->gl_deadline) {
+			__sync_fetch_and_add(&shard->gs_hits, 1);
+			return agl;
+		}
+
+		/*
+		 * We're not going to find any more UID matches, and reaping
+		 * is handled further down to maintain LRU order.
+		 */
+		break;
+	}
+	__sync_fetch_and_add(&shard->gs_misses, 1);
+	pthread_rwlock_unlock(&shard->gs_lock);
+	return NULL;
+}
+
+/*
+ * Release an entry found via lookup.
+ */
+void gid_cache_release(gid_cache_t *cache, const gid_list_t *agl)
+{
+	gid_cache_shard_t *shard;
+
+	shard = BUCKET_SHARD(cache, agl->gl_id % cache->gc_nbuckets);
+	pthread_rwlock_unlock(&shard->gs_lock);
+}
+
+/*
+ * Add a new list entry to the cache. If an entry for this ID already exists,
+ * update it.
+ */
+int gid_cache_add(gid_cache_t *cache, gid_list_t *gl)
+{
+	gid_cache_shard_t *shard;
+	unsigned int nbuckets;
+	int bucket;
+	time_t now;
+
+	if (!gl || !gl->gl_list)
+		return -1;
+
+	if (!cache->gc_max_age)
+		return 0;
+
+	for (;;) {
+		nbuckets = cache->gc_nbuckets;
+		shard = BUCKET_SHARD(cache, gl->gl_id % nbuckets);
+		pthread_rwlock_wrlock(&shard->gs_lock);
+		if (nbuckets == cache->gc_nbuckets)
+			break;
+		pthread_rwlock_unlock(&shard->gs_lock);
+	}
+
+	now = time(NULL);
+	bucket = gl->gl_id % nbuckets;
+
+	if (__gid_cache_insert(BUCKET_START(cache->gc_cache, bucket), gl,
+			       now + cache->gc_max_age))
+		shard->gs_evictions++;
+
+	pthread_rwlock_unlock(&shard->gs_lock);
+
 	return 1;
 }
+
+/*
+ * Write the cache geometry and hit/miss/eviction counters to a statedump.
+ */
+void gid_cache_dump(gid_cache_t *cache, const char *prefix)
+{
+	char key[GF_DUMP_MAX_BUF_LEN];
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	int i;
+
+	if (!cache || !cache->gc_cache)
+		return;
+
+	for (i = 0; i < AUX_GID_CACHE_SHARDS; i++) {
+		hits += cache->gc_shards[i].gs_hits;
+		misses += cache->gc_shards[i].gs_misses;
+		evictions += cache->gc_shards[i].gs_evictions;
+	}
+
+	gf_proc_dump_build_key(key, prefix, "size");
+	gf_proc_dump_write(key, "%u",
+			   cache->gc_nbuckets * AUX_GID_CACHE_ASSOC);
+	gf_proc_dump_build_key(key, prefix, "max_age");
+	gf_proc_dump_write(key, "%u", cache->gc_max_age);
+	gf_proc_dump_build_key(key, prefix, "hits");
+	gf_proc_dump_write(key, "%"PRIu64, hits);
+	gf_proc_dump_build_key(key, prefix, "misses");
+	gf_proc_dump_write(key, "%"PRIu64, misses);
+	gf_proc_dump_build_key(key, prefix, "evictions");
+	gf_proc_dump_write(key, "%"PRIu64, evictions);
+}
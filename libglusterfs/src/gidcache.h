@@ -15,20 +15,21 @@
 #include "locking.h"
 
 /*
- * TBD: make the cache size tunable
- *
- * The current size represents a pretty trivial amount of memory, and should
- * provide good hit rates even for quite busy systems.  If we ever want to
- * support really large cache sizes, we'll need to do dynamic allocation
- * instead of just defining an array within a private structure. It doesn't make
- * a whole lot of sense to change the associativity, because it won't improve
- * hit rates all that much and will increase the maintenance cost as we have
- * to scan more entries with every lookup/update.
+ * The cache is set-associative with AUX_GID_CACHE_ASSOC entries per bucket.
+ * The number of buckets follows the configured size (AUX_GID_CACHE_SIZE
+ * entries by default) and can be changed at runtime with gid_cache_resize().
+ * Buckets are striped over AUX_GID_CACHE_SHARDS read-write locks, so lookups
+ * for different users, and concurrent lookups of the same user, do not
+ * serialise on a single lock.  It doesn't make a whole lot of sense to change
+ * the associativity, because it won't improve hit rates all that much and will
+ * increase the maintenance cost as we have to scan more entries with every
+ * lookup/update.
  */
 
 #define AUX_GID_CACHE_ASSOC     4
 #define AUX_GID_CACHE_BUCKETS   256
 #define AUX_GID_CACHE_SIZE      (AUX_GID_CACHE_ASSOC * AUX_GID_CACHE_BUCKETS)
+#define AUX_GID_CACHE_SHARDS    16
 
 typedef struct {
 	uint64_t	gl_id;
@@ -38,16 +39,27 @@ typedef struct {
 } gid_list_t;
 
 typedef struct {
-	gf_lock_t	gc_lock;
+	pthread_rwlock_t gs_lock;	/* guards the buckets of this shard */
+	uint64_t	gs_hits;
+	uint64_t	gs_misses;
+	uint64_t	gs_evictions;
+} gid_cache_shard_t;
+
+typedef struct {
+	gf_lock_t	gc_lock;	/* serialises resizes */
 	uint32_t	gc_max_age;
 	unsigned int	gc_nbuckets;
-	gid_list_t	gc_cache[AUX_GID_CACHE_SIZE];
+	gid_list_t	*gc_cache;
+	gid_cache_shard_t gc_shards[AUX_GID_CACHE_SHARDS];
 } gid_cache_t;
 
 int gid_cache_init(gid_cache_t *, uint32_t);
 int gid_cache_reconf(gid_cache_t *, uint32_t);
+int gid_cache_resize(gid_cache_t *, uint32_t);
+void gid_cache_destroy(gid_cache_t *);
 const gid_list_t *gid_cache_lookup(gid_cache_t *, uint64_t);
 void gid_cache_release(gid_cache_t *, const gid_list_t *);
 int gid_cache_add(gid_cache_t *, gid_list_t *);
+void gid_cache_dump(gid_cache_t *, const char *);
 
 #endif /* __GIDCACHE_H__ */
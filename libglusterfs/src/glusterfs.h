@@ -155,6 +155,9 @@
 
 #define GF_UUID_BUF_SIZE 50
 
+/* threads initializing translators of a graph, see --graph-init-threads */
+#define GF_GRAPH_INIT_THREADS_DEFAULT 8
+
 #define GF_REBALANCE_TID_KEY     "rebalance-id"
 #define GF_REMOVE_BRICK_TID_KEY  "remove-brick-id"
 #define GF_REPLACE_BRICK_TID_KEY "replace-brick-id"
@@ -341,6 +344,13 @@ struct _cmd_args {
         int              fopen_keep_cache;
         int              gid_timeout;
         int              aux_gfid_mount;
+        int              event_threads;
+        int              iobuf_hugepages;
+        int              iobuf_numa;
+        int              log_sync;
+        uint32_t         log_rate_limit;
+        char            *metrics_socket;
+        int              graph_init_threads;
         struct list_head xlator_options;  /* list of xlator_option_t */
 
         /* fuse options */
@@ -18,6 +18,7 @@
 #include <netdb.h>
 #include <fnmatch.h>
 #include "defaults.h"
+#include "timer.h"
 
 
 #if 0
@@ -292,25 +293,259 @@ glusterfs_graph_validate_options (glusterfs_graph_t *graph)
 }
 
 
+/*
+ * Translators are initialized by a small pool of threads.  A translator is
+ * started once all of its parents have been initialized, which keeps the
+ * parent-before-child order of the sequential walk while independent
+ * subtrees (the clients under a distribute, the subvolumes of a replica
+ * set) initialize concurrently.  With one thread the graph is walked in
+ * volfile order as it always was.
+ */
+struct graph_init_state {
+        pthread_mutex_t   mutex;
+        pthread_cond_t    cond;
+        xlator_t        **xls;
+        int              *parents_left;  /* parents not initialized yet */
+        int              *ready;         /* stack of startable indices */
+        int               nready;
+        int               count;
+        int               done;
+        int               running;
+        int               ret;
+        xlator_t         *slowest;
+        uint64_t          slowest_usec;
+};
+
+
+static uint64_t
+graph_usec_since (struct timeval *start)
+{
+        struct timeval now = {0, };
+
+        gettimeofday (&now, NULL);
+
+        return (now.tv_sec - start->tv_sec) * 1000000ULL +
+                now.tv_usec - start->tv_usec;
+}
+
+
+static int
+graph_xlator_init_timed (xlator_t *xl, uint64_t *usec)
+{
+        struct timeval start = {0, };
+        int            ret   = 0;
+
+        gettimeofday (&start, NULL);
+
+        ret = xlator_init (xl);
+
+        *usec = graph_usec_since (&start);
+
+        if (ret)
+                gf_log (xl->name, GF_LOG_ERROR,
+                        "initializing translator failed");
+        else
+                gf_log (xl->name, GF_LOG_INFO,
+                        "initialized translator (%s) in %"PRIu64" us",
+                        xl->type, *usec);
+
+        return ret;
+}
+
+
+static int
+graph_init_index (struct graph_init_state *state, xlator_t *xl)
+{
+        int i = 0;
+
+        for (i = 0; i < state->count; i++)
+                if (state->xls[i] == xl)
+                        return i;
+
+        return -1;
+}
+
+
+static void *
+graph_init_worker (void *data)
+{
+        struct graph_init_state *state    = data;
+        xlator_list_t           *child    = NULL;
+        xlator_t                *xl       = NULL;
+        uint64_t                 usec     = 0;
+        int                      idx      = 0;
+        int                      ret      = 0;
+
+        pthread_mutex_lock (&state->mutex);
+        for (;;) {
+                while (!state->nready && state->running && !state->ret)
+                        pthread_cond_wait (&state->cond, &state->mutex);
+
+                /* a failure stops the dispatch; nothing ready and nothing
+                   running means the graph is done */
+                if (state->ret || !state->nready)
+                        break;
+
+                idx = state->ready[--state->nready];
+                xl = state->xls[idx];
+                state->running++;
+                pthread_mutex_unlock (&state->mutex);
+
+                ret = graph_xlator_init_timed (xl, &usec);
+
+                pthread_mutex_lock (&state->mutex);
+                state->running--;
+                if (ret) {
+                        if (!state->ret)
+                                state->ret = ret;
+                } else {
+                        state->done++;
+                        if (usec >= state->slowest_usec) {
+                                state->slowest = xl;
+                                state->slowest_usec = usec;
+                        }
+                        for (child = xl->children; child;
+                             child = child->next) {
+                                idx = graph_init_index (state, child->xlator);
+                                if (idx < 0 || --state->parents_left[idx])
+                                        continue;
+                                state->ready[state->nready++] = idx;
+                        }
+                }
+                pthread_cond_broadcast (&state->cond);
+        }
+        pthread_cond_broadcast (&state->cond);
+        pthread_mutex_unlock (&state->mutex);
+
+        return NULL;
+}
+
+
+static int
+glusterfs_graph_init_parallel (glusterfs_graph_t *graph, int threads)
+{
+        struct graph_init_state  state   = {{{0, }, }, };
+        xlator_list_t           *parent  = NULL;
+        xlator_t                *trav    = NULL;
+        pthread_t               *tids    = NULL;
+        int                      started = 0;
+        int                      count   = 0;
+        int                      i       = 0;
+        int                      ret     = -1;
+
+        for (trav = graph->first; trav; trav = trav->next)
+                count++;
+
+        state.xls = GF_CALLOC (count, sizeof (*state.xls),
+                               gf_common_mt_graph_init);
+        state.parents_left = GF_CALLOC (count, sizeof (int),
+                                        gf_common_mt_graph_init);
+        state.ready = GF_CALLOC (count, sizeof (int),
+                                 gf_common_mt_graph_init);
+        tids = GF_CALLOC (threads, sizeof (*tids), gf_common_mt_graph_init);
+        if (!state.xls || !state.parents_left || !state.ready || !tids)
+                goto out;
+
+        state.count = count;
+        for (i = 0, trav = graph->first; trav; trav = trav->next, i++)
+                state.xls[i] = trav;
+
+        for (i = 0; i < count; i++) {
+                for (parent = state.xls[i]->parents; parent;
+                     parent = parent->next)
+                        if (graph_init_index (&state, parent->xlator) >= 0)
+                                state.parents_left[i]++;
+        }
+
+        /* pushed in reverse so the top of the graph is popped first */
+        for (i = count - 1; i >= 0; i--)
+                if (!state.parents_left[i])
+                        state.ready[state.nready++] = i;
+
+        /* created lazily and without locking by its first user */
+        gf_timer_registry_init (THIS->ctx);
+
+        pthread_mutex_init (&state.mutex, NULL);
+        pthread_cond_init (&state.cond, NULL);
+
+        /* the calling thread is one of the workers */
+        for (started = 0; started < threads - 1; started++) {
+                if (gf_thread_create (&tids[started], NULL,
+                                      graph_init_worker, &state) != 0)
+                        break;
+        }
+
+        graph_init_worker (&state);
+
+        for (i = 0; i < started; i++)
+                pthread_join (tids[i], NULL);
+
+        pthread_cond_destroy (&state.cond);
+        pthread_mutex_destroy (&state.mutex);
+
+        ret = state.ret;
+        if (!ret && state.done != count) {
+                gf_log ("graph", GF_LOG_ERROR, "%d of %d translators could "
+                        "not be reached from the top of the graph",
+                        count - state.done, count);
+                ret = -1;
+        }
+
+        if (!ret && state.slowest)
+                gf_log ("graph", GF_LOG_INFO, "initialized %d translators "
+                        "with %d threads, slowest %s (%"PRIu64" us)", count,
+                        started + 1, state.slowest->name, state.slowest_usec);
+out:
+        GF_FREE (state.xls);
+        GF_FREE (state.parents_left);
+        GF_FREE (state.ready);
+        GF_FREE (tids);
+
+        return ret;
+}
+
+
 int
 glusterfs_graph_init (glusterfs_graph_t *graph)
 {
         xlator_t           *trav = NULL;
+        glusterfs_ctx_t    *ctx = NULL;
+        struct timeval      start = {0, };
+        uint64_t            usec = 0;
+        int                 threads = 0;
         int                 ret = -1;
 
+        ctx = THIS->ctx;
+        if (ctx)
+                threads = ctx->cmd_args.graph_init_threads;
+        if (!threads)
+                threads = GF_GRAPH_INIT_THREADS_DEFAULT;
+        if (threads > graph->xl_count)
+                threads = graph->xl_count;
+
+        gettimeofday (&start, NULL);
+
+        if (threads > 1) {
+                ret = glusterfs_graph_init_parallel (graph, threads);
+                goto out;
+        }
+
         trav = graph->first;
 
         while (trav) {
-                ret = xlator_init (trav);
-                if (ret) {
-                        gf_log (trav->name, GF_LOG_ERROR,
-                                "initializing translator failed");
-                        return ret;
-                }
+                ret = graph_xlator_init_timed (trav, &usec);
+                if (ret)
+                        goto out;
                 trav = trav->next;
         }
 
-        return 0;
+        ret = 0;
+out:
+        if (!ret)
+                gf_log ("graph", GF_LOG_INFO, "graph %d initialized in "
+                        "%"PRIu64" us", graph->id, graph_usec_since (&start));
+
+        return ret;
 }
 
 
@@ -487,7 +722,10 @@ glusterfs_graph_prepare (glusterfs_graph_t *graph, glusterfs_ctx_t *ctx)
 int
 glusterfs_graph_activate (glusterfs_graph_t *graph, glusterfs_ctx_t *ctx)
 {
-        int ret = 0;
+        struct timeval start = {0, };
+        int            ret = 0;
+
+        gettimeofday (&start, NULL);
 
         /* XXX: all xlator options validation */
         ret = glusterfs_graph_validate_options (graph);
@@ -532,6 +770,9 @@ glusterfs_graph_activate (glusterfs_graph_t *graph, glusterfs_ctx_t *ctx)
                 return ret;
         }
 
+        gf_log ("graph", GF_LOG_INFO, "graph %d activated in %"PRIu64" us",
+                graph->id, graph_usec_since (&start));
+
         return 0;
 }
 
@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifndef _CONFIG_H
 #define _CONFIG_H
@@ -23,6 +24,12 @@
 #define DM_DELTA 0x9E3779B9
 #define DM_FULLROUNDS 10        /* 32 is overkill, 16 is strong crypto */
 #define DM_PARTROUNDS 6         /* 6 gets complete mixing */
+#define DM_H0 0x9464a485
+#define DM_H1 0x542e1a94
+
+#if defined(__x86_64__) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
 uint32_t
@@ -89,34 +96,63 @@ uint32_t SuperFastHash (const char * data, int32_t len) {
 
 
 /* Davies-Meyer hashing function implementation
+ *
+ * The hash decides where DHT places every name, so any change to its output
+ * breaks existing layouts.  The rounds below are unrolled with the round
+ * sums folded into constants, and the message is read with memcpy rather
+ * than through an unaligned uint32_t pointer; words are still taken in host
+ * byte order and trailing bytes are still mixed in as (signed) chars, as the
+ * original implementation did.
  */
-static int
-dm_round (int rounds, uint32_t *array, uint32_t *h0, uint32_t *h1)
+
+#define DM_ROUND(b0, b1, array, r) do {                                  \
+                uint32_t __sum = (uint32_t) DM_DELTA * (r);              \
+                b0 += ((b1 << 4) + array[0])                             \
+                        ^ (b1 + __sum)                                   \
+                        ^ ((b1 >> 5) + array[1]);                        \
+                b1 += ((b0 << 4) + array[2])                             \
+                        ^ (b0 + __sum)                                   \
+                        ^ ((b0 >> 5) + array[3]);                        \
+        } while (0)
+
+/* DM_PARTROUNDS rounds, for every full 16 byte block */
+static inline void
+dm_part_rounds (uint32_t *array, uint32_t *h0, uint32_t *h1)
 {
-        uint32_t sum = 0;
-        int      n = 0;
-        uint32_t b0  = 0;
-        uint32_t b1  = 0;
-
-        b0 = *h0;
-        b1 = *h1;
-
-        n = rounds;
-
-        do {
-                sum += DM_DELTA;
-                b0  += ((b1 << 4) + array[0])
-                        ^ (b1 + sum)
-                        ^ ((b1 >> 5) + array[1]);
-                b1  += ((b0 << 4) + array[2])
-                        ^ (b0 + sum)
-                        ^ ((b0 >> 5) + array[3]);
-        } while (--n);
+        uint32_t b0 = *h0;
+        uint32_t b1 = *h1;
+
+        DM_ROUND (b0, b1, array, 1);
+        DM_ROUND (b0, b1, array, 2);
+        DM_ROUND (b0, b1, array, 3);
+        DM_ROUND (b0, b1, array, 4);
+        DM_ROUND (b0, b1, array, 5);
+        DM_ROUND (b0, b1, array, 6);
 
         *h0 += b0;
         *h1 += b1;
+}
+
+/* DM_FULLROUNDS rounds, for the final block */
+static inline void
+dm_full_rounds (uint32_t *array, uint32_t *h0, uint32_t *h1)
+{
+        uint32_t b0 = *h0;
+        uint32_t b1 = *h1;
+
+        DM_ROUND (b0, b1, array, 1);
+        DM_ROUND (b0, b1, array, 2);
+        DM_ROUND (b0, b1, array, 3);
+        DM_ROUND (b0, b1, array, 4);
+        DM_ROUND (b0, b1, array, 5);
+        DM_ROUND (b0, b1, array, 6);
+        DM_ROUND (b0, b1, array, 7);
+        DM_ROUND (b0, b1, array, 8);
+        DM_ROUND (b0, b1, array, 9);
+        DM_ROUND (b0, b1, array, 10);
 
-        return 0;
+        *h0 += b0;
+        *h1 += b1;
 }
 
 
@@ -131,45 +167,21 @@ __pad (int len)
         return pad;
 }
 
-uint32_t
-gf_dm_hashfn (const char *msg, int len)
+/* Fill @array with the final (partial) block of @msg: the remaining whole
+ * words, then the remaining bytes shifted into the padding word. */
+static inline void
+dm_last_block (const char *msg, int len, uint32_t *array)
 {
-        uint32_t  h0 = 0x9464a485;
-        uint32_t  h1 = 0x542e1a94;
-        uint32_t  array[4];
-        uint32_t  pad = 0;
-        int       i = 0;
-        int       j = 0;
-        int       full_quads = 0;
-        int       full_words = 0;
-        int       full_bytes = 0;
-        uint32_t *intmsg = NULL;
-        int       word = 0;
-
-
-        intmsg = (uint32_t *) msg;
-        pad = __pad (len);
-
-        full_bytes   = len;
-        full_words   = len / 4;
-        full_quads   = len / 16;
-
-        for (i = 0; i < full_quads; i++) {
-                for (j = 0; j < 4; j++) {
-                        word     = *intmsg;
-                        array[j] = word;
-                        intmsg++;
-                        full_words--;
-                        full_bytes -= 4;
-                }
-                dm_round (DM_PARTROUNDS, &array[0], &h0, &h1);
-        }
+        const char *tail       = msg + (len & ~15);
+        int         full_words = (len & 15) / 4;
+        int         full_bytes = len & 15;
+        uint32_t    pad        = __pad (len);
+        int         j          = 0;
 
         for (j = 0; j < 4; j++) {
                 if (full_words) {
-                        word     = *intmsg;
-                        array[j] = word;
-                        intmsg++;
+                        memcpy (&array[j], tail, sizeof (uint32_t));
+                        tail += sizeof (uint32_t);
                         full_words--;
                         full_bytes -= 4;
                 } else {
@@ -181,7 +193,161 @@ gf_dm_hashfn (const char *msg, int len)
                         }
                 }
         }
-        dm_round (DM_FULLROUNDS, &array[0], &h0, &h1);
+}
+
+uint32_t
+gf_dm_hashfn (const char *msg, int len)
+{
+        uint32_t  h0 = DM_H0;
+        uint32_t  h1 = DM_H1;
+        uint32_t  array[4];
+        int       i = 0;
+        int       full_quads = 0;
+
+        full_quads = len / 16;
+
+        for (i = 0; i < full_quads; i++) {
+                memcpy (array, msg + i * 16, sizeof (array));
+                dm_part_rounds (array, &h0, &h1);
+        }
+
+        dm_last_block (msg, len, array);
+        dm_full_rounds (array, &h0, &h1);
 
         return h0 ^ h1;
 }
+
+#if defined(__x86_64__) && defined(__SSE2__)
+
+/* Hash four names at once, one per 32-bit lane.  Lanes whose names have no
+ * block left at a given step still run the rounds, but their result is
+ * masked out. */
+
+#define DM_VROUND(b0, b1, a, r) do {                                     \
+                __m128i __sum = _mm_set1_epi32 ((int) ((uint32_t) DM_DELTA * (r))); \
+                b0 = _mm_add_epi32 (b0, _mm_xor_si128 (_mm_xor_si128 (   \
+                        _mm_add_epi32 (_mm_slli_epi32 (b1, 4), a[0]),    \
+                        _mm_add_epi32 (b1, __sum)),                      \
+                        _mm_add_epi32 (_mm_srli_epi32 (b1, 5), a[1])));  \
+                b1 = _mm_add_epi32 (b1, _mm_xor_si128 (_mm_xor_si128 (   \
+                        _mm_add_epi32 (_mm_slli_epi32 (b0, 4), a[2]),    \
+                        _mm_add_epi32 (b0, __sum)),                      \
+                        _mm_add_epi32 (_mm_srli_epi32 (b0, 5), a[3])));  \
+        } while (0)
+
+/* rows[lane] holds that lane's four words; a[j] gets word j of every lane */
+static inline void
+dm_transpose (__m128i *rows, __m128i *a)
+{
+        __m128i t0 = _mm_unpacklo_epi32 (rows[0], rows[1]);
+        __m128i t1 = _mm_unpacklo_epi32 (rows[2], rows[3]);
+        __m128i t2 = _mm_unpackhi_epi32 (rows[0], rows[1]);
+        __m128i t3 = _mm_unpackhi_epi32 (rows[2], rows[3]);
+
+        a[0] = _mm_unpacklo_epi64 (t0, t1);
+        a[1] = _mm_unpackhi_epi64 (t0, t1);
+        a[2] = _mm_unpacklo_epi64 (t2, t3);
+        a[3] = _mm_unpackhi_epi64 (t2, t3);
+}
+
+static void
+gf_dm_hashfn_x4 (const char **msgs, const int *lens, uint32_t *hashes,
+                 int count)
+{
+        __m128i   h0      = _mm_set1_epi32 ((int) DM_H0);
+        __m128i   h1      = _mm_set1_epi32 ((int) DM_H1);
+        __m128i   quads   = _mm_setzero_si128 ();
+        __m128i   rows[4];
+        __m128i   a[4];
+        __m128i   b0, b1, mask;
+        uint32_t  array[4];
+        uint32_t  out[4];
+        int       nquads[4] = {0, };
+        int       maxquads  = 0;
+        int       lane      = 0;
+        int       i         = 0;
+
+        for (lane = 0; lane < count; lane++) {
+                nquads[lane] = lens[lane] / 16;
+                if (nquads[lane] > maxquads)
+                        maxquads = nquads[lane];
+        }
+        quads = _mm_setr_epi32 (nquads[0], nquads[1], nquads[2], nquads[3]);
+
+        for (i = 0; i < maxquads; i++) {
+                for (lane = 0; lane < 4; lane++) {
+                        if (i < nquads[lane])
+                                rows[lane] = _mm_loadu_si128 (
+                                        (const __m128i *)(msgs[lane] + i * 16));
+                        else
+                                rows[lane] = _mm_setzero_si128 ();
+                }
+                dm_transpose (rows, a);
+
+                b0 = h0;
+                b1 = h1;
+                DM_VROUND (b0, b1, a, 1);
+                DM_VROUND (b0, b1, a, 2);
+                DM_VROUND (b0, b1, a, 3);
+                DM_VROUND (b0, b1, a, 4);
+                DM_VROUND (b0, b1, a, 5);
+                DM_VROUND (b0, b1, a, 6);
+
+                mask = _mm_cmpgt_epi32 (quads, _mm_set1_epi32 (i));
+                h0 = _mm_add_epi32 (h0, _mm_and_si128 (mask, b0));
+                h1 = _mm_add_epi32 (h1, _mm_and_si128 (mask, b1));
+        }
+
+        for (lane = 0; lane < 4; lane++) {
+                if (lane < count)
+                        dm_last_block (msgs[lane], lens[lane], array);
+                else
+                        memset (array, 0, sizeof (array));
+                rows[lane] = _mm_loadu_si128 ((const __m128i *) array);
+        }
+        dm_transpose (rows, a);
+
+        b0 = h0;
+        b1 = h1;
+        DM_VROUND (b0, b1, a, 1);
+        DM_VROUND (b0, b1, a, 2);
+        DM_VROUND (b0, b1, a, 3);
+        DM_VROUND (b0, b1, a, 4);
+        DM_VROUND (b0, b1, a, 5);
+        DM_VROUND (b0, b1, a, 6);
+        DM_VROUND (b0, b1, a, 7);
+        DM_VROUND (b0, b1, a, 8);
+        DM_VROUND (b0, b1, a, 9);
+        DM_VROUND (b0, b1, a, 10);
+        h0 = _mm_add_epi32 (h0, b0);
+        h1 = _mm_add_epi32 (h1, b1);
+
+        _mm_storeu_si128 ((__m128i *) out, _mm_xor_si128 (h0, h1));
+        memcpy (hashes, out, count * sizeof (uint32_t));
+}
+
+#endif /* __x86_64__ && __SSE2__ */
+
+/*
+ * gf_dm_hashfn_batch - gf_dm_hashfn() of @count names at once
+ *
+ * hashes[i] = gf_dm_hashfn (msgs[i], lens[i]).  Meant for callers that
+ * hash every name of a readdir reply.
+ */
+void
+gf_dm_hashfn_batch (const char **msgs, const int *lens, uint32_t *hashes,
+                    int count)
+{
+        int i = 0;
+
+#if defined(__x86_64__) && defined(__SSE2__)
+        for (; i + 4 <= count; i += 4)
+                gf_dm_hashfn_x4 (msgs + i, lens + i, hashes + i, 4);
+        if (i < count) {
+                gf_dm_hashfn_x4 (msgs + i, lens + i, hashes + i, count - i);
+                i = count;
+        }
+#endif
+        for (; i < count; i++)
+                hashes[i] = gf_dm_hashfn (msgs[i], lens[i]);
+}
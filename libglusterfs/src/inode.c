@@ -17,6 +17,7 @@
 #include "fd.h"
 #include "common-utils.h"
 #include "statedump.h"
+#include "metrics.h"
 #include <pthread.h>
 #include <sys/types.h>
 #include <stdint.h>
@@ -28,9 +29,8 @@
    move latest accessed dentry to list_head of inode
 */
 
-#define INODE_DUMP_LIST(head, key_buf, key_prefix, list_type)           \
+#define INODE_DUMP_LIST(head, key_buf, key_prefix, list_type, i)        \
         {                                                               \
-                int i = 1;                                              \
                 inode_t *inode = NULL;                                  \
                 list_for_each_entry (inode, head, list) {               \
                         gf_proc_dump_build_key(key_buf, key_prefix,     \
@@ -40,11 +40,28 @@
                 }                                                       \
         }
 
+/* take @lk, counting the acquisitions which found it already held */
+#define INODE_LOCK_COUNTED(lk, counter)                                 \
+        do {                                                            \
+                if (pthread_mutex_trylock (lk) != 0) {                  \
+                        pthread_mutex_lock (lk);                        \
+                        (counter)++;                                    \
+                }                                                       \
+        } while (0)
+
+#define inode_shard(inode) (&(inode)->table->shards[(inode)->shard])
+
+#define bucket_shard(table, bucket)                                     \
+        (&(table)->shards[(bucket) % INODE_TABLE_SHARDS])
+
+static inode_t *
+__inode_unref (inode_t *inode, struct list_head *purge);
+
 static inode_t *
-__inode_unref (inode_t *inode);
+__inode_forget (inode_t *inode, uint64_t nlookup);
 
 static int
-inode_table_prune (inode_table_t *table);
+inode_table_prune (inode_table_t *table, struct _inode_table_shard *shard);
 
 void
 fd_dump (struct list_head *head, char *prefix);
@@ -81,8 +98,9 @@ hash_gfid (uuid_t uuid, int mod)
 static void
 __dentry_hash (dentry_t *dentry)
 {
-        inode_table_t   *table = NULL;
-        int              hash = 0;
+        inode_table_t             *table = NULL;
+        struct _inode_table_shard *shard = NULL;
+        int                        hash = 0;
 
         if (!dentry) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "dentry not found");
@@ -92,9 +110,14 @@ __dentry_hash (dentry_t *dentry)
         table = dentry->inode->table;
         hash = hash_dentry (dentry->parent, dentry->name,
                             table->hashsize);
+        shard = bucket_shard (table, hash);
 
-        list_del_init (&dentry->hash);
-        list_add (&dentry->hash, &table->name_hash[hash]);
+        INODE_LOCK_COUNTED (&shard->hash_lock, shard->hash_contended);
+        {
+                list_del_init (&dentry->hash);
+                list_add (&dentry->hash, &table->name_hash[hash]);
+        }
+        pthread_mutex_unlock (&shard->hash_lock);
 }
 
 
@@ -113,17 +136,48 @@ __is_dentry_hashed (dentry_t *dentry)
 static void
 __dentry_unhash (dentry_t *dentry)
 {
+        inode_table_t             *table = NULL;
+        struct _inode_table_shard *shard = NULL;
+        int                        hash = 0;
+
         if (!dentry) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "dentry not found");
                 return;
         }
 
-        list_del_init (&dentry->hash);
+        if (!__is_dentry_hashed (dentry))
+                return;
+
+        table = dentry->inode->table;
+        hash = hash_dentry (dentry->parent, dentry->name,
+                            table->hashsize);
+        shard = bucket_shard (table, hash);
+
+        INODE_LOCK_COUNTED (&shard->hash_lock, shard->hash_contended);
+        {
+                list_del_init (&dentry->hash);
+        }
+        pthread_mutex_unlock (&shard->hash_lock);
+}
+
+
+static void
+inode_unref_collect (inode_t *inode, struct list_head *purge)
+{
+        struct _inode_table_shard *shard = NULL;
+
+        shard = inode_shard (inode);
+
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
+        {
+                __inode_unref (inode, purge);
+        }
+        pthread_mutex_unlock (&shard->lock);
 }
 
 
 static void
-__dentry_unset (dentry_t *dentry)
+__dentry_unset (dentry_t *dentry, struct list_head *purge)
 {
         if (!dentry) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "dentry not found");
@@ -137,7 +191,7 @@ __dentry_unset (dentry_t *dentry)
         GF_FREE (dentry->name);
 
         if (dentry->parent) {
-                __inode_unref (dentry->parent);
+                inode_unref_collect (dentry->parent, purge);
                 dentry->parent = NULL;
         }
 
@@ -221,35 +275,47 @@ __is_dentry_cyclic (dentry_t *dentry)
 }
 
 
-static void
-__inode_unhash (inode_t *inode)
+static int
+__is_inode_hashed (inode_t *inode)
 {
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
-                return;
+                return 0;
         }
 
-        list_del_init (&inode->hash);
+        return !list_empty (&inode->hash);
 }
 
 
-static int
-__is_inode_hashed (inode_t *inode)
+static void
+__inode_unhash (inode_t *inode)
 {
+        struct _inode_table_shard *shard = NULL;
+
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
-                return 0;
+                return;
         }
 
-        return !list_empty (&inode->hash);
+        if (!__is_inode_hashed (inode))
+                return;
+
+        shard = bucket_shard (inode->table, hash_gfid (inode->gfid, 65536));
+
+        INODE_LOCK_COUNTED (&shard->hash_lock, shard->hash_contended);
+        {
+                list_del_init (&inode->hash);
+        }
+        pthread_mutex_unlock (&shard->hash_lock);
 }
 
 
 static void
 __inode_hash (inode_t *inode)
 {
-        inode_table_t *table = NULL;
-        int            hash = 0;
+        inode_table_t             *table = NULL;
+        struct _inode_table_shard *shard = NULL;
+        int                        hash = 0;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
@@ -258,9 +324,14 @@ __inode_hash (inode_t *inode)
 
         table = inode->table;
         hash = hash_gfid (inode->gfid, 65536);
+        shard = bucket_shard (table, hash);
 
-        list_del_init (&inode->hash);
-        list_add (&inode->hash, &table->inode_hash[hash]);
+        INODE_LOCK_COUNTED (&shard->hash_lock, shard->hash_contended);
+        {
+                list_del_init (&inode->hash);
+                list_add (&inode->hash, &table->inode_hash[hash]);
+        }
+        pthread_mutex_unlock (&shard->hash_lock);
 }
 
 
@@ -332,59 +403,58 @@ noctx:
 static void
 __inode_activate (inode_t *inode)
 {
+        struct _inode_table_shard *shard = NULL;
+
         if (!inode)
                 return;
 
-        list_move (&inode->list, &inode->table->active);
-        inode->table->active_size++;
+        shard = inode_shard (inode);
+
+        list_move (&inode->list, &shard->active);
+        shard->active_size++;
 }
 
 
 static void
 __inode_passivate (inode_t *inode)
 {
-        dentry_t      *dentry = NULL;
-        dentry_t      *t = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
                 return;
         }
 
-        list_move_tail (&inode->list, &inode->table->lru);
-        inode->table->lru_size++;
+        shard = inode_shard (inode);
 
-        list_for_each_entry_safe (dentry, t, &inode->dentry_list, inode_list) {
-                if (!__is_dentry_hashed (dentry))
-                        __dentry_unset (dentry);
-        }
+        list_move_tail (&inode->list, &shard->lru);
+        shard->lru_size++;
 }
 
 
+/* Mark @inode as going away and hand it over to the caller's @purge list.
+   Its hash and dentries are torn down later by inode_table_purge(), once
+   the shard lock has been dropped. */
 static void
-__inode_retire (inode_t *inode)
+__inode_retire (inode_t *inode, struct list_head *purge)
 {
-        dentry_t      *dentry = NULL;
-        dentry_t      *t = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
                 return;
         }
 
-        list_move_tail (&inode->list, &inode->table->purge);
-        inode->table->purge_size++;
-
-        __inode_unhash (inode);
+        shard = inode_shard (inode);
 
-        list_for_each_entry_safe (dentry, t, &inode->dentry_list, inode_list) {
-                __dentry_unset (dentry);
-        }
+        inode->purging = _gf_true;
+        list_move_tail (&inode->list, purge);
+        shard->purge_size++;
 }
 
 
 static inode_t *
-__inode_unref (inode_t *inode)
+__inode_unref (inode_t *inode, struct list_head *purge)
 {
         if (!inode)
                 return NULL;
@@ -397,12 +467,12 @@ __inode_unref (inode_t *inode)
         --inode->ref;
 
         if (!inode->ref) {
-                inode->table->active_size--;
+                inode_shard (inode)->active_size--;
 
                 if (inode->nlookup)
                         __inode_passivate (inode);
                 else
-                        __inode_retire (inode);
+                        __inode_retire (inode, purge);
         }
 
         return inode;
@@ -416,7 +486,7 @@ __inode_ref (inode_t *inode)
                 return NULL;
 
         if (!inode->ref) {
-                inode->table->lru_size--;
+                inode_shard (inode)->lru_size--;
                 __inode_activate (inode);
         }
         inode->ref++;
@@ -425,23 +495,110 @@ __inode_ref (inode_t *inode)
 }
 
 
+/* Take a reference on an inode reached through the hashes, where it may
+   already have been retired by a concurrent unref or prune. */
+static inode_t *
+inode_ref_live (inode_t *inode)
+{
+        struct _inode_table_shard *shard = NULL;
+
+        shard = inode_shard (inode);
+
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
+        {
+                if (inode->purging)
+                        inode = NULL;
+                else
+                        __inode_ref (inode);
+        }
+        pthread_mutex_unlock (&shard->lock);
+
+        return inode;
+}
+
+
+static void
+inode_table_purge (inode_table_t *table, struct list_head *purge)
+{
+        struct _inode_table_shard *shard = NULL;
+        inode_t                   *del = NULL;
+        inode_t                   *tmp = NULL;
+        dentry_t                  *dentry = NULL;
+        dentry_t                  *t = NULL;
+        int                        hashed = 0;
+
+        if (list_empty (purge))
+                return;
+
+        /* an inode which never got linked (still without a gfid) is
+           neither hashed nor has dentries, so the common inode_new()/
+           inode_unref() pair stays off table->lock */
+        list_for_each_entry (del, purge, list) {
+                if (!uuid_is_null (del->gfid)) {
+                        hashed = 1;
+                        break;
+                }
+        }
+
+        if (hashed) {
+                INODE_LOCK_COUNTED (&table->lock, table->lock_contended);
+                {
+                        /* unsetting dentries may retire their parents,
+                           which get appended to @purge and visited here
+                           as well */
+                        list_for_each_entry (del, purge, list) {
+                                __inode_unhash (del);
+
+                                list_for_each_entry_safe (dentry, t,
+                                                          &del->dentry_list,
+                                                          inode_list) {
+                                        __dentry_unset (dentry, purge);
+                                }
+                        }
+                }
+                pthread_mutex_unlock (&table->lock);
+        }
+
+        list_for_each_entry_safe (del, tmp, purge, list) {
+                list_del_init (&del->list);
+
+                shard = inode_shard (del);
+                INODE_LOCK_COUNTED (&shard->lock, shard->contended);
+                {
+                        shard->purge_size--;
+                }
+                pthread_mutex_unlock (&shard->lock);
+
+                __inode_forget (del, 0);
+                __inode_destroy (del);
+        }
+}
+
+
 inode_t *
 inode_unref (inode_t *inode)
 {
-        inode_table_t *table = NULL;
+        inode_table_t             *table = NULL;
+        struct _inode_table_shard *shard = NULL;
+        struct list_head           purge;
 
         if (!inode)
                 return NULL;
 
         table = inode->table;
+        shard = inode_shard (inode);
+
+        INIT_LIST_HEAD (&purge);
 
-        pthread_mutex_lock (&table->lock);
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
         {
-                inode = __inode_unref (inode);
+                inode = __inode_unref (inode, &purge);
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->lock);
+
+        inode_table_purge (table, &purge);
 
-        inode_table_prune (table);
+        inode_table_prune (table, shard);
 
         return inode;
 }
@@ -450,18 +607,18 @@ inode_unref (inode_t *inode)
 inode_t *
 inode_ref (inode_t *inode)
 {
-        inode_table_t *table = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!inode)
                 return NULL;
 
-        table = inode->table;
+        shard = inode_shard (inode);
 
-        pthread_mutex_lock (&table->lock);
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
         {
                 inode = __inode_ref (inode);
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->lock);
 
         return inode;
 }
@@ -494,7 +651,7 @@ __dentry_create (inode_t *inode, inode_t *parent, const char *name)
         }
 
         if (parent)
-                newd->parent = __inode_ref (parent);
+                newd->parent = inode_ref (parent);
 
         list_add (&newd->inode_list, &inode->dentry_list);
         newd->inode = inode;
@@ -520,6 +677,8 @@ __inode_create (inode_table_t *table)
         }
 
         newi->table = table;
+        newi->shard = __sync_fetch_and_add (&table->next_shard, 1)
+                % INODE_TABLE_SHARDS;
 
         LOCK_INIT (&newi->lock);
 
@@ -538,9 +697,6 @@ __inode_create (inode_table_t *table)
                 goto out;
         }
 
-        list_add (&newi->list, &table->lru);
-        table->lru_size++;
-
 out:
 
         return newi;
@@ -550,22 +706,30 @@ out:
 inode_t *
 inode_new (inode_table_t *table)
 {
-        inode_t *inode = NULL;
+        inode_t                   *inode = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!table) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
                 return NULL;
         }
 
-        pthread_mutex_lock (&table->lock);
+        inode = __inode_create (table);
+        if (inode == NULL)
+                goto out;
+
+        /* activated in one go, an unreferenced inode on the lru list
+           could be pruned under our feet */
+        shard = inode_shard (inode);
+
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
         {
-                inode = __inode_create (table);
-                if (inode != NULL) {
-                        __inode_ref (inode);
-                }
+                list_add (&inode->list, &shard->lru);
+                shard->lru_size++;
+                __inode_ref (inode);
         }
-        pthread_mutex_unlock (&table->lock);
-
+        pthread_mutex_unlock (&shard->lock);
+out:
         return inode;
 }
 
@@ -599,6 +763,7 @@ __inode_forget (inode_t *inode, uint64_t nlookup)
 }
 
 
+/* caller holds either table->lock or the hash_lock of the bucket's shard */
 dentry_t *
 __dentry_grep (inode_table_t *table, inode_t *parent, const char *name)
 {
@@ -625,8 +790,9 @@ __dentry_grep (inode_table_t *table, inode_t *parent, const char *name)
 inode_t *
 inode_grep (inode_table_t *table, inode_t *parent, const char *name)
 {
-        inode_t   *inode = NULL;
-        dentry_t  *dentry = NULL;
+        inode_t                   *inode = NULL;
+        dentry_t                  *dentry = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!table || !parent || !name) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING,
@@ -634,17 +800,17 @@ inode_grep (inode_table_t *table, inode_t *parent, const char *name)
                 return NULL;
         }
 
-        pthread_mutex_lock (&table->lock);
+        shard = bucket_shard (table, hash_dentry (parent, name,
+                                                  table->hashsize));
+
+        INODE_LOCK_COUNTED (&shard->hash_lock, shard->hash_contended);
         {
                 dentry = __dentry_grep (table, parent, name);
 
                 if (dentry)
-                        inode = dentry->inode;
-
-                if (inode)
-                        __inode_ref (inode);
+                        inode = inode_ref_live (dentry->inode);
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->hash_lock);
 
         return inode;
 }
@@ -697,9 +863,10 @@ int
 inode_grep_for_gfid (inode_table_t *table, inode_t *parent, const char *name,
                      uuid_t gfid, ia_type_t *type)
 {
-        inode_t   *inode = NULL;
-        dentry_t  *dentry = NULL;
-        int        ret = -1;
+        inode_t                   *inode = NULL;
+        dentry_t                  *dentry = NULL;
+        struct _inode_table_shard *shard = NULL;
+        int                        ret = -1;
 
         if (!table || !parent || !name) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING,
@@ -707,7 +874,10 @@ inode_grep_for_gfid (inode_table_t *table, inode_t *parent, const char *name,
                 return ret;
         }
 
-        pthread_mutex_lock (&table->lock);
+        shard = bucket_shard (table, hash_dentry (parent, name,
+                                                  table->hashsize));
+
+        INODE_LOCK_COUNTED (&shard->hash_lock, shard->hash_contended);
         {
                 dentry = __dentry_grep (table, parent, name);
 
@@ -720,7 +890,7 @@ inode_grep_for_gfid (inode_table_t *table, inode_t *parent, const char *name,
                         ret = 0;
                 }
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->hash_lock);
 
         return ret;
 }
@@ -742,6 +912,7 @@ __is_root_gfid (uuid_t gfid)
 }
 
 
+/* caller holds either table->lock or the hash_lock of the bucket's shard */
 inode_t *
 __inode_find (inode_table_t *table, uuid_t gfid)
 {
@@ -774,28 +945,35 @@ out:
 inode_t *
 inode_find (inode_table_t *table, uuid_t gfid)
 {
-        inode_t   *inode = NULL;
+        inode_t                   *inode = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!table) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "table not found");
                 return NULL;
         }
 
-        pthread_mutex_lock (&table->lock);
+        if (__is_root_gfid (gfid))
+                return inode_ref (table->root);
+
+        shard = bucket_shard (table, hash_gfid (gfid, 65536));
+
+        INODE_LOCK_COUNTED (&shard->hash_lock, shard->hash_contended);
         {
                 inode = __inode_find (table, gfid);
                 if (inode)
-                        __inode_ref (inode);
+                        inode = inode_ref_live (inode);
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->hash_lock);
 
         return inode;
 }
 
 
+/* Returns the linked inode with a reference held for the caller. */
 static inode_t *
 __inode_link (inode_t *inode, inode_t *parent, const char *name,
-              struct iatt *iatt)
+              struct iatt *iatt, struct list_head *purge)
 {
         dentry_t      *dentry = NULL;
         dentry_t      *old_dentry = NULL;
@@ -830,6 +1008,11 @@ __inode_link (inode_t *inode, inode_t *parent, const char *name,
 
                 old_inode = __inode_find (table, iatt->ia_gfid);
 
+                /* an inode already retired by its last unref stays
+                   hashed until purged; link a fresh one instead */
+                if (old_inode)
+                        old_inode = inode_ref_live (old_inode);
+
                 if (old_inode) {
                         link_inode = old_inode;
                 } else {
@@ -839,6 +1022,9 @@ __inode_link (inode_t *inode, inode_t *parent, const char *name,
                 }
         }
 
+        if (link_inode == inode)
+                inode_ref (link_inode);
+
         if (name) {
                 if (!strcmp(name, ".") || !strcmp(name, ".."))
                         return link_inode;
@@ -856,16 +1042,18 @@ __inode_link (inode_t *inode, inode_t *parent, const char *name,
                                                   "inode %s with parent %s",
                                                   uuid_utoa (link_inode->gfid),
                                                   uuid_utoa (parent->gfid));
+                                inode_unref_collect (link_inode, purge);
                                 return NULL;
                         }
                         if (old_inode && __is_dentry_cyclic (dentry)) {
-                                __dentry_unset (dentry);
+                                __dentry_unset (dentry, purge);
+                                inode_unref_collect (link_inode, purge);
                                 return NULL;
                         }
                         __dentry_hash (dentry);
 
                         if (old_dentry)
-                                __dentry_unset (old_dentry);
+                                __dentry_unset (old_dentry, purge);
                 }
         }
 
@@ -879,6 +1067,7 @@ inode_link (inode_t *inode, inode_t *parent, const char *name,
 {
         inode_table_t *table = NULL;
         inode_t       *linked_inode = NULL;
+        struct list_head purge;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
@@ -887,16 +1076,18 @@ inode_link (inode_t *inode, inode_t *parent, const char *name,
 
         table = inode->table;
 
-        pthread_mutex_lock (&table->lock);
-        {
-                linked_inode = __inode_link (inode, parent, name, iatt);
+        INIT_LIST_HEAD (&purge);
 
-                if (linked_inode)
-                        __inode_ref (linked_inode);
+        INODE_LOCK_COUNTED (&table->lock, table->lock_contended);
+        {
+                linked_inode = __inode_link (inode, parent, name, iatt,
+                                             &purge);
         }
         pthread_mutex_unlock (&table->lock);
 
-        inode_table_prune (table);
+        inode_table_purge (table, &purge);
+
+        inode_table_prune (table, inode_shard (inode));
 
         return linked_inode;
 }
@@ -905,20 +1096,20 @@ inode_link (inode_t *inode, inode_t *parent, const char *name,
 int
 inode_lookup (inode_t *inode)
 {
-        inode_table_t *table = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
                 return -1;
         }
 
-        table = inode->table;
+        shard = inode_shard (inode);
 
-        pthread_mutex_lock (&table->lock);
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
         {
                 __inode_lookup (inode);
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->lock);
 
         return 0;
 }
@@ -927,22 +1118,22 @@ inode_lookup (inode_t *inode)
 int
 inode_forget (inode_t *inode, uint64_t nlookup)
 {
-        inode_table_t *table = NULL;
+        struct _inode_table_shard *shard = NULL;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
                 return -1;
         }
 
-        table = inode->table;
+        shard = inode_shard (inode);
 
-        pthread_mutex_lock (&table->lock);
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
         {
                 __inode_forget (inode, nlookup);
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->lock);
 
-        inode_table_prune (table);
+        inode_table_prune (inode->table, shard);
 
         return 0;
 }
@@ -997,7 +1188,8 @@ inode_invalidate(inode_t *inode)
 
 
 static void
-__inode_unlink (inode_t *inode, inode_t *parent, const char *name)
+__inode_unlink (inode_t *inode, inode_t *parent, const char *name,
+                struct list_head *purge)
 {
         dentry_t *dentry = NULL;
 
@@ -1008,7 +1200,7 @@ __inode_unlink (inode_t *inode, inode_t *parent, const char *name)
 
         /* dentry NULL for corrupted backend */
         if (dentry)
-                __dentry_unset (dentry);
+                __dentry_unset (dentry, purge);
 }
 
 
@@ -1016,6 +1208,7 @@ void
 inode_unlink (inode_t *inode, inode_t *parent, const char *name)
 {
         inode_table_t *table = NULL;
+        struct list_head purge;
 
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
@@ -1024,13 +1217,17 @@ inode_unlink (inode_t *inode, inode_t *parent, const char *name)
 
         table = inode->table;
 
-        pthread_mutex_lock (&table->lock);
+        INIT_LIST_HEAD (&purge);
+
+        INODE_LOCK_COUNTED (&table->lock, table->lock_contended);
         {
-                __inode_unlink (inode, parent, name);
+                __inode_unlink (inode, parent, name, &purge);
         }
         pthread_mutex_unlock (&table->lock);
 
-        inode_table_prune (table);
+        inode_table_purge (table, &purge);
+
+        inode_table_prune (table, inode_shard (inode));
 }
 
 
@@ -1039,6 +1236,9 @@ inode_rename (inode_table_t *table, inode_t *srcdir, const char *srcname,
               inode_t *dstdir, const char *dstname, inode_t *inode,
               struct iatt *iatt)
 {
+        inode_t          *linked_inode = NULL;
+        struct list_head  purge;
+
         if (!inode) {
                 gf_log_callingfn (THIS->name, GF_LOG_WARNING, "inode not found");
                 return -1;
@@ -1046,14 +1246,21 @@ inode_rename (inode_table_t *table, inode_t *srcdir, const char *srcname,
 
         table = inode->table;
 
-        pthread_mutex_lock (&table->lock);
+        INIT_LIST_HEAD (&purge);
+
+        INODE_LOCK_COUNTED (&table->lock, table->lock_contended);
         {
-                __inode_link (inode, dstdir, dstname, iatt);
-                __inode_unlink (inode, srcdir, srcname);
+                linked_inode = __inode_link (inode, dstdir, dstname, iatt,
+                                             &purge);
+                if (linked_inode)
+                        inode_unref_collect (linked_inode, &purge);
+                __inode_unlink (inode, srcdir, srcname, &purge);
         }
         pthread_mutex_unlock (&table->lock);
 
-        inode_table_prune (table);
+        inode_table_purge (table, &purge);
+
+        inode_table_prune (table, inode_shard (inode));
 
         return 0;
 }
@@ -1100,7 +1307,7 @@ inode_parent (inode_t *inode, uuid_t pargfid, const char *name)
 
         table = inode->table;
 
-        pthread_mutex_lock (&table->lock);
+        INODE_LOCK_COUNTED (&table->lock, table->lock_contended);
         {
                 if (pargfid && !uuid_is_null (pargfid) && name) {
                         dentry = __dentry_search_for_inode (inode, pargfid, name);
@@ -1112,7 +1319,7 @@ inode_parent (inode_t *inode, uuid_t pargfid, const char *name)
                         parent = dentry->parent;
 
                 if (parent)
-                        __inode_ref (parent);
+                        inode_ref (parent);
         }
         pthread_mutex_unlock (&table->lock);
 
@@ -1229,7 +1436,7 @@ inode_path (inode_t *inode, const char *name, char **bufp)
 
         table = inode->table;
 
-        pthread_mutex_lock (&table->lock);
+        INODE_LOCK_COUNTED (&table->lock, table->lock_contended);
         {
                 ret = __inode_path (inode, name, bufp);
         }
@@ -1239,45 +1446,38 @@ inode_path (inode_t *inode, const char *name, char **bufp)
 }
 
 
+/* Each shard keeps its own share of the table's lru_limit, so pruning only
+   has to look at the shard which the caller just touched. */
 static int
-inode_table_prune (inode_table_t *table)
+inode_table_prune (inode_table_t *table, struct _inode_table_shard *shard)
 {
         int               ret = 0;
         struct list_head  purge = {0, };
-        inode_t          *del = NULL;
-        inode_t          *tmp = NULL;
         inode_t          *entry = NULL;
 
-        if (!table)
+        if (!table || !shard)
                 return -1;
 
+        if (!table->lru_limit)
+                return 0;
+
         INIT_LIST_HEAD (&purge);
 
-        pthread_mutex_lock (&table->lock);
+        INODE_LOCK_COUNTED (&shard->lock, shard->contended);
         {
-                while (table->lru_limit
-                       && table->lru_size > (table->lru_limit)) {
+                while (shard->lru_size > table->shard_lru_limit) {
 
-                        entry = list_entry (table->lru.next, inode_t, list);
+                        entry = list_entry (shard->lru.next, inode_t, list);
 
-                        table->lru_size--;
-                        __inode_retire (entry);
+                        shard->lru_size--;
+                        __inode_retire (entry, &purge);
 
                         ret++;
                 }
-
-                list_splice_init (&table->purge, &purge);
-                table->purge_size = 0;
         }
-        pthread_mutex_unlock (&table->lock);
+        pthread_mutex_unlock (&shard->lock);
 
-        {
-                list_for_each_entry_safe (del, tmp, &purge, list) {
-                        list_del_init (&del->list);
-                        __inode_forget (del, 0);
-                        __inode_destroy (del);
-                }
-        }
+        inode_table_purge (table, &purge);
 
         return ret;
 }
@@ -1286,19 +1486,27 @@ inode_table_prune (inode_table_t *table)
 static void
 __inode_table_init_root (inode_table_t *table)
 {
-        inode_t     *root = NULL;
-        struct iatt  iatt = {0, };
+        inode_t          *root = NULL;
+        struct iatt       iatt = {0, };
+        struct list_head  purge;
 
         if (!table)
                 return;
 
+        INIT_LIST_HEAD (&purge);
+
         root = __inode_create (table);
 
+        list_add (&root->list, &inode_shard (root)->lru);
+        inode_shard (root)->lru_size++;
+
         iatt.ia_gfid[15] = 1;
         iatt.ia_ino = 1;
         iatt.ia_type = IA_IFDIR;
 
-        __inode_link (root, NULL, NULL, &iatt);
+        /* the reference taken by linking is never dropped, which keeps
+           the root off the lru list */
+        __inode_link (root, NULL, NULL, &iatt, &purge);
         table->root = root;
 }
 
@@ -1318,6 +1526,10 @@ inode_table_new (size_t lru_limit, xlator_t *xl)
         new->ctxcount = xl->graph->xl_count + 1;
 
         new->lru_limit = lru_limit;
+        /* each shard is pruned on its own, so the table as a whole may
+           keep up to INODE_TABLE_SHARDS - 1 inodes over lru_limit */
+        new->shard_lru_limit = (lru_limit + INODE_TABLE_SHARDS - 1)
+                / INODE_TABLE_SHARDS;
 
         new->hashsize = 14057; /* TODO: Random Number?? */
 
@@ -1363,9 +1575,12 @@ inode_table_new (size_t lru_limit, xlator_t *xl)
                 INIT_LIST_HEAD (&new->name_hash[i]);
         }
 
-        INIT_LIST_HEAD (&new->active);
-        INIT_LIST_HEAD (&new->lru);
-        INIT_LIST_HEAD (&new->purge);
+        for (i = 0; i < INODE_TABLE_SHARDS; i++) {
+                pthread_mutex_init (&new->shards[i].lock, NULL);
+                pthread_mutex_init (&new->shards[i].hash_lock, NULL);
+                INIT_LIST_HEAD (&new->shards[i].active);
+                INIT_LIST_HEAD (&new->shards[i].lru);
+        }
 
         ret = gf_asprintf (&new->name, "%s/inode", xl->name);
         if (-1 == ret) {
@@ -1373,10 +1588,10 @@ inode_table_new (size_t lru_limit, xlator_t *xl)
                 ;
         }
 
-        __inode_table_init_root (new);
-
         pthread_mutex_init (&new->lock, NULL);
 
+        __inode_table_init_root (new);
+
         ret = 0;
 out:
         if (ret) {
@@ -1872,19 +2087,39 @@ void
 inode_table_dump (inode_table_t *itable, char *prefix)
 {
 
-        char    key[GF_DUMP_MAX_BUF_LEN];
-        int     ret = 0;
+        char                       key[GF_DUMP_MAX_BUF_LEN];
+        int                        ret = 0;
+        int                        i = 0;
+        int                        active = 1;
+        int                        lru = 1;
+        uint32_t                   active_size = 0;
+        uint32_t                   lru_size = 0;
+        uint32_t                   purge_size = 0;
+        uint64_t                   contended = 0;
+        uint64_t                   hash_contended = 0;
+        struct _inode_table_shard *shard = NULL;
 
         if (!itable)
                 return;
 
         memset(key, 0, sizeof(key));
+
+        /* held for xlators calling __inode_path() from their dumpops */
         ret = pthread_mutex_trylock(&itable->lock);
 
         if (ret != 0) {
                 return;
         }
 
+        for (i = 0; i < INODE_TABLE_SHARDS; i++) {
+                shard = &itable->shards[i];
+                active_size += shard->active_size;
+                lru_size += shard->lru_size;
+                purge_size += shard->purge_size;
+                contended += shard->contended;
+                hash_contended += shard->hash_contended;
+        }
+
         gf_proc_dump_build_key(key, prefix, "hashsize");
         gf_proc_dump_write(key, "%d", itable->hashsize);
         gf_proc_dump_build_key(key, prefix, "name");
@@ -1893,19 +2128,82 @@ inode_table_dump (inode_table_t *itable, char *prefix)
         gf_proc_dump_build_key(key, prefix, "lru_limit");
         gf_proc_dump_write(key, "%d", itable->lru_limit);
         gf_proc_dump_build_key(key, prefix, "active_size");
-        gf_proc_dump_write(key, "%d", itable->active_size);
+        gf_proc_dump_write(key, "%d", active_size);
         gf_proc_dump_build_key(key, prefix, "lru_size");
-        gf_proc_dump_write(key, "%d", itable->lru_size);
+        gf_proc_dump_write(key, "%d", lru_size);
         gf_proc_dump_build_key(key, prefix, "purge_size");
-        gf_proc_dump_write(key, "%d", itable->purge_size);
-
-        INODE_DUMP_LIST(&itable->active, key, prefix, "active");
-        INODE_DUMP_LIST(&itable->lru, key, prefix, "lru");
-        INODE_DUMP_LIST(&itable->purge, key, prefix, "purge");
+        gf_proc_dump_write(key, "%d", purge_size);
+
+        gf_proc_dump_build_key(key, prefix, "shards");
+        gf_proc_dump_write(key, "%d", INODE_TABLE_SHARDS);
+        gf_proc_dump_build_key(key, prefix, "lock_contention");
+        gf_proc_dump_write(key, "%"PRIu64, itable->lock_contended);
+        gf_proc_dump_build_key(key, prefix, "shard_lock_contention");
+        gf_proc_dump_write(key, "%"PRIu64, contended);
+        gf_proc_dump_build_key(key, prefix, "hash_lock_contention");
+        gf_proc_dump_write(key, "%"PRIu64, hash_contended);
+
+        for (i = 0; i < INODE_TABLE_SHARDS; i++) {
+                shard = &itable->shards[i];
+                if (!shard->contended && !shard->hash_contended)
+                        continue;
+                gf_proc_dump_build_key(key, prefix, "shard.%d.contention", i);
+                gf_proc_dump_write(key, "%"PRIu64",%"PRIu64,
+                                   shard->contended, shard->hash_contended);
+        }
+
+        for (i = 0; i < INODE_TABLE_SHARDS; i++) {
+                shard = &itable->shards[i];
+                if (pthread_mutex_trylock (&shard->lock) != 0)
+                        continue;
+                INODE_DUMP_LIST(&shard->active, key, prefix, "active", active);
+                pthread_mutex_unlock (&shard->lock);
+        }
+
+        for (i = 0; i < INODE_TABLE_SHARDS; i++) {
+                shard = &itable->shards[i];
+                if (pthread_mutex_trylock (&shard->lock) != 0)
+                        continue;
+                INODE_DUMP_LIST(&shard->lru, key, prefix, "lru", lru);
+                pthread_mutex_unlock (&shard->lock);
+        }
 
         pthread_mutex_unlock(&itable->lock);
 }
 
+/* the counters of inode_table_dump(), summed over the shards without
+   taking any lock and without walking the lists */
+void
+inode_table_metrics (inode_table_t *itable, gf_metrics_t *m)
+{
+        struct _inode_table_shard *shard = NULL;
+        uint64_t                   active_size = 0;
+        uint64_t                   lru_size = 0;
+        uint64_t                   purge_size = 0;
+        uint64_t                   contended = 0;
+        uint64_t                   hash_contended = 0;
+        int                        i = 0;
+
+        for (i = 0; i < INODE_TABLE_SHARDS; i++) {
+                shard = &itable->shards[i];
+                active_size += shard->active_size;
+                lru_size += shard->lru_size;
+                purge_size += shard->purge_size;
+                contended += shard->contended;
+                hash_contended += shard->hash_contended;
+        }
+
+        gf_metrics_begin (m, "itable");
+        gf_metrics_uint (m, "lru_limit", itable->lru_limit);
+        gf_metrics_uint (m, "active_size", active_size);
+        gf_metrics_uint (m, "lru_size", lru_size);
+        gf_metrics_uint (m, "purge_size", purge_size);
+        gf_metrics_uint (m, "lock_contention", itable->lock_contended);
+        gf_metrics_uint (m, "shard_lock_contention", contended);
+        gf_metrics_uint (m, "hash_lock_contention", hash_contended);
+        gf_metrics_end (m);
+}
+
 void
 inode_dump_to_dict (inode_t *inode, char *prefix, dict_t *dict)
 {
@@ -1946,56 +2244,63 @@ out:
 void
 inode_table_dump_to_dict (inode_table_t *itable, char *prefix, dict_t *dict)
 {
-        char            key[GF_DUMP_MAX_BUF_LEN] = {0,};
-        int             ret = 0;
-        inode_t         *inode = NULL;
-        int             count = 0;
+        char                       key[GF_DUMP_MAX_BUF_LEN] = {0,};
+        int                        ret = 0;
+        inode_t                   *inode = NULL;
+        int                        active = 0;
+        int                        lru = 0;
+        uint32_t                   purge = 0;
+        int                        i = 0;
+        struct _inode_table_shard *shard = NULL;
 
         ret = pthread_mutex_trylock (&itable->lock);
         if (ret)
                 return;
 
+        /* the sizes are counted while dumping, so that they match the
+           entries of shards which were busy and got skipped */
+        for (i = 0; i < INODE_TABLE_SHARDS; i++) {
+                shard = &itable->shards[i];
+                if (pthread_mutex_trylock (&shard->lock) != 0)
+                        continue;
+
+                purge += shard->purge_size;
+
+                list_for_each_entry (inode, &shard->active, list) {
+                        memset (key, 0, sizeof (key));
+                        snprintf (key, sizeof (key), "%s.itable.active%d",
+                                  prefix, active++);
+                        inode_dump_to_dict (inode, key, dict);
+                }
+
+                list_for_each_entry (inode, &shard->lru, list) {
+                        memset (key, 0, sizeof (key));
+                        snprintf (key, sizeof (key), "%s.itable.lru%d",
+                                  prefix, lru++);
+                        inode_dump_to_dict (inode, key, dict);
+                }
+
+                pthread_mutex_unlock (&shard->lock);
+        }
+
         memset (key, 0, sizeof (key));
         snprintf (key, sizeof (key), "%s.itable.active_size", prefix);
-        ret = dict_set_uint32 (dict, key, itable->active_size);
+        ret = dict_set_uint32 (dict, key, active);
         if (ret)
                 goto out;
 
         memset (key, 0, sizeof (key));
         snprintf (key, sizeof (key), "%s.itable.lru_size", prefix);
-        ret = dict_set_uint32 (dict, key, itable->lru_size);
+        ret = dict_set_uint32 (dict, key, lru);
         if (ret)
                 goto out;
 
         memset (key, 0, sizeof (key));
         snprintf (key, sizeof (key), "%s.itable.purge_size", prefix);
-        ret = dict_set_uint32 (dict, key, itable->purge_size);
+        ret = dict_set_uint32 (dict, key, purge);
         if (ret)
                 goto out;
 
-        list_for_each_entry (inode, &itable->active, list) {
-                memset (key, 0, sizeof (key));
-                snprintf (key, sizeof (key), "%s.itable.active%d", prefix,
-                          count++);
-                inode_dump_to_dict (inode, key, dict);
-        }
-        count = 0;
-
-        list_for_each_entry (inode, &itable->lru, list) {
-                memset (key, 0, sizeof (key));
-                snprintf (key, sizeof (key), "%s.itable.lru%d", prefix,
-                          count++);
-                inode_dump_to_dict (inode, key, dict);
-        }
-        count = 0;
-
-        list_for_each_entry (inode, &itable->purge, list) {
-                memset (key, 0, sizeof (key));
-                snprintf (key, sizeof (key), "%s.itable.purge%d", prefix,
-                          count++);
-                inode_dump_to_dict (inode, key, dict);
-        }
-
 out:
         pthread_mutex_unlock (&itable->lock);
 
@@ -36,22 +36,48 @@ typedef struct _dentry dentry_t;
 #include "uuid.h"
 
 
+/* The inode table is split into shards so that lookups and reference
+   counting on unrelated inodes do not serialise on a single mutex.
+
+   Each inode belongs to one shard (chosen round-robin at creation), whose
+   @lock guards the inode's ref/nlookup counts and its place on the shard's
+   active/lru lists. Hash buckets map to shards by index; a bucket is only
+   modified with both table->lock and the owning shard's @hash_lock held, so
+   readers need just one of the two.
+
+   Lock order: table->lock -> shard->hash_lock -> shard->lock. Never hold
+   two locks of the same kind at once.
+*/
+#define INODE_TABLE_SHARDS 64
+
+struct _inode_table_shard {
+        pthread_mutex_t    lock;          /* ref, nlookup and lists below */
+        struct list_head   active;        /* inodes currently active (in an fop) */
+        uint32_t           active_size;   /* count of inodes in active list */
+        struct list_head   lru;           /* inodes recently used.
+                                             lru.next least recent */
+        uint32_t           lru_size;      /* count of inodes in lru list */
+        uint32_t           purge_size;    /* retired, awaiting destruction */
+        uint64_t           contended;     /* times @lock had to be waited for */
+        pthread_mutex_t    hash_lock;     /* inode_hash and name_hash buckets
+                                             which map to this shard */
+        uint64_t           hash_contended;/* times @hash_lock was waited for */
+};
+
 struct _inode_table {
-        pthread_mutex_t    lock;
+        pthread_mutex_t    lock;        /* dentry tree and hash updates */
+        uint64_t           lock_contended;
         size_t             hashsize;    /* bucket size of inode hash and dentry hash */
         char              *name;        /* name of the inode table, just for gf_log() */
         inode_t           *root;        /* root directory inode, with number 1 */
         xlator_t          *xl;          /* xlator to be called to do purge */
         uint32_t           lru_limit;   /* maximum LRU cache size */
+        uint32_t           shard_lru_limit; /* lru_limit spread over shards,
+                                               rounded up */
+        uint32_t           next_shard;  /* shard for the next new inode */
         struct list_head  *inode_hash;  /* buckets for inode hash table */
         struct list_head  *name_hash;   /* buckets for dentry hash table */
-        struct list_head   active;      /* list of inodes currently active (in an fop) */
-        uint32_t           active_size; /* count of inodes in active list */
-        struct list_head   lru;         /* list of inodes recently used.
-                                           lru.next most recent */
-        uint32_t           lru_size;    /* count of inodes in lru list  */
-        struct list_head   purge;       /* list of inodes to be purged soon */
-        uint32_t           purge_size;  /* count of inodes in purge list */
+        struct _inode_table_shard shards[INODE_TABLE_SHARDS];
 
         struct mem_pool   *inode_pool;  /* memory pool for inodes */
         struct mem_pool   *dentry_pool; /* memory pool for dentrys */
@@ -93,6 +119,8 @@ struct _inode {
         uint32_t             fd_count;      /* Open fd count */
         uint32_t             ref;           /* reference count on this inode */
         ia_type_t            ia_type;       /* what kind of file */
+        uint32_t             shard;         /* index into table->shards */
+        gf_boolean_t         purging;       /* retired, no new refs allowed */
         struct list_head     fd_list;       /* list of open files on this inode */
         struct list_head     dentry_list;   /* list of directory entries for this inode */
         struct list_head     hash;          /* hash table pointers */
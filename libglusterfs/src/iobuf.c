@@ -11,7 +11,16 @@
 
 #include "iobuf.h"
 #include "statedump.h"
+#include "metrics.h"
 #include <stdio.h>
+#include <dirent.h>
+
+#ifdef GF_LINUX_HOST_OS
+#include <sys/syscall.h>
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#endif
 
 
 /*
@@ -34,6 +43,35 @@ struct iobuf_init_config gf_iobuf_init_config[] = {
         {1 * 1024 * 1024, 2},
 };
 
+/* Per-thread iobuf magazines
+
+   Each thread using a pool keeps, for every page size class, a small stack
+   of free iobufs taken from the arenas. iobuf_get2() and iobuf_put() are
+   served from it without iobuf_pool->mutex; an empty magazine is refilled,
+   and a full one drained, half a magazine at a time under the mutex.
+   Cached iobufs stay on their arena's active list, so the arena is never
+   pruned from underneath a magazine.
+*/
+#define IOBUF_MAGAZINE_MAX   32
+#define IOBUF_MAGAZINE_BYTES (512 * GF_UNIT_KB)
+
+struct iobuf_magazine {
+        int            count;
+        int            size;    /* capacity, smaller for big pages */
+        uint64_t       hits;
+        struct iobuf  *iobufs[IOBUF_MAGAZINE_MAX];
+};
+
+struct iobuf_thread_cache {
+        struct list_head       list;    /* in iobuf_pool->caches */
+        struct iobuf_pool     *iobuf_pool;
+        struct iobuf_magazine  mags[IOBUF_ARENA_MAX_INDEX];
+};
+
+
+static void
+iobuf_thread_cache_destroy (void *data);
+
 int
 gf_iobuf_get_arena_index (size_t page_size)
 {
@@ -146,7 +184,7 @@ __iobuf_arena_destroy (struct iobuf_arena *iobuf_arena)
 
         if (iobuf_arena->mem_base
             && iobuf_arena->mem_base != MAP_FAILED)
-                munmap (iobuf_arena->mem_base, iobuf_arena->arena_size);
+                munmap (iobuf_arena->mem_base, iobuf_arena->map_size);
 
         GF_FREE (iobuf_arena);
 out:
@@ -154,6 +192,145 @@ out:
 }
 
 
+/* NUMA node of the CPU the calling thread runs on, or -1 when arenas
+   are not allocated per node */
+static int
+iobuf_pool_numa_node (struct iobuf_pool *iobuf_pool)
+{
+        unsigned int cpu  = 0;
+        unsigned int node = 0;
+
+        if (iobuf_pool->numa_nodes <= 1)
+                return -1;
+
+#if defined(GF_LINUX_HOST_OS) && defined(SYS_getcpu)
+        if (syscall (SYS_getcpu, &cpu, &node, NULL) == 0)
+                return node;
+#endif
+        return -1;
+}
+
+
+static int
+iobuf_numa_node_count (void)
+{
+        DIR           *dir     = NULL;
+        struct dirent *entry   = NULL;
+        int            count   = 0;
+
+        dir = opendir ("/sys/devices/system/node");
+        if (!dir)
+                return 1;
+
+        while ((entry = readdir (dir)) != NULL) {
+                if (!strncmp (entry->d_name, "node", 4) &&
+                    isdigit (entry->d_name[4]))
+                        count++;
+        }
+        closedir (dir);
+
+        return count ? count : 1;
+}
+
+
+/* maps @iobuf_arena->arena_size bytes as asked by the pool's memory policy,
+   on the calling thread's NUMA node */
+static void *
+iobuf_arena_map (struct iobuf_pool *iobuf_pool,
+                 struct iobuf_arena *iobuf_arena)
+{
+        void          *base = MAP_FAILED;
+        unsigned long  nodemask = 0;
+
+        iobuf_arena->map_size = iobuf_arena->arena_size;
+
+#ifdef MAP_HUGETLB
+        if (iobuf_pool->hugepages == GF_IOBUF_HUGEPAGES_HUGETLB) {
+                iobuf_arena->map_size =
+                        (iobuf_arena->arena_size + GF_IOBUF_HUGEPAGE_SIZE - 1)
+                        & ~(GF_IOBUF_HUGEPAGE_SIZE - 1);
+                base = mmap (NULL, iobuf_arena->map_size,
+                             PROT_READ|PROT_WRITE,
+                             MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+                if (base != MAP_FAILED) {
+                        iobuf_arena->hugetlb = _gf_true;
+                } else {
+                        gf_log ("iobuf", GF_LOG_DEBUG, "hugetlb mapping of "
+                                "%zu bytes failed (%s), using transparent "
+                                "huge pages", iobuf_arena->map_size,
+                                strerror (errno));
+                        iobuf_arena->map_size = iobuf_arena->arena_size;
+                }
+        }
+#endif
+
+        if (base == MAP_FAILED) {
+                base = mmap (NULL, iobuf_arena->map_size,
+                             PROT_READ|PROT_WRITE,
+                             MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+                if (base == MAP_FAILED)
+                        return base;
+
+#ifdef MADV_HUGEPAGE
+                if (iobuf_pool->hugepages != GF_IOBUF_HUGEPAGES_NONE)
+                        madvise (base, iobuf_arena->map_size, MADV_HUGEPAGE);
+#endif
+        }
+
+        iobuf_arena->numa_node = iobuf_pool_numa_node (iobuf_pool);
+
+#if defined(GF_LINUX_HOST_OS) && defined(SYS_mbind)
+        /* nothing has touched the pages yet, so they all get allocated
+           on the preferred node */
+        if (iobuf_arena->numa_node >= 0 &&
+            iobuf_arena->numa_node < sizeof (nodemask) * 8) {
+                nodemask = 1UL << iobuf_arena->numa_node;
+                if (syscall (SYS_mbind, base, iobuf_arena->map_size,
+                             MPOL_PREFERRED, &nodemask,
+                             sizeof (nodemask) * 8, 0) != 0)
+                        gf_log ("iobuf", GF_LOG_DEBUG, "binding arena to "
+                                "node %d failed (%s)", iobuf_arena->numa_node,
+                                strerror (errno));
+        }
+#endif
+
+        return base;
+}
+
+
+int
+iobuf_pool_set_mem_policy (struct iobuf_pool *iobuf_pool,
+                           gf_iobuf_hugepages_t hugepages, gf_boolean_t numa)
+{
+        int  nodes = 1;
+
+        GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
+
+        if (numa) {
+                nodes = iobuf_numa_node_count ();
+                if (nodes <= 1)
+                        gf_log ("iobuf", GF_LOG_INFO, "single NUMA node, "
+                                "iobuf arenas are shared by all threads");
+        }
+
+        pthread_mutex_lock (&iobuf_pool->mutex);
+        {
+                iobuf_pool->hugepages = hugepages;
+                iobuf_pool->numa_nodes = nodes;
+        }
+        pthread_mutex_unlock (&iobuf_pool->mutex);
+
+        gf_log ("iobuf", GF_LOG_INFO, "new iobuf arenas use %s pages%s",
+                (hugepages == GF_IOBUF_HUGEPAGES_HUGETLB) ? "hugetlb" :
+                (hugepages == GF_IOBUF_HUGEPAGES_THP) ? "transparent huge" :
+                "normal", (nodes > 1) ? ", allocated per NUMA node" : "");
+
+        return 0;
+out:
+        return -1;
+}
+
+
 struct iobuf_arena *
 __iobuf_arena_alloc (struct iobuf_pool *iobuf_pool, size_t page_size,
                      int32_t num_iobufs)
@@ -180,9 +357,7 @@ __iobuf_arena_alloc (struct iobuf_pool *iobuf_pool, size_t page_size,
 
         iobuf_arena->arena_size = rounded_size * num_iobufs;
 
-        iobuf_arena->mem_base = mmap (NULL, iobuf_arena->arena_size,
-                                      PROT_READ|PROT_WRITE,
-                                      MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        iobuf_arena->mem_base = iobuf_arena_map (iobuf_pool, iobuf_arena);
         if (iobuf_arena->mem_base == MAP_FAILED) {
                 gf_log (THIS->name, GF_LOG_WARNING, "maping failed");
                 goto err;
@@ -212,6 +387,7 @@ __iobuf_arena_unprune (struct iobuf_pool *iobuf_pool, size_t page_size)
         struct iobuf_arena *iobuf_arena  = NULL;
         struct iobuf_arena *tmp          = NULL;
         int                 index        = 0;
+        int                 node         = -1;
 
         GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
 
@@ -223,7 +399,11 @@ __iobuf_arena_unprune (struct iobuf_pool *iobuf_pool, size_t page_size)
                 return NULL;
         }
 
+        node = iobuf_pool_numa_node (iobuf_pool);
+
         list_for_each_entry (tmp, &iobuf_pool->purge[index], list) {
+                if (node != -1 && tmp->numa_node != node)
+                        continue;
                 list_del_init (&tmp->list);
                 iobuf_arena = tmp;
                 break;
@@ -288,12 +468,24 @@ out:
 void
 iobuf_pool_destroy (struct iobuf_pool *iobuf_pool)
 {
-        struct iobuf_arena *iobuf_arena = NULL;
-        struct iobuf_arena *tmp         = NULL;
-        int                 i           = 0;
+        struct iobuf_arena        *iobuf_arena = NULL;
+        struct iobuf_arena        *tmp         = NULL;
+        struct iobuf_thread_cache *cache       = NULL;
+        struct iobuf_thread_cache *cache_tmp   = NULL;
+        int                        i           = 0;
 
         GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
 
+        /* cached iobufs go away along with their arenas below */
+        if (iobuf_pool->cache_key_ok)
+                pthread_key_delete (iobuf_pool->cache_key);
+
+        list_for_each_entry_safe (cache, cache_tmp, &iobuf_pool->caches,
+                                  list) {
+                list_del_init (&cache->list);
+                FREE (cache);
+        }
+
         for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
                 list_for_each_entry_safe (iobuf_arena, tmp,
                                           &iobuf_pool->arenas[i], list) {
@@ -326,6 +518,7 @@ iobuf_create_stdalloc_arena (struct iobuf_pool *iobuf_pool)
         iobuf_arena->iobuf_pool = iobuf_pool;
 
         iobuf_arena->page_size = 0x7fffffff;
+        iobuf_arena->numa_node = -1;
 
         list_add_tail (&iobuf_arena->list,
                        &iobuf_pool->arenas[IOBUF_ARENA_MAX_INDEX]);
@@ -349,6 +542,15 @@ iobuf_pool_new (void)
                 goto out;
 
         pthread_mutex_init (&iobuf_pool->mutex, NULL);
+
+        INIT_LIST_HEAD (&iobuf_pool->caches);
+        if (pthread_key_create (&iobuf_pool->cache_key,
+                                iobuf_thread_cache_destroy))
+                gf_log ("iobuf", GF_LOG_WARNING, "failed to create thread "
+                        "key, per-thread iobuf magazines are disabled");
+        else
+                iobuf_pool->cache_key_ok = 1;
+
         for (i = 0; i <= IOBUF_ARENA_MAX_INDEX; i++) {
                 INIT_LIST_HEAD (&iobuf_pool->arenas[i]);
                 INIT_LIST_HEAD (&iobuf_pool->filled[i]);
@@ -437,6 +639,7 @@ __iobuf_select_arena (struct iobuf_pool *iobuf_pool, size_t page_size)
         struct iobuf_arena *iobuf_arena  = NULL;
         struct iobuf_arena *trav         = NULL;
         int                 index        = 0;
+        int                 node         = -1;
 
         GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
 
@@ -448,9 +651,14 @@ __iobuf_select_arena (struct iobuf_pool *iobuf_pool, size_t page_size)
                 return NULL;
         }
 
+        /* arenas not bound to a node (numa_node -1) suit everyone */
+        node = iobuf_pool_numa_node (iobuf_pool);
+
         /* look for unused iobuf from the head-most arena */
         list_for_each_entry (trav, &iobuf_pool->arenas[index], list) {
-                if (trav->passive_cnt) {
+                if (trav->passive_cnt &&
+                    (node == -1 || trav->numa_node == -1 ||
+                     trav->numa_node == node)) {
                         iobuf_arena = trav;
                         break;
                 }
@@ -571,12 +779,157 @@ out:
 }
 
 
+void
+__iobuf_put (struct iobuf *iobuf, struct iobuf_arena *iobuf_arena);
+
+
+/* runs at thread exit, hands the cached iobufs back to their arenas */
+static void
+iobuf_thread_cache_destroy (void *data)
+{
+        struct iobuf_thread_cache *cache      = data;
+        struct iobuf_pool         *iobuf_pool = NULL;
+        struct iobuf_magazine     *mag        = NULL;
+        struct iobuf              *iobuf      = NULL;
+        int                        i          = 0;
+        int                        j          = 0;
+
+        if (!cache)
+                return;
+
+        iobuf_pool = cache->iobuf_pool;
+
+        pthread_mutex_lock (&iobuf_pool->mutex);
+        {
+                for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
+                        mag = &cache->mags[i];
+
+                        iobuf_pool->cache_hits[i] += mag->hits;
+                        for (j = 0; j < mag->count; j++) {
+                                iobuf = mag->iobufs[j];
+                                __iobuf_put (iobuf, iobuf->iobuf_arena);
+                        }
+                        mag->count = 0;
+                }
+
+                list_del_init (&cache->list);
+        }
+        pthread_mutex_unlock (&iobuf_pool->mutex);
+
+        FREE (cache);
+}
+
+
+static struct iobuf_thread_cache *
+iobuf_thread_cache_get (struct iobuf_pool *iobuf_pool)
+{
+        struct iobuf_thread_cache *cache = NULL;
+        int                        size  = 0;
+        int                        i     = 0;
+
+        if (!iobuf_pool->cache_key_ok)
+                return NULL;
+
+        cache = pthread_getspecific (iobuf_pool->cache_key);
+        if (cache)
+                return cache;
+
+        cache = CALLOC (1, sizeof (*cache));
+        if (!cache)
+                return NULL;
+
+        INIT_LIST_HEAD (&cache->list);
+        cache->iobuf_pool = iobuf_pool;
+
+        for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
+                size = IOBUF_MAGAZINE_BYTES / gf_iobuf_init_config[i].pagesize;
+                if (size > IOBUF_MAGAZINE_MAX)
+                        size = IOBUF_MAGAZINE_MAX;
+                if (size < 2)
+                        size = 2;
+                cache->mags[i].size = size;
+        }
+
+        if (pthread_setspecific (iobuf_pool->cache_key, cache)) {
+                FREE (cache);
+                return NULL;
+        }
+
+        pthread_mutex_lock (&iobuf_pool->mutex);
+        {
+                list_add (&cache->list, &iobuf_pool->caches);
+        }
+        pthread_mutex_unlock (&iobuf_pool->mutex);
+
+        return cache;
+}
+
+
+/* moves up to half a magazine of free iobufs of class @index into @mag.
+   caller holds iobuf_pool->mutex */
+static void
+__iobuf_magazine_refill (struct iobuf_pool *iobuf_pool,
+                         struct iobuf_magazine *mag, int index)
+{
+        struct iobuf_arena *iobuf_arena = NULL;
+        struct iobuf       *iobuf       = NULL;
+        size_t              page_size   = 0;
+
+        page_size = gf_iobuf_init_config[index].pagesize;
+
+        iobuf_pool->cache_misses[index]++;
+
+        while (mag->count < mag->size / 2) {
+                iobuf_arena = __iobuf_select_arena (iobuf_pool, page_size);
+                if (!iobuf_arena)
+                        break;
+
+                iobuf = __iobuf_get (iobuf_arena, page_size);
+                if (!iobuf)
+                        break;
+
+                mag->iobufs[mag->count++] = iobuf;
+        }
+}
+
+
+/* returns the older half of a full magazine to the arenas */
+static void
+iobuf_magazine_drain (struct iobuf_pool *iobuf_pool,
+                      struct iobuf_magazine *mag, int index)
+{
+        struct iobuf *iobuf = NULL;
+        int           batch = 0;
+        int           i     = 0;
+
+        batch = mag->size / 2;
+
+        pthread_mutex_lock (&iobuf_pool->mutex);
+        {
+                iobuf_pool->cache_drains[index]++;
+
+                for (i = 0; i < batch; i++) {
+                        iobuf = mag->iobufs[i];
+                        __iobuf_put (iobuf, iobuf->iobuf_arena);
+                }
+        }
+        pthread_mutex_unlock (&iobuf_pool->mutex);
+
+        memmove (&mag->iobufs[0], &mag->iobufs[batch],
+                 (mag->count - batch) * sizeof (mag->iobufs[0]));
+        mag->count -= batch;
+}
+
+
 struct iobuf *
 iobuf_get2 (struct iobuf_pool *iobuf_pool, size_t page_size)
 {
-        struct iobuf       *iobuf        = NULL;
-        struct iobuf_arena *iobuf_arena  = NULL;
-        size_t              rounded_size = 0;
+        struct iobuf              *iobuf        = NULL;
+        struct iobuf_arena        *iobuf_arena  = NULL;
+        struct iobuf_thread_cache *cache        = NULL;
+        struct iobuf_magazine     *mag          = NULL;
+        size_t                     rounded_size = 0;
+        int                        index        = 0;
 
         if (page_size == 0) {
                 page_size = iobuf_pool->default_page_size;
@@ -597,8 +950,30 @@ iobuf_get2 (struct iobuf_pool *iobuf_pool, size_t page_size)
                 return iobuf;
         }
 
+        index = gf_iobuf_get_arena_index (rounded_size);
+
+        cache = iobuf_thread_cache_get (iobuf_pool);
+        if (cache) {
+                mag = &cache->mags[index];
+                if (mag->count) {
+                        mag->hits++;
+                        iobuf = mag->iobufs[--mag->count];
+                        __iobuf_ref (iobuf);
+                        return iobuf;
+                }
+        }
+
         pthread_mutex_lock (&iobuf_pool->mutex);
         {
+                if (mag) {
+                        __iobuf_magazine_refill (iobuf_pool, mag, index);
+                        if (mag->count) {
+                                iobuf = mag->iobufs[--mag->count];
+                                __iobuf_ref (iobuf);
+                                goto unlock;
+                        }
+                }
+
                 /* most eligible arena for picking an iobuf */
                 iobuf_arena = __iobuf_select_arena (iobuf_pool, rounded_size);
                 if (!iobuf_arena)
@@ -620,31 +995,12 @@ struct iobuf *
 iobuf_get (struct iobuf_pool *iobuf_pool)
 {
         struct iobuf       *iobuf        = NULL;
-        struct iobuf_arena *iobuf_arena  = NULL;
 
         GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
 
-        pthread_mutex_lock (&iobuf_pool->mutex);
-        {
-                /* most eligible arena for picking an iobuf */
-                iobuf_arena = __iobuf_select_arena (iobuf_pool,
-                                                    iobuf_pool->default_page_size);
-                if (!iobuf_arena) {
-                        gf_log (THIS->name, GF_LOG_WARNING, "arena not found");
-                        goto unlock;
-                }
-
-                iobuf = __iobuf_get (iobuf_arena,
-                                     iobuf_pool->default_page_size);
-                if (!iobuf) {
-                        gf_log (THIS->name, GF_LOG_WARNING, "iobuf not found");
-                        goto unlock;
-                }
-
-                __iobuf_ref (iobuf);
-        }
-unlock:
-        pthread_mutex_unlock (&iobuf_pool->mutex);
+        iobuf = iobuf_get2 (iobuf_pool, iobuf_pool->default_page_size);
+        if (!iobuf)
+                gf_log (THIS->name, GF_LOG_WARNING, "iobuf not found");
 
 out:
         return iobuf;
@@ -697,8 +1053,11 @@ out:
 void
 iobuf_put (struct iobuf *iobuf)
 {
-        struct iobuf_arena *iobuf_arena = NULL;
-        struct iobuf_pool  *iobuf_pool = NULL;
+        struct iobuf_arena        *iobuf_arena = NULL;
+        struct iobuf_pool         *iobuf_pool  = NULL;
+        struct iobuf_thread_cache *cache       = NULL;
+        struct iobuf_magazine     *mag         = NULL;
+        int                        index       = 0;
 
         GF_VALIDATE_OR_GOTO ("iobuf", iobuf, out);
 
@@ -714,6 +1073,16 @@ iobuf_put (struct iobuf *iobuf)
                 return;
         }
 
+        index = gf_iobuf_get_arena_index (iobuf_arena->page_size);
+        cache = (index != -1) ? iobuf_thread_cache_get (iobuf_pool) : NULL;
+        if (cache) {
+                mag = &cache->mags[index];
+                if (mag->count == mag->size)
+                        iobuf_magazine_drain (iobuf_pool, mag, index);
+                mag->iobufs[mag->count++] = iobuf;
+                return;
+        }
+
         pthread_mutex_lock (&iobuf_pool->mutex);
         {
                 __iobuf_put (iobuf, iobuf_arena);
@@ -1028,6 +1397,10 @@ iobuf_arena_info_dump (struct iobuf_arena *iobuf_arena, const char *key_prefix)
         gf_proc_dump_write(key, "%"PRIu64, iobuf_arena->max_active);
         gf_proc_dump_build_key(key, key_prefix, "page_size");
         gf_proc_dump_write(key, "%"PRIu64, iobuf_arena->page_size);
+        gf_proc_dump_build_key(key, key_prefix, "numa_node");
+        gf_proc_dump_write(key, "%d", iobuf_arena->numa_node);
+        gf_proc_dump_build_key(key, key_prefix, "hugetlb");
+        gf_proc_dump_write(key, "%d", iobuf_arena->hugetlb);
         list_for_each_entry (trav, &iobuf_arena->active.list, list) {
                 gf_proc_dump_build_key(key, key_prefix,"active_iobuf.%d", i++);
                 gf_proc_dump_add_section(key);
@@ -1041,11 +1414,14 @@ out:
 void
 iobuf_stats_dump (struct iobuf_pool *iobuf_pool)
 {
-        char               msg[1024];
-        struct iobuf_arena *trav = NULL;
-        int                i = 1;
-        int                j = 0;
-        int                ret = -1;
+        char                       msg[1024];
+        struct iobuf_arena        *trav = NULL;
+        struct iobuf_thread_cache *cache = NULL;
+        uint64_t                   hits = 0;
+        uint64_t                   misses = 0;
+        int                        i = 1;
+        int                        j = 0;
+        int                        ret = -1;
 
         GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
 
@@ -1066,6 +1442,32 @@ iobuf_stats_dump (struct iobuf_pool *iobuf_pool)
                            iobuf_pool->arena_cnt);
         gf_proc_dump_write("iobuf_pool.request_misses", "%"PRId64,
                            iobuf_pool->request_misses);
+        gf_proc_dump_write("iobuf_pool.hugepages", "%d",
+                           iobuf_pool->hugepages);
+        gf_proc_dump_write("iobuf_pool.numa_nodes", "%d",
+                           iobuf_pool->numa_nodes);
+
+        for (j = 0; j < IOBUF_ARENA_MAX_INDEX; j++) {
+                hits = iobuf_pool->cache_hits[j];
+                list_for_each_entry (cache, &iobuf_pool->caches, list)
+                        hits += cache->mags[j].hits;
+                misses = iobuf_pool->cache_misses[j];
+
+                snprintf (msg, sizeof (msg), "iobuf_pool.%zu.cache_hits",
+                          gf_iobuf_init_config[j].pagesize);
+                gf_proc_dump_write (msg, "%"PRIu64, hits);
+                snprintf (msg, sizeof (msg), "iobuf_pool.%zu.cache_misses",
+                          gf_iobuf_init_config[j].pagesize);
+                gf_proc_dump_write (msg, "%"PRIu64, misses);
+                snprintf (msg, sizeof (msg), "iobuf_pool.%zu.cache_drains",
+                          gf_iobuf_init_config[j].pagesize);
+                gf_proc_dump_write (msg, "%"PRIu64,
+                                    iobuf_pool->cache_drains[j]);
+                snprintf (msg, sizeof (msg), "iobuf_pool.%zu.cache_hit_rate",
+                          gf_iobuf_init_config[j].pagesize);
+                gf_proc_dump_write (msg, "%.2f%%", (hits + misses) ?
+                                    (hits * 100.0) / (hits + misses) : 0.0);
+        }
 
         for (j = 0; j < IOBUF_ARENA_MAX_INDEX; j++) {
                 list_for_each_entry (trav, &iobuf_pool->arenas[j], list) {
@@ -1099,6 +1501,45 @@ out:
 }
 
 
+/* the global counters of iobuf_stats_dump() without the per-arena part */
+void
+iobuf_stats_metrics (struct iobuf_pool *iobuf_pool, gf_metrics_t *m)
+{
+        struct iobuf_thread_cache *cache = NULL;
+        uint64_t                   hits = 0;
+        int                        j = 0;
+
+        pthread_mutex_lock (&iobuf_pool->mutex);
+        {
+                gf_metrics_begin (m, "iobuf");
+                gf_metrics_int (m, "arena_size", iobuf_pool->arena_size);
+                gf_metrics_int (m, "arena_cnt", iobuf_pool->arena_cnt);
+                gf_metrics_int (m, "request_misses",
+                                iobuf_pool->request_misses);
+
+                gf_metrics_begin_list (m, "classes");
+                for (j = 0; j < IOBUF_ARENA_MAX_INDEX; j++) {
+                        hits = iobuf_pool->cache_hits[j];
+                        list_for_each_entry (cache, &iobuf_pool->caches, list)
+                                hits += cache->mags[j].hits;
+
+                        gf_metrics_begin (m, NULL);
+                        gf_metrics_uint (m, "page_size",
+                                         gf_iobuf_init_config[j].pagesize);
+                        gf_metrics_uint (m, "cache_hits", hits);
+                        gf_metrics_uint (m, "cache_misses",
+                                         iobuf_pool->cache_misses[j]);
+                        gf_metrics_uint (m, "cache_drains",
+                                         iobuf_pool->cache_drains[j]);
+                        gf_metrics_end (m);
+                }
+                gf_metrics_end_list (m);
+                gf_metrics_end (m);
+        }
+        pthread_mutex_unlock (&iobuf_pool->mutex);
+}
+
+
 void
 iobuf_to_iovec(struct iobuf *iob, struct iovec *iov)
 {
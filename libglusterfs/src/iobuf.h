@@ -36,6 +36,15 @@
 
 #define GF_IOBUF_ALIGN_SIZE 512
 
+/* how the memory of new arenas is backed, see iobuf_pool_set_mem_policy() */
+typedef enum {
+        GF_IOBUF_HUGEPAGES_NONE = 0,
+        GF_IOBUF_HUGEPAGES_THP,         /* madvise (MADV_HUGEPAGE) */
+        GF_IOBUF_HUGEPAGES_HUGETLB,     /* MAP_HUGETLB, else THP */
+} gf_iobuf_hugepages_t;
+
+#define GF_IOBUF_HUGEPAGE_SIZE (2 * GF_UNIT_MB)
+
 /* one allocatable unit for the consumers of the IOBUF API */
 /* each unit hosts @page_size bytes of memory */
 struct iobuf;
@@ -91,6 +100,11 @@ struct iobuf_arena {
         struct iobuf_pool  *iobuf_pool;
 
         void               *mem_base;
+        size_t              map_size;   /* length of the mapping at
+                                           mem_base, >= arena_size */
+        int                 numa_node;  /* node memory is bound to,
+                                           -1 if not bound */
+        gf_boolean_t        hugetlb;    /* mapped with MAP_HUGETLB */
         struct iobuf       *iobufs;     /* allocated iobufs list */
 
         int                 active_cnt;
@@ -123,6 +137,19 @@ struct iobuf_pool {
 
         uint64_t            request_misses; /* mostly the requests for higher
                                                value of iobufs */
+
+        gf_iobuf_hugepages_t hugepages;
+        int                 numa_nodes; /* > 1 when arenas are allocated
+                                           per NUMA node */
+
+        pthread_key_t       cache_key;  /* per-thread iobuf magazines */
+        int                 cache_key_ok;
+        struct list_head    caches;     /* all threads' magazines */
+
+        /* per page size class, folded in from the magazines */
+        uint64_t            cache_hits[GF_VARIABLE_IOBUF_COUNT];
+        uint64_t            cache_misses[GF_VARIABLE_IOBUF_COUNT];
+        uint64_t            cache_drains[GF_VARIABLE_IOBUF_COUNT];
 };
 
 
@@ -133,6 +160,9 @@ void iobuf_unref (struct iobuf *iobuf);
 struct iobuf *iobuf_ref (struct iobuf *iobuf);
 void iobuf_pool_destroy (struct iobuf_pool *iobuf_pool);
 void iobuf_to_iovec(struct iobuf *iob, struct iovec *iov);
+int iobuf_pool_set_mem_policy (struct iobuf_pool *iobuf_pool,
+                               gf_iobuf_hugepages_t hugepages,
+                               gf_boolean_t numa);
 
 #define iobuf_ptr(iob) ((iob)->ptr)
 #define iobpool_default_pagesize(iobpool) ((iobpool)->default_page_size)
@@ -155,6 +185,9 @@ void iobref_clear (struct iobref *iobref);
 size_t iobuf_size (struct iobuf *iobuf);
 size_t iobref_size (struct iobref *iobref);
 void   iobuf_stats_dump (struct iobuf_pool *iobuf_pool);
+struct gf_metrics;
+void   iobuf_stats_metrics (struct iobuf_pool *iobuf_pool,
+                            struct gf_metrics *m);
 
 struct iobuf *
 iobuf_get2 (struct iobuf_pool *iobuf_pool, size_t page_size);
@@ -115,6 +115,134 @@ gf_set_fop_from_fn_pointer (call_frame_t *frame, struct xlator_fops *fops, void
 }
 
 
+static inline int
+gf_latency_hist_index (uint64_t usecs)
+{
+        int msb = 0;
+
+        if (usecs >= (1ULL << GF_LATENCY_HIST_MAX_BITS))
+                usecs = (1ULL << GF_LATENCY_HIST_MAX_BITS) - 1;
+
+        if (usecs < GF_LATENCY_HIST_SUB_COUNT)
+                return usecs;
+
+        msb = 63 - __builtin_clzll (usecs);
+
+        return GF_LATENCY_HIST_SUB_COUNT +
+                (msb - GF_LATENCY_HIST_SUB_BITS) * GF_LATENCY_HIST_SUB_COUNT +
+                ((usecs >> (msb - GF_LATENCY_HIST_SUB_BITS)) &
+                 (GF_LATENCY_HIST_SUB_COUNT - 1));
+}
+
+
+/* largest value which falls into bucket @index */
+static uint64_t
+gf_latency_hist_bucket_max (int index)
+{
+        int      shift = 0;
+        uint64_t sub   = 0;
+
+        if (index < GF_LATENCY_HIST_SUB_COUNT)
+                return index;
+
+        shift = (index - GF_LATENCY_HIST_SUB_COUNT) /
+                GF_LATENCY_HIST_SUB_COUNT;
+        sub   = index % GF_LATENCY_HIST_SUB_COUNT;
+
+        return ((GF_LATENCY_HIST_SUB_COUNT + sub + 1) << shift) - 1;
+}
+
+
+void
+gf_latency_hist_add (gf_latency_hist_t *hist, uint64_t usecs)
+{
+        __sync_fetch_and_add (&hist->buckets[gf_latency_hist_index (usecs)],
+                              1);
+}
+
+
+/* @copy->count is recomputed from the buckets, the live histogram only
+ * maintains the buckets themselves. */
+void
+gf_latency_hist_snapshot (gf_latency_hist_t *hist, gf_latency_hist_t *copy,
+                          int reset)
+{
+        int i = 0;
+
+        copy->count = 0;
+        for (i = 0; i < GF_LATENCY_HIST_BUCKETS; i++) {
+                if (reset)
+                        copy->buckets[i] =
+                                __sync_fetch_and_and (&hist->buckets[i], 0);
+                else
+                        copy->buckets[i] = hist->buckets[i];
+                copy->count += copy->buckets[i];
+        }
+}
+
+
+void
+gf_latency_hist_merge (gf_latency_hist_t *dst, gf_latency_hist_t *src)
+{
+        int i = 0;
+
+        for (i = 0; i < GF_LATENCY_HIST_BUCKETS; i++)
+                dst->buckets[i] += src->buckets[i];
+        dst->count += src->count;
+}
+
+
+/* @hist must be a snapshot; returns the upper bound (microseconds) of the
+ * bucket holding the requested percentile, 0 if there are no samples. */
+uint64_t
+gf_latency_hist_percentile (gf_latency_hist_t *hist, double percentile)
+{
+        uint64_t target = 0;
+        uint64_t seen   = 0;
+        int      i      = 0;
+
+        if (!hist->count)
+                return 0;
+
+        target = (uint64_t) (hist->count * percentile / 100.0 + 0.5);
+        if (target == 0)
+                target = 1;
+        if (target > hist->count)
+                target = hist->count;
+
+        for (i = 0; i < GF_LATENCY_HIST_BUCKETS; i++) {
+                seen += hist->buckets[i];
+                if (seen >= target)
+                        break;
+        }
+
+        if (i == GF_LATENCY_HIST_BUCKETS)
+                i--;
+
+        return gf_latency_hist_bucket_max (i);
+}
+
+
+static gf_latency_hist_t *
+gf_latency_hist_get (xlator_t *xl)
+{
+        gf_latency_hist_t *hist = NULL;
+
+        if (xl->latency_hist)
+                return xl->latency_hist;
+
+        hist = GF_CALLOC (GF_FOP_MAXVALUE, sizeof (*hist),
+                          gf_common_mt_latency_hist_t);
+        if (!hist)
+                return NULL;
+
+        if (!__sync_bool_compare_and_swap (&xl->latency_hist, NULL, hist))
+                GF_FREE (hist);
+
+        return xl->latency_hist;
+}
+
+
 void
 gf_update_latency (call_frame_t *frame)
 {
@@ -122,18 +250,33 @@ gf_update_latency (call_frame_t *frame)
         struct timeval *begin, *end;
 
         fop_latency_t *lat;
+        gf_latency_hist_t *hist;
+
+        if (frame->op < 0 || frame->op >= GF_FOP_MAXVALUE)
+                return;
 
         begin = &frame->begin;
         end   = &frame->end;
 
         elapsed = (end->tv_sec - begin->tv_sec) * 1e6
                 + (end->tv_usec - begin->tv_usec);
+        if (elapsed < 0)
+                elapsed = 0;
 
         lat = &frame->this->latencies[frame->op];
 
+        if (!lat->count || elapsed < lat->min)
+                lat->min = elapsed;
+        if (elapsed > lat->max)
+                lat->max = elapsed;
+
         lat->total += elapsed;
         lat->count++;
         lat->mean = lat->mean + (elapsed - lat->mean) / lat->count;
+
+        hist = gf_latency_hist_get (frame->this);
+        if (hist)
+                gf_latency_hist_add (&hist[frame->op], (uint64_t) elapsed);
 }
 
 void
@@ -158,6 +301,7 @@ gf_proc_dump_latency_info (xlator_t *xl)
 {
         char key_prefix[GF_DUMP_MAX_BUF_LEN];
         char key[GF_DUMP_MAX_BUF_LEN];
+        gf_latency_hist_t hist;
         int i;
 
         snprintf (key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.latency", xl->name);
@@ -167,10 +311,21 @@ gf_proc_dump_latency_info (xlator_t *xl)
                 gf_proc_dump_build_key (key, key_prefix,
                                         (char *)gf_fop_list[i]);
 
-                gf_proc_dump_write (key, "%.03f,%"PRId64",%.03f",
+                memset (&hist, 0, sizeof (hist));
+                if (xl->latency_hist)
+                        gf_latency_hist_snapshot (&xl->latency_hist[i], &hist,
+                                                  1);
+
+                /* mean,count,total,p50,p90,p99,p99.9 */
+                gf_proc_dump_write (key, "%.03f,%"PRId64",%.03f,%"PRIu64
+                                    ",%"PRIu64",%"PRIu64",%"PRIu64,
                                     xl->latencies[i].mean,
                                     xl->latencies[i].count,
-                                    xl->latencies[i].total);
+                                    xl->latencies[i].total,
+                                    gf_latency_hist_percentile (&hist, 50),
+                                    gf_latency_hist_percentile (&hist, 90),
+                                    gf_latency_hist_percentile (&hist, 99),
+                                    gf_latency_hist_percentile (&hist, 99.9));
         }
 
         memset (xl->latencies, 0, sizeof (xl->latencies));
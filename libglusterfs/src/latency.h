@@ -22,6 +22,41 @@ typedef struct fop_latency {
         uint64_t count;
 } fop_latency_t;
 
+/*
+ * Log-linear latency histogram (microseconds).  Every power of two is
+ * split into 2^GF_LATENCY_HIST_SUB_BITS linear sub-buckets, which keeps
+ * the relative error of a reported percentile below 1/16 over the whole
+ * range while needing only a few hundred counters.  Samples are added
+ * with atomic increments so that concurrent fops need no lock; readers
+ * take a snapshot (optionally resetting the live counters) and derive
+ * percentiles from the copy.
+ */
+#define GF_LATENCY_HIST_SUB_BITS   4
+#define GF_LATENCY_HIST_SUB_COUNT  (1 << GF_LATENCY_HIST_SUB_BITS)
+#define GF_LATENCY_HIST_MAX_BITS   32   /* samples clamp at ~71 minutes */
+#define GF_LATENCY_HIST_BUCKETS    (GF_LATENCY_HIST_SUB_COUNT +          \
+                                    (GF_LATENCY_HIST_MAX_BITS -          \
+                                     GF_LATENCY_HIST_SUB_BITS) *         \
+                                    GF_LATENCY_HIST_SUB_COUNT)
+
+typedef struct gf_latency_hist {
+        uint64_t count;
+        uint64_t buckets[GF_LATENCY_HIST_BUCKETS];
+} gf_latency_hist_t;
+
+void
+gf_latency_hist_add (gf_latency_hist_t *hist, uint64_t usecs);
+
+void
+gf_latency_hist_snapshot (gf_latency_hist_t *hist, gf_latency_hist_t *copy,
+                          int reset);
+
+void
+gf_latency_hist_merge (gf_latency_hist_t *dst, gf_latency_hist_t *src);
+
+uint64_t
+gf_latency_hist_percentile (gf_latency_hist_t *hist, double percentile);
+
 void
 gf_latency_toggle (int signum, glusterfs_ctx_t *ctx);
 
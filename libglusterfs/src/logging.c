@@ -38,6 +38,7 @@
 #include "logging.h"
 #include "defaults.h"
 #include "glusterfs.h"
+#include "statedump.h"
 
 #ifdef GF_LINUX_HOST_OS
 #include <syslog.h>
@@ -110,10 +111,458 @@ gf_log_set_xl_loglevel (void *this, gf_loglevel_t level)
 void
 gf_log_fini (void)
 {
+        gf_log_flush ();
         pthread_mutex_destroy (&THIS->ctx->log.logfile_mutex);
 }
 
 
+/* Asynchronous logging: each thread queues its formatted messages on a
+   ring of its own, without taking any lock, and the log writer thread
+   drains the rings to the log files. A message repeated back to back is
+   written once, followed by the number of repeats. */
+
+#define GF_LOG_RING_SIZE        256
+#define GF_LOG_RING_MASK        (GF_LOG_RING_SIZE - 1)
+
+/* a repeated message is not held back longer than this (in seconds) */
+#define GF_LOG_SUPPRESS_TIMEOUT 5
+
+typedef struct gf_log_entry_ {
+        glusterfs_ctx_t  *ctx;
+        gf_loglevel_t     level;
+        size_t            skip;   /* length of the timestamp prefix */
+        char             *msg;
+} gf_log_entry_t;
+
+typedef struct gf_log_ring_ {
+        struct list_head  list;
+        volatile uint32_t head;   /* only moved by the owning thread */
+        volatile uint32_t tail;   /* only moved by the draining thread */
+        int               orphan; /* owning thread exited */
+        time_t            window; /* second the rate limit is counted in */
+        uint32_t          window_count;
+        gf_log_entry_t    entries[GF_LOG_RING_SIZE];
+} gf_log_ring_t;
+
+static struct {
+        /* protects the list of rings, writer startup and draining */
+        pthread_mutex_t   lock;
+        pthread_cond_t    cond;
+        pthread_key_t     key;
+        pthread_t         writer;
+        int               running;
+        volatile int      idle;
+        int               ready;
+        struct list_head  rings;
+        glusterfs_ctx_t  *fork_ctx; /* whose log is held across fork () */
+
+        gf_log_entry_t    last;   /* last message written */
+        time_t            last_time;
+        uint32_t          repeats;
+
+        uint64_t          queued;
+        uint64_t          dropped;
+        uint64_t          dropped_reported;
+        uint64_t          suppressed;
+} gf_log_async;
+
+static pthread_once_t gf_log_async_once = PTHREAD_ONCE_INIT;
+
+static char *gf_log_level_strings[] = {"",  /* NONE */
+                                       "M", /* EMERGENCY */
+                                       "A", /* ALERT */
+                                       "C", /* CRITICAL */
+                                       "E", /* ERROR */
+                                       "W", /* WARNING */
+                                       "N", /* NOTICE */
+                                       "I", /* INFO */
+                                       "D", /* DEBUG */
+                                       "T", /* TRACE */
+                                       ""};
+
+static void
+gf_log_write (glusterfs_ctx_t *ctx, gf_loglevel_t level, const char *msg)
+{
+        pthread_mutex_lock (&ctx->log.logfile_mutex);
+        {
+
+                if (ctx->log.logfile) {
+                        fprintf (ctx->log.logfile, "%s\n", msg);
+                        fflush (ctx->log.logfile);
+                } else {
+                        fprintf (stderr, "%s\n", msg);
+                        fflush (stderr);
+                }
+
+#ifdef GF_LINUX_HOST_OS
+                /* We want only serious log in 'syslog', not our debug
+                   and trace logs */
+                if (ctx->log.gf_log_syslog && level &&
+                    (level <= ctx->log.sys_log_level))
+                        syslog ((level-1), "%s\n", msg);
+#endif
+        }
+        pthread_mutex_unlock (&ctx->log.logfile_mutex);
+}
+
+/* write a message of the logging code itself to the log of @ctx */
+static void
+gf_log_write_note (glusterfs_ctx_t *ctx, gf_loglevel_t level,
+                   const char *function, int line, const char *fmt, ...)
+{
+        char            msg[1024]    = {0,};
+        char            timestr[256] = {0,};
+        struct timeval  tv           = {0,};
+        va_list         ap;
+        int             len          = 0;
+
+        if (gettimeofday (&tv, NULL) == -1)
+                return;
+        gf_time_fmt (timestr, sizeof timestr, tv.tv_sec, gf_timefmt_FT);
+        snprintf (timestr + strlen (timestr), sizeof timestr - strlen (timestr),
+                  ".%"GF_PRI_SUSECONDS, tv.tv_usec);
+
+        len = snprintf (msg, sizeof (msg), "[%s] %s [logging.c:%d:%s] 0-%s: ",
+                        timestr, gf_log_level_strings[level], line, function,
+                        "logging");
+        if (len < 0 || len >= (int) sizeof (msg))
+                return;
+
+        va_start (ap, fmt);
+        vsnprintf (msg + len, sizeof (msg) - len, fmt, ap);
+        va_end (ap);
+
+        gf_log_write (ctx, level, msg);
+}
+
+static void
+__gf_log_flush_repeats (void)
+{
+        gf_log_entry_t *last = &gf_log_async.last;
+
+        if (!gf_log_async.repeats)
+                return;
+
+        gf_log_write_note (last->ctx, last->level, __FUNCTION__, __LINE__,
+                           "last message repeated %u times",
+                           gf_log_async.repeats);
+        gf_log_async.repeats = 0;
+}
+
+static void
+__gf_log_emit (gf_log_entry_t *entry)
+{
+        gf_log_entry_t *last = &gf_log_async.last;
+
+        if (last->msg && last->ctx == entry->ctx &&
+            last->level == entry->level &&
+            strcmp (last->msg + last->skip, entry->msg + entry->skip) == 0) {
+                gf_log_async.repeats++;
+                gf_log_async.suppressed++;
+                GF_FREE (entry->msg);
+                return;
+        }
+
+        __gf_log_flush_repeats ();
+        gf_log_write (entry->ctx, entry->level, entry->msg);
+
+        GF_FREE (last->msg);
+        *last = *entry;
+        gf_log_async.last_time = time (NULL);
+}
+
+/* called with gf_log_async.lock held */
+static int
+__gf_log_drain (void)
+{
+        gf_log_ring_t  *ring  = NULL;
+        gf_log_ring_t  *tmp   = NULL;
+        gf_log_entry_t  entry = {0,};
+        int             count = 0;
+
+        list_for_each_entry_safe (ring, tmp, &gf_log_async.rings, list) {
+                while (ring->tail != ring->head) {
+                        /* see the entry the owner filled in before it
+                           moved head */
+                        __sync_synchronize ();
+                        entry = ring->entries[ring->tail & GF_LOG_RING_MASK];
+                        __sync_synchronize ();
+                        ring->tail++;
+
+                        __gf_log_emit (&entry);
+                        count++;
+                }
+
+                if (ring->orphan) {
+                        list_del_init (&ring->list);
+                        GF_FREE (ring);
+                }
+        }
+
+        if (gf_log_async.dropped != gf_log_async.dropped_reported &&
+            gf_log_async.last.ctx) {
+                __gf_log_flush_repeats ();
+                gf_log_write_note (gf_log_async.last.ctx, GF_LOG_WARNING,
+                                   __FUNCTION__, __LINE__,
+                                   "%"PRIu64" log messages dropped",
+                                   gf_log_async.dropped -
+                                   gf_log_async.dropped_reported);
+                gf_log_async.dropped_reported = gf_log_async.dropped;
+        }
+
+        return count;
+}
+
+static int
+__gf_log_pending (void)
+{
+        gf_log_ring_t *ring = NULL;
+
+        list_for_each_entry (ring, &gf_log_async.rings, list) {
+                if (ring->tail != ring->head)
+                        return 1;
+        }
+
+        return 0;
+}
+
+static void *
+gf_log_writer (void *data)
+{
+        struct timeval  tv       = {0,};
+        struct timespec deadline = {0,};
+
+        pthread_mutex_lock (&gf_log_async.lock);
+        while (1) {
+                if (__gf_log_drain ())
+                        continue;
+
+                if (gf_log_async.repeats &&
+                    (time (NULL) - gf_log_async.last_time >=
+                     GF_LOG_SUPPRESS_TIMEOUT))
+                        __gf_log_flush_repeats ();
+
+                /* a thread queueing a message wakes us up only when it
+                   sees us idle, look once more after telling so */
+                gf_log_async.idle = 1;
+                __sync_synchronize ();
+                if (!__gf_log_pending ()) {
+                        gettimeofday (&tv, NULL);
+                        deadline.tv_sec = tv.tv_sec + 1;
+                        deadline.tv_nsec = tv.tv_usec * 1000;
+                        pthread_cond_timedwait (&gf_log_async.cond,
+                                                &gf_log_async.lock,
+                                                &deadline);
+                }
+                gf_log_async.idle = 0;
+        }
+        pthread_mutex_unlock (&gf_log_async.lock);
+
+        return NULL;
+}
+
+static void
+gf_log_ring_orphan (void *data)
+{
+        gf_log_ring_t *ring = data;
+
+        /* the writer frees it once it is drained */
+        pthread_mutex_lock (&gf_log_async.lock);
+        {
+                ring->orphan = 1;
+        }
+        pthread_mutex_unlock (&gf_log_async.lock);
+}
+
+/* keep the writer, and any thread writing synchronously, out of the log
+   while forking, or the child inherits their locks held */
+static void
+gf_log_async_atfork_prepare (void)
+{
+        xlator_t *this = THIS;
+
+        pthread_mutex_lock (&gf_log_async.lock);
+
+        gf_log_async.fork_ctx = this ? this->ctx : NULL;
+        if (gf_log_async.fork_ctx)
+                pthread_mutex_lock (&gf_log_async.fork_ctx->log.logfile_mutex);
+}
+
+static void
+gf_log_async_atfork_parent (void)
+{
+        if (gf_log_async.fork_ctx)
+                pthread_mutex_unlock (&gf_log_async.fork_ctx->log.logfile_mutex);
+        gf_log_async.fork_ctx = NULL;
+
+        pthread_mutex_unlock (&gf_log_async.lock);
+}
+
+static void
+gf_log_async_atfork_child (void)
+{
+        gf_log_ring_t *ring = NULL;
+
+        if (gf_log_async.fork_ctx)
+                pthread_mutex_init (&gf_log_async.fork_ctx->log.logfile_mutex,
+                                    NULL);
+        gf_log_async.fork_ctx = NULL;
+
+        /* the writer did not survive the fork, and messages still queued
+           are written by the parent */
+        pthread_mutex_init (&gf_log_async.lock, NULL);
+        pthread_cond_init (&gf_log_async.cond, NULL);
+        gf_log_async.running = 0;
+        gf_log_async.idle = 0;
+
+        list_for_each_entry (ring, &gf_log_async.rings, list) {
+                while (ring->tail != ring->head) {
+                        GF_FREE (ring->entries[ring->tail &
+                                               GF_LOG_RING_MASK].msg);
+                        ring->tail++;
+                }
+        }
+}
+
+static void
+gf_log_async_init (void)
+{
+        pthread_mutex_init (&gf_log_async.lock, NULL);
+        pthread_cond_init (&gf_log_async.cond, NULL);
+        INIT_LIST_HEAD (&gf_log_async.rings);
+
+        if (pthread_key_create (&gf_log_async.key, gf_log_ring_orphan))
+                return;
+
+        pthread_atfork (gf_log_async_atfork_prepare,
+                        gf_log_async_atfork_parent,
+                        gf_log_async_atfork_child);
+        atexit (gf_log_flush);
+
+        gf_log_async.ready = 1;
+}
+
+/* hands @msg over to the log writer. Returns -1 if the message has to be
+   written by the caller */
+static int
+gf_log_enqueue (glusterfs_ctx_t *ctx, gf_loglevel_t level, char *msg,
+                size_t skip, time_t now)
+{
+        gf_log_ring_t  *ring  = NULL;
+        gf_log_entry_t *entry = NULL;
+        uint32_t        head  = 0;
+
+        if (!ctx->log.async)
+                return -1;
+
+        pthread_once (&gf_log_async_once, gf_log_async_init);
+        if (!gf_log_async.ready)
+                return -1;
+
+        /* do not hold back what may be the last words of the process */
+        if (level <= GF_LOG_CRITICAL) {
+                gf_log_flush ();
+                return -1;
+        }
+
+        ring = pthread_getspecific (gf_log_async.key);
+        if (!ring) {
+                ring = GF_CALLOC (1, sizeof (*ring), gf_common_mt_log_ring_t);
+                if (!ring)
+                        return -1;
+                if (pthread_setspecific (gf_log_async.key, ring)) {
+                        GF_FREE (ring);
+                        return -1;
+                }
+
+                pthread_mutex_lock (&gf_log_async.lock);
+                {
+                        list_add_tail (&ring->list, &gf_log_async.rings);
+                }
+                pthread_mutex_unlock (&gf_log_async.lock);
+        }
+
+        if (!gf_log_async.running) {
+                pthread_mutex_lock (&gf_log_async.lock);
+                {
+                        if (!gf_log_async.running &&
+                            gf_thread_create (&gf_log_async.writer, NULL,
+                                              gf_log_writer, NULL) == 0)
+                                gf_log_async.running = 1;
+                }
+                pthread_mutex_unlock (&gf_log_async.lock);
+
+                if (!gf_log_async.running)
+                        return -1;
+        }
+
+        if (ctx->log.rate_limit) {
+                if (ring->window != now) {
+                        ring->window = now;
+                        ring->window_count = 0;
+                }
+                if (++ring->window_count > ctx->log.rate_limit)
+                        goto drop;
+        }
+
+        head = ring->head;
+        if (head - ring->tail >= GF_LOG_RING_SIZE)
+                goto drop;
+
+        entry = &ring->entries[head & GF_LOG_RING_MASK];
+        entry->ctx = ctx;
+        entry->level = level;
+        entry->skip = skip;
+        entry->msg = msg;
+
+        /* publish the entry before moving head over it */
+        __sync_synchronize ();
+        ring->head = head + 1;
+        __sync_add_and_fetch (&gf_log_async.queued, 1);
+
+        if (gf_log_async.idle)
+                pthread_cond_signal (&gf_log_async.cond);
+
+        return 0;
+drop:
+        __sync_add_and_fetch (&gf_log_async.dropped, 1);
+        GF_FREE (msg);
+        return 0;
+}
+
+/* write out all queued messages */
+void
+gf_log_flush (void)
+{
+        pthread_once (&gf_log_async_once, gf_log_async_init);
+
+        pthread_mutex_lock (&gf_log_async.lock);
+        {
+                __gf_log_drain ();
+                __gf_log_flush_repeats ();
+
+                /* the context may go away after this */
+                GF_FREE (gf_log_async.last.msg);
+                memset (&gf_log_async.last, 0, sizeof (gf_log_async.last));
+        }
+        pthread_mutex_unlock (&gf_log_async.lock);
+}
+
+void
+gf_log_dump (void *data)
+{
+        glusterfs_ctx_t *ctx = data;
+
+        gf_proc_dump_add_section ("logging");
+        gf_proc_dump_write ("async", "%d", ctx->log.async);
+        gf_proc_dump_write ("rate-limit", "%u", ctx->log.rate_limit);
+        gf_proc_dump_write ("queued", "%"PRIu64, gf_log_async.queued);
+        gf_proc_dump_write ("dropped", "%"PRIu64, gf_log_async.dropped);
+        gf_proc_dump_write ("suppressed", "%"PRIu64,
+                            gf_log_async.suppressed);
+}
+
+
 #ifdef GF_USE_SYSLOG
 /**
  * gf_get_error_message -function to get error message for given error code
@@ -402,6 +851,11 @@ gf_log_init (void *data, const char *file, const char *ident)
 
         ctx->log.gf_log_logfile = ctx->log.logfile;
 
+        /* only logging to a file goes through the log writer, stderr
+           ("-" above) is written to right away */
+        ctx->log.async = !ctx->cmd_args.log_sync;
+        ctx->log.rate_limit = ctx->cmd_args.log_rate_limit;
+
         return 0;
 }
 
@@ -672,28 +1126,17 @@ _gf_log_callingfn (const char *domain, const char *file, const char *function,
 
         len = strlen (str1);
         msg = GF_MALLOC (len + strlen (str2) + 1, gf_common_mt_char);
+        if (!msg)
+                goto out;
 
         strcpy (msg, str1);
         strcpy (msg + len, str2);
 
-        pthread_mutex_lock (&ctx->log.logfile_mutex);
-        {
-                if (ctx->log.logfile) {
-                        fprintf (ctx->log.logfile, "%s\n", msg);
-                } else {
-                        fprintf (stderr, "%s\n", msg);
-                }
-
-#ifdef GF_LINUX_HOST_OS
-                /* We want only serious log in 'syslog', not our debug
-                   and trace logs */
-                if (ctx->log.gf_log_syslog && level &&
-                    (level <= ctx->log.sys_log_level))
-                        syslog ((level-1), "%s\n", msg);
-#endif
-        }
-
-        pthread_mutex_unlock (&ctx->log.logfile_mutex);
+        if (gf_log_enqueue (ctx, level, msg, strlen (timestr) + 3,
+                            tv.tv_sec) == 0)
+                msg = NULL;
+        else
+                gf_log_write (ctx, level, msg);
 
 out:
         GF_FREE (msg);
@@ -839,31 +1282,17 @@ log:
 
         len = strlen (str1);
         msg = GF_MALLOC (len + strlen (str2) + 1, gf_common_mt_char);
+        if (!msg)
+                goto err;
 
         strcpy (msg, str1);
         strcpy (msg + len, str2);
 
-        pthread_mutex_lock (&ctx->log.logfile_mutex);
-        {
-
-                if (ctx->log.logfile) {
-                        fprintf (ctx->log.logfile, "%s\n", msg);
-                        fflush (ctx->log.logfile);
-                } else {
-                        fprintf (stderr, "%s\n", msg);
-                        fflush (stderr);
-                }
-
-#ifdef GF_LINUX_HOST_OS
-                /* We want only serious log in 'syslog', not our debug
-                   and trace logs */
-                if (ctx->log.gf_log_syslog && level &&
-                    (level <= ctx->log.sys_log_level))
-                        syslog ((level-1), "%s\n", msg);
-#endif
-        }
-
-        pthread_mutex_unlock (&ctx->log.logfile_mutex);
+        if (gf_log_enqueue (ctx, level, msg, strlen (timestr) + 3,
+                            tv.tv_sec) == 0)
+                msg = NULL;
+        else
+                gf_log_write (ctx, level, msg);
 
 err:
         GF_FREE (msg);
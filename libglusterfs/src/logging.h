@@ -76,6 +76,11 @@ typedef struct gf_log_handle_ {
         FILE            *gf_log_logfile;
         char            *cmd_log_filename;
         FILE            *cmdlogfile;
+        /* messages are queued for the log writer thread instead of being
+           written by the logging thread */
+        int              async;
+        /* most messages a thread may queue in a second, 0 for no limit */
+        uint32_t         rate_limit;
 #ifdef GF_USE_SYSLOG
         int              log_control_file_found;
         char            *ident;
@@ -90,6 +95,9 @@ void gf_log_logrotate (int signum);
 
 void gf_log_cleanup (void);
 
+void gf_log_flush (void);
+void gf_log_dump (void *ctx);
+
 int _gf_log (const char *domain, const char *file,
              const char *function, int32_t line, gf_loglevel_t level,
              const char *fmt, ...)
@@ -274,6 +274,295 @@ free:
 
 
 
+/* Per-thread magazines
+ *
+ * Every thread keeps a small table of magazines, each a stack of free
+ * chunks belonging to one mem_pool. mem_get() and mem_put() are served from
+ * the calling thread's magazine without taking pool->lock. An empty magazine
+ * is refilled, and a full one drained, in batches of GF_MEM_POOL_BATCH
+ * chunks under pool->lock.
+ *
+ * Magazines refer to pools by id. mem_pool_destroy() bumps mem_pool_epoch,
+ * and a thread that notices a new epoch re-validates its magazines against
+ * the registry of live pools before touching any pool other than the one
+ * it was asked for. Chunks cached for a destroyed pool are simply forgotten,
+ * their memory went away with the pool.
+ */
+#define GF_MEM_POOL_MAGAZINES     64
+#define GF_MEM_POOL_MAGAZINE_SIZE 32
+#define GF_MEM_POOL_BATCH         (GF_MEM_POOL_MAGAZINE_SIZE / 2)
+
+struct mem_pool_magazine {
+        struct mem_pool *pool;
+        uint64_t         pool_id;
+        int              count;
+        uint64_t         hits;   /* not yet added to pool->cache_hits */
+        void            *chunks[GF_MEM_POOL_MAGAZINE_SIZE];
+};
+
+struct mem_pool_thread_cache {
+        uint64_t                 epoch;
+        struct mem_pool_magazine mags[GF_MEM_POOL_MAGAZINES];
+};
+
+static pthread_key_t     mem_pool_cache_key;
+static int               mem_pool_cache_key_ok;
+static pthread_once_t    mem_pool_cache_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t   mem_pool_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct list_head  mem_pool_registry = {&mem_pool_registry,
+                                              &mem_pool_registry};
+static uint64_t          mem_pool_next_id = 1;
+static uint64_t          mem_pool_epoch;
+
+
+/* caller holds mem_pool_registry_lock */
+static int
+__mem_pool_is_live (struct mem_pool *pool, uint64_t id)
+{
+        struct mem_pool *trav = NULL;
+
+        list_for_each_entry (trav, &mem_pool_registry, registry_list) {
+                if (trav == pool && trav->id == id)
+                        return 1;
+        }
+
+        return 0;
+}
+
+
+/* caller holds pool->lock */
+static void
+__mem_pool_magazine_flush_stats (struct mem_pool *pool,
+                                 struct mem_pool_magazine *mag)
+{
+        pool->alloc_count += mag->hits;
+        pool->cache_hits += mag->hits;
+        mag->hits = 0;
+}
+
+
+/* returns the chunks of @mag to its pool and empties the magazine.
+   caller holds mem_pool_registry_lock and has checked the pool is live */
+static void
+__mem_pool_magazine_release (struct mem_pool_magazine *mag)
+{
+        struct mem_pool  *pool = mag->pool;
+        struct list_head *list = NULL;
+        int               i = 0;
+
+        LOCK (&pool->lock);
+        {
+                for (i = 0; i < mag->count; i++) {
+                        list = mem_pool_ptr2chunkhead (mag->chunks[i]);
+                        list_add (list, &pool->list);
+                }
+                pool->hot_count -= mag->count;
+                pool->cold_count += mag->count;
+                __mem_pool_magazine_flush_stats (pool, mag);
+        }
+        UNLOCK (&pool->lock);
+
+        memset (mag, 0, sizeof (*mag));
+}
+
+
+/* forget magazines of pools destroyed since the last check.
+   caller holds mem_pool_registry_lock */
+static void
+__mem_pool_cache_validate (struct mem_pool_thread_cache *cache)
+{
+        struct mem_pool_magazine *mag = NULL;
+        int                       i = 0;
+
+        if (cache->epoch == mem_pool_epoch)
+                return;
+
+        for (i = 0; i < GF_MEM_POOL_MAGAZINES; i++) {
+                mag = &cache->mags[i];
+                if (!mag->pool_id)
+                        continue;
+
+                if (!__mem_pool_is_live (mag->pool, mag->pool_id))
+                        memset (mag, 0, sizeof (*mag));
+        }
+
+        cache->epoch = mem_pool_epoch;
+}
+
+
+static void
+mem_pool_cache_destroy (void *data)
+{
+        struct mem_pool_thread_cache *cache = data;
+        int                           i = 0;
+
+        if (!cache)
+                return;
+
+        pthread_mutex_lock (&mem_pool_registry_lock);
+        {
+                __mem_pool_cache_validate (cache);
+
+                for (i = 0; i < GF_MEM_POOL_MAGAZINES; i++) {
+                        if (cache->mags[i].pool_id)
+                                __mem_pool_magazine_release (&cache->mags[i]);
+                }
+        }
+        pthread_mutex_unlock (&mem_pool_registry_lock);
+
+        FREE (cache);
+}
+
+
+static void
+mem_pool_cache_key_init (void)
+{
+        if (pthread_key_create (&mem_pool_cache_key, mem_pool_cache_destroy))
+                gf_log ("mem-pool", GF_LOG_WARNING, "failed to create thread "
+                        "key, per-thread magazines are disabled");
+        else
+                mem_pool_cache_key_ok = 1;
+}
+
+
+static struct mem_pool_thread_cache *
+mem_pool_thread_cache_get (void)
+{
+        struct mem_pool_thread_cache *cache = NULL;
+
+        pthread_once (&mem_pool_cache_once, mem_pool_cache_key_init);
+        if (!mem_pool_cache_key_ok)
+                return NULL;
+
+        cache = pthread_getspecific (mem_pool_cache_key);
+        if (cache)
+                return cache;
+
+        cache = CALLOC (1, sizeof (*cache));
+        if (!cache)
+                return NULL;
+
+        pthread_mutex_lock (&mem_pool_registry_lock);
+        {
+                cache->epoch = mem_pool_epoch;
+        }
+        pthread_mutex_unlock (&mem_pool_registry_lock);
+
+        if (pthread_setspecific (mem_pool_cache_key, cache)) {
+                FREE (cache);
+                return NULL;
+        }
+
+        return cache;
+}
+
+
+/* Returns the calling thread's magazine for @pool, or NULL if the pool
+   has to be used directly. Two slots are probed; when both belong to other
+   pools the second one is handed over to @pool.
+*/
+static struct mem_pool_magazine *
+mem_pool_magazine_get (struct mem_pool *pool)
+{
+        struct mem_pool_thread_cache *cache = NULL;
+        struct mem_pool_magazine     *mag = NULL;
+        struct mem_pool_magazine     *victim = NULL;
+        int                           slot = 0;
+
+        cache = mem_pool_thread_cache_get ();
+        if (!cache)
+                return NULL;
+
+        slot = pool->id % GF_MEM_POOL_MAGAZINES;
+
+        mag = &cache->mags[slot];
+        if (mag->pool_id == pool->id)
+                return mag;
+        if (!mag->pool_id)
+                victim = mag;
+
+        mag = &cache->mags[(slot + 1) % GF_MEM_POOL_MAGAZINES];
+        if (mag->pool_id == pool->id)
+                return mag;
+        if (!victim)
+                victim = mag;
+
+        if (victim->pool_id) {
+                pthread_mutex_lock (&mem_pool_registry_lock);
+                {
+                        __mem_pool_cache_validate (cache);
+                        if (victim->pool_id)
+                                __mem_pool_magazine_release (victim);
+                }
+                pthread_mutex_unlock (&mem_pool_registry_lock);
+        }
+
+        victim->pool = pool;
+        victim->pool_id = pool->id;
+
+        return victim;
+}
+
+
+/* moves up to GF_MEM_POOL_BATCH cold chunks into @mag.
+   caller holds pool->lock */
+static void
+__mem_pool_magazine_refill (struct mem_pool *pool,
+                            struct mem_pool_magazine *mag)
+{
+        struct list_head *list = NULL;
+
+        pool->cache_misses++;
+        __mem_pool_magazine_flush_stats (pool, mag);
+
+        if (!pool->cold_count)
+                return;
+
+        pool->cache_refills++;
+
+        while (pool->cold_count && mag->count < GF_MEM_POOL_BATCH) {
+                list = pool->list.next;
+                list_del (list);
+
+                pool->hot_count++;
+                pool->cold_count--;
+
+                mag->chunks[mag->count++] =
+                        mem_pool_chunkhead2ptr ((void *)list);
+        }
+
+        if (pool->max_alloc < pool->hot_count)
+                pool->max_alloc = pool->hot_count;
+}
+
+
+/* returns the older half of a full magazine to the pool */
+static void
+mem_pool_magazine_drain (struct mem_pool *pool, struct mem_pool_magazine *mag)
+{
+        struct list_head *list = NULL;
+        int               i = 0;
+
+        LOCK (&pool->lock);
+        {
+                pool->cache_drains++;
+                __mem_pool_magazine_flush_stats (pool, mag);
+
+                for (i = 0; i < GF_MEM_POOL_BATCH; i++) {
+                        list = mem_pool_ptr2chunkhead (mag->chunks[i]);
+                        list_add (list, &pool->list);
+                }
+                pool->hot_count -= GF_MEM_POOL_BATCH;
+                pool->cold_count += GF_MEM_POOL_BATCH;
+        }
+        UNLOCK (&pool->lock);
+
+        memmove (&mag->chunks[0], &mag->chunks[GF_MEM_POOL_BATCH],
+                 (mag->count - GF_MEM_POOL_BATCH) * sizeof (void *));
+        mag->count -= GF_MEM_POOL_BATCH;
+}
+
+
 struct mem_pool *
 mem_pool_new_fn (unsigned long sizeof_type,
                  unsigned long count, char *name)
@@ -308,6 +597,7 @@ mem_pool_new_fn (unsigned long sizeof_type,
         LOCK_INIT (&mem_pool->lock);
         INIT_LIST_HEAD (&mem_pool->list);
         INIT_LIST_HEAD (&mem_pool->global_list);
+        INIT_LIST_HEAD (&mem_pool->registry_list);
 
         mem_pool->padded_sizeof_type = padded_sizeof_type;
         mem_pool->cold_count = count;
@@ -329,14 +619,20 @@ mem_pool_new_fn (unsigned long sizeof_type,
         mem_pool->pool = pool;
         mem_pool->pool_end = pool + (count * (padded_sizeof_type));
 
-        /* add this pool to the global list */
+        /* add this pool to the global list; translators of a graph are
+           initialized concurrently, so the list is updated under the
+           registry lock */
         ctx = THIS->ctx;
-        if (!ctx)
-                goto out;
 
-        list_add (&mem_pool->global_list, &ctx->mempool_list);
+        pthread_mutex_lock (&mem_pool_registry_lock);
+        {
+                mem_pool->id = mem_pool_next_id++;
+                list_add (&mem_pool->registry_list, &mem_pool_registry);
+                if (ctx)
+                        list_add (&mem_pool->global_list, &ctx->mempool_list);
+        }
+        pthread_mutex_unlock (&mem_pool_registry_lock);
 
-out:
         return mem_pool;
 }
 
@@ -361,19 +657,44 @@ mem_get0 (struct mem_pool *mem_pool)
 void *
 mem_get (struct mem_pool *mem_pool)
 {
-        struct list_head *list = NULL;
-        void             *ptr = NULL;
-        int             *in_use = NULL;
-        struct mem_pool **pool_ptr = NULL;
+        struct list_head         *list = NULL;
+        void                     *ptr = NULL;
+        int                      *in_use = NULL;
+        struct mem_pool         **pool_ptr = NULL;
+        struct mem_pool_magazine *mag = NULL;
 
         if (!mem_pool) {
                 gf_log_callingfn ("mem-pool", GF_LOG_ERROR, "invalid argument");
                 return NULL;
         }
 
+        mag = mem_pool_magazine_get (mem_pool);
+        if (mag && mag->count) {
+                mag->hits++;
+                ptr = mem_pool_ptr2chunkhead (mag->chunks[--mag->count]);
+                in_use = (ptr + GF_MEM_POOL_LIST_BOUNDARY + GF_MEM_POOL_PTR);
+                *in_use = 1;
+
+                pool_ptr = mem_pool_from_ptr (ptr);
+                *pool_ptr = (struct mem_pool *)mem_pool;
+                return mem_pool_chunkhead2ptr (ptr);
+        }
+
         LOCK (&mem_pool->lock);
         {
+                if (mag)
+                        __mem_pool_magazine_refill (mem_pool, mag);
+
                 mem_pool->alloc_count++;
+                if (mag && mag->count) {
+                        ptr = mem_pool_ptr2chunkhead (mag->chunks[--mag->count]);
+                        in_use = (ptr + GF_MEM_POOL_LIST_BOUNDARY +
+                                  GF_MEM_POOL_PTR);
+                        *in_use = 1;
+
+                        goto fwd_addr_out;
+                }
+
                 if (mem_pool->cold_count) {
                         list = mem_pool->list.next;
                         list_del (list);
@@ -461,6 +782,7 @@ mem_put (void *ptr)
         void   *head = NULL;
         struct mem_pool **tmp = NULL;
         struct mem_pool *pool = NULL;
+        struct mem_pool_magazine *mag = NULL;
 
         if (!ptr) {
                 gf_log_callingfn ("mem-pool", GF_LOG_ERROR, "invalid argument");
@@ -481,6 +803,21 @@ mem_put (void *ptr)
                                   "mem-pool ptr is NULL");
                 return;
         }
+
+        /* the slab bounds never change, no lock needed to check them */
+        if (__is_member (pool, ptr) == 1) {
+                in_use = (head + GF_MEM_POOL_LIST_BOUNDARY + GF_MEM_POOL_PTR);
+                mag = is_mem_chunk_in_use (in_use) ?
+                        mem_pool_magazine_get (pool) : NULL;
+                if (mag) {
+                        *in_use = 0;
+                        if (mag->count == GF_MEM_POOL_MAGAZINE_SIZE)
+                                mem_pool_magazine_drain (pool, mag);
+                        mag->chunks[mag->count++] = ptr;
+                        return;
+                }
+        }
+
         LOCK (&pool->lock);
         {
 
@@ -538,7 +875,13 @@ mem_pool_destroy (struct mem_pool *pool)
         gf_log (THIS->name, GF_LOG_INFO, "size=%lu max=%d total=%"PRIu64,
                 pool->padded_sizeof_type, pool->max_alloc, pool->alloc_count);
 
-        list_del (&pool->global_list);
+        pthread_mutex_lock (&mem_pool_registry_lock);
+        {
+                list_del (&pool->global_list);
+                list_del_init (&pool->registry_list);
+                mem_pool_epoch++;
+        }
+        pthread_mutex_unlock (&mem_pool_registry_lock);
 
         LOCK_DESTROY (&pool->lock);
         GF_FREE (pool->name);
@@ -178,6 +178,14 @@ struct mem_pool {
         int               max_stdalloc;
         char             *name;
         struct list_head  global_list;
+
+        /* per-thread magazines, see mem_pool_magazine_get() */
+        uint64_t          id;
+        struct list_head  registry_list;
+        uint64_t          cache_hits;
+        uint64_t          cache_misses;
+        uint64_t          cache_refills;
+        uint64_t          cache_drains;
 };
 
 struct mem_pool *
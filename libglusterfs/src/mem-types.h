@@ -117,6 +117,17 @@ enum gf_common_mem_types_ {
         gf_common_mt_locker               = 101,
         gf_common_mt_auxgids              = 102,
         gf_common_mt_syncopctx            = 103,
-        gf_common_mt_end                  = 104
+        gf_common_mt_dict_index_t         = 104,
+        gf_common_mt_log_ring_t           = 105,
+        gf_common_mt_latency_hist_t       = 106,
+        gf_common_mt_gid_cache_t          = 107,
+        gf_common_mt_chash_table_t        = 108,
+        gf_common_mt_chash_stripe         = 109,
+        gf_common_mt_chash_slots          = 110,
+        gf_common_mt_metrics_buf          = 111,
+        gf_common_mt_metrics_listener     = 112,
+        gf_common_mt_graph_init           = 113,
+        gf_common_mt_socket_rbuf          = 114,
+        gf_common_mt_end                  = 115
 };
 #endif
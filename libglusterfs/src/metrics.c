@@ -0,0 +1,473 @@
+/*
+  Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "stack.h"
+#include "iobuf.h"
+#include "inode.h"
+#include "latency.h"
+#include "common-utils.h"
+#include "metrics.h"
+
+#define GF_METRICS_INITIAL_SIZE 16384
+/* seconds a client gets to read a whole snapshot */
+#define GF_METRICS_CLIENT_TIMEOUT 5
+
+static int
+gf_metrics_reserve (gf_metrics_t *m, size_t len)
+{
+        char   *buf  = NULL;
+        size_t  size = 0;
+
+        if (m->failed)
+                return -1;
+
+        if (m->len + len < m->size)
+                return 0;
+
+        size = m->size ? m->size : GF_METRICS_INITIAL_SIZE;
+        while (m->len + len >= size)
+                size *= 2;
+
+        if (m->buf)
+                buf = GF_REALLOC (m->buf, size);
+        else
+                buf = GF_MALLOC (size, gf_common_mt_metrics_buf);
+        if (!buf) {
+                m->failed = 1;
+                return -1;
+        }
+
+        m->buf = buf;
+        m->size = size;
+
+        return 0;
+}
+
+static void
+gf_metrics_append (gf_metrics_t *m, const char *str, size_t len)
+{
+        if (gf_metrics_reserve (m, len))
+                return;
+
+        memcpy (m->buf + m->len, str, len);
+        m->len += len;
+        m->buf[m->len] = '\0';
+}
+
+static void
+gf_metrics_quote (gf_metrics_t *m, const char *str)
+{
+        char         esc[8];
+        const char  *p = NULL;
+
+        gf_metrics_append (m, "\"", 1);
+        for (p = str; *p; p++) {
+                if (*p == '"' || *p == '\\') {
+                        esc[0] = '\\';
+                        esc[1] = *p;
+                        gf_metrics_append (m, esc, 2);
+                } else if ((unsigned char) *p < 0x20) {
+                        snprintf (esc, sizeof (esc), "\\u%04x",
+                                  (unsigned char) *p);
+                        gf_metrics_append (m, esc, 6);
+                } else {
+                        gf_metrics_append (m, p, 1);
+                }
+        }
+        gf_metrics_append (m, "\"", 1);
+}
+
+/* separator and "key": for the next member, nothing but the separator for
+   a list element */
+static void
+gf_metrics_key (gf_metrics_t *m, const char *key)
+{
+        if (m->comma)
+                gf_metrics_append (m, ",", 1);
+        m->comma = 1;
+
+        if (!key)
+                return;
+
+        gf_metrics_quote (m, key);
+        gf_metrics_append (m, ":", 1);
+}
+
+void
+gf_metrics_begin (gf_metrics_t *m, const char *key)
+{
+        gf_metrics_key (m, key);
+        gf_metrics_append (m, "{", 1);
+        m->comma = 0;
+}
+
+void
+gf_metrics_end (gf_metrics_t *m)
+{
+        gf_metrics_append (m, "}", 1);
+        m->comma = 1;
+}
+
+void
+gf_metrics_begin_list (gf_metrics_t *m, const char *key)
+{
+        gf_metrics_key (m, key);
+        gf_metrics_append (m, "[", 1);
+        m->comma = 0;
+}
+
+void
+gf_metrics_end_list (gf_metrics_t *m)
+{
+        gf_metrics_append (m, "]", 1);
+        m->comma = 1;
+}
+
+void
+gf_metrics_uint (gf_metrics_t *m, const char *key, uint64_t value)
+{
+        char num[32];
+        int  len = 0;
+
+        gf_metrics_key (m, key);
+        len = snprintf (num, sizeof (num), "%"PRIu64, value);
+        gf_metrics_append (m, num, len);
+}
+
+void
+gf_metrics_int (gf_metrics_t *m, const char *key, int64_t value)
+{
+        char num[32];
+        int  len = 0;
+
+        gf_metrics_key (m, key);
+        len = snprintf (num, sizeof (num), "%"PRId64, value);
+        gf_metrics_append (m, num, len);
+}
+
+void
+gf_metrics_str (gf_metrics_t *m, const char *key, const char *value)
+{
+        gf_metrics_key (m, key);
+        if (value)
+                gf_metrics_quote (m, value);
+        else
+                gf_metrics_append (m, "null", 4);
+}
+
+void
+gf_metrics_release (gf_metrics_t *m)
+{
+        GF_FREE (m->buf);
+        memset (m, 0, sizeof (*m));
+}
+
+static void
+gf_metrics_mempools (glusterfs_ctx_t *ctx, gf_metrics_t *m)
+{
+        struct mem_pool *pool = NULL;
+
+        gf_metrics_begin_list (m, "mempools");
+        list_for_each_entry (pool, &ctx->mempool_list, global_list) {
+                gf_metrics_begin (m, NULL);
+                gf_metrics_str (m, "name", pool->name);
+                gf_metrics_int (m, "hot", pool->hot_count);
+                gf_metrics_int (m, "cold", pool->cold_count);
+                gf_metrics_uint (m, "padded_sizeof", pool->padded_sizeof_type);
+                gf_metrics_uint (m, "alloc", pool->alloc_count);
+                gf_metrics_int (m, "max_alloc", pool->max_alloc);
+                gf_metrics_uint (m, "misses", pool->pool_misses);
+                gf_metrics_int (m, "stdalloc", pool->curr_stdalloc);
+                gf_metrics_int (m, "max_stdalloc", pool->max_stdalloc);
+                gf_metrics_uint (m, "cache_hits", pool->cache_hits);
+                gf_metrics_uint (m, "cache_misses", pool->cache_misses);
+                gf_metrics_uint (m, "cache_refills", pool->cache_refills);
+                gf_metrics_uint (m, "cache_drains", pool->cache_drains);
+                gf_metrics_end (m);
+        }
+        gf_metrics_end_list (m);
+}
+
+static void
+gf_metrics_callpool (glusterfs_ctx_t *ctx, gf_metrics_t *m)
+{
+        call_pool_t *pool = ctx->pool;
+
+        if (!pool)
+                return;
+
+        gf_metrics_begin (m, "callpool");
+        gf_metrics_int (m, "stacks", pool->cnt);
+        gf_metrics_uint (m, "stacks_done", pool->stacks_done);
+        gf_metrics_uint (m, "frames_wound", pool->frames_wound);
+        gf_metrics_uint (m, "frames_spilled", pool->frames_spilled);
+        gf_metrics_end (m);
+}
+
+static void
+gf_metrics_fops (xlator_t *xl, gf_metrics_t *m)
+{
+        gf_latency_hist_t hist;
+        int               i = 0;
+
+        gf_metrics_begin (m, "fops");
+        for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+                if (!xl->latencies[i].count)
+                        continue;
+
+                memset (&hist, 0, sizeof (hist));
+                if (xl->latency_hist)
+                        gf_latency_hist_snapshot (&xl->latency_hist[i], &hist,
+                                                  0);
+
+                gf_metrics_begin (m, gf_fop_list[i]);
+                gf_metrics_uint (m, "count", xl->latencies[i].count);
+                gf_metrics_uint (m, "total_us", xl->latencies[i].total);
+                gf_metrics_uint (m, "min_us", xl->latencies[i].min);
+                gf_metrics_uint (m, "max_us", xl->latencies[i].max);
+                gf_metrics_uint (m, "p50_us",
+                                 gf_latency_hist_percentile (&hist, 50));
+                gf_metrics_uint (m, "p99_us",
+                                 gf_latency_hist_percentile (&hist, 99));
+                gf_metrics_end (m);
+        }
+        gf_metrics_end (m);
+}
+
+static void
+gf_metrics_xlator (xlator_t *xl, gf_metrics_t *m)
+{
+        gf_metrics_begin (m, NULL);
+        gf_metrics_str (m, "name", xl->name);
+        gf_metrics_str (m, "type", xl->type);
+
+        if (xl->ctx->measure_latency)
+                gf_metrics_fops (xl, m);
+
+        if (xl->itable)
+                inode_table_metrics (xl->itable, m);
+
+        if (xl->dumpops && xl->dumpops->metrics)
+                xl->dumpops->metrics (xl, m);
+
+        gf_metrics_end (m);
+}
+
+int
+gf_metrics_snapshot (glusterfs_ctx_t *ctx, gf_metrics_t *m)
+{
+        xlator_t *trav = NULL;
+
+        memset (m, 0, sizeof (*m));
+
+        gf_metrics_begin (m, NULL);
+        gf_metrics_int (m, "version", GF_METRICS_VERSION);
+        gf_metrics_int (m, "pid", getpid ());
+        gf_metrics_int (m, "time", time (NULL));
+        gf_metrics_str (m, "volfile_id", ctx->cmd_args.volfile_id);
+        gf_metrics_str (m, "brick", ctx->cmd_args.brick_name);
+        gf_metrics_int (m, "measure_latency", ctx->measure_latency);
+
+        gf_metrics_mempools (ctx, m);
+        if (ctx->iobuf_pool)
+                iobuf_stats_metrics (ctx->iobuf_pool, m);
+        gf_metrics_callpool (ctx, m);
+
+        if (ctx->active)
+                gf_metrics_int (m, "graph_id", ctx->graph_id);
+
+        gf_metrics_begin_list (m, "xlators");
+        if (ctx->master)
+                gf_metrics_xlator (ctx->master, m);
+        if (ctx->active) {
+                for (trav = ctx->active->first; trav; trav = trav->next)
+                        gf_metrics_xlator (trav, m);
+        }
+        gf_metrics_end_list (m);
+        gf_metrics_end (m);
+
+        gf_metrics_append (m, "\n", 1);
+
+        return m->failed ? -1 : 0;
+}
+
+struct gf_metrics_listener {
+        glusterfs_ctx_t *ctx;
+        int              sock;
+};
+
+/*
+ * The listener serves one client at a time, so a client that stops reading
+ * must not hold it up: the fd is non-blocking and the whole snapshot has to
+ * be read within GF_METRICS_CLIENT_TIMEOUT, or the client is dropped.
+ */
+static int
+gf_metrics_send (int fd, const char *buf, size_t len)
+{
+        struct timespec now      = {0, };
+        struct pollfd   pfd      = {0, };
+        long            deadline = 0;
+        long            left     = 0;
+        size_t          done     = 0;
+        ssize_t         ret      = 0;
+
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        deadline = now.tv_sec * 1000 + now.tv_nsec / 1000000 +
+                   GF_METRICS_CLIENT_TIMEOUT * 1000;
+
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+
+        while (done < len) {
+                ret = write (fd, buf + done, len - done);
+                if (ret > 0) {
+                        done += ret;
+                        continue;
+                }
+                if (ret < 0 && errno == EINTR)
+                        continue;
+                if (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+                        return -1;
+
+                clock_gettime (CLOCK_MONOTONIC, &now);
+                left = deadline - (now.tv_sec * 1000 + now.tv_nsec / 1000000);
+                if (left <= 0)
+                        goto slow;
+                ret = poll (&pfd, 1, left);
+                if (ret == 0)
+                        goto slow;
+                if (ret < 0 && errno != EINTR)
+                        return -1;
+        }
+
+        return 0;
+
+slow:
+        gf_log ("metrics", GF_LOG_WARNING,
+                "metrics client did not read %zu bytes in %d seconds, "
+                "closing it", len - done, GF_METRICS_CLIENT_TIMEOUT);
+        return -1;
+}
+
+static void *
+gf_metrics_serve (void *data)
+{
+        struct gf_metrics_listener *listener = data;
+        gf_metrics_t                m        = {0, };
+        int                         fd       = -1;
+
+        for (;;) {
+                fd = accept (listener->sock, NULL, NULL);
+                if (fd < 0) {
+                        if (errno == EINTR || errno == ECONNABORTED)
+                                continue;
+                        /* the connection stays pending until an fd is
+                           freed, don't spin on it */
+                        if (errno == EMFILE || errno == ENFILE) {
+                                usleep (100000);
+                                continue;
+                        }
+                        gf_log ("metrics", GF_LOG_ERROR,
+                                "accept on metrics socket failed: %s",
+                                strerror (errno));
+                        break;
+                }
+
+                if (fcntl (fd, F_SETFL, O_NONBLOCK) < 0) {
+                        close (fd);
+                        continue;
+                }
+
+                if (gf_metrics_snapshot (listener->ctx, &m) == 0)
+                        gf_metrics_send (fd, m.buf, m.len);
+                gf_metrics_release (&m);
+
+                close (fd);
+        }
+
+        close (listener->sock);
+        GF_FREE (listener);
+
+        return NULL;
+}
+
+int
+gf_metrics_listen (glusterfs_ctx_t *ctx, const char *path)
+{
+        struct gf_metrics_listener *listener = NULL;
+        struct sockaddr_un          addr     = {0, };
+        pthread_t                   thread;
+        int                         sock     = -1;
+        int                         ret      = -1;
+
+        if (strlen (path) >= sizeof (addr.sun_path)) {
+                gf_log ("metrics", GF_LOG_ERROR,
+                        "metrics socket path %s is too long", path);
+                goto out;
+        }
+
+        listener = GF_CALLOC (1, sizeof (*listener),
+                              gf_common_mt_metrics_listener);
+        if (!listener)
+                goto out;
+
+        sock = socket (AF_UNIX, SOCK_STREAM, 0);
+        if (sock < 0) {
+                gf_log ("metrics", GF_LOG_ERROR,
+                        "could not create metrics socket: %s",
+                        strerror (errno));
+                goto out;
+        }
+        fcntl (sock, F_SETFD, FD_CLOEXEC);
+
+        addr.sun_family = AF_UNIX;
+        strcpy (addr.sun_path, path);
+        unlink (path);
+
+        ret = bind (sock, (struct sockaddr *)&addr, sizeof (addr));
+        if (ret == 0)
+                ret = listen (sock, 16);
+        if (ret) {
+                gf_log ("metrics", GF_LOG_ERROR,
+                        "could not listen on metrics socket %s: %s", path,
+                        strerror (errno));
+                goto out;
+        }
+
+        listener->ctx = ctx;
+        listener->sock = sock;
+
+        ret = gf_thread_create (&thread, NULL, gf_metrics_serve, listener);
+        if (ret) {
+                gf_log ("metrics", GF_LOG_ERROR,
+                        "could not start metrics thread: %s", strerror (ret));
+                ret = -1;
+                goto out;
+        }
+        pthread_detach (thread);
+
+        gf_log ("metrics", GF_LOG_INFO, "serving metrics on %s", path);
+
+        return 0;
+out:
+        if (sock >= 0)
+                close (sock);
+        GF_FREE (listener);
+
+        return ret;
+}
@@ -0,0 +1,75 @@
+/*
+  Copyright (c) 2013 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include "glusterfs.h"
+#include "inode.h"
+
+/*
+ * Counters-only snapshot of a process as one JSON object: mempools, the
+ * iobuf pool, the call pool and, per translator of the active graph, fop
+ * latencies, inode table sizes and whatever the translator's
+ * dumpops->metrics adds.  Unlike a statedump it takes no dump lock, walks
+ * no inode or fd lists and needs no signal, so it is cheap enough to be
+ * scraped often.  The snapshot is written to every connection accepted on
+ * the socket given with --metrics-socket, which is then closed.
+ *
+ * Values are read without locking and are only approximately consistent
+ * with each other.  Fop counters are those of statedump and are reset by
+ * it.
+ */
+
+#define GF_METRICS_VERSION 1
+
+typedef struct gf_metrics {
+        char    *buf;
+        size_t   len;
+        size_t   size;
+        int      comma;   /* the next member needs a separator */
+        int      failed;  /* out of memory, the snapshot is incomplete */
+} gf_metrics_t;
+
+/* a NULL key adds an element to the enclosing list */
+void
+gf_metrics_begin (gf_metrics_t *m, const char *key);
+
+void
+gf_metrics_end (gf_metrics_t *m);
+
+void
+gf_metrics_begin_list (gf_metrics_t *m, const char *key);
+
+void
+gf_metrics_end_list (gf_metrics_t *m);
+
+void
+gf_metrics_uint (gf_metrics_t *m, const char *key, uint64_t value);
+
+void
+gf_metrics_int (gf_metrics_t *m, const char *key, int64_t value);
+
+void
+gf_metrics_str (gf_metrics_t *m, const char *key, const char *value);
+
+int
+gf_metrics_snapshot (glusterfs_ctx_t *ctx, gf_metrics_t *m);
+
+void
+gf_metrics_release (gf_metrics_t *m);
+
+int
+gf_metrics_listen (glusterfs_ctx_t *ctx, const char *path);
+
+void
+inode_table_metrics (inode_table_t *itable, gf_metrics_t *m);
+
+#endif /* __METRICS_H__ */
@@ -35,9 +35,11 @@ create_frame (xlator_t *xl, call_pool_t *pool)
                 return NULL;
         }
 
-        stack = mem_get0 (pool->stack_mem_pool);
+        stack = mem_get (pool->stack_mem_pool);
         if (!stack)
                 return NULL;
+        /* slab frames are zeroed as they are handed out */
+        memset (stack, 0, offsetof (call_stack_t, frame_slab));
 
         stack->pool = pool;
         stack->frames.root = stack;
@@ -206,6 +208,12 @@ gf_proc_dump_pending_frames (call_pool_t *call_pool)
         section_added = _gf_true;
         gf_proc_dump_write("callpool_address","%p", call_pool);
         gf_proc_dump_write("callpool.cnt","%d", call_pool->cnt);
+        gf_proc_dump_write("callpool.stacks_done", "%"PRIu64,
+                           call_pool->stacks_done);
+        gf_proc_dump_write("callpool.frames_wound", "%"PRIu64,
+                           call_pool->frames_wound);
+        gf_proc_dump_write("callpool.frames_spilled", "%"PRIu64,
+                           call_pool->frames_spilled);
 
 
         list_for_each_entry (trav, &call_pool->all_frames, all_frames) {
@@ -59,6 +59,11 @@ struct call_pool {
         gf_lock_t                   lock;
         struct mem_pool             *frame_mem_pool;
         struct mem_pool             *stack_mem_pool;
+
+        /* totals of destroyed stacks, guarded by @lock */
+        uint64_t                    stacks_done;
+        uint64_t                    frames_wound;
+        uint64_t                    frames_spilled; /* from frame_mem_pool */
 };
 
 struct _call_frame_t {
@@ -85,6 +90,9 @@ struct _call_frame_t {
 
 #define SMALL_GROUP_COUNT 128
 
+/* frames carved from the stack itself before falling back to the pool */
+#define CALL_STACK_FRAME_SLAB 16
+
 struct _call_stack_t {
         union {
                 struct list_head      all_frames;
@@ -113,6 +121,14 @@ struct _call_stack_t {
         int32_t                       op;
         int8_t                        type;
         struct timeval                tv;
+
+        uint32_t                      frames_carved;  /* slab, until reset */
+        uint32_t                      frames_spilled; /* from the pool */
+        int32_t                       frame_slab_used;
+
+        /* must stay last: only the members above are zeroed on allocation,
+           each slab frame is zeroed when it is handed out */
+        call_frame_t                  frame_slab[CALL_STACK_FRAME_SLAB];
 };
 
 
@@ -134,6 +150,53 @@ gf_latency_begin (call_frame_t *frame, void *fn);
 void
 gf_latency_end (call_frame_t *frame);
 
+/* Hand out the next frame of @stack's slab, or one from the frame pool once
+ * the slab is used up. Slab frames are released with the stack. */
+static inline call_frame_t *
+call_stack_frame_get (call_stack_t *stack)
+{
+        call_frame_t *frame = NULL;
+        int32_t       slot = CALL_STACK_FRAME_SLAB;
+
+        if (stack->frame_slab_used < CALL_STACK_FRAME_SLAB)
+                slot = __sync_fetch_and_add (&stack->frame_slab_used, 1);
+
+        if (slot < CALL_STACK_FRAME_SLAB) {
+                frame = &stack->frame_slab[slot];
+                memset (frame, 0, sizeof (*frame));
+                return frame;
+        }
+
+        frame = mem_get0 (stack->pool->frame_mem_pool);
+        if (frame)
+                __sync_fetch_and_add (&stack->frames_spilled, 1);
+
+        return frame;
+}
+
+static inline gf_boolean_t
+__frame_in_slab (call_frame_t *frame)
+{
+        call_stack_t *stack = frame->root;
+
+        return (frame >= stack->frame_slab &&
+                frame < stack->frame_slab + CALL_STACK_FRAME_SLAB);
+}
+
+/* account for the slab frames handed out so far and rewind the slab;
+   no frame of @stack may be in use */
+static inline void
+__call_stack_frames_tally (call_stack_t *stack)
+{
+        int32_t used = stack->frame_slab_used;
+
+        if (used > CALL_STACK_FRAME_SLAB)
+                used = CALL_STACK_FRAME_SLAB;
+
+        stack->frames_carved += used;
+        stack->frame_slab_used = 0;
+}
+
 static inline void
 FRAME_DESTROY (call_frame_t *frame)
 {
@@ -149,7 +212,8 @@ FRAME_DESTROY (call_frame_t *frame)
         }
 
         LOCK_DESTROY (&frame->lock);
-        mem_put (frame);
+        if (!__frame_in_slab (frame))
+                mem_put (frame);
 
         if (local)
                 mem_put (local);
@@ -161,10 +225,17 @@ STACK_DESTROY (call_stack_t *stack)
 {
         void *local = NULL;
 
+        __call_stack_frames_tally (stack);
+
         LOCK (&stack->pool->lock);
         {
                 list_del_init (&stack->all_frames);
                 stack->pool->cnt--;
+
+                stack->pool->stacks_done++;
+                stack->pool->frames_wound += stack->frames_carved +
+                                             stack->frames_spilled;
+                stack->pool->frames_spilled += stack->frames_spilled;
         }
         UNLOCK (&stack->pool->lock);
 
@@ -202,6 +273,8 @@ STACK_RESET (call_stack_t *stack)
                 FRAME_DESTROY (stack->frames.next);
         }
 
+        __call_stack_frames_tally (stack);
+
         if (local)
                 mem_put (local);
 }
@@ -231,7 +304,7 @@ STACK_RESET (call_stack_t *stack)
                 call_frame_t *_new = NULL;                              \
                 xlator_t     *old_THIS = NULL;                          \
                                                                         \
-                _new = mem_get0 (frame->root->pool->frame_mem_pool);    \
+                _new = call_stack_frame_get (frame->root);              \
                 if (!_new) {                                            \
                         gf_log ("stack", GF_LOG_ERROR, "alloc failed"); \
                         break;                                          \
@@ -286,7 +359,7 @@ STACK_RESET (call_stack_t *stack)
                 call_frame_t *_new = NULL;                              \
                 xlator_t     *old_THIS = NULL;                          \
                                                                         \
-                _new = mem_get0 (frame->root->pool->frame_mem_pool);    \
+                _new = call_stack_frame_get (frame->root);              \
                 if (!_new) {                                            \
                         gf_log ("stack", GF_LOG_ERROR, "alloc failed"); \
                         break;                                          \
@@ -406,10 +479,11 @@ copy_frame (call_frame_t *frame)
                 return NULL;
         }
 
-        newstack = mem_get0 (frame->root->pool->stack_mem_pool);
+        newstack = mem_get (frame->root->pool->stack_mem_pool);
         if (newstack == NULL) {
                 return NULL;
         }
+        memset (newstack, 0, offsetof (call_stack_t, frame_slab));
 
         oldstack = frame->root;
 
@@ -15,6 +15,8 @@
 #include "statedump.h"
 #include "stack.h"
 #include "common-utils.h"
+#include "event.h"
+#include "syncop.h"
 
 #ifdef HAVE_MALLOC_H
 #include <malloc.h>
@@ -333,6 +335,13 @@ gf_proc_dump_mempool_info (glusterfs_ctx_t *ctx)
 
                 gf_proc_dump_write ("pool-misses", "%"PRIu64, pool->pool_misses);
                 gf_proc_dump_write ("max-stdalloc", "%d", pool->max_stdalloc);
+                gf_proc_dump_write ("cache-hits", "%"PRIu64, pool->cache_hits);
+                gf_proc_dump_write ("cache-misses", "%"PRIu64,
+                                    pool->cache_misses);
+                gf_proc_dump_write ("cache-refills", "%"PRIu64,
+                                    pool->cache_refills);
+                gf_proc_dump_write ("cache-drains", "%"PRIu64,
+                                    pool->cache_drains);
         }
 }
 
@@ -762,6 +771,9 @@ gf_proc_dump_info (int signum, glusterfs_ctx_t *ctx)
 
         if (GF_PROC_DUMP_IS_OPTION_ENABLED (iobuf))
                 iobuf_stats_dump (ctx->iobuf_pool);
+        event_pool_dump (ctx->event_pool);
+        gf_log_dump (ctx);
+        syncenv_dump (ctx->env);
         if (GF_PROC_DUMP_IS_OPTION_ENABLED (callpool))
                 gf_proc_dump_pending_frames (ctx->pool);
 
@@ -14,6 +14,7 @@
 #endif
 
 #include "syncop.h"
+#include "statedump.h"
 
 int
 syncopctx_setfsuid (void *uid)
@@ -169,12 +170,15 @@ out:
 	return ret;
 }
 
+/* caller holds task->proc->lock */
 static void
 __run (struct synctask *task)
 {
-        struct syncenv *env = NULL;
+        struct syncenv  *env = NULL;
+        struct syncproc *proc = NULL;
 
         env = task->env;
+        proc = task->proc;
 
         list_del_init (&task->all_tasks);
         switch (task->state) {
@@ -184,10 +188,12 @@ __run (struct synctask *task)
         case SYNCTASK_RUN:
                 gf_log (task->xl->name, GF_LOG_DEBUG,
                         "re-running already running task");
-                env->runcount--;
+                proc->runcount--;
+                __sync_fetch_and_sub (&env->runcount, 1);
                 break;
         case SYNCTASK_WAIT:
-                env->waitcount--;
+                proc->waitcount--;
+                __sync_fetch_and_sub (&env->waitcount, 1);
                 break;
         case SYNCTASK_DONE:
                 gf_log (task->xl->name, GF_LOG_WARNING,
@@ -199,18 +205,22 @@ __run (struct synctask *task)
 		return;
         }
 
-        list_add_tail (&task->all_tasks, &env->runq);
-        env->runcount++;
+        list_add_tail (&task->all_tasks, &proc->runq);
+        proc->runcount++;
+        __sync_fetch_and_add (&env->runcount, 1);
         task->state = SYNCTASK_RUN;
 }
 
 
+/* caller holds task->proc->lock */
 static void
 __wait (struct synctask *task)
 {
-        struct syncenv *env = NULL;
+        struct syncenv  *env = NULL;
+        struct syncproc *proc = NULL;
 
         env = task->env;
+        proc = task->proc;
 
         list_del_init (&task->all_tasks);
         switch (task->state) {
@@ -218,12 +228,14 @@ __wait (struct synctask *task)
         case SYNCTASK_SUSPEND:
                 break;
         case SYNCTASK_RUN:
-                env->runcount--;
+                proc->runcount--;
+                __sync_fetch_and_sub (&env->runcount, 1);
                 break;
         case SYNCTASK_WAIT:
                 gf_log (task->xl->name, GF_LOG_WARNING,
                         "re-waiting already waiting task");
-                env->waitcount--;
+                proc->waitcount--;
+                __sync_fetch_and_sub (&env->waitcount, 1);
                 break;
         case SYNCTASK_DONE:
                 gf_log (task->xl->name, GF_LOG_WARNING,
@@ -235,12 +247,92 @@ __wait (struct synctask *task)
 		return;
         }
 
-        list_add_tail (&task->all_tasks, &env->waitq);
-        env->waitcount++;
+        list_add_tail (&task->all_tasks, &proc->waitq);
+        proc->waitcount++;
+        __sync_fetch_and_add (&env->waitcount, 1);
         task->state = SYNCTASK_WAIT;
 }
 
 
+/* pick a home for a task which has never run, preferring running procs */
+static struct syncproc *
+syncenv_place (struct syncenv *env)
+{
+        unsigned int  start = 0;
+        int           i = 0;
+
+        start = __sync_fetch_and_add (&env->next, 1);
+
+        for (i = 0; i < env->procmax; i++) {
+                if (env->proc[(start + i) % env->procmax].processor)
+                        return &env->proc[(start + i) % env->procmax];
+        }
+
+        return &env->proc[start % env->procmax];
+}
+
+
+/* Lock the proc @task is homed on. The home only changes under the old
+ * home's lock (when the task is stolen), so recheck after locking. */
+static struct syncproc *
+synctask_lock_proc (struct synctask *task)
+{
+        struct syncproc *proc = NULL;
+
+        for (;;) {
+                proc = task->proc;
+                if (!proc) {
+                        proc = syncenv_place (task->env);
+                        if (!__sync_bool_compare_and_swap (&task->proc, NULL,
+                                                           proc))
+                                continue;
+                }
+
+                pthread_mutex_lock (&proc->lock);
+                if (task->proc == proc)
+                        break;
+                pthread_mutex_unlock (&proc->lock);
+        }
+
+        return proc;
+}
+
+
+/* A task was queued on @proc, make sure a sleeping proc notices. Pairs with
+ * the idle/runcount check in syncproc_idle(). */
+static void
+syncenv_kick (struct syncenv *env, struct syncproc *proc)
+{
+        struct syncproc *target = NULL;
+        int              i = 0;
+
+        __sync_synchronize ();
+        if (!env->idle)
+                return;
+
+        pthread_mutex_lock (&env->mutex);
+        {
+                if (proc->sleeping) {
+                        target = proc;
+                } else {
+                        for (i = 0; i < env->procmax; i++) {
+                                if (env->proc[i].sleeping) {
+                                        target = &env->proc[i];
+                                        break;
+                                }
+                        }
+                }
+
+                if (target) {
+                        target->sleeping = 0;
+                        __sync_fetch_and_sub (&env->idle, 1);
+                        pthread_cond_signal (&target->cond);
+                }
+        }
+        pthread_mutex_unlock (&env->mutex);
+}
+
+
 void
 synctask_yield (struct synctask *task)
 {
@@ -265,20 +357,22 @@ synctask_yield (struct synctask *task)
 void
 synctask_wake (struct synctask *task)
 {
-        struct syncenv *env = NULL;
-
-        env = task->env;
+        struct syncproc *proc = NULL;
+        int              queued = 0;
 
-        pthread_mutex_lock (&env->mutex);
+        proc = synctask_lock_proc (task);
         {
                 task->woken = 1;
 
-                if (task->slept)
+                if (task->slept) {
                         __run (task);
-
-		pthread_cond_broadcast (&env->cond);
+                        queued = 1;
+                }
         }
-        pthread_mutex_unlock (&env->mutex);
+        pthread_mutex_unlock (&proc->lock);
+
+        if (queued)
+                syncenv_kick (task->env, proc);
 }
 
 void
@@ -476,45 +570,136 @@ synctask_new (struct syncenv *env, synctask_fn_t fn, synctask_cbk_t cbk,
 }
 
 
-struct synctask *
-syncenv_task (struct syncproc *proc)
+/* Take a runnable task off @victim's runq for @proc: from the head of its
+ * own queue, from the tail when stealing. */
+static struct synctask *
+syncproc_dequeue (struct syncproc *proc, struct syncproc *victim)
+{
+        struct synctask *task = NULL;
+
+        pthread_mutex_lock (&victim->lock);
+        {
+                if (list_empty (&victim->runq))
+                        goto unlock;
+
+                if (victim == proc)
+                        task = list_entry (victim->runq.next, struct synctask,
+                                           all_tasks);
+                else
+                        task = list_entry (victim->runq.prev, struct synctask,
+                                           all_tasks);
+
+                list_del_init (&task->all_tasks);
+                victim->runcount--;
+                __sync_fetch_and_sub (&proc->env->runcount, 1);
+
+                task->woken = 0;
+                task->slept = 0;
+
+                task->proc = proc;
+        }
+unlock:
+        pthread_mutex_unlock (&victim->lock);
+
+        if (task && victim != proc)
+                proc->steals++;
+
+        return task;
+}
+
+
+static struct synctask *
+syncproc_steal (struct syncproc *proc)
+{
+        struct syncenv  *env = NULL;
+        struct syncproc *victim = NULL;
+        struct synctask *task = NULL;
+        int              self = 0;
+        int              i = 0;
+
+        env = proc->env;
+        self = proc - env->proc;
+
+        for (i = 1; i < env->procmax; i++) {
+                victim = &env->proc[(self + i) % env->procmax];
+                /* unlocked peek, rechecked in syncproc_dequeue() */
+                if (list_empty (&victim->runq))
+                        continue;
+                task = syncproc_dequeue (proc, victim);
+                if (task)
+                        break;
+        }
+
+        return task;
+}
+
+
+/* Sleep until a task is queued. Returns 1 if the proc should exit after
+ * SYNCPROC_IDLE_TIME without work. */
+static int
+syncproc_idle (struct syncproc *proc)
 {
         struct syncenv   *env = NULL;
-        struct synctask  *task = NULL;
         struct timespec   sleep_till = {0, };
         int               ret = 0;
+        int               quit = 0;
 
         env = proc->env;
 
         pthread_mutex_lock (&env->mutex);
         {
-                while (list_empty (&env->runq)) {
-                        sleep_till.tv_sec = time (NULL) + SYNCPROC_IDLE_TIME;
-                        ret = pthread_cond_timedwait (&env->cond, &env->mutex,
+                proc->sleeping = 1;
+                __sync_fetch_and_add (&env->idle, 1);
+
+                /* a task queued before we were visible as idle */
+                if (env->runcount) {
+                        proc->sleeping = 0;
+                        __sync_fetch_and_sub (&env->idle, 1);
+                        goto unlock;
+                }
+
+                sleep_till.tv_sec = time (NULL) + SYNCPROC_IDLE_TIME;
+                while (proc->sleeping && ret != ETIMEDOUT)
+                        ret = pthread_cond_timedwait (&proc->cond, &env->mutex,
                                                       &sleep_till);
-                        if (!list_empty (&env->runq))
-                                break;
-                        if ((ret == ETIMEDOUT) &&
-                            (env->procs > env->procmin)) {
-                                task = NULL;
+
+                /* still set only if nobody kicked us */
+                if (proc->sleeping) {
+                        proc->sleeping = 0;
+                        __sync_fetch_and_sub (&env->idle, 1);
+
+                        if ((env->procs > env->procmin) &&
+                            list_empty (&proc->runq)) {
                                 env->procs--;
-                                memset (proc, 0, sizeof (*proc));
-                                goto unlock;
+                                proc->processor = 0;
+                                quit = 1;
                         }
                 }
+        }
+unlock:
+        pthread_mutex_unlock (&env->mutex);
 
-                task = list_entry (env->runq.next, struct synctask, all_tasks);
+        return quit;
+}
 
-                list_del_init (&task->all_tasks);
-                env->runcount--;
 
-                task->woken = 0;
-                task->slept = 0;
+struct synctask *
+syncenv_task (struct syncproc *proc)
+{
+        struct synctask  *task = NULL;
 
-                task->proc = proc;
+        for (;;) {
+                task = syncproc_dequeue (proc, proc);
+                if (task)
+                        break;
+
+                task = syncproc_steal (proc);
+                if (task)
+                        break;
+
+                if (syncproc_idle (proc))
+                        break;
         }
-unlock:
-        pthread_mutex_unlock (&env->mutex);
 
         return task;
 }
@@ -523,9 +708,10 @@ unlock:
 void
 synctask_switchto (struct synctask *task)
 {
-        struct syncenv *env = NULL;
+        struct syncproc *proc = NULL;
 
-        env = task->env;
+        proc = task->proc;
+        proc->runs++;
 
         synctask_set (task);
         THIS = task->xl;
@@ -545,7 +731,8 @@ synctask_switchto (struct synctask *task)
                 return;
         }
 
-        pthread_mutex_lock (&env->mutex);
+        /* a running task cannot be stolen, task->proc is still @proc */
+        pthread_mutex_lock (&proc->lock);
         {
                 if (task->woken) {
                         __run (task);
@@ -554,7 +741,7 @@ synctask_switchto (struct synctask *task)
                         __wait (task);
                 }
         }
-        pthread_mutex_unlock (&env->mutex);
+        pthread_mutex_unlock (&proc->lock);
 }
 
 void *
@@ -589,6 +776,10 @@ syncenv_scale (struct syncenv *env)
         int  i = 0;
         int  ret = 0;
 
+        /* called after every task switch, avoid env->mutex when possible */
+        if (env->procs > env->runcount)
+                return;
+
         pthread_mutex_lock (&env->mutex);
         {
                 if (env->procs > env->runcount)
@@ -627,6 +818,37 @@ syncenv_destroy (struct syncenv *env)
 }
 
 
+void
+syncenv_dump (struct syncenv *env)
+{
+        char  key[GF_DUMP_MAX_BUF_LEN] = {0,};
+        int   i = 0;
+
+        if (!env)
+                return;
+
+        gf_proc_dump_add_section ("syncenv");
+        gf_proc_dump_write ("procs", "%d", env->procs);
+        gf_proc_dump_write ("idle_procs", "%d", env->idle);
+        gf_proc_dump_write ("runq_depth", "%d", env->runcount);
+        gf_proc_dump_write ("waitq_depth", "%d", env->waitcount);
+
+        for (i = 0; i < env->procmax; i++) {
+                if (!env->proc[i].processor && !env->proc[i].runs)
+                        continue;
+
+                gf_proc_dump_build_key (key, "proc", "%d.runq_depth", i);
+                gf_proc_dump_write (key, "%d", env->proc[i].runcount);
+                gf_proc_dump_build_key (key, "proc", "%d.waitq_depth", i);
+                gf_proc_dump_write (key, "%d", env->proc[i].waitcount);
+                gf_proc_dump_build_key (key, "proc", "%d.runs", i);
+                gf_proc_dump_write (key, "%"PRIu64, env->proc[i].runs);
+                gf_proc_dump_build_key (key, "proc", "%d.steals", i);
+                gf_proc_dump_write (key, "%"PRIu64, env->proc[i].steals);
+        }
+}
+
+
 struct syncenv *
 syncenv_new (size_t stacksize, int procmin, int procmax)
 {
@@ -648,10 +870,15 @@ syncenv_new (size_t stacksize, int procmin, int procmax)
                 return NULL;
 
         pthread_mutex_init (&newenv->mutex, NULL);
-        pthread_cond_init (&newenv->cond, NULL);
 
-        INIT_LIST_HEAD (&newenv->runq);
-        INIT_LIST_HEAD (&newenv->waitq);
+        /* every slot is usable as a task home, even without a thread */
+        for (i = 0; i < SYNCENV_PROC_MAX; i++) {
+                newenv->proc[i].env = newenv;
+                pthread_mutex_init (&newenv->proc[i].lock, NULL);
+                pthread_cond_init (&newenv->proc[i].cond, NULL);
+                INIT_LIST_HEAD (&newenv->proc[i].runq);
+                INIT_LIST_HEAD (&newenv->proc[i].waitq);
+        }
 
         newenv->stacksize    = SYNCENV_DEFAULT_STACKSIZE;
         if (stacksize)
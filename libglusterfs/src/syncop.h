@@ -86,6 +86,22 @@ struct syncproc {
         ucontext_t          sched;
         struct syncenv     *env;
         struct synctask    *current;
+
+        /* A task stays homed on the proc which last ran it (task->proc)
+         * and is requeued here when woken. @lock guards both queues and
+         * the woken/slept state of every task homed on this proc. Idle
+         * procs steal from the tail of other procs' runq. */
+        pthread_mutex_t     lock;
+        struct list_head    runq;
+        int                 runcount;
+        struct list_head    waitq;
+        int                 waitcount;
+
+        pthread_cond_t      cond;     /* idle wait, paired with env->mutex */
+        int                 sleeping; /* guarded by env->mutex */
+
+        uint64_t            runs;     /* tasks switched to */
+        uint64_t            steals;   /* tasks taken from other procs */
 };
 
 /* hosts the scheduler thread and framework for executing synctasks */
@@ -93,16 +109,15 @@ struct syncenv {
         struct syncproc     proc[SYNCENV_PROC_MAX];
         int                 procs;
 
-        struct list_head    runq;
-        int                 runcount;
-        struct list_head    waitq;
-        int                 waitcount;
+        int                 runcount;  /* all procs, updated atomically */
+        int                 waitcount; /* all procs, updated atomically */
+        int                 idle;      /* procs sleeping on their cond */
+        unsigned int        next;      /* round-robin home for new tasks */
 
 	int                 procmin;
 	int                 procmax;
 
-        pthread_mutex_t     mutex;
-        pthread_cond_t      cond;
+        pthread_mutex_t     mutex;     /* proc creation/exit, idle waits */
 
         size_t              stacksize;
 };
@@ -241,6 +256,7 @@ struct syncopctx {
 struct syncenv * syncenv_new (size_t stacksize, int procmin, int procmax);
 void syncenv_destroy (struct syncenv *);
 void syncenv_scale (struct syncenv *env);
+void syncenv_dump (struct syncenv *env);
 
 int synctask_new (struct syncenv *, synctask_fn_t, synctask_cbk_t, call_frame_t* frame, void *);
 struct synctask *synctask_create (struct syncenv *, synctask_fn_t,
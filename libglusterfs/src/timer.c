@@ -13,12 +13,254 @@
 #include "config.h"
 #endif
 
+#ifdef HAVE_SYS_TIMERFD_H
+#include <sys/timerfd.h>
+#endif
+
 #include "timer.h"
 #include "logging.h"
 #include "common-utils.h"
 #include "globals.h"
 #include "timespec.h"
 
+#define GF_TIMER_TICK_NS    (GF_TIMER_TICK_MS * 1000000ULL)
+
+/* the timer thread wakes up at least this often to notice reg->fin */
+#define GF_TIMER_MAX_SLEEP  (1000 / GF_TIMER_TICK_MS)
+
+static inline uint64_t
+gf_timer_now (void)
+{
+        struct timespec now = {0, };
+
+        timespec_now (&now);
+
+        return TS (now) / GF_TIMER_TICK_NS;
+}
+
+
+static inline int
+gf_timer_is_slot (gf_timer_registry_t *reg, gf_timer_t *head)
+{
+        return (head >= &reg->wheel[0][0] &&
+                head < &reg->wheel[0][0] + GF_TIMER_LEVELS * GF_TIMER_SLOTS);
+}
+
+
+static void
+__gf_timer_link (gf_timer_t *head, gf_timer_t *event)
+{
+        event->next = head;
+        event->prev = head->prev;
+        event->prev->next = event;
+        event->next->prev = event;
+        event->head = head;
+}
+
+
+static void
+__gf_timer_unlink (gf_timer_registry_t *reg, gf_timer_t *event)
+{
+        gf_timer_t *head = event->head;
+        int         idx  = 0;
+
+        event->next->prev = event->prev;
+        event->prev->next = event->next;
+
+        if (head->next == head && gf_timer_is_slot (reg, head)) {
+                idx = head - &reg->wheel[0][0];
+                reg->used[idx / GF_TIMER_SLOTS] &=
+                        ~(1ULL << (idx % GF_TIMER_SLOTS));
+        }
+}
+
+
+/* put @event into the slot of the lowest level which can hold it, timers
+   beyond the range of the wheel wait in its last level */
+static void
+__gf_timer_place (gf_timer_registry_t *reg, gf_timer_t *event)
+{
+        uint64_t expires = event->expires;
+        uint64_t delta   = 0;
+        int      level   = 0;
+        int      slot    = 0;
+
+        if (expires < reg->current)
+                expires = reg->current;
+
+        delta = expires - reg->current;
+        while (level < GF_TIMER_LEVELS - 1 &&
+               delta >= (1ULL << ((level + 1) * GF_TIMER_SLOT_BITS)))
+                level++;
+
+        if (delta >= (1ULL << (GF_TIMER_LEVELS * GF_TIMER_SLOT_BITS)))
+                expires = reg->current +
+                        (1ULL << (GF_TIMER_LEVELS * GF_TIMER_SLOT_BITS)) - 1;
+
+        slot = (expires >> (level * GF_TIMER_SLOT_BITS)) & GF_TIMER_SLOT_MASK;
+
+        __gf_timer_link (&reg->wheel[level][slot], event);
+        reg->used[level] |= (1ULL << slot);
+}
+
+
+/* first tick, not before reg->current, at which a non-empty slot is run */
+static uint64_t
+__gf_timer_next (gf_timer_registry_t *reg)
+{
+        uint64_t next  = UINT64_MAX;
+        uint64_t used  = 0;
+        uint64_t block = 0;
+        int      shift = 0;
+        int      rot   = 0;
+        int      level = 0;
+
+        for (level = 0; level < GF_TIMER_LEVELS; level++) {
+                if (!reg->used[level])
+                        continue;
+
+                /* a level's slot is run when the tick enters its block,
+                   a block which was entered already comes round again
+                   only after a full turn */
+                shift = level * GF_TIMER_SLOT_BITS;
+                block = reg->current >> shift;
+                if (reg->current & ((1ULL << shift) - 1))
+                        block++;
+
+                used = reg->used[level];
+                rot = block & GF_TIMER_SLOT_MASK;
+                if (rot)
+                        used = (used >> rot) | (used << (64 - rot));
+                block += __builtin_ctzll (used);
+
+                if ((block << shift) < next)
+                        next = block << shift;
+        }
+
+        return next;
+}
+
+
+static int
+__gf_timer_cascade (gf_timer_registry_t *reg, int level)
+{
+        gf_timer_t *head  = NULL;
+        gf_timer_t *event = NULL;
+        int         slot  = 0;
+
+        slot = (reg->current >> (level * GF_TIMER_SLOT_BITS)) &
+                GF_TIMER_SLOT_MASK;
+        head = &reg->wheel[level][slot];
+
+        while (head->next != head) {
+                event = head->next;
+                __gf_timer_unlink (reg, event);
+                __gf_timer_place (reg, event);
+        }
+
+        return slot;
+}
+
+
+/* run the wheel up to @now, due timers are moved to reg->expired */
+static void
+__gf_timer_advance (gf_timer_registry_t *reg, uint64_t now)
+{
+        gf_timer_t *head  = NULL;
+        uint64_t    next  = 0;
+        int         slot  = 0;
+        int         level = 0;
+
+        while (reg->current <= now) {
+                /* nothing happens in the ticks before the next busy
+                   slot, skip them */
+                next = __gf_timer_next (reg);
+                if (next > now) {
+                        reg->current = now + 1;
+                        break;
+                }
+                reg->current = next;
+
+                slot = reg->current & GF_TIMER_SLOT_MASK;
+                for (level = 1; !slot && level < GF_TIMER_LEVELS; level++)
+                        slot = __gf_timer_cascade (reg, level);
+
+                head = &reg->wheel[0][reg->current & GF_TIMER_SLOT_MASK];
+                while (head->next != head) {
+                        gf_timer_t *event = head->next;
+
+                        __gf_timer_unlink (reg, event);
+                        __gf_timer_link (&reg->expired, event);
+                }
+
+                reg->current++;
+        }
+}
+
+
+static void
+__gf_timer_arm (gf_timer_registry_t *reg, uint64_t tick)
+{
+        reg->armed = tick;
+
+#ifdef HAVE_SYS_TIMERFD_H
+        if (reg->timerfd != -1) {
+                struct itimerspec its = {{0, }, };
+
+                its.it_value.tv_sec = (tick * GF_TIMER_TICK_NS) / GIGA;
+                its.it_value.tv_nsec = (tick * GF_TIMER_TICK_NS) % GIGA;
+                if (timerfd_settime (reg->timerfd, TFD_TIMER_ABSTIME,
+                                     &its, NULL) != 0)
+                        gf_log ("timer", GF_LOG_WARNING,
+                                "timerfd_settime failed (%s)",
+                                strerror (errno));
+                return;
+        }
+#endif
+        pthread_cond_signal (&reg->cond);
+}
+
+
+/* called with reg->lock held, returns with it held again */
+static void
+__gf_timer_wait (gf_timer_registry_t *reg)
+{
+        struct timeval  tv       = {0, };
+        struct timespec deadline = {0, };
+        uint64_t        now      = 0;
+        uint64_t        ns       = 0;
+
+#ifdef HAVE_SYS_TIMERFD_H
+        if (reg->timerfd != -1) {
+                uint64_t expirations = 0;
+
+                pthread_mutex_unlock (&reg->lock);
+                {
+                        if (read (reg->timerfd, &expirations,
+                                  sizeof (expirations)) < 0 &&
+                            errno != EINTR && errno != EAGAIN)
+                                gf_log ("timer", GF_LOG_WARNING,
+                                        "reading timerfd failed (%s)",
+                                        strerror (errno));
+                }
+                pthread_mutex_lock (&reg->lock);
+                return;
+        }
+#endif
+        now = gf_timer_now ();
+        if (reg->armed <= now)
+                return;
+
+        /* the condition variable runs on the wall clock */
+        gettimeofday (&tv, NULL);
+        ns = (reg->armed - now) * GF_TIMER_TICK_NS + tv.tv_usec * 1000ULL;
+        deadline.tv_sec = tv.tv_sec + ns / GIGA;
+        deadline.tv_nsec = ns % GIGA;
+
+        pthread_cond_timedwait (&reg->cond, &reg->lock, &deadline);
+}
+
+
 gf_timer_t *
 gf_timer_call_after (glusterfs_ctx_t *ctx,
                      struct timespec delta,
@@ -27,8 +269,6 @@ gf_timer_call_after (glusterfs_ctx_t *ctx,
 {
         gf_timer_registry_t *reg = NULL;
         gf_timer_t *event = NULL;
-        gf_timer_t *trav = NULL;
-        uint64_t at = 0;
 
         if (ctx == NULL)
         {
@@ -49,22 +289,19 @@ gf_timer_call_after (glusterfs_ctx_t *ctx,
         }
         timespec_now (&event->at);
         timespec_adjust_delta (&event->at, delta);
-        at = TS (event->at);
+        /* round up, a timer never fires early */
+        event->expires = (TS (event->at) + GF_TIMER_TICK_NS - 1) /
+                GF_TIMER_TICK_NS;
         event->callbk = callbk;
         event->data = data;
         event->xl = THIS;
         pthread_mutex_lock (&reg->lock);
         {
-                trav = reg->active.prev;
-                while (trav != &reg->active) {
-                        if (TS (trav->at) < at)
-                                break;
-                        trav = trav->prev;
-                }
-                event->prev = trav;
-                event->next = event->prev->next;
-                event->prev->next = event;
-                event->next->prev = event;
+                __gf_timer_place (reg, event);
+
+                /* wake the timer thread up earlier if it is sleeping */
+                if (event->expires < reg->armed)
+                        __gf_timer_arm (reg, event->expires);
         }
         pthread_mutex_unlock (&reg->lock);
         return event;
@@ -80,12 +317,8 @@ gf_timer_call_stale (gf_timer_registry_t *reg,
                 return 0;
         }
 
-        event->next->prev = event->prev;
-        event->prev->next = event->next;
-        event->next = &reg->stale;
-        event->prev = event->next->prev;
-        event->next->prev = event;
-        event->prev->next = event;
+        __gf_timer_unlink (reg, event);
+        __gf_timer_link (&reg->stale, event);
 
         return 0;
 }
@@ -111,8 +344,7 @@ gf_timer_call_cancel (glusterfs_ctx_t *ctx,
 
         pthread_mutex_lock (&reg->lock);
         {
-                event->next->prev = event->prev;
-                event->prev->next = event->next;
+                __gf_timer_unlink (reg, event);
         }
         pthread_mutex_unlock (&reg->lock);
 
@@ -120,11 +352,24 @@ gf_timer_call_cancel (glusterfs_ctx_t *ctx,
         return 0;
 }
 
+static void
+__gf_timer_free_list (gf_timer_registry_t *reg, gf_timer_t *head)
+{
+        gf_timer_t *event = NULL;
+
+        while (head->next != head) {
+                event = head->next;
+                __gf_timer_unlink (reg, event);
+                GF_FREE (event);
+        }
+}
+
 void *
 gf_timer_proc (void *ctx)
 {
         gf_timer_registry_t *reg = NULL;
-        const struct timespec sleepts = {.tv_sec = 1, .tv_nsec = 0, };
+        int                  level = 0;
+        int                  slot = 0;
 
         if (ctx == NULL)
         {
@@ -138,50 +383,49 @@ gf_timer_proc (void *ctx)
                 return NULL;
         }
 
+        pthread_mutex_lock (&reg->lock);
+
         while (!reg->fin) {
                 uint64_t now;
-                struct timespec now_ts;
+                uint64_t next;
                 gf_timer_t *event = NULL;
 
-                timespec_now (&now_ts);
-                now = TS (now_ts);
-                while (1) {
-                        uint64_t at;
-                        char need_cbk = 0;
+                reg->armed = 0;
+                now = gf_timer_now ();
+                __gf_timer_advance (reg, now);
 
-                        pthread_mutex_lock (&reg->lock);
+                while (reg->expired.next != &reg->expired) {
+                        event = reg->expired.next;
+                        gf_timer_call_stale (reg, event);
+
+                        pthread_mutex_unlock (&reg->lock);
                         {
-                                event = reg->active.next;
-                                at = TS (event->at);
-                                if (event != &reg->active && now >= at) {
-                                        need_cbk = 1;
-                                        gf_timer_call_stale (reg, event);
-                                }
+                                if (event->xl)
+                                        THIS = event->xl;
+                                event->callbk (event->data);
                         }
-                        pthread_mutex_unlock (&reg->lock);
-                        if (event->xl)
-                                THIS = event->xl;
-                        if (need_cbk)
-                                event->callbk  (event->data);
-
-                        else
-                                break;
+                        pthread_mutex_lock (&reg->lock);
                 }
-                nanosleep (&sleepts, NULL);
-        }
 
-        pthread_mutex_lock (&reg->lock);
-        {
-                while (reg->active.next != &reg->active) {
-                        gf_timer_call_cancel (ctx, reg->active.next);
-                }
+                next = __gf_timer_next (reg);
+                if (next > now + GF_TIMER_MAX_SLEEP)
+                        next = now + GF_TIMER_MAX_SLEEP;
+                __gf_timer_arm (reg, next);
 
-                while (reg->stale.next != &reg->stale) {
-                        gf_timer_call_cancel (ctx, reg->stale.next);
-                }
+                __gf_timer_wait (reg);
         }
+
+        for (level = 0; level < GF_TIMER_LEVELS; level++)
+                for (slot = 0; slot < GF_TIMER_SLOTS; slot++)
+                        __gf_timer_free_list (reg, &reg->wheel[level][slot]);
+
+        __gf_timer_free_list (reg, &reg->expired);
+        __gf_timer_free_list (reg, &reg->stale);
         pthread_mutex_unlock (&reg->lock);
         pthread_mutex_destroy (&reg->lock);
+        pthread_cond_destroy (&reg->cond);
+        if (reg->timerfd != -1)
+                close (reg->timerfd);
         GF_FREE (((glusterfs_ctx_t *)ctx)->timer);
 
         return NULL;
@@ -190,6 +434,9 @@ gf_timer_proc (void *ctx)
 gf_timer_registry_t *
 gf_timer_registry_init (glusterfs_ctx_t *ctx)
 {
+        int level = 0;
+        int slot  = 0;
+
         if (ctx == NULL) {
                 gf_log_callingfn ("timer", GF_LOG_ERROR, "invalid argument");
                 return NULL;
@@ -204,10 +451,29 @@ gf_timer_registry_init (glusterfs_ctx_t *ctx)
                         goto out;
 
                 pthread_mutex_init (&reg->lock, NULL);
-                reg->active.next = &reg->active;
-                reg->active.prev = &reg->active;
+                pthread_cond_init (&reg->cond, NULL);
                 reg->stale.next = &reg->stale;
                 reg->stale.prev = &reg->stale;
+                reg->expired.next = &reg->expired;
+                reg->expired.prev = &reg->expired;
+                for (level = 0; level < GF_TIMER_LEVELS; level++) {
+                        for (slot = 0; slot < GF_TIMER_SLOTS; slot++) {
+                                reg->wheel[level][slot].next =
+                                        &reg->wheel[level][slot];
+                                reg->wheel[level][slot].prev =
+                                        &reg->wheel[level][slot];
+                        }
+                }
+                reg->current = gf_timer_now ();
+
+                reg->timerfd = -1;
+#ifdef HAVE_SYS_TIMERFD_H
+                reg->timerfd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+                if (reg->timerfd == -1)
+                        gf_log ("timer", GF_LOG_WARNING, "timerfd_create "
+                                "failed (%s), falling back to condition "
+                                "wait", strerror (errno));
+#endif
 
                 ctx->timer = reg;
                 gf_thread_create (&reg->th, NULL, gf_timer_proc, ctx);
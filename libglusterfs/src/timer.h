@@ -23,19 +23,38 @@
 
 typedef void (*gf_timer_cbk_t) (void *);
 
+/* timers are kept on a hierarchical timing wheel: the slots of the first
+   level are GF_TIMER_TICK_MS long, those of every next level
+   GF_TIMER_SLOTS times longer. Timers are moved down a level each time
+   the wheel reaches their slot, and fire from the first level. */
+#define GF_TIMER_TICK_MS    1
+#define GF_TIMER_LEVELS     5
+#define GF_TIMER_SLOT_BITS  6
+#define GF_TIMER_SLOTS      (1 << GF_TIMER_SLOT_BITS)
+#define GF_TIMER_SLOT_MASK  (GF_TIMER_SLOTS - 1)
+
 struct _gf_timer {
         struct _gf_timer *next, *prev;
         struct timespec    at;
         gf_timer_cbk_t    callbk;
         void             *data;
         xlator_t         *xl;
+        uint64_t          expires;  /* in ticks */
+        struct _gf_timer *head;     /* list the timer is on */
 };
 
 struct _gf_timer_registry {
         pthread_t        th;
         char             fin;
         struct _gf_timer stale;
-        struct _gf_timer active;
+        struct _gf_timer expired;
+        struct _gf_timer wheel[GF_TIMER_LEVELS][GF_TIMER_SLOTS];
+        uint64_t         used[GF_TIMER_LEVELS];  /* non-empty slots */
+        uint64_t         current;                /* next tick to run */
+        uint64_t         armed;  /* tick gf_timer_proc wakes up at, 0
+                                    while it is running the wheel */
+        int              timerfd;
+        pthread_cond_t   cond;   /* used when there is no timerfd */
         pthread_mutex_t  lock;
 };
 
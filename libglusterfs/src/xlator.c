@@ -551,6 +551,7 @@ xlator_tree_free (xlator_t *tree)
                 dict_unref (prev->options);
                 GF_FREE (prev->name);
                 GF_FREE (prev->type);
+                GF_FREE (prev->latency_hist);
                 xlator_list_destroy (prev->children);
                 xlator_list_destroy (prev->parents);
 
@@ -710,6 +711,7 @@ xlator_destroy (xlator_t *xl)
 
         GF_FREE (xl->name);
         GF_FREE (xl->type);
+        GF_FREE (xl->latency_hist);
         if (xl->dlhandle)
                 dlclose (xl->dlhandle);
         if (xl->options)
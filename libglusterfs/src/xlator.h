@@ -818,6 +818,10 @@ typedef int32_t (*dumpop_fdctx_to_dict_t) (xlator_t *this, fd_t *fd,
 
 typedef int32_t (*dumpop_eh_t) (xlator_t *this);
 
+struct gf_metrics;
+
+typedef int32_t (*dumpop_metrics_t) (xlator_t *this, struct gf_metrics *m);
+
 struct xlator_dumpops {
         dumpop_priv_t                   priv;
         dumpop_inode_t                  inode;
@@ -830,6 +834,7 @@ struct xlator_dumpops {
         dumpop_inodectx_to_dict_t       inodectx_to_dict;
         dumpop_fdctx_to_dict_t          fdctx_to_dict;
         dumpop_eh_t                     history;
+        dumpop_metrics_t                metrics;
 };
 
 typedef struct xlator_list {
@@ -865,6 +870,8 @@ struct _xlator {
 
         /* for latency measurement */
         fop_latency_t latencies[GF_FOP_MAXVALUE];
+        gf_latency_hist_t *latency_hist; /* GF_FOP_MAXVALUE entries,
+                                            allocated on first sample */
 
         /* Misc */
         eh_t               *history; /* event history context */
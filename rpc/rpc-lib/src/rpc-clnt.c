@@ -54,6 +54,7 @@ __saved_frames_get_timedout (struct saved_frames *frames, uint32_t timeout,
 		if ((tmp->saved_at.tv_sec + timeout) < current->tv_sec) {
 			bailout_frame = tmp;
 			list_del_init (&bailout_frame->list);
+			list_del_init (&bailout_frame->hash);
 			frames->count--;
 		}
 	}
@@ -77,6 +78,71 @@ _is_lock_fop (struct saved_frame *sframe)
                 (fop == GFS3_OP_FENTRYLK));
 }
 
+/* xids are handed out in sequence, so their low bits spread the frames
+   evenly over the buckets */
+static void
+__saved_frames_hash (struct saved_frames *frames,
+                     struct saved_frame *saved_frame)
+{
+        uint32_t bucket = 0;
+
+        bucket = saved_frame->rpcreq->xid & (frames->bucket_count - 1);
+        list_add_tail (&saved_frame->hash, &frames->buckets[bucket]);
+}
+
+
+static void
+__saved_frames_grow (struct saved_frames *frames)
+{
+        struct list_head   *old          = NULL;
+        uint32_t            old_count    = 0;
+        struct saved_frame *trav         = NULL;
+        struct saved_frame *tmp          = NULL;
+        uint32_t            i            = 0;
+
+        old       = frames->buckets;
+        old_count = frames->bucket_count;
+
+        frames->buckets = GF_CALLOC (old_count * 2, sizeof (*old),
+                                     gf_common_mt_rpcclnt_savedframe_t);
+        if (!frames->buckets) {
+                /* keep going with longer chains */
+                frames->buckets = old;
+                return;
+        }
+
+        frames->bucket_count = old_count * 2;
+        for (i = 0; i < frames->bucket_count; i++)
+                INIT_LIST_HEAD (&frames->buckets[i]);
+
+        for (i = 0; i < old_count; i++) {
+                list_for_each_entry_safe (trav, tmp, &old[i], hash) {
+                        list_del_init (&trav->hash);
+                        __saved_frames_hash (frames, trav);
+                }
+        }
+
+        GF_FREE (old);
+}
+
+
+static struct saved_frame *
+__saved_frames_lookup (struct saved_frames *frames, int64_t callid)
+{
+        struct saved_frame *tmp    = NULL;
+        uint32_t            bucket = 0;
+
+        bucket = callid & (frames->bucket_count - 1);
+
+        list_for_each_entry (tmp, &frames->buckets[bucket], hash) {
+                if (tmp->rpcreq->xid == callid)
+                        return tmp;
+        }
+
+        return NULL;
+}
+
+
 struct saved_frame *
 __saved_frames_put (struct saved_frames *frames, void *frame,
                     struct rpc_req *rpcreq)
@@ -91,6 +157,7 @@ __saved_frames_put (struct saved_frames *frames, void *frame,
 
         memset (saved_frame, 0, sizeof (*saved_frame));
 	INIT_LIST_HEAD (&saved_frame->list);
+	INIT_LIST_HEAD (&saved_frame->hash);
 
 	saved_frame->capital_this = THIS;
 	saved_frame->frame        = frame;
@@ -102,8 +169,13 @@ __saved_frames_put (struct saved_frames *frames, void *frame,
         else
                 list_add_tail (&saved_frame->list, &frames->sf.list);
 
+        __saved_frames_hash (frames, saved_frame);
+
 	frames->count++;
 
+        if (frames->count > 2 * (int64_t) frames->bucket_count)
+                __saved_frames_grow (frames);
+
 out:
 	return saved_frame;
 }
@@ -119,6 +191,7 @@ saved_frames_delete (struct saved_frame *saved_frame,
         pthread_mutex_lock (&conn->lock);
         {
                 list_del_init (&saved_frame->list);
+                list_del_init (&saved_frame->hash);
                 conn->saved_frames->count--;
         }
         pthread_mutex_unlock (&conn->lock);
@@ -257,6 +330,7 @@ struct saved_frames *
 saved_frames_new (void)
 {
 	struct saved_frames *saved_frames = NULL;
+        uint32_t             i            = 0;
 
 	saved_frames = GF_CALLOC (1, sizeof (*saved_frames),
                                   gf_common_mt_rpcclnt_savedframe_t);
@@ -264,6 +338,18 @@ saved_frames_new (void)
 		return NULL;
 	}
 
+        saved_frames->buckets = GF_CALLOC (SAVED_FRAMES_MIN_BUCKETS,
+                                           sizeof (*saved_frames->buckets),
+                                           gf_common_mt_rpcclnt_savedframe_t);
+        if (!saved_frames->buckets) {
+                GF_FREE (saved_frames);
+                return NULL;
+        }
+
+        saved_frames->bucket_count = SAVED_FRAMES_MIN_BUCKETS;
+        for (i = 0; i < saved_frames->bucket_count; i++)
+                INIT_LIST_HEAD (&saved_frames->buckets[i]);
+
 	INIT_LIST_HEAD (&saved_frames->sf.list);
 	INIT_LIST_HEAD (&saved_frames->lk_sf.list);
 
@@ -283,21 +369,11 @@ __saved_frame_copy (struct saved_frames *frames, int64_t callid,
                 goto out;
         }
 
-	list_for_each_entry (tmp, &frames->sf.list, list) {
-		if (tmp->rpcreq->xid == callid) {
-			*saved_frame = *tmp;
-                        ret = 0;
-			goto out;
-		}
-	}
-
-	list_for_each_entry (tmp, &frames->lk_sf.list, list) {
-		if (tmp->rpcreq->xid == callid) {
-			*saved_frame = *tmp;
-                        ret = 0;
-			goto out;
-		}
-	}
+        tmp = __saved_frames_lookup (frames, callid);
+        if (tmp) {
+                *saved_frame = *tmp;
+                ret = 0;
+        }
 
 out:
 	return ret;
@@ -308,28 +384,13 @@ struct saved_frame *
 __saved_frame_get (struct saved_frames *frames, int64_t callid)
 {
 	struct saved_frame *saved_frame = NULL;
-	struct saved_frame *tmp = NULL;
 
-	list_for_each_entry (tmp, &frames->sf.list, list) {
-		if (tmp->rpcreq->xid == callid) {
-			list_del_init (&tmp->list);
-			frames->count--;
-			saved_frame = tmp;
-			goto out;
-		}
-	}
-
-	list_for_each_entry (tmp, &frames->lk_sf.list, list) {
-		if (tmp->rpcreq->xid == callid) {
-			list_del_init (&tmp->list);
-			frames->count--;
-			saved_frame = tmp;
-			goto out;
-		}
-	}
-
-out:
+        saved_frame = __saved_frames_lookup (frames, callid);
 	if (saved_frame) {
+                list_del_init (&saved_frame->list);
+                list_del_init (&saved_frame->hash);
+                frames->count--;
+
                 THIS  = saved_frame->capital_this;
         }
 
@@ -376,6 +437,7 @@ saved_frames_unwind (struct saved_frames *saved_frames)
                                        trav->rpcreq->conn->rpc_clnt->reqpool);
 
 		list_del_init (&trav->list);
+		list_del_init (&trav->hash);
                 mem_put (trav);
 	}
 }
@@ -389,6 +451,7 @@ saved_frames_destroy (struct saved_frames *frames)
 
 	saved_frames_unwind (frames);
 
+        GF_FREE (frames->buckets);
 	GF_FREE (frames);
 }
 
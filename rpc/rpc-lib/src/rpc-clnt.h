@@ -41,6 +41,10 @@ typedef int (*fop_cbk_fn_t) (struct rpc_req *req, struct iovec *iov, int count,
 
 typedef int (*clnt_fn_t) (call_frame_t *fr, xlator_t *xl, void *args);
 
+/* initial size of the xid hash of the saved frames, doubled as the number
+   of outstanding requests grows */
+#define SAVED_FRAMES_MIN_BUCKETS 256
+
 struct saved_frame {
 	union {
 		struct list_head list;
@@ -49,6 +53,7 @@ struct saved_frame {
 			struct saved_frame *frame_prev;
 		};
 	};
+        struct list_head         hash;
         void                    *capital_this;
 	void                    *frame;
 	struct timeval           saved_at;
@@ -56,10 +61,14 @@ struct saved_frame {
         rpc_transport_rsp_t      rsp;
 };
 
+/* sf and lk_sf are kept in the order the requests were sent, which is all
+   the bail-out timer needs; replies are matched through the buckets */
 struct saved_frames {
 	int64_t            count;
 	struct saved_frame sf;
 	struct saved_frame lk_sf;
+        struct list_head  *buckets;      /* by xid */
+        uint32_t           bucket_count; /* a power of two */
 };
 
 
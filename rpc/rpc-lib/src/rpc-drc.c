@@ -18,7 +18,7 @@
 #include "rpc-drc.h"
 #endif
 #include "locking.h"
-#include "hashfn.h"
+#include "checksum.h"
 #include "common-utils.h"
 #include "statedump.h"
 #include "mem-pool.h"
@@ -26,23 +26,108 @@
 #include <netinet/in.h>
 #include <unistd.h>
 
+/**
+ * rpcsvc_remove_drc_client - Cleanup the drc client
+ *
+ * @param drc - the main drc structure
+ * @param client - the drc client to be removed, no longer on the list
+ * @return void
+ */
+static void
+rpcsvc_remove_drc_client (rpcsvc_drc_globals_t *drc, drc_client_t *client)
+{
+        int                 i           = 0;
+
+        /* every op holds a reference on its client, none are left */
+        for (i = 0; i < DRC_CLIENT_SHARDS; i++)
+                LOCK_DESTROY (&client->shards[i].lock);
+
+        GF_FREE (client);
+}
+
+/**
+ * rpcsvc_drc_client_ref - ref the drc client
+ *
+ * @param client - the drc client to ref
+ * @return client
+ */
+static drc_client_t *
+rpcsvc_drc_client_ref (drc_client_t *client)
+{
+        GF_ASSERT (client);
+        __sync_add_and_fetch (&client->ref, 1);
+        return client;
+}
+
+/**
+ * __rpcsvc_drc_client_unref - unref the drc client with drc->lock held,
+ *                             and destroy the client on last unref
+ *
+ * @param drc - the main drc structure
+ * @param client - the drc client to unref
+ * @return NULL if it is the last unref, client otherwise
+ */
+static drc_client_t *
+__rpcsvc_drc_client_unref (rpcsvc_drc_globals_t *drc, drc_client_t *client)
+{
+        GF_ASSERT (drc);
+        GF_ASSERT (client->ref);
+
+        if (__sync_sub_and_fetch (&client->ref, 1))
+                return client;
+
+        drc->client_count--;
+        list_del (&client->client_list);
+        rpcsvc_remove_drc_client (drc, client);
+
+        return NULL;
+}
+
+/**
+ * rpcsvc_drc_client_unref - unref the drc client, taking drc->lock only
+ *                           when this may be the last reference
+ *
+ * @param drc - the main drc structure
+ * @param client - the drc client to unref
+ * @return NULL if it is the last unref, client otherwise
+ */
+static drc_client_t *
+rpcsvc_drc_client_unref (rpcsvc_drc_globals_t *drc, drc_client_t *client)
+{
+        uint32_t        ref     = 0;
+
+        GF_ASSERT (drc);
+        GF_ASSERT (client);
+
+        ref = client->ref;
+        while (ref > 1) {
+                if (__sync_bool_compare_and_swap (&client->ref, ref, ref - 1))
+                        return client;
+                ref = client->ref;
+        }
+
+        LOCK (&drc->lock);
+        client = __rpcsvc_drc_client_unref (drc, client);
+        UNLOCK (&drc->lock);
+
+        return client;
+}
+
 /**
  * rpcsvc_drc_op_destroy - Destroys the cached reply
  *
  * @param drc - the main drc structure
- * @param reply - the cached reply to destroy
- * @return NULL if reply is destroyed, reply otherwise
+ * @param reply - the cached reply to destroy, already unlinked
+ * @return void
  */
-static drc_cached_op_t *
+static void
 rpcsvc_drc_op_destroy (rpcsvc_drc_globals_t *drc, drc_cached_op_t *reply)
 {
         GF_ASSERT (drc);
         GF_ASSERT (reply);
 
-        if (reply->state == DRC_OP_IN_TRANSIT)
-                return reply;
-
-        iobref_unref (reply->msg.iobref);
+        if (reply->msg.iobref)
+                iobref_unref (reply->msg.iobref);
         if (reply->msg.rpchdr)
                 GF_FREE (reply->msg.rpchdr);
         if (reply->msg.proghdr)
@@ -50,40 +135,64 @@ rpcsvc_drc_op_destroy (rpcsvc_drc_globals_t *drc, drc_cached_op_t *reply)
         if (reply->msg.progpayload)
                 GF_FREE (reply->msg.progpayload);
 
-        list_del (&reply->global_list);
-        reply->client->op_count--;
-        drc->op_count--;
-        mem_put (reply);
-        reply = NULL;
+        __sync_sub_and_fetch (&drc->mem_used, reply->size);
+        __sync_sub_and_fetch (&drc->op_count, 1);
 
-        return reply;
+        /* the cached replies of a client outlive its connection, for it
+           to find them when retransmitting after a reconnect */
+        rpcsvc_drc_client_unref (drc, reply->client);
+
+        mem_put (reply);
 }
 
 /**
- * rpcsvc_drc_op_rb_unref - This function is used in rb tree cleanup only
+ * rpcsvc_drc_op_unref - drop a reference on a cached op, destroying it
+ *                       with the last one
  *
- * @param reply - the cached reply to unref
  * @param drc - the main drc structure
+ * @param reply - the cached op
+ * @return void
+ */
+void
+rpcsvc_drc_op_unref (rpcsvc_drc_globals_t *drc, drc_cached_op_t *reply)
+{
+        if (__sync_sub_and_fetch (&reply->ref, 1) == 0)
+                rpcsvc_drc_op_destroy (drc, reply);
+}
+
+/**
+ * __rpcsvc_drc_op_unlink - take an op out of its shard, with the shard lock
+ *                          held; the cache's reference is left to the caller
+ *
+ * @param reply - the op to unlink
  * @return void
  */
 static void
-rpcsvc_drc_rb_op_destroy (void *reply, void *drc)
+__rpcsvc_drc_op_unlink (drc_cached_op_t *reply)
 {
-        rpcsvc_drc_op_destroy (drc, (drc_cached_op_t *)reply);
+        list_del_init (&reply->hash);
+        list_del_init (&reply->lru);
+        reply->shard->op_count--;
+        __sync_sub_and_fetch (&reply->client->op_count, 1);
 }
 
 /**
- * rpcsvc_remove_drc_client - Cleanup the drc client
+ * rpcsvc_drc_release_ops - drop the cache's reference on unlinked ops
  *
- * @param client - the drc client to be removed
+ * @param drc - the main drc structure
+ * @param list - ops linked through their lru member
  * @return void
  */
 static void
-rpcsvc_remove_drc_client (drc_client_t *client)
+rpcsvc_drc_release_ops (rpcsvc_drc_globals_t *drc, struct list_head *list)
 {
-        rb_destroy (client->rbtree, rpcsvc_drc_rb_op_destroy);
-        list_del (&client->client_list);
-        GF_FREE (client);
+        drc_cached_op_t    *reply       = NULL;
+        drc_cached_op_t    *tmp         = NULL;
+
+        list_for_each_entry_safe (reply, tmp, list, lru) {
+                list_del_init (&reply->lru);
+                rpcsvc_drc_op_unref (drc, reply);
+        }
 }
 
 /**
@@ -115,102 +224,70 @@ rpcsvc_client_lookup (rpcsvc_drc_globals_t *drc,
 }
 
 /**
- * drc_compare_reqs - Used by rbtree to determine if incoming req matches with
- *                    an existing node(cached reply) in rbtree
+ * drc_req_checksum - checksum of the leading bytes of a request's arguments
  *
- * @param item - pointer to the incoming req
- * @param rb_node_data - pointer to an rbtree node (cached reply)
- * @param param - drc pointer - unused here, but used in *op_destroy
- * @return 0 if req matches reply, else (req->xid - reply->xid)
+ * @param req - the request
+ * @return the checksum
  */
-int
-drc_compare_reqs (const void *item, const void *rb_node_data, void *param)
+static uint32_t
+drc_req_checksum (rpcsvc_request_t *req)
 {
-        int               ret      = -1;
-        rpcsvc_request_t *req      = NULL;
-        drc_cached_op_t  *reply    = NULL;
-
-        GF_ASSERT (item);
-        GF_ASSERT (rb_node_data);
-        GF_ASSERT (param);
-
-        req = (rpcsvc_request_t *)item;
-        reply = (drc_cached_op_t *)rb_node_data;
-
-        ret = req->xid - reply->xid;
-        if (ret != 0)
-                return ret;
-
-        if (req->prognum == reply->prognum &&
-            req->procnum == reply->procnum &&
-            req->progver == reply->progversion)
+        if (!req->count || !req->msg[0].iov_len)
                 return 0;
 
-        return 1;
+        return gf_rsync_weak_checksum (req->msg[0].iov_base,
+                                       min (req->msg[0].iov_len,
+                                            DRC_CHECKSUM_LEN));
 }
 
 /**
- * drc_rb_calloc - used by rbtree api to allocate memory for nodes
+ * drc_match_req - determine if an incoming req matches a cached op
  *
- * @param allocator - the libavl_allocator structure used by rbtree
- * @param size - not needed by this function
- * @return pointer to new cached reply (node in rbtree)
+ * @param req - the incoming req
+ * @param checksum - drc_req_checksum () of req
+ * @param reply - the cached op
+ * @return 1 if req matches reply, 0 otherwise
  */
-static void *
-drc_rb_calloc (struct libavl_allocator *allocator, size_t size)
+static int
+drc_match_req (rpcsvc_request_t *req, uint32_t checksum,
+               drc_cached_op_t *reply)
 {
-        rpcsvc_drc_globals_t *drc = NULL;
-
-        /* get the drc pointer by simple typecast, since allocator
-         * is the first member of rpcsvc_drc_globals_t
-         */
-        drc = (rpcsvc_drc_globals_t *)allocator;
-
-        return mem_get (drc->mempool);
+        return (req->xid == reply->xid &&
+                checksum == reply->checksum &&
+                req->prognum == reply->prognum &&
+                req->procnum == reply->procnum &&
+                req->progver == reply->progversion);
 }
 
 /**
- * drc_rb_free - used by rbtree api to free a node
+ * drc_init_client_cache - initialize the shards of a drc client
  *
- * @param a - the libavl_allocator structure used by rbtree api
- * @param block - node that needs to be freed
+ * @param client - the drc client to be initialized
  * @return void
  */
 static void
-drc_rb_free (struct libavl_allocator *a, void *block)
+drc_init_client_cache (drc_client_t *client)
 {
-        mem_put (block);
-}
+        struct drc_shard   *shard       = NULL;
+        int                 i           = 0;
+        int                 j           = 0;
 
-/**
- * drc_init_client_cache - initialize a drc client and its rb tree
- *
- * @param drc - the main drc structure
- * @param client - the drc client to be initialized
- * @return 0 on success, -1 on failure
- */
-static int
-drc_init_client_cache (rpcsvc_drc_globals_t *drc, drc_client_t *client)
-{
-        GF_ASSERT (drc);
         GF_ASSERT (client);
 
-        drc->allocator.libavl_malloc = drc_rb_calloc;
-        drc->allocator.libavl_free = drc_rb_free;
+        for (i = 0; i < DRC_CLIENT_SHARDS; i++) {
+                shard = &client->shards[i];
 
-        client->rbtree = rb_create (drc_compare_reqs, drc,
-                                    (struct libavl_allocator *)drc);
-        if (!client->rbtree) {
-                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "rb tree creation failed");
-                return -1;
+                LOCK_INIT (&shard->lock);
+                INIT_LIST_HEAD (&shard->lru);
+                for (j = 0; j < DRC_SHARD_BUCKETS; j++)
+                        INIT_LIST_HEAD (&shard->buckets[j]);
         }
-
-        return 0;
 }
 
 /**
  * rpcsvc_get_drc_client - find the drc client with given sockaddr, else
- *                         allocate and initialize a new drc client
+ *                         allocate and initialize a new drc client; to be
+ *                         called with drc->lock held
  *
  * @param drc - the main drc structure
  * @param sockaddr - network address of client
@@ -239,13 +316,7 @@ rpcsvc_get_drc_client (rpcsvc_drc_globals_t *drc,
         client->sock_union = (union gf_sock_union)*sockaddr;
         client->op_count = 0;
 
-        if (drc_init_client_cache (drc, client)) {
-                gf_log (GF_RPCSVC, GF_LOG_DEBUG,
-                        "initialization of drc client failed");
-                GF_FREE (client);
-                client = NULL;
-                goto out;
-        }
+        drc_init_client_cache (client);
         drc->client_count++;
 
         list_add (&client->client_list, &drc->clients_head);
@@ -283,76 +354,259 @@ rpcsvc_need_drc (rpcsvc_request_t *req)
 }
 
 /**
- * rpcsvc_drc_client_ref - ref the drc client
+ * rpcsvc_drc_over_limit - check whether the cache is over its entry or
+ *                         memory budget, not counting ops about to go
  *
- * @param client - the drc client to ref
- * @return client
+ * @param drc - the main drc structure
+ * @param ops - no. of ops already unlinked but not yet destroyed
+ * @param bytes - their size
+ * @return _gf_true if something has to be evicted
  */
-static drc_client_t *
-rpcsvc_drc_client_ref (drc_client_t *client)
+static gf_boolean_t
+rpcsvc_drc_over_limit (rpcsvc_drc_globals_t *drc, uint32_t ops,
+                       uint64_t bytes)
 {
-        GF_ASSERT (client);
-        client->ref++;
-        return client;
+        uint32_t        op_count = drc->op_count;
+        uint64_t        mem_used = drc->mem_used;
+
+        if (op_count <= ops)
+                return _gf_false;
+
+        return (op_count - ops >= drc->global_cache_size ||
+                (mem_used > bytes && mem_used - bytes > drc->mem_size));
 }
 
 /**
- * rpcsvc_drc_client_unref - unref the drc client, and destroy
- *                           the client on last unref
+ * __rpcsvc_drc_shard_evict - unlink the oldest cached ops of a shard while
+ *                            the cache is over its limits, at least the lru
+ *                            factor's share of the shard
  *
  * @param drc - the main drc structure
- * @param client - the drc client to unref
- * @return NULL if it is the last unref, client otherwise
+ * @param shard - the shard, locked
+ * @param evicted - where to put the unlinked ops for rpcsvc_drc_release_ops
+ * @param ops - no. of ops on evicted, updated
+ * @param bytes - their size, updated
+ * @return void
  */
-static drc_client_t *
-rpcsvc_drc_client_unref (rpcsvc_drc_globals_t *drc, drc_client_t *client)
+static void
+__rpcsvc_drc_shard_evict (rpcsvc_drc_globals_t *drc, struct drc_shard *shard,
+                          struct list_head *evicted, uint32_t *ops,
+                          uint64_t *bytes)
+{
+        uint32_t            n           = 0;
+        uint32_t            i           = 0;
+        drc_cached_op_t    *reply       = NULL;
+        drc_cached_op_t    *tmp         = NULL;
+
+        n = shard->op_count / drc->lru_factor;
+
+        list_for_each_entry_safe (reply, tmp, &shard->lru, lru) {
+                if (i >= n && !rpcsvc_drc_over_limit (drc, *ops, *bytes))
+                        break;
+
+                /* Don't delete ops that are in transit */
+                if (reply->state == DRC_OP_IN_TRANSIT)
+                        continue;
+
+                __rpcsvc_drc_op_unlink (reply);
+                list_add_tail (&reply->lru, evicted);
+                *bytes += reply->size;
+                (*ops)++;
+                i++;
+        }
+}
+
+/**
+ * rpcsvc_vacate_drc_entries - free up space in the shards of all clients
+ *                             when the shard of the current request had
+ *                             not enough to give; busy locks are skipped
+ *
+ * @param drc - the main drc structure
+ * @return void
+ */
+static void
+rpcsvc_vacate_drc_entries (rpcsvc_drc_globals_t *drc)
 {
+        struct list_head    evicted;
+        drc_client_t       *client      = NULL;
+        struct drc_shard   *shard       = NULL;
+        uint32_t            ops         = 0;
+        uint64_t            bytes       = 0;
+        int                 i           = 0;
+
         GF_ASSERT (drc);
-        GF_ASSERT (client->ref);
 
-        client->ref--;
-        if (!client->ref) {
-                drc->client_count--;
-                rpcsvc_remove_drc_client (client);
-                client = NULL;
+        INIT_LIST_HEAD (&evicted);
+
+        if (TRY_LOCK (&drc->lock))
+                return;
+
+        list_for_each_entry (client, &drc->clients_head, client_list) {
+                for (i = 0; i < DRC_CLIENT_SHARDS; i++) {
+                        if (!rpcsvc_drc_over_limit (drc, ops, bytes))
+                                goto unlock;
+
+                        shard = &client->shards[i];
+                        if (TRY_LOCK (&shard->lock))
+                                continue;
+
+                        __rpcsvc_drc_shard_evict (drc, shard, &evicted,
+                                                  &ops, &bytes);
+                        UNLOCK (&shard->lock);
+                }
         }
 
-        return client;
+ unlock:
+        UNLOCK (&drc->lock);
+
+        /* dropping the last op of a client frees the client, which takes
+           drc->lock */
+        rpcsvc_drc_release_ops (drc, &evicted);
 }
 
 /**
- * rpcsvc_drc_lookup - lookup a request to see if it is already cached
+ * rpcsvc_drc_shard - the shard and hash chain of a client a xid belongs to
+ *
+ * @param client - the drc client
+ * @param xid - the xid of the request
+ * @param bucket - the chain in the shard
+ * @return the shard
+ */
+static struct drc_shard *
+rpcsvc_drc_shard (drc_client_t *client, uint32_t xid,
+                  struct list_head **bucket)
+{
+        struct drc_shard   *shard       = NULL;
+
+        /* clients hand out xids in sequence */
+        shard = &client->shards[xid % DRC_CLIENT_SHARDS];
+        *bucket = &shard->buckets[(xid / DRC_CLIENT_SHARDS) %
+                                  DRC_SHARD_BUCKETS];
+
+        return shard;
+}
+
+/**
+ * __rpcsvc_cache_request - cache the in-transition incoming request, with
+ *                          the shard lock held
  *
  * @param req - incoming request
- * @return cached reply of req if found, NULL otherwise
+ * @param client - the drc client of the request
+ * @param shard - the shard of the request, locked
+ * @param bucket - the hash chain of the request
+ * @param checksum - drc_req_checksum () of req
+ * @return 0 on success, -1 on failure
+ */
+static int
+__rpcsvc_cache_request (rpcsvc_request_t *req, drc_client_t *client,
+                        struct drc_shard *shard, struct list_head *bucket,
+                        uint32_t checksum)
+{
+        drc_cached_op_t           *reply          = NULL;
+        rpcsvc_drc_globals_t      *drc            = NULL;
+
+        drc = req->svc->drc;
+
+        reply = mem_get (drc->mempool);
+        if (!reply)
+                return -1;
+
+        memset (reply, 0, sizeof (*reply));
+        reply->client = rpcsvc_drc_client_ref (client);
+        reply->shard = shard;
+        reply->xid = req->xid;
+        reply->prognum = req->prognum;
+        reply->progversion = req->progver;
+        reply->procnum = req->procnum;
+        reply->checksum = checksum;
+        reply->state = DRC_OP_IN_TRANSIT;
+        reply->size = sizeof (*reply);
+        reply->ref = 1;
+
+        list_add_tail (&reply->hash, bucket);
+        list_add_tail (&reply->lru, &shard->lru);
+        shard->op_count++;
+        __sync_add_and_fetch (&client->op_count, 1);
+        __sync_add_and_fetch (&drc->op_count, 1);
+        __sync_add_and_fetch (&drc->mem_used, reply->size);
+
+        req->reply = reply;
+
+        return 0;
+}
+
+/**
+ * rpcsvc_drc_lookup - lookup a request to see if it is already cached, and
+ *                     cache it as in transit if it is not
+ *
+ * @param req - incoming request
+ * @return cached reply of req if found, with a reference the caller has to
+ *         drop with rpcsvc_drc_op_unref (), NULL otherwise
  */
 drc_cached_op_t *
 rpcsvc_drc_lookup (rpcsvc_request_t *req)
 {
-        drc_client_t           *client = NULL;
-        drc_cached_op_t        *reply  = NULL;
+        rpcsvc_drc_globals_t   *drc      = NULL;
+        drc_client_t           *client   = NULL;
+        drc_cached_op_t        *reply    = NULL;
+        drc_cached_op_t        *tmp      = NULL;
+        struct drc_shard       *shard    = NULL;
+        struct list_head       *bucket   = NULL;
+        struct list_head        evicted;
+        uint32_t                checksum = 0;
+        uint32_t                ops      = 0;
+        uint64_t                bytes    = 0;
+        gf_boolean_t            full     = _gf_false;
 
         GF_ASSERT (req);
 
+        drc = req->svc->drc;
+        INIT_LIST_HEAD (&evicted);
+
         if (!req->trans->drc_client) {
-                client = rpcsvc_get_drc_client (req->svc->drc,
+                LOCK (&drc->lock);
+                client = rpcsvc_get_drc_client (drc,
                                                 &req->trans->peerinfo.sockaddr);
+                if (client)
+                        req->trans->drc_client = rpcsvc_drc_client_ref (client);
+                UNLOCK (&drc->lock);
                 if (!client)
                         goto out;
-                req->trans->drc_client = client;
         }
 
-        client = rpcsvc_drc_client_ref (req->trans->drc_client);
+        client = req->trans->drc_client;
+        checksum = drc_req_checksum (req);
+        shard = rpcsvc_drc_shard (client, req->xid, &bucket);
+
+        LOCK (&shard->lock);
+        {
+                list_for_each_entry (tmp, bucket, hash) {
+                        if (drc_match_req (req, checksum, tmp)) {
+                                reply = tmp;
+                                __sync_add_and_fetch (&reply->ref, 1);
+                                goto unlock;
+                        }
+                }
 
-        if (client->op_count == 0)
-                goto out;
+                /* cache is full, free up some space */
+                if (rpcsvc_drc_over_limit (drc, 0, 0)) {
+                        __rpcsvc_drc_shard_evict (drc, shard, &evicted,
+                                                  &ops, &bytes);
+                        full = rpcsvc_drc_over_limit (drc, ops, bytes);
+                }
 
-        reply = rb_find (client->rbtree, req);
+                if (__rpcsvc_cache_request (req, client, shard, bucket,
+                                            checksum))
+                        gf_log (GF_RPCSVC, GF_LOG_DEBUG,
+                                "Failed to add op to drc cache");
+        }
+ unlock:
+        UNLOCK (&shard->lock);
 
+        rpcsvc_drc_release_ops (drc, &evicted);
+        if (full)
+                rpcsvc_vacate_drc_entries (drc);
  out:
-        if (client)
-                rpcsvc_drc_client_unref (req->svc->drc, client);
-
         return reply;
 }
 
@@ -360,7 +614,7 @@ rpcsvc_drc_lookup (rpcsvc_request_t *req)
  * rpcsvc_send_cached_reply - send the cached reply for the incoming request
  *
  * @param req - incoming request (which is a duplicate in this case)
- * @param reply - the cached reply for req
+ * @param reply - the cached reply for req, referenced
  * @return 0 on successful reply submission, -1 or other non-zero value otherwise
  */
 int
@@ -374,13 +628,11 @@ rpcsvc_send_cached_reply (rpcsvc_request_t *req, drc_cached_op_t *reply)
         gf_log (GF_RPCSVC, GF_LOG_DEBUG, "sending cached reply: xid: %d, "
                 "client: %s", req->xid, req->trans->peerinfo.identifier);
 
-        rpcsvc_drc_client_ref (reply->client);
         ret = rpcsvc_transport_submit (req->trans,
                      reply->msg.rpchdr, reply->msg.rpchdrcount,
                      reply->msg.proghdr, reply->msg.proghdrcount,
                      reply->msg.progpayload, reply->msg.progpayloadcount,
                      reply->msg.iobref, req->trans_private);
-        rpcsvc_drc_client_unref (req->svc->drc, reply->client);
 
         return ret;
 }
@@ -406,155 +658,60 @@ rpcsvc_cache_reply (rpcsvc_request_t *req, struct iobref *iobref,
 {
         int                       ret              = -1;
         drc_cached_op_t          *reply            = NULL;
+        rpcsvc_drc_globals_t     *drc              = NULL;
+        struct list_head          evicted;
+        size_t                    size             = 0;
+        uint32_t                  ops              = 0;
+        uint64_t                  bytes            = 0;
+        gf_boolean_t              full             = _gf_false;
 
         GF_ASSERT (req);
         GF_ASSERT (req->reply);
 
+        drc = req->svc->drc;
         reply = req->reply;
+        INIT_LIST_HEAD (&evicted);
 
-        reply->state = DRC_OP_CACHED;
+        size = iov_length (rpchdr, rpchdrcount) +
+                iov_length (proghdr, proghdrcount) +
+                iov_length (payload, payloadcount);
 
-        reply->msg.iobref = iobref_ref (iobref);
+        LOCK (&reply->shard->lock);
+        {
+                reply->msg.iobref = iobref_ref (iobref);
 
-        reply->msg.rpchdrcount = rpchdrcount;
-        reply->msg.rpchdr = iov_dup (rpchdr, rpchdrcount);
+                reply->msg.rpchdrcount = rpchdrcount;
+                reply->msg.rpchdr = iov_dup (rpchdr, rpchdrcount);
 
-        reply->msg.proghdrcount = proghdrcount;
-        reply->msg.proghdr = iov_dup (proghdr, proghdrcount);
+                reply->msg.proghdrcount = proghdrcount;
+                reply->msg.proghdr = iov_dup (proghdr, proghdrcount);
 
-        reply->msg.progpayloadcount = payloadcount;
-        if (payloadcount)
-                reply->msg.progpayload = iov_dup (payload, payloadcount);
+                reply->msg.progpayloadcount = payloadcount;
+                if (payloadcount)
+                        reply->msg.progpayload = iov_dup (payload,
+                                                          payloadcount);
 
-        //        rpcsvc_drc_client_unref (req->svc->drc, req->trans->drc_client);
-        //        rpcsvc_drc_op_unref (req->svc->drc, reply);
-        ret = 0;
+                reply->size += size;
+                __sync_add_and_fetch (&drc->mem_used, size);
 
-        return ret;
-}
+                reply->state = DRC_OP_CACHED;
 
-/**
- * rpcsvc_vacate_drc_entries - free up some percentage of drc cache
- *                             based on the lru factor
- *
- * @param drc - the main drc structure
- * @return void
- */
-static void
-rpcsvc_vacate_drc_entries (rpcsvc_drc_globals_t *drc)
-{
-        uint32_t            i           = 0;
-        uint32_t            n           = 0;
-        drc_cached_op_t    *reply       = NULL;
-        drc_cached_op_t    *tmp         = NULL;
-        drc_client_t       *client      = NULL;
-
-        GF_ASSERT (drc);
-
-        n = drc->global_cache_size / drc->lru_factor;
-
-        list_for_each_entry_safe_reverse (reply, tmp, &drc->cache_head, global_list) {
-                /* Don't delete ops that are in transit */
-                if (reply->state == DRC_OP_IN_TRANSIT)
-                        continue;
-
-                client = reply->client;
-
-                (void *)rb_delete (client->rbtree, reply);
-
-                rpcsvc_drc_op_destroy (drc, reply);
-                rpcsvc_drc_client_unref (drc, client);
-                i++;
-                if (i >= n)
-                        break;
+                if (rpcsvc_drc_over_limit (drc, 0, 0)) {
+                        __rpcsvc_drc_shard_evict (drc, reply->shard,
+                                                  &evicted, &ops, &bytes);
+                        full = rpcsvc_drc_over_limit (drc, ops, bytes);
+                }
         }
-}
+        UNLOCK (&reply->shard->lock);
 
-/**
- * rpcsvc_add_op_to_cache - insert the cached op into the client rbtree and drc list
- *
- * @param drc - the main drc structure
- * @param reply - the op to be inserted
- * @return 0 on success, -1 on failure
- */
-static int
-rpcsvc_add_op_to_cache (rpcsvc_drc_globals_t *drc, drc_cached_op_t *reply)
-{
-        drc_client_t        *client         = NULL;
-        drc_cached_op_t    **tmp_reply      = NULL;
-
-        GF_ASSERT (drc);
-        GF_ASSERT (reply);
+        req->reply = NULL;
 
-        client = reply->client;
-
-        /* cache is full, free up some space */
-        if (drc->op_count >= drc->global_cache_size)
+        rpcsvc_drc_release_ops (drc, &evicted);
+        if (full)
                 rpcsvc_vacate_drc_entries (drc);
 
-        tmp_reply = (drc_cached_op_t **)rb_probe (client->rbtree, reply);
-        if (*tmp_reply != reply) {
-                /* should never happen */
-                gf_log (GF_RPCSVC, GF_LOG_ERROR,
-                        "DRC failed to detect duplicates");
-                return -1;
-        } else if (*tmp_reply == NULL) {
-                /* mem alloc failed */
-                return -1;
-        }
-
-        client->op_count++;
-        list_add (&reply->global_list, &drc->cache_head);
-        drc->op_count++;
-
-        return 0;
-}
-
-/**
- * rpcsvc_cache_request - cache the in-transition incoming request
- *
- * @param req - incoming request
- * @return 0 on success, -1 on failure
- */
-int
-rpcsvc_cache_request (rpcsvc_request_t *req)
-{
-        int                        ret            = -1;
-        drc_client_t              *client         = NULL;
-        drc_cached_op_t           *reply          = NULL;
-        rpcsvc_drc_globals_t      *drc            = NULL;
-
-        GF_ASSERT (req);
-
-        drc = req->svc->drc;
-
-        client = req->trans->drc_client;
-        if (!client) {
-                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "drc client is NULL");
-                goto out;
-        }
-
-        reply = mem_get (drc->mempool);
-        if (!reply)
-                goto out;
-
-        reply->client = rpcsvc_drc_client_ref (client);
-        reply->xid = req->xid;
-        reply->prognum = req->prognum;
-        reply->progversion = req->progver;
-        reply->procnum = req->procnum;
-        reply->state = DRC_OP_IN_TRANSIT;
-        req->reply = reply;
-
-        ret = rpcsvc_add_op_to_cache (drc, reply);
-        if (ret) {
-                req->reply = NULL;
-                rpcsvc_drc_op_destroy (drc, reply);
-                rpcsvc_drc_client_unref (drc, client);
-                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "Failed to add op to drc cache");
-        }
+        ret = 0;
 
- out:
         return ret;
 }
 
@@ -596,14 +753,20 @@ rpcsvc_drc_priv (rpcsvc_drc_globals_t *drc)
         gf_proc_dump_build_key (key, "drc", "max_cache_size");
         gf_proc_dump_write (key, "%d", drc->global_cache_size);
 
+        gf_proc_dump_build_key (key, "drc", "current_mem_size");
+        gf_proc_dump_write (key, "%"PRIu64, drc->mem_used);
+
+        gf_proc_dump_build_key (key, "drc", "max_mem_size");
+        gf_proc_dump_write (key, "%"PRIu64, drc->mem_size);
+
         gf_proc_dump_build_key (key, "drc", "lru_factor");
         gf_proc_dump_write (key, "%d", drc->lru_factor);
 
         gf_proc_dump_build_key (key, "drc", "duplicate_request_count");
-        gf_proc_dump_write (key, "%d", drc->cache_hits);
+        gf_proc_dump_write (key, "%"PRIu64, drc->cache_hits);
 
         gf_proc_dump_build_key (key, "drc", "in_transit_duplicate_requests");
-        gf_proc_dump_write (key, "%d", drc->intransit_hits);
+        gf_proc_dump_write (key, "%"PRIu64, drc->intransit_hits);
 
         list_for_each_entry (client, &drc->clients_head, client_list) {
                 gf_proc_dump_build_key (key, "client", "%d.ip-address", i);
@@ -679,8 +842,8 @@ rpcsvc_drc_notify (rpcsvc_t *svc, void *xl,
                 ret = 0;
                 if (list_empty (&drc->clients_head))
                         break;
-                /* should be the last unref */
-                rpcsvc_drc_client_unref (drc, client);
+                /* the client stays as long as it has ops cached */
+                __rpcsvc_drc_client_unref (drc, client);
                 trans->drc_client = NULL;
                 break;
 
@@ -693,6 +856,34 @@ rpcsvc_drc_notify (rpcsvc_t *svc, void *xl,
         return ret;
 }
 
+/**
+ * rpcsvc_drc_get_mem_size - read the memory bound of the cache
+ *
+ * @param options - the options dictionary which configures drc
+ * @param mem_size - where to store the bound, in bytes
+ * @return 0 on success, -1 if the option is not a valid size
+ */
+static int
+rpcsvc_drc_get_mem_size (dict_t *options, uint64_t *mem_size)
+{
+        char            *str    = NULL;
+
+        if (dict_get_str (options, "nfs.drc-mem-size", &str)) {
+                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "drc mem size not set."
+                        " Continuing with default size");
+                *mem_size = DRC_DEFAULT_MEM_SIZE;
+                return 0;
+        }
+
+        if (gf_string2bytesize (str, mem_size) || !*mem_size) {
+                gf_log (GF_RPCSVC, GF_LOG_ERROR, "invalid nfs.drc-mem-size: "
+                        "%s", str);
+                return -1;
+        }
+
+        return 0;
+}
+
 /**
  * rpcsvc_drc_init - Initialize the duplicate request cache service
  *
@@ -707,6 +898,7 @@ rpcsvc_drc_init (rpcsvc_t *svc, dict_t *options)
         uint32_t                    drc_type       = 0;
         uint32_t                    drc_size       = 0;
         uint32_t                    drc_factor     = 0;
+        uint64_t                    drc_mem_size   = 0;
         rpcsvc_drc_globals_t       *drc            = NULL;
         static gf_boolean_t         drc_inited     = _gf_false;
 
@@ -771,6 +963,13 @@ rpcsvc_drc_init (rpcsvc_t *svc, dict_t *options)
 
         drc->global_cache_size = drc_size;
 
+        /* Set the bound on memory used by cached replies */
+        ret = rpcsvc_drc_get_mem_size (options, &drc_mem_size);
+        if (ret)
+                goto out;
+
+        drc->mem_size = drc_mem_size;
+
         /* Mempool for cached ops */
         drc->mempool = mem_pool_new (drc_cached_op_t, drc->global_cache_size);
         if (!drc->mempool) {
@@ -791,7 +990,6 @@ rpcsvc_drc_init (rpcsvc_t *svc, dict_t *options)
         drc->lru_factor = (drc_lru_factor_t) drc_factor;
 
         INIT_LIST_HEAD (&drc->clients_head);
-        INIT_LIST_HEAD (&drc->cache_head);
 
         ret = rpcsvc_register_notify (svc, rpcsvc_drc_notify, THIS);
         if (ret) {
@@ -824,6 +1022,7 @@ rpcsvc_drc_reconfigure (rpcsvc_t *svc, dict_t *options)
         gf_boolean_t            enable_drc = _gf_false;
         rpcsvc_drc_globals_t    *drc       = NULL;
         uint32_t                drc_size   = 0;
+        uint64_t                drc_mem_size = 0;
 
         if ((!svc) || (!options))
                 return (-1);
@@ -839,6 +1038,12 @@ rpcsvc_drc_reconfigure (rpcsvc_t *svc, dict_t *options)
                 return (-1);
         }
 
+        /* drc-mem-size only bounds eviction, it can change at any time */
+        if (rpcsvc_drc_get_mem_size (options, &drc_mem_size))
+                return (-1);
+
+        drc->mem_size = drc_mem_size;
+
         /* reconfig for nfs.drc */
         ret = dict_get_str_boolean (options, "nfs.drc", _gf_true);
         if (ret < 0) {
@@ -20,17 +20,35 @@
 #include "rpcsvc.h"
 #include "locking.h"
 #include "dict.h"
-#include "rb.h"
+
+/* Each client's cache is split over DRC_CLIENT_SHARDS locks, by xid; every
+ * shard hashes its ops over DRC_SHARD_BUCKETS chains and keeps them in the
+ * order they were added for eviction.
+ */
+#define DRC_CLIENT_SHARDS       16
+#define DRC_SHARD_BUCKETS       64
+
+/* requests with the same xid and program only match if the checksum of
+ * this many leading bytes of their arguments matches too
+ */
+#define DRC_CHECKSUM_LEN        256
+
+struct drc_shard {
+        gf_lock_t                  lock;
+        /* ops of this shard, oldest first */
+        struct list_head           lru;
+        uint32_t                   op_count;
+        struct list_head           buckets[DRC_SHARD_BUCKETS];
+};
 
 /* per-client cache structure */
 struct drc_client {
         uint32_t                   ref;
         union gf_sock_union        sock_union;
-        /* pointers to the cache */
-        struct rb_table           *rbtree;
         /* no. of ops currently cached */
         uint32_t                   op_count;
         struct list_head           client_list;
+        struct drc_shard           shards[DRC_CLIENT_SHARDS];
 };
 
 struct drc_cached_op {
@@ -39,10 +57,15 @@ struct drc_cached_op {
         int                            prognum;
         int                            progversion;
         int                            procnum;
+        uint32_t                       checksum;
+        /* bytes charged to the cache for this op */
+        size_t                         size;
         rpc_transport_msg_t            msg;
         drc_client_t                  *client;
-        struct list_head               client_list;
-        struct list_head               global_list;
+        struct drc_shard              *shard;
+        struct list_head               hash;
+        struct list_head               lru;
+        /* one for the cache, one for each cached reply being sent */
         int32_t                        ref;
 };
 
@@ -54,21 +77,20 @@ enum drc_status {
 typedef enum drc_status drc_status_t;
 
 struct drc_globals {
-        /* allocator must be the first member since
-         * it is used so in gf_libavl_allocator
-         */
-        struct libavl_allocator   allocator;
         drc_type_t                type;
-        /* configurable size parameter */
+        /* configurable size parameters */
         uint32_t                  global_cache_size;
+        uint64_t                  mem_size;
         drc_lru_factor_t          lru_factor;
+        /* protects the client list */
         gf_lock_t                 lock;
         drc_status_t              status;
+        /* updated atomically, without the lock */
         uint32_t                  op_count;
+        uint64_t                  mem_used;
         uint64_t                  cache_hits;
         uint64_t                  intransit_hits;
         struct mem_pool          *mempool;
-        struct list_head          cache_head;
         uint32_t                  client_count;
         struct list_head          clients_head;
         gf_boolean_t              enable_drc;
@@ -80,6 +102,9 @@ rpcsvc_need_drc (rpcsvc_request_t *req);
 drc_cached_op_t *
 rpcsvc_drc_lookup (rpcsvc_request_t *req);
 
+void
+rpcsvc_drc_op_unref (rpcsvc_drc_globals_t *drc, drc_cached_op_t *reply);
+
 int
 rpcsvc_send_cached_reply (rpcsvc_request_t *req, drc_cached_op_t *reply);
 
@@ -89,9 +114,6 @@ rpcsvc_cache_reply (rpcsvc_request_t *req, struct iobref *iobref,
                     struct iovec *proghdr, int proghdrcount,
                     struct iovec *payload, int payloadcount);
 
-int
-rpcsvc_cache_request (rpcsvc_request_t *req);
-
 int32_t
 rpcsvc_drc_priv (rpcsvc_drc_globals_t *drc);
 
@@ -120,6 +120,7 @@ typedef enum drc_policy drc_policy_t;
 #define DRC_DEFAULT_TYPE               DRC_TYPE_IN_MEMORY
 #define DRC_DEFAULT_CACHE_SIZE         0x20000
 #define DRC_DEFAULT_LRU_FACTOR         DRC_LRU_25_PC
+#define DRC_DEFAULT_MEM_SIZE           (64 * GF_UNIT_MB)
 
 /* DRC END */
 
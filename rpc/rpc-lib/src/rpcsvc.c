@@ -574,7 +574,7 @@ rpcsvc_handle_rpc_call (rpcsvc_t *svc, rpc_transport_t *trans,
         if (rpcsvc_need_drc (req)) {
                 drc = req->svc->drc;
 
-                LOCK (&drc->lock);
+                /* caches a fresh request as in-transit */
                 reply = rpcsvc_drc_lookup (req);
 
                 /* retransmission of completed request, send cached reply */
@@ -582,25 +582,20 @@ rpcsvc_handle_rpc_call (rpcsvc_t *svc, rpc_transport_t *trans,
                         gf_log (GF_RPCSVC, GF_LOG_INFO, "duplicate request:"
                                 " XID: 0x%x", req->xid);
                         ret = rpcsvc_send_cached_reply (req, reply);
-                        drc->cache_hits++;
-                        UNLOCK (&drc->lock);
+                        __sync_fetch_and_add (&drc->cache_hits, 1);
+                        rpcsvc_drc_op_unref (drc, reply);
                         goto out;
 
                 } /* retransmitted request, original op in transit, drop it */
-                else if (reply && reply->state == DRC_OP_IN_TRANSIT) {
+                else if (reply) {
                         gf_log (GF_RPCSVC, GF_LOG_INFO, "op in transit,"
                                 " discarding. XID: 0x%x", req->xid);
                         ret = 0;
-                        drc->intransit_hits++;
+                        __sync_fetch_and_add (&drc->intransit_hits, 1);
+                        rpcsvc_drc_op_unref (drc, reply);
                         rpcsvc_request_destroy (req);
-                        UNLOCK (&drc->lock);
                         goto out;
-
-                } /* fresh request, cache it as in-transit and proceed */
-                else {
-                        ret = rpcsvc_cache_request (req);
                 }
-                UNLOCK (&drc->lock);
         }
 
         if (req->rpc_err == SUCCESS) {
@@ -1147,7 +1142,6 @@ rpcsvc_submit_generic (rpcsvc_request_t *req, struct iovec *proghdr,
         size_t                  msglen     = 0;
         size_t                  hdrlen     = 0;
         char                    new_iobref = 0;
-        rpcsvc_drc_globals_t   *drc        = NULL;
 
         if ((!req) || (!req->trans))
                 return -1;
@@ -1184,13 +1178,9 @@ rpcsvc_submit_generic (rpcsvc_request_t *req, struct iovec *proghdr,
 
         /* cache the request in the duplicate request cache for appropriate ops */
         if (req->reply) {
-                drc = req->svc->drc;
-
-                LOCK (&drc->lock);
                 ret = rpcsvc_cache_reply (req, iobref, &recordhdr, 1,
                                           proghdr, hdrcount,
                                           payload, payloadcount);
-                UNLOCK (&drc->lock);
         }
 
         ret = rpcsvc_transport_submit (trans, &recordhdr, 1, proghdr, hdrcount,
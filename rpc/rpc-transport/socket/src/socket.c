@@ -349,68 +349,65 @@ __socket_ssl_read (rpc_transport_t *this, void *buf, size_t count)
 }
 
 
+/*
+ * Reads for the record state machine.  Bytes left in the receive buffer
+ * are served first; once it is empty a small read refills it with a single
+ * recv, which usually brings in the rest of the record and the records
+ * after it, and a large read goes directly into the caller's vector.
+ */
 static int
 __socket_cached_read (rpc_transport_t *this, struct iovec *opvector, int opcount)
 {
 	socket_private_t   *priv = NULL;
-	int                 sock = -1;
-	struct gf_sock_incoming *in = NULL;
-	int                 req_len = -1;
+	struct iovec        vector[MAX_IOVEC + 1];
+	size_t              req_len = 0;
 	int                 ret = -1;
 
 	priv = this->private;
-	sock = priv->sock;
-	in = &priv->incoming;
 	req_len = iov_length (opvector, opcount);
 
-	if (in->record_state == SP_STATE_READING_FRAGHDR) {
-		in->ra_read = 0;
-		in->ra_served = 0;
-		in->ra_max = 0;
-		in->ra_buf = NULL;
-		goto uncached;
-	}
-
-	if (!in->ra_max) {
-		/* first call after passing SP_STATE_READING_FRAGHDR */
-		in->ra_max = min (RPC_FRAGSIZE (in->fraghdr), GF_SOCKET_RA_MAX);
-		/* Note that the in->iobuf is the primary iobuf into which
-		   headers are read into. By using this itself as our
-		   read-ahead cache, we can avoid memory copies in iov_load
-		*/
-		in->ra_buf = iobuf_ptr (in->iobuf);
+	if (priv->rbuf_start < priv->rbuf_end) {
+		ret = iov_load (opvector, opcount, &priv->rbuf[priv->rbuf_start],
+				min (req_len, priv->rbuf_end - priv->rbuf_start));
+		priv->rbuf_start += ret;
+		/* do not read buffered and unbuffered in the same call */
+		goto out;
 	}
 
-	/* fill read-ahead */
-	if (in->ra_read < in->ra_max) {
-		ret = __socket_ssl_read (this, &in->ra_buf[in->ra_read],
-					 (in->ra_max - in->ra_read));
-		if (ret > 0)
-			in->ra_read += ret;
+	priv->rbuf_start = priv->rbuf_end = 0;
 
-		/* we proceed to test if there is still cached data to
-		   be served even if readahead could not progress */
+	if (!priv->rbuf) {
+		priv->rbuf = GF_MALLOC (GF_SOCKET_RBUF_SIZE,
+					gf_common_mt_socket_rbuf);
+		if (!priv->rbuf)
+			goto uncached;
 	}
 
-	/* serve cached */
-	if (in->ra_served < in->ra_read) {
-		ret = iov_load (opvector, opcount, &in->ra_buf[in->ra_served],
-				min (req_len, (in->ra_read - in->ra_served)));
+	if (req_len >= GF_SOCKET_RBUF_DIRECT) {
+		if (opcount > MAX_IOVEC)
+			goto uncached;
 
-		in->ra_served += ret;
-		/* Do not read uncached and cached in the same call */
+		memcpy (vector, opvector, opcount * sizeof (*vector));
+		vector[opcount].iov_base = priv->rbuf;
+		vector[opcount].iov_len = GF_SOCKET_RBUF_SIZE;
+
+		ret = __socket_ssl_readv (this, vector, opcount + 1);
+		if (ret > (int) req_len) {
+			priv->rbuf_end = ret - req_len;
+			ret = req_len;
+		}
 		goto out;
 	}
 
-	if (in->ra_read < in->ra_max)
-		/* If there was no cached data to be served, (and we are
-		   guaranteed to have already performed an attempt to progress
-		   readahead above), and we have not yet read out the full
-		   readahead capacity, then bail out for now without doing
-		   the uncached read below (as that will overtake future cached
-		   read)
-		*/
+	ret = __socket_ssl_read (this, priv->rbuf, GF_SOCKET_RBUF_SIZE);
+	if (ret <= 0)
 		goto out;
+
+	priv->rbuf_end = ret;
+	ret = iov_load (opvector, opcount, priv->rbuf, min (req_len, ret));
+	priv->rbuf_start = ret;
+	goto out;
+
 uncached:
 	ret = __socket_ssl_readv (this, opvector, opcount);
 out:
@@ -479,6 +476,7 @@ __socket_rwv (rpc_transport_t *this, struct iovec *vector, int count,
 			else {
 				ret = writev (sock, opvector, opcount);
 			}
+                        this->total_write_calls++;
 
                         if (ret == 0 || (ret == -1 && errno == EAGAIN)) {
                                 /* done for now */
@@ -844,6 +842,7 @@ __socket_reset (rpc_transport_t *this)
         GF_FREE (priv->incoming.request_info);
 
         memset (&priv->incoming, 0, sizeof (priv->incoming));
+        priv->rbuf_start = priv->rbuf_end = 0;
 
         event_unregister (this->ctx->event_pool, priv->sock, priv->idx);
 
@@ -983,12 +982,35 @@ out:
 }
 
 
+static void
+__socket_ioq_entry_done (rpc_transport_t *this, struct ioq *entry, int direct)
+{
+	socket_private_t *priv = NULL;
+	char              a_byte = 0;
+
+        GF_ASSERT (entry->pending_count == 0);
+        __socket_ioq_entry_free (entry);
+        this->total_msgs_write++;
+
+        priv = this->private;
+        if (priv->own_thread) {
+                /*
+                 * The pipe should only remain readable if there are
+                 * more entries after this, so drain the byte
+                 * representing this entry.
+                 */
+                if (!direct && read(priv->pipe[0],&a_byte,1) < 1) {
+                        gf_log(this->name,GF_LOG_WARNING,
+                               "read error on pipe");
+                }
+        }
+}
+
+
 static int
 __socket_ioq_churn_entry (rpc_transport_t *this, struct ioq *entry, int direct)
 {
         int               ret = -1;
-	socket_private_t *priv = NULL;
-	char              a_byte = 0;
 
         ret = __socket_writev (this, entry->pending_vector,
                                entry->pending_count,
@@ -997,32 +1019,77 @@ __socket_ioq_churn_entry (rpc_transport_t *this, struct ioq *entry, int direct)
 
         if (ret == 0) {
                 /* current entry was completely written */
-                GF_ASSERT (entry->pending_count == 0);
-                __socket_ioq_entry_free (entry);
-		priv = this->private;
-		if (priv->own_thread) {
-			/*
-			 * The pipe should only remain readable if there are
-			 * more entries after this, so drain the byte
-			 * representing this entry.
-			 */
-			if (!direct && read(priv->pipe[0],&a_byte,1) < 1) {
-				gf_log(this->name,GF_LOG_WARNING,
-				       "read error on pipe");
-			}
-		}
+                __socket_ioq_entry_done (this, entry, direct);
         }
 
         return ret;
 }
 
 
+/*
+ * Write the pending parts of as many queued entries as fit in
+ * SOCKET_WRITEV_IOVEC with a single writev, instead of one writev per
+ * entry, then free the entries which went out completely and move the
+ * pending vector of the one which went out in part.
+ */
+static int
+__socket_ioq_churn_batch (rpc_transport_t *this)
+{
+        socket_private_t *priv          = NULL;
+        struct ioq       *entry         = NULL;
+        struct ioq       *tmp           = NULL;
+        struct iovec      vector[SOCKET_WRITEV_IOVEC];
+        struct iovec     *pending       = NULL;
+        int               pending_count = 0;
+        int               written       = 0;
+        int               count         = 0;
+        int               ret           = -1;
+
+        priv = this->private;
+
+        list_for_each_entry (entry, &priv->ioq, list) {
+                if (count + entry->pending_count > SOCKET_WRITEV_IOVEC)
+                        break;
+                memcpy (&vector[count], entry->pending_vector,
+                        entry->pending_count * sizeof (struct iovec));
+                count += entry->pending_count;
+        }
+
+        ret = __socket_writev (this, vector, count, &pending,
+                               &pending_count);
+        if (ret == -1)
+                goto out;
+
+        /* iovecs before this one were written completely */
+        written = pending - vector;
+
+        list_for_each_entry_safe (entry, tmp, &priv->ioq, list) {
+                if (written >= entry->pending_count) {
+                        written -= entry->pending_count;
+                        entry->pending_count = 0;
+                        __socket_ioq_entry_done (this, entry, 0);
+                        if (!written && !pending_count)
+                                break;
+                        continue;
+                }
+
+                /* the partly written entry; the first pending iovec
+                   carries the adjusted base and length */
+                entry->pending_vector += written;
+                entry->pending_count  -= written;
+                entry->pending_vector[0] = *pending;
+                break;
+        }
+out:
+        return ret;
+}
+
+
 static int
 __socket_ioq_churn (rpc_transport_t *this)
 {
         socket_private_t *priv = NULL;
         int               ret = 0;
-        struct ioq       *entry = NULL;
 
         GF_VALIDATE_OR_GOTO ("socket", this, out);
         GF_VALIDATE_OR_GOTO ("socket", this->private, out);
@@ -1030,10 +1097,7 @@ __socket_ioq_churn (rpc_transport_t *this)
         priv = this->private;
 
         while (!list_empty (&priv->ioq)) {
-                /* pick next entry */
-                entry = priv->ioq_next;
-
-                ret = __socket_ioq_churn_entry (this, entry, 0);
+                ret = __socket_ioq_churn_batch (this);
 
                 if (ret != 0)
                         break;
@@ -2105,6 +2169,24 @@ out:
 }
 
 
+/* whether buffered records are there to be delivered, as long as the
+   transport is not throttled */
+static gf_boolean_t
+socket_rbuf_pending (socket_private_t *priv)
+{
+        gf_boolean_t pending = _gf_false;
+
+        pthread_mutex_lock (&priv->lock);
+        {
+                pending = (!priv->throttled &&
+                           priv->rbuf_start < priv->rbuf_end);
+        }
+        pthread_mutex_unlock (&priv->lock);
+
+        return pending;
+}
+
+
 static int
 socket_event_poll_in (rpc_transport_t *this)
 {
@@ -2112,9 +2194,17 @@ socket_event_poll_in (rpc_transport_t *this)
         rpc_transport_pollin_t *pollin = NULL;
         socket_private_t       *priv = this->private;
 
-        ret = socket_proto_state_machine (this, &pollin);
+        /* records already in the receive buffer will not make the socket
+           readable again, so deliver all of them before going back to
+           poll */
+        do {
+                pollin = NULL;
+
+                ret = socket_proto_state_machine (this, &pollin);
+
+                if (pollin == NULL)
+                        break;
 
-        if (pollin != NULL) {
                 priv->ot_state = OT_CALLBACK;
                 ret = rpc_transport_notify (this, RPC_TRANSPORT_MSG_RECEIVED,
                                             pollin);
@@ -2122,7 +2212,7 @@ socket_event_poll_in (rpc_transport_t *this)
                         priv->ot_state = OT_RUNNING;
                 }
                 rpc_transport_pollin_destroy (pollin);
-        }
+        } while (ret >= 0 && socket_rbuf_pending (priv));
 
         return ret;
 }
@@ -2228,7 +2318,9 @@ socket_event_handler (int fd, int idx, void *data,
                 ret = socket_event_poll_out (this);
         }
 
-        if (!ret && poll_in) {
+        /* socket_throttle() asks for POLLOUT to get here when records
+           were left in the receive buffer */
+        if (!ret && (poll_in || socket_rbuf_pending (priv))) {
                 ret = socket_event_poll_in (this);
         }
 
@@ -3264,7 +3356,8 @@ out:
 static int
 socket_throttle (rpc_transport_t *this, gf_boolean_t onoff)
 {
-        socket_private_t *priv = NULL;
+        socket_private_t *priv    = NULL;
+        int               pollout = -1;
 
         priv = this->private;
 
@@ -3273,9 +3366,24 @@ socket_throttle (rpc_transport_t *this, gf_boolean_t onoff)
            never get called with the POLLIN event and therefore
            will never read() any more data until throttling
            is turned off.
+
+           Records already in the receive buffer do not make the
+           socket readable again, so when turning throttling off
+           with some left, poll for POLLOUT as well to have the
+           event handler deliver them. It turns POLLOUT off again
+           once the ioq is empty.
         */
+        pthread_mutex_lock (&priv->lock);
+        {
+                /* the own thread polls for input regardless */
+                priv->throttled = onoff && !priv->own_thread;
+                if (!onoff && priv->rbuf_start < priv->rbuf_end)
+                        pollout = 1;
+        }
+        pthread_mutex_unlock (&priv->lock);
+
         priv->idx = event_select_on (this->ctx->event_pool, priv->sock,
-                                     priv->idx, (int) !onoff, -1);
+                                     priv->idx, (int) !onoff, pollout);
         return 0;
 }
 
@@ -3347,6 +3455,17 @@ out:
 
 }
 
+/* transports of different translators may be set up concurrently while a
+   graph is initialized */
+static pthread_once_t socket_ssl_once = PTHREAD_ONCE_INIT;
+
+static void
+socket_ssl_library_init (void)
+{
+	SSL_library_init();
+	SSL_load_error_strings();
+}
+
 static int
 socket_init (rpc_transport_t *this)
 {
@@ -3548,8 +3667,7 @@ socket_init (rpc_transport_t *this)
 	       priv->own_thread ? "private" : "system");
 
 	if (priv->use_ssl) {
-		SSL_library_init();
-		SSL_load_error_strings();
+		pthread_once (&socket_ssl_once, socket_ssl_library_init);
 		priv->ssl_meth = (SSL_METHOD *)TLSv1_method();
 		priv->ssl_ctx = SSL_CTX_new(priv->ssl_meth);
 
@@ -3648,6 +3766,7 @@ fini (rpc_transport_t *this)
 		if (priv->ssl_ca_list) {
 			GF_FREE(priv->ssl_ca_list);
 		}
+                GF_FREE (priv->rbuf);
                 GF_FREE (priv);
         }
 
@@ -13,6 +13,7 @@
 
 #include <openssl/ssl.h>
 #include <openssl/err.h>
+#include <limits.h>
 
 #ifndef _CONFIG_H
 #define _CONFIG_H
@@ -30,6 +31,13 @@
 #define MAX_IOVEC 16
 #endif /* MAX_IOVEC */
 
+/* iovecs of queued messages gathered into one writev */
+#ifdef IOV_MAX
+#define SOCKET_WRITEV_IOVEC IOV_MAX
+#else
+#define SOCKET_WRITEV_IOVEC 1024
+#endif
+
 #define GF_DEFAULT_SOCKET_LISTEN_PORT  GF_DEFAULT_BASE_PORT
 
 #define RPC_MAX_FRAGMENT_SIZE 0x7fffffff
@@ -158,7 +166,15 @@ struct gf_sock_incoming_frag {
         sp_rpcfrag_state_t state;
 };
 
-#define GF_SOCKET_RA_MAX 1024
+/* Small reads are served from a per-connection receive buffer filled with
+ * one recv of up to GF_SOCKET_RBUF_SIZE, so that back-to-back records are
+ * parsed out of memory instead of costing a readv per record marker and
+ * header.  Reads of GF_SOCKET_RBUF_DIRECT bytes or more (write payloads)
+ * go straight into the caller's iobuf when the buffer is empty, with the
+ * receive buffer as a second iovec for whatever follows.
+ */
+#define GF_SOCKET_RBUF_SIZE   (16 * GF_UNIT_KB)
+#define GF_SOCKET_RBUF_DIRECT (4 * GF_UNIT_KB)
 
 struct gf_sock_incoming {
         sp_rpcrecord_state_t  record_state;
@@ -177,11 +193,6 @@ struct gf_sock_incoming {
         char                 complete_record;
         msg_type_t           msg_type;
         size_t               total_bytes_read;
-
-	size_t               ra_read;
-	size_t               ra_max;
-	size_t               ra_served;
-	char                *ra_buf;
 };
 
 typedef enum {
@@ -208,6 +219,10 @@ typedef struct {
                 };
         };
         struct gf_sock_incoming incoming;
+        char                  *rbuf;        /* receive buffer, see above */
+        size_t                 rbuf_start;  /* first byte not parsed yet */
+        size_t                 rbuf_end;    /* end of the received bytes */
+        gf_boolean_t           throttled;   /* POLLIN taken off by rpcsvc */
         pthread_mutex_t        lock;
         int                    windowsize;
         char                   lowlat;
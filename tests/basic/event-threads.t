@@ -0,0 +1,34 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function event_pool_value {
+        local key=$1
+        local fpath=$(generate_mount_statedump $V0)
+        local val=$(grep -A3 "^\[event-pool\]" $fpath | grep "^$key=" | cut -f2 -d'=')
+        rm -f $fpath
+        echo "$val"
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2};
+TEST $CLI volume start $V0;
+
+TEST glusterfs -s $H0 --volfile-id $V0 --event-threads=4 $M0;
+
+for i in $(seq 1 50); do
+        echo "data-$i" > $M0/file-$i;
+done
+
+EXPECT "data-25" cat $M0/file-25
+EXPECT "50" echo $(ls $M0 | wc -l)
+
+EXPECT "4" event_pool_value configured_threads
+EXPECT "4" event_pool_value active_threads
+
+TEST umount -l $M0
+cleanup;
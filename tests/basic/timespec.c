@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <time.h>
+
+/* from libglusterfs */
+extern void timespec_adjust_delta (struct timespec *ts, struct timespec delta);
+
+static int
+check (long sec, long nsec, long dsec, long dnsec, long esec, long ensec)
+{
+        struct timespec ts    = {sec, nsec};
+        struct timespec delta = {dsec, dnsec};
+
+        timespec_adjust_delta (&ts, delta);
+        if (ts.tv_sec == esec && ts.tv_nsec == ensec)
+                return 0;
+
+        fprintf (stderr, "%ld.%09ld + %ld.%09ld = %ld.%09ld, "
+                 "expected %ld.%09ld\n", sec, nsec, dsec, dnsec,
+                 (long) ts.tv_sec, (long) ts.tv_nsec, esec, ensec);
+        return 1;
+}
+
+int
+main (void)
+{
+        int ret = 0;
+
+        ret |= check (10, 100000000, 0, 200000000, 10, 300000000);
+        /* the nanoseconds wrap past one second */
+        ret |= check (10, 900000000, 0, 200000000, 11, 100000000);
+        ret |= check (10, 999999999, 0, 1, 11, 0);
+        ret |= check (10, 500000000, 2, 700000000, 13, 200000000);
+
+        return ret;
+}
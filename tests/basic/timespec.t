@@ -0,0 +1,12 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+## timer expiry times carry the nanoseconds that wrap past a second
+TEST gcc -g $(dirname $0)/timespec.c -o $(dirname $0)/timespec -lglusterfs
+TEST $(dirname $0)/timespec
+rm -f $(dirname $0)/timespec
+
+cleanup;
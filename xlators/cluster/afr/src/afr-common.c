@@ -822,6 +822,7 @@ afr_local_sh_cleanup (afr_local_t *local, xlator_t *this)
         loc_wipe (&sh->lookup_loc);
 
         GF_FREE (sh->checksum);
+        GF_FREE (sh->checksum_murmur3);
 
         GF_FREE (sh->write_needed);
         if (sh->healing_fd)
@@ -30,6 +30,7 @@
 #include "afr-self-heal.h"
 #include "afr-self-heal-common.h"
 #include "afr-self-heal-algorithm.h"
+#include "checksum.h"
 
 /*
   This file contains the various self-heal algorithms
@@ -233,6 +234,11 @@ sh_loop_frame_create (call_frame_t *sh_frame, xlator_t *this,
                                            gf_afr_mt_uint8_t);
         if (!new_loop_sh->checksum)
                 goto out;
+        new_loop_sh->checksum_murmur3 = GF_CALLOC (priv->child_count,
+                                                   sizeof (*new_loop_sh->checksum_murmur3),
+                                                   gf_afr_mt_char);
+        if (!new_loop_sh->checksum_murmur3)
+                goto out;
         new_loop_sh->inode      = inode_ref (sh->inode);
         new_loop_sh->sh_data_algo_start = sh->sh_data_algo_start;
         new_loop_sh->source = sh->source;
@@ -630,6 +636,8 @@ sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
         } else {
                 memcpy (loop_sh->checksum + child_index * MD5_DIGEST_LENGTH,
                         strong_checksum, MD5_DIGEST_LENGTH);
+                loop_sh->checksum_murmur3[child_index] =
+                        (xdata && dict_get (xdata, GF_RSYNC_STRONG_HASH_KEY));
         }
 
         call_count = afr_frame_return (loop_frame);
@@ -639,7 +647,9 @@ sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
                         if (sh->sources[i] || !sh_local->child_up[i])
                                 continue;
 
-                        if (memcmp (loop_sh->checksum + (i * MD5_DIGEST_LENGTH),
+                        if ((loop_sh->checksum_murmur3[i] !=
+                             loop_sh->checksum_murmur3[sh->source]) ||
+                            memcmp (loop_sh->checksum + (i * MD5_DIGEST_LENGTH),
                                     loop_sh->checksum + (sh->source * MD5_DIGEST_LENGTH),
                                     MD5_DIGEST_LENGTH)) {
                                 /*
@@ -661,6 +671,26 @@ sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
                         sh_priv->total_blocks++;
                         if (write_needed)
                                 sh_priv->diff_blocks++;
+
+                        /* Digests of different kinds can't be compared,
+                           so the block above was treated as differing.
+                           Use MD5 everywhere for the rest of the file. */
+                        for (i = 0; i < priv->child_count; i++) {
+                                if (!sh_priv->murmur3_checksum)
+                                        break;
+                                if ((i == sh->source ||
+                                     (!sh->sources[i] &&
+                                      sh_local->child_up[i])) &&
+                                    !loop_sh->checksum_murmur3[i]) {
+                                        gf_log (this->name, GF_LOG_DEBUG,
+                                                "subvolume %s returned an MD5 "
+                                                "checksum, using MD5 for the "
+                                                "rest of %s",
+                                                priv->children[i]->name,
+                                                sh_local->loc.path);
+                                        sh_priv->murmur3_checksum = _gf_false;
+                                }
+                        }
                 }
                 UNLOCK (&sh_priv->lock);
 
@@ -682,12 +712,27 @@ sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
         afr_private_t           *priv         = NULL;
         afr_local_t             *loop_local   = NULL;
         afr_self_heal_t         *loop_sh      = NULL;
+        afr_local_t             *sh_local     = NULL;
+        afr_sh_algo_private_t   *sh_priv      = NULL;
+        dict_t                  *xdata        = NULL;
         int                     call_count    = 0;
         int                     i             = 0;
 
         priv         = this->private;
         loop_local   = loop_frame->local;
         loop_sh      = &loop_local->self_heal;
+        sh_local     = loop_sh->sh_frame->local;
+        sh_priv      = sh_local->self_heal.private;
+
+        if (sh_priv->murmur3_checksum) {
+                xdata = dict_new ();
+                if (xdata &&
+                    dict_set_str (xdata, GF_RSYNC_STRONG_HASH_KEY,
+                                  GF_RSYNC_STRONG_HASH_MURMUR3)) {
+                        dict_unref (xdata);
+                        xdata = NULL;
+                }
+        }
 
         call_count = loop_sh->active_sinks + 1;  /* sinks and source */
 
@@ -698,7 +743,7 @@ sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
                            priv->children[loop_sh->source],
                            priv->children[loop_sh->source]->fops->rchecksum,
                            loop_sh->healing_fd,
-                           loop_sh->offset, loop_sh->block_size, NULL);
+                           loop_sh->offset, loop_sh->block_size, xdata);
 
         for (i = 0; i < priv->child_count; i++) {
                 if (loop_sh->sources[i] || !loop_local->child_up[i])
@@ -709,12 +754,15 @@ sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
                                    priv->children[i],
                                    priv->children[i]->fops->rchecksum,
                                    loop_sh->healing_fd,
-                                   loop_sh->offset, loop_sh->block_size, NULL);
+                                   loop_sh->offset, loop_sh->block_size, xdata);
 
                 if (!--call_count)
                         break;
         }
 
+        if (xdata)
+                dict_unref (xdata);
+
         return 0;
 }
 
@@ -806,6 +854,9 @@ afr_sh_start_loops (call_frame_t *sh_frame, xlator_t *this,
                 ret = -1;
                 goto out;
         }
+        sh->private->murmur3_checksum =
+                !strcmp (priv->data_self_heal_checksum,
+                         GF_RSYNC_STRONG_HASH_MURMUR3);
         sh_loop_driver (sh_frame, this, _gf_true, first_loop_frame);
         ret = 0;
 out:
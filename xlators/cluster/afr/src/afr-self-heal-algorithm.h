@@ -27,6 +27,9 @@ typedef struct {
 
         int32_t total_blocks;
         int32_t diff_blocks;
+
+        gf_boolean_t murmur3_checksum;  /* cleared once a brick answers
+                                           with MD5 */
 } afr_sh_algo_private_t;
 
 #endif /* __AFR_SELF_HEAL_ALGORITHM_H__ */
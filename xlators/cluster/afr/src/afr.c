@@ -146,6 +146,9 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("data-self-heal-algorithm",
                           priv->data_self_heal_algorithm, options, str, out);
 
+        GF_OPTION_RECONF ("data-self-heal-checksum",
+                          priv->data_self_heal_checksum, options, str, out);
+
         GF_OPTION_RECONF ("self-heal-daemon", priv->shd.enabled, options, bool, out);
 
         GF_OPTION_RECONF ("read-subvolume", read_subvol, options, xlator, out);
@@ -300,6 +303,9 @@ init (xlator_t *this)
         GF_OPTION_INIT ("data-self-heal-algorithm",
                         priv->data_self_heal_algorithm, str, out);
 
+        GF_OPTION_INIT ("data-self-heal-checksum",
+                        priv->data_self_heal_checksum, str, out);
+
         GF_OPTION_INIT ("data-self-heal-window-size",
                         priv->data_self_heal_window_size, uint32, out);
 
@@ -626,6 +632,17 @@ struct volume_options options[] = {
                            "otherwise \"diff\" algo is chosen.",
           .value = { "diff", "full"}
         },
+        { .key  = {"data-self-heal-checksum"},
+          .type = GF_OPTION_TYPE_STR,
+          .default_value = "md5",
+          .description   = "Strong checksum the \"diff\" algorithm compares "
+                           "blocks with. \"murmur3\" is several times "
+                           "cheaper for the bricks than \"md5\" but is not "
+                           "a cryptographic hash. Bricks that do not support "
+                           "it answer with MD5, and the heal falls back to "
+                           "MD5 for the rest of the file.",
+          .value = { "md5", "murmur3"}
+        },
         { .key  = {"data-self-heal-window-size"},
           .type = GF_OPTION_TYPE_INT,
           .min  = 1,
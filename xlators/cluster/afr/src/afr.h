@@ -132,6 +132,8 @@ typedef struct _afr_private {
 
         char         *data_self_heal;              /* on/off/open */
         char *       data_self_heal_algorithm;    /* name of algorithm */
+        char *       data_self_heal_checksum;     /* strong checksum used
+                                                     by the diff algorithm */
         unsigned int data_self_heal_window_size;  /* max number of pipelined
                                                      read/writes */
 
@@ -296,6 +298,8 @@ struct afr_self_heal_ {
         off_t offset;
         unsigned char *write_needed;
         uint8_t *checksum;
+        unsigned char *checksum_murmur3;  /* per child: reply carried a
+                                             murmur3 digest, not MD5 */
         afr_post_remove_call_t post_remove_call;
 
         char    *data_sh_info;
@@ -3027,6 +3027,9 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
         dht_conf_t   *conf   = NULL;
         xlator_t     *subvol = 0;
         int           ret    = 0;
+        uint32_t     *hashes = NULL;
+        int           idx    = 0;
+        int           i      = 0;
 
         INIT_LIST_HEAD (&entries.list);
         prev = cookie;
@@ -3041,8 +3044,13 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
 
         layout = local->layout;
 
+        if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO)
+                hashes = dht_hash_compute_entries (this, layout->type,
+                                                   orig_entries);
+
         list_for_each_entry (orig_entry, (&orig_entries->list), list) {
                 next_offset = orig_entry->d_off;
+                idx = i++;
                 if (check_is_dir (NULL, (&orig_entry->d_stat), NULL) &&
                     (prev->this != local->first_up_subvol)) {
                         continue;
@@ -3061,8 +3069,12 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
 
                 /* Do this if conf->search_unhashed is set to "auto" */
                 if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO) {
-                        subvol = dht_layout_search (this, layout,
-                                                    orig_entry->d_name);
+                        if (hashes)
+                                subvol = dht_layout_search_hash (this, layout,
+                                                                 hashes[idx]);
+                        else
+                                subvol = dht_layout_search (this, layout,
+                                                            orig_entry->d_name);
                         if (!subvol || (subvol != prev->this)) {
                                 /* TODO: Count the number of entries which need
                                    linkfile to prove its existence in fs */
@@ -3111,6 +3123,9 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                 op_errno = 0;
 
 done:
+        GF_FREE (hashes);
+        hashes = NULL;
+
         if (count == 0) {
                 /* non-zero next_offset means that
                    EOF is not yet hit on the current subvol
@@ -3146,6 +3161,8 @@ done:
         }
 
 unwind:
+        GF_FREE (hashes);
+
         if (op_ret < 0)
                 op_ret = 0;
 
@@ -3173,6 +3190,8 @@ dht_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         int           count = 0;
         dht_layout_t *layout = 0;
         xlator_t     *subvol = 0;
+        uint32_t     *hashes = NULL;
+        int           i      = 0;
 
         INIT_LIST_HEAD (&entries.list);
         prev = cookie;
@@ -3186,10 +3205,17 @@ dht_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         layout = local->layout;
 
+        hashes = dht_hash_compute_entries (this, layout->type, orig_entries);
+
         list_for_each_entry (orig_entry, (&orig_entries->list), list) {
                 next_offset = orig_entry->d_off;
 
-                subvol = dht_layout_search (this, layout, orig_entry->d_name);
+                if (hashes)
+                        subvol = dht_layout_search_hash (this, layout,
+                                                         hashes[i++]);
+                else
+                        subvol = dht_layout_search (this, layout,
+                                                    orig_entry->d_name);
 
                 if (!subvol || (subvol == prev->this)) {
                         entry = gf_dirent_for_name (orig_entry->d_name);
@@ -3222,6 +3248,9 @@ dht_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 op_errno = 0;
 
 done:
+        GF_FREE (hashes);
+        hashes = NULL;
+
         if (count == 0) {
                 /* non-zero next_offset means that
                    EOF is not yet hit on the current subvol
@@ -3243,6 +3272,8 @@ done:
         }
 
 unwind:
+        GF_FREE (hashes);
+
         if (op_ret < 0)
                 op_ret = 0;
 
@@ -405,6 +405,8 @@ dht_layout_t                            *dht_layout_get (xlator_t *this, inode_t
 dht_layout_t                            *dht_layout_for_subvol (xlator_t *this, xlator_t *subvol);
 xlator_t *dht_layout_search (xlator_t   *this, dht_layout_t *layout,
                              const char *name);
+xlator_t *dht_layout_search_hash (xlator_t *this, dht_layout_t *layout,
+                                  uint32_t hash);
 int                                      dht_layout_normalize (xlator_t *this, loc_t *loc, dht_layout_t *layout);
 int dht_layout_anomalies (xlator_t      *this, loc_t *loc, dht_layout_t *layout,
                           uint32_t      *holes_p, uint32_t *overlaps_p,
@@ -447,6 +449,8 @@ xlator_t *dht_subvol_next_available (xlator_t *this, xlator_t *prev);
 int       dht_subvol_cnt (xlator_t *this, xlator_t *subvol);
 
 int dht_hash_compute (xlator_t *this, int type, const char *name, uint32_t *hash_p);
+uint32_t *dht_hash_compute_entries (xlator_t *this, int type,
+                                    gf_dirent_t *entries);
 
 int dht_linkfile_create (call_frame_t    *frame, fop_mknod_cbk_t linkfile_cbk,
                          xlator_t        *this, xlator_t *tovol,
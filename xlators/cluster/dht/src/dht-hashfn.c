@@ -109,3 +109,55 @@ dht_hash_compute (xlator_t *this, int type, const char *name, uint32_t *hash_p)
 
         return dht_hash_compute_internal (type, rsync_friendly_name, hash_p);
 }
+
+
+/*
+ * Hash the names of all @entries in one batch.  Returns the hashes in list
+ * order, to be freed with GF_FREE, or NULL when the names have to be hashed
+ * one at a time (regex munging, other hash types, no memory).
+ */
+uint32_t *
+dht_hash_compute_entries (xlator_t *this, int type, gf_dirent_t *entries)
+{
+        dht_conf_t      *priv   = this->private;
+        gf_dirent_t     *entry  = NULL;
+        const char     **names  = NULL;
+        int             *lens   = NULL;
+        uint32_t        *hashes = NULL;
+        int              count  = 0;
+        int              i      = 0;
+
+        if (priv->extra_regex_valid || priv->rsync_regex_valid)
+                return NULL;
+
+        if ((type != DHT_HASH_TYPE_DM) && (type != DHT_HASH_TYPE_DM_USER))
+                return NULL;
+
+        list_for_each_entry (entry, &entries->list, list)
+                count++;
+
+        if (!count)
+                return NULL;
+
+        names = GF_CALLOC (count, sizeof (*names), gf_dht_mt_char);
+        lens = GF_CALLOC (count, sizeof (*lens), gf_dht_mt_int32_t);
+        hashes = GF_CALLOC (count, sizeof (*hashes), gf_dht_mt_uint32_t);
+        if (!names || !lens || !hashes) {
+                GF_FREE (hashes);
+                hashes = NULL;
+                goto out;
+        }
+
+        list_for_each_entry (entry, &entries->list, list) {
+                names[i] = entry->d_name;
+                lens[i] = strlen (entry->d_name);
+                i++;
+        }
+
+        gf_dm_hashfn_batch (names, lens, hashes, count);
+out:
+        GF_FREE (names);
+        GF_FREE (lens);
+
+        return hashes;
+}
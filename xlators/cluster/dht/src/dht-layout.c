@@ -153,8 +153,6 @@ xlator_t *
 dht_layout_search (xlator_t *this, dht_layout_t *layout, const char *name)
 {
         uint32_t   hash = 0;
-        xlator_t  *subvol = NULL;
-        int        i = 0;
         int        ret = 0;
 
 
@@ -163,9 +161,19 @@ dht_layout_search (xlator_t *this, dht_layout_t *layout, const char *name)
                 gf_log (this->name, GF_LOG_WARNING,
                         "hash computation failed for type=%d name=%s",
                         layout->type, name);
-                goto out;
+                return NULL;
         }
 
+        return dht_layout_search_hash (this, layout, hash);
+}
+
+
+xlator_t *
+dht_layout_search_hash (xlator_t *this, dht_layout_t *layout, uint32_t hash)
+{
+        xlator_t  *subvol = NULL;
+        int        i = 0;
+
         for (i = 0; i < layout->cnt; i++) {
                 if (layout->list[i].start <= hash
                     && layout->list[i].stop >= hash) {
@@ -179,7 +187,6 @@ dht_layout_search (xlator_t *this, dht_layout_t *layout, const char *name)
                         "no subvolume for hash (value) = %u", hash);
         }
 
-out:
         return subvol;
 }
 
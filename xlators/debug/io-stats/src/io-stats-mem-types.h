@@ -18,6 +18,7 @@ enum gf_io_stats_mem_types_ {
         gf_io_stats_mt_ios_fd,
         gf_io_stats_mt_ios_stat,
         gf_io_stats_mt_ios_stat_list,
+        gf_io_stats_mt_latency_hist,
         gf_io_stats_mt_end
 };
 #endif
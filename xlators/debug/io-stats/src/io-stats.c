@@ -98,12 +98,27 @@ struct ios_global_stats {
         uint64_t        fop_hits[GF_FOP_MAXVALUE];
         struct timeval  started_at;
         struct ios_lat  latency[GF_FOP_MAXVALUE];
+        gf_latency_hist_t *hist;     /* GF_FOP_MAXVALUE entries */
         uint64_t        nr_opens;
         uint64_t        max_nr_opens;
         struct timeval  max_openfd_time;
 };
 
 
+/* percentiles exported as "<interval>-<fop>-<name>latency" for profile info */
+static struct {
+        const char *name;
+        double      value;
+} ios_latency_percentiles[] = {
+        { "p50",  50   },
+        { "p90",  90   },
+        { "p99",  99   },
+        { "p999", 99.9 },
+};
+#define IOS_LATENCY_PERCENTILES                                         \
+        (sizeof (ios_latency_percentiles) / sizeof (ios_latency_percentiles[0]))
+
+
 struct ios_conf {
         gf_lock_t                 lock;
         struct ios_global_stats   cumulative;
@@ -578,6 +593,16 @@ ios_dump_throughput_stats (struct ios_stat_head *list_head, xlator_t *this,
         return 0;
 }
 
+static uint64_t
+ios_latency_percentile (struct ios_global_stats *stats, int fop,
+                        double percentile)
+{
+        if (!stats->hist)
+                return 0;
+
+        return gf_latency_hist_percentile (&stats->hist[fop], percentile);
+}
+
 int
 io_stats_dump_global_to_logfp (xlator_t *this, struct ios_global_stats *stats,
                                struct timeval *now, int interval, FILE* logfp)
@@ -657,11 +682,12 @@ io_stats_dump_global_to_logfp (xlator_t *this, struct ios_global_stats *stats,
                 ios_log (this, logfp, "%s\n", str_write);
         }
 
-        ios_log (this, logfp, "%-13s %10s %14s %14s %14s", "Fop",
-                 "Call Count", "Avg-Latency", "Min-Latency",
-                 "Max-Latency");
-        ios_log (this, logfp, "%-13s %10s %14s %14s %14s", "---", "----------",
-                 "-----------", "-----------", "-----------");
+        ios_log (this, logfp, "%-13s %10s %14s %14s %14s %14s %14s %14s",
+                 "Fop", "Call Count", "Avg-Latency", "Min-Latency",
+                 "Max-Latency", "P50-Latency", "P90-Latency", "P99-Latency");
+        ios_log (this, logfp, "%-13s %10s %14s %14s %14s %14s %14s %14s",
+                 "---", "----------", "-----------", "-----------",
+                 "-----------", "-----------", "-----------", "-----------");
 
         for (i = 0; i < GF_FOP_MAXVALUE; i++) {
                 if (stats->fop_hits[i] && !stats->latency[i].avg)
@@ -670,9 +696,14 @@ io_stats_dump_global_to_logfp (xlator_t *this, struct ios_global_stats *stats,
                                  stats->fop_hits[i], "0", "0", "0");
                 else if (stats->fop_hits[i] && stats->latency[i].avg)
                         ios_log (this, logfp, "%-13s %10"PRId64" %11.2lf us "
-                                 "%11.2lf us %11.2lf us", gf_fop_list[i],
-                                 stats->fop_hits[i], stats->latency[i].avg,
-                                 stats->latency[i].min, stats->latency[i].max);
+                                 "%11.2lf us %11.2lf us %11"PRIu64" us "
+                                 "%11"PRIu64" us %11"PRIu64" us",
+                                 gf_fop_list[i], stats->fop_hits[i],
+                                 stats->latency[i].avg, stats->latency[i].min,
+                                 stats->latency[i].max,
+                                 ios_latency_percentile (stats, i, 50),
+                                 ios_latency_percentile (stats, i, 90),
+                                 ios_latency_percentile (stats, i, 99));
         }
         ios_log (this, logfp, "------ ----- ----- ----- ----- ----- ----- ----- "
                  " ----- ----- ----- -----\n");
@@ -741,6 +772,7 @@ io_stats_dump_global_to_dict (xlator_t *this, struct ios_global_stats *stats,
         char            key[256] = {0};
         uint64_t        sec = 0;
         int             i = 0;
+        int             j = 0;
         uint64_t        count = 0;
 
         GF_ASSERT (stats);
@@ -853,6 +885,23 @@ io_stats_dump_global_to_dict (xlator_t *this, struct ios_global_stats *stats,
                                 interval, stats->latency[i].max);
                         goto out;
                 }
+
+                if (!stats->hist || !stats->hist[i].count)
+                        continue;
+                for (j = 0; j < IOS_LATENCY_PERCENTILES; j++) {
+                        snprintf (key, sizeof (key), "%d-%d-%slatency",
+                                  interval, i, ios_latency_percentiles[j].name);
+                        ret = dict_set_uint64 (dict, key,
+                                ios_latency_percentile (stats, i,
+                                        ios_latency_percentiles[j].value));
+                        if (ret) {
+                                gf_log (this->name, GF_LOG_ERROR, "failed to "
+                                        "set %s %slatency(%d)", gf_fop_list[i],
+                                        ios_latency_percentiles[j].name,
+                                        interval);
+                                goto out;
+                        }
+                }
         }
 out:
         gf_log (this->name, GF_LOG_DEBUG, "returning %d", ret);
@@ -922,7 +971,10 @@ io_stats_dump (xlator_t *this, struct ios_dump_args *args)
         struct ios_conf         *conf = NULL;
         struct ios_global_stats  cumulative = {0, };
         struct ios_global_stats  incremental = {0, };
+        gf_latency_hist_t       *hist = NULL;
+        gf_latency_hist_t       *live_hist = NULL;
         int                      increment = 0;
+        int                      i = 0;
         struct timeval           now;
 
         GF_ASSERT (this);
@@ -932,6 +984,10 @@ io_stats_dump (xlator_t *this, struct ios_dump_args *args)
 
         conf = this->private;
 
+        /* cumulative snapshot followed by the incremental one */
+        hist = GF_CALLOC (2 * GF_FOP_MAXVALUE, sizeof (*hist),
+                          gf_io_stats_mt_latency_hist);
+
         gettimeofday (&now, NULL);
         LOCK (&conf->lock);
         {
@@ -940,14 +996,29 @@ io_stats_dump (xlator_t *this, struct ios_dump_args *args)
 
                 increment = conf->increment++;
 
+                live_hist = conf->incremental.hist;
                 memset (&conf->incremental, 0, sizeof (conf->incremental));
+                conf->incremental.hist = live_hist;
                 conf->incremental.started_at = now;
+
+                for (i = 0; hist && i < GF_FOP_MAXVALUE; i++) {
+                        gf_latency_hist_snapshot (&cumulative.hist[i],
+                                                  &hist[i], 0);
+                        gf_latency_hist_snapshot (&incremental.hist[i],
+                                                  &hist[GF_FOP_MAXVALUE + i],
+                                                  1);
+                }
         }
         UNLOCK (&conf->lock);
 
+        cumulative.hist  = hist;
+        incremental.hist = hist ? &hist[GF_FOP_MAXVALUE] : NULL;
+
         io_stats_dump_global (this, &cumulative, &now, -1, args);
         io_stats_dump_global (this, &incremental, &now, increment, args);
 
+        GF_FREE (hist);
+
         return 0;
 }
 
@@ -1035,6 +1106,9 @@ update_ios_latency_stats (struct ios_global_stats   *stats, double elapsed,
         avg = stats->latency[op].avg;
 
         stats->latency[op].avg = avg + (elapsed - avg) / stats->fop_hits[op];
+
+        gf_latency_hist_add (&stats->hist[op],
+                             elapsed > 0 ? (uint64_t) elapsed : 0);
 }
 
 int
@@ -2710,6 +2784,15 @@ init (xlator_t *this)
 
         LOCK_INIT (&conf->lock);
 
+        conf->cumulative.hist = GF_CALLOC (2 * GF_FOP_MAXVALUE,
+                                           sizeof (gf_latency_hist_t),
+                                           gf_io_stats_mt_latency_hist);
+        if (!conf->cumulative.hist) {
+                GF_FREE (conf);
+                return -1;
+        }
+        conf->incremental.hist = &conf->cumulative.hist[GF_FOP_MAXVALUE];
+
         gettimeofday (&conf->cumulative.started_at, NULL);
         gettimeofday (&conf->incremental.started_at, NULL);
 
@@ -2759,6 +2842,7 @@ fini (xlator_t *this)
 
         ios_destroy_top_stats (conf);
 
+        GF_FREE (conf->cumulative.hist);
         GF_FREE(conf);
 
         gf_log (this->name, GF_LOG_INFO,
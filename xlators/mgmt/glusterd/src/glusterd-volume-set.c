@@ -511,6 +511,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.data-self-heal-checksum",
+          .voltype    = "cluster/replicate",
+          .option     = "data-self-heal-checksum",
+          .op_version = 3,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.eager-lock",
           .voltype    = "cluster/replicate",
           .op_version = 1,
@@ -768,6 +774,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 1,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "network.channels",
+          .voltype    = "protocol/client",
+          .option     = "channels",
+          .op_version = 3,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "features.lock-heal",
           .voltype    = "protocol/client",
           .option     = "lk-heal",
@@ -1332,6 +1344,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type        = GLOBAL_DOC,
           .op_version  = 3
         },
+        { .key         = "nfs.drc-mem-size",
+          .voltype     = "nfs/server",
+          .option      = "nfs.drc-mem-size",
+          .type        = GLOBAL_DOC,
+          .op_version  = 3
+        },
         { .key         = "nfs.read-size",
           .voltype     = "nfs/server",
           .option      = "nfs3.read-size",
@@ -4846,6 +4846,7 @@ fuse_priv_dump (xlator_t  *this)
         gf_proc_dump_write("reverse_thread_started", "%d",
                            (int)private->reverse_fuse_thread_started);
         gf_proc_dump_write("use_readdirp", "%d", private->use_readdirp);
+        gid_cache_dump (&private->gid_cache, "gid_cache");
 
         return 0;
 }
@@ -5397,6 +5398,7 @@ cleanup_exit:
                         close (priv->fd);
                 if (priv->fuse_dump_fd != -1)
                         close (priv->fuse_dump_fd);
+                gid_cache_destroy (&priv->gid_cache);
                 GF_FREE (priv);
         }
         GF_FREE (mnt_args);
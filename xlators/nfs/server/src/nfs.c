@@ -35,12 +35,14 @@
 #include "options.h"
 #include "acl3.h"
 #include "rpc-drc.h"
+#include "statedump.h"
 
 #define STRINGIFY(val) #val
 #define TOSTRING(val) STRINGIFY(val)
 
 #define OPT_SERVER_AUX_GIDS             "nfs.server-aux-gids"
 #define OPT_SERVER_GID_CACHE_TIMEOUT    "nfs.server.aux-gid-timeout"
+#define OPT_SERVER_GID_CACHE_SIZE       "nfs.server.aux-gid-cache-size"
 
 /* TODO: DATADIR should be based on configure's $(localstatedir) */
 #define DATADIR                         "/var/lib/glusterd"
@@ -947,12 +949,20 @@ nfs_init_state (xlator_t *this)
                         bool, free_foppool);
         GF_OPTION_INIT (OPT_SERVER_GID_CACHE_TIMEOUT, nfs->server_aux_gids_max_age,
                         uint32, free_foppool);
+        GF_OPTION_INIT (OPT_SERVER_GID_CACHE_SIZE,
+                        nfs->server_aux_gids_cache_size, uint32, free_foppool);
 
         if (gid_cache_init(&nfs->gid_cache, nfs->server_aux_gids_max_age) < 0) {
                 gf_log(GF_NFS, GF_LOG_ERROR, "Failed to initialize group cache.");
                 goto free_foppool;
         }
 
+        if (gid_cache_resize (&nfs->gid_cache,
+                              nfs->server_aux_gids_cache_size) < 0) {
+                gf_log(GF_NFS, GF_LOG_ERROR, "Failed to size group cache.");
+                goto free_foppool;
+        }
+
         if (stat("/sbin/rpc.statd", &stbuf) == -1) {
                 gf_log (GF_NFS, GF_LOG_WARNING, "/sbin/rpc.statd not found. "
                         "Disabling NLM");
@@ -975,8 +985,10 @@ nfs_init_state (xlator_t *this)
         ret = 0;
 
 free_foppool:
-        if (ret < 0)
+        if (ret < 0) {
+                gid_cache_destroy (&nfs->gid_cache);
                 mem_pool_destroy (nfs->foppool);
+        }
 
 free_rpcsvc:
         /*
@@ -1090,6 +1102,20 @@ nfs_reconfigure_state (xlator_t *this, dict_t *options)
                                OPT_SERVER_GID_CACHE_TIMEOUT, optuint32);
         }
 
+        GF_OPTION_RECONF (OPT_SERVER_GID_CACHE_SIZE, optuint32,
+                                               options, uint32, out);
+        if (nfs->server_aux_gids_cache_size != optuint32) {
+                if (gid_cache_resize (&nfs->gid_cache, optuint32) < 0) {
+                        gf_log(GF_NFS, GF_LOG_ERROR, "Failed to resize "
+                               "group cache to %u entries", optuint32);
+                } else {
+                        nfs->server_aux_gids_cache_size = optuint32;
+                        gf_log(GF_NFS, GF_LOG_INFO, "Reconfigured %s with "
+                               "value %u", OPT_SERVER_GID_CACHE_SIZE,
+                               optuint32);
+                }
+        }
+
         /* reconfig nfs.dynamic-volumes */
         ret = dict_get_str_boolean (options, "nfs.dynamic-volumes",
                                              GF_NFS_DVM_OFF);
@@ -1329,6 +1355,7 @@ fini (xlator_t *this)
         nfs = (struct nfs_state *)this->private;
         gf_log (GF_NFS, GF_LOG_DEBUG, "NFS service going down");
         nfs_deinit_versions (&nfs->versions, this);
+        gid_cache_destroy (&nfs->gid_cache);
         return 0;
 }
 
@@ -1452,6 +1479,10 @@ nfs_priv (xlator_t *this)
                 gf_log (this->name, GF_LOG_DEBUG, "Statedump of NLM failed");
                 goto out;
         }
+
+        gf_proc_dump_add_section ("nfs.gid_cache");
+        gid_cache_dump (&((struct nfs_state *)(this->private))->gid_cache,
+                        "nfs.gid_cache");
  out:
         return ret;
 }
@@ -1803,6 +1834,14 @@ struct volume_options options[] = {
           .description = "Number of seconds to cache auxiliary-GID data, when "
                          OPT_SERVER_AUX_GIDS " is set."
         },
+        { .key = {OPT_SERVER_GID_CACHE_SIZE},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 4,
+          .max = 1048576,
+          .default_value = "1024",
+          .description = "Number of users whose auxiliary-GID lists are "
+                         "cached, when " OPT_SERVER_AUX_GIDS " is set."
+        },
         { .key = {"nfs.acl"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "on",
@@ -1821,5 +1860,11 @@ struct volume_options options[] = {
           .description = "Sets the number of non-idempotent "
                          "requests to cache in drc"
         },
+        { .key  = {"nfs.drc-mem-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "64MB",
+          .description = "Sets the amount of memory the cached replies "
+                         "of the drc may use"
+        },
         { .key  = {NULL} },
 };
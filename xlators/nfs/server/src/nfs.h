@@ -83,6 +83,7 @@ struct nfs_state {
         struct rpc_clnt         *rpc_clnt;
         gf_boolean_t            server_aux_gids;
 	uint32_t		server_aux_gids_max_age;
+	uint32_t		server_aux_gids_cache_size;
 	gid_cache_t		gid_cache;
         uint32_t                generation;
         gf_boolean_t            register_portmap;
@@ -1131,10 +1131,9 @@ ioc_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
         {
                 if (!ioc_inode->cache.page_table) {
                         ioc_inode->cache.page_table
-                                = rbthash_table_init
-                                (IOC_PAGE_TABLE_BUCKET_COUNT,
-                                 ioc_hashfn, NULL, 0,
-                                 table->mem_pool);
+                                = chash_table_init
+                                (IOC_PAGE_TABLE_STRIPES, 0,
+                                 ioc_hashfn, NULL);
 
                         if (ioc_inode->cache.page_table == NULL) {
                                 op_errno = ENOMEM;
@@ -1710,7 +1709,6 @@ init (xlator_t *this)
         int32_t          ret               = -1;
         glusterfs_ctx_t *ctx               = NULL;
         data_t          *data              = 0;
-        uint32_t         num_pages         = 0;
 
         xl_options = this->options;
 
@@ -1797,17 +1795,6 @@ init (xlator_t *this)
         pthread_mutex_init (&table->table_lock, NULL);
         this->private = table;
 
-        num_pages = (table->cache_size / table->page_size)
-                + ((table->cache_size % table->page_size)
-                   ? 1 : 0);
-
-        table->mem_pool = mem_pool_new (rbthash_entry_t, num_pages);
-        if (!table->mem_pool) {
-                gf_log (this->name, GF_LOG_ERROR,
-                        "Unable to allocate mem_pool");
-                goto out;
-        }
-
         ret = 0;
 
         ctx = this->ctx;
@@ -1920,6 +1907,9 @@ __ioc_cache_dump (ioc_inode_t *ioc_inode, char *prefix)
                                     timestr);
         }
 
+        chash_table_dump (ioc_inode->cache.page_table,
+                          "inode.cache.page_table");
+
         for (offset = 0; offset < ioc_inode->ia_size;
              offset += table->page_size) {
                 page = __ioc_page_get (ioc_inode, offset);
@@ -2065,11 +2055,6 @@ fini (xlator_t *this)
 
         this->private = NULL;
 
-        if (table->mem_pool != NULL) {
-                mem_pool_destroy (table->mem_pool);
-                table->mem_pool = NULL;
-        }
-
         list_for_each_entry_safe (curr, tmp, &table->priority_list, list) {
                 list_del_init (&curr->list);
                 GF_FREE (curr->pattern);
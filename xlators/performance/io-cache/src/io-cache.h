@@ -25,14 +25,14 @@
 #include "xlator.h"
 #include "common-utils.h"
 #include "call-stub.h"
-#include "rbthash.h"
+#include "chash.h"
 #include "hashfn.h"
 #include <sys/time.h>
 #include <fnmatch.h>
 
 #define IOC_PAGE_SIZE    (1024 * 128)   /* 128KB */
 #define IOC_CACHE_SIZE   (32 * 1024 * 1024)
-#define IOC_PAGE_TABLE_BUCKET_COUNT 1
+#define IOC_PAGE_TABLE_STRIPES 1
 
 struct ioc_table;
 struct ioc_local;
@@ -121,7 +121,7 @@ struct ioc_page {
 };
 
 struct ioc_cache {
-        rbthash_table_t  *page_table;
+        chash_table_t    *page_table;
         struct list_head  page_lru;
         time_t            mtime;       /*
                                         * seconds component of file mtime
@@ -168,7 +168,6 @@ struct ioc_table {
         uint32_t         inode_count;
         int32_t          cache_timeout;
         int32_t          max_pri;
-        struct mem_pool  *mem_pool;
 };
 
 typedef struct ioc_table ioc_table_t;
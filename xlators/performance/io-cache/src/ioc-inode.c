@@ -231,7 +231,7 @@ ioc_inode_destroy (ioc_inode_t *ioc_inode)
         ioc_table_unlock (table);
 
         ioc_inode_flush (ioc_inode);
-        rbthash_table_destroy (ioc_inode->cache.page_table);
+        chash_table_destroy (ioc_inode->cache.page_table);
 
         pthread_mutex_destroy (&ioc_inode->inode_lock);
         GF_FREE (ioc_inode);
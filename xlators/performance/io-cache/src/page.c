@@ -50,8 +50,8 @@ __ioc_page_get (ioc_inode_t *ioc_inode, off_t offset)
 
         rounded_offset = floor (offset, table->page_size);
 
-        page = rbthash_get (ioc_inode->cache.page_table, &rounded_offset,
-                            sizeof (rounded_offset));
+        page = chash_get (ioc_inode->cache.page_table, &rounded_offset,
+                          sizeof (rounded_offset));
 
         if (page != NULL) {
                 /* push the page to the end of the lru list */
@@ -104,8 +104,8 @@ __ioc_page_destroy (ioc_page_t *page)
                 page_size = -1;
                 page->stale = 1;
         } else {
-                rbthash_remove (page->inode->cache.page_table, &page->offset,
-                                sizeof (page->offset));
+                chash_remove (page->inode->cache.page_table, &page->offset,
+                              sizeof (page->offset));
                 list_del (&page->page_lru);
 
                 gf_log (page->inode->table->xl->name, GF_LOG_TRACE,
@@ -275,8 +275,8 @@ __ioc_page_create (ioc_inode_t *ioc_inode, off_t offset)
         newpage->inode = ioc_inode;
         pthread_mutex_init (&newpage->page_lock, NULL);
 
-        rbthash_insert (ioc_inode->cache.page_table, newpage, &rounded_offset,
-                        sizeof (rounded_offset));
+        chash_insert (ioc_inode->cache.page_table, newpage, &rounded_offset,
+                      sizeof (rounded_offset));
 
         list_add_tail (&newpage->page_lru, &ioc_inode->cache.page_lru);
 
@@ -23,6 +23,7 @@
 #include <sys/time.h>
 #include <time.h>
 #include "locking.h"
+#include "metrics.h"
 
 void *iot_worker (void *arg);
 int iot_workers_scale (iot_conf_t *conf);
@@ -2704,6 +2705,32 @@ iot_priv_dump (xlator_t *this)
         return 0;
 }
 
+int
+iot_metrics (xlator_t *this, gf_metrics_t *m)
+{
+        iot_conf_t     *conf = NULL;
+
+        conf = this->private;
+        if (!conf)
+                return 0;
+
+        gf_metrics_begin (m, "queue");
+        gf_metrics_int (m, "size", conf->queue_size);
+        gf_metrics_int (m, "high", conf->queue_sizes[IOT_PRI_HI]);
+        gf_metrics_int (m, "normal", conf->queue_sizes[IOT_PRI_NORMAL]);
+        gf_metrics_int (m, "low", conf->queue_sizes[IOT_PRI_LO]);
+        gf_metrics_int (m, "least", conf->queue_sizes[IOT_PRI_LEAST]);
+        gf_metrics_end (m);
+
+        gf_metrics_begin (m, "threads");
+        gf_metrics_int (m, "max", conf->max_count);
+        gf_metrics_int (m, "current", conf->curr_count);
+        gf_metrics_int (m, "sleeping", conf->sleep_count);
+        gf_metrics_end (m);
+
+        return 0;
+}
+
 int
 reconfigure (xlator_t *this, dict_t *options)
 {
@@ -2844,6 +2871,7 @@ fini (xlator_t *this)
 
 struct xlator_dumpops dumpops = {
         .priv    = iot_priv_dump,
+        .metrics = iot_metrics,
 };
 
 struct xlator_fops fops = {
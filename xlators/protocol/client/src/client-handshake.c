@@ -58,8 +58,10 @@ rpc_client_ping_timer_expired (void *data)
         struct rpc_clnt         *clnt               = NULL;
         xlator_t                *this               = NULL;
         clnt_conf_t             *conf               = NULL;
+        clnt_channel_t          *chan               = NULL;
 
-        this = data;
+        chan = data;
+        this = chan->this;
 
         if (!this || !this->private) {
                 gf_log (THIS->name, GF_LOG_WARNING, "xlator initialization not done");
@@ -68,7 +70,7 @@ rpc_client_ping_timer_expired (void *data)
 
         conf = this->private;
 
-        clnt = conf->rpc;
+        clnt = chan->rpc;
         if (!clnt) {
                 gf_log (this->name, GF_LOG_WARNING, "rpc not initialized");
                 goto out;
@@ -106,7 +108,7 @@ rpc_client_ping_timer_expired (void *data)
                         conn->ping_timer =
                                 gf_timer_call_after (this->ctx, timeout,
                                                      rpc_client_ping_timer_expired,
-                                                     (void *) this);
+                                                     (void *) chan);
                         if (conn->ping_timer == NULL)
                                 gf_log (trans->name, GF_LOG_WARNING,
                                         "unable to setup ping timer");
@@ -122,9 +124,10 @@ rpc_client_ping_timer_expired (void *data)
         if (disconnect) {
                 gf_log (trans->name, GF_LOG_CRITICAL,
                         "server %s has not responded in the last %d "
-                        "seconds, disconnecting.",
+                        "seconds, disconnecting%s.",
                         conn->trans->peerinfo.identifier,
-                        conf->opt.ping_timeout);
+                        conf->opt.ping_timeout,
+                        chan->index ? " the channel" : "");
 
                 rpc_transport_disconnect (conn->trans);
         }
@@ -138,24 +141,28 @@ client_start_ping (void *data)
 {
         xlator_t                *this        = NULL;
         clnt_conf_t             *conf        = NULL;
+        clnt_channel_t          *chan        = NULL;
+        struct rpc_clnt         *rpc         = NULL;
         rpc_clnt_connection_t   *conn        = NULL;
         int32_t                  ret         = -1;
         struct timespec          timeout     = {0, };
         call_frame_t            *frame       = NULL;
         int                      frame_count = 0;
 
-        this = data;
+        chan = data;
+        this = chan->this;
         if (!this || !this->private) {
                 gf_log (THIS->name, GF_LOG_WARNING, "xlator not initialized");
                 goto fail;
         }
 
         conf  = this->private;
-        if (!conf->rpc) {
+        rpc   = chan->rpc;
+        if (!rpc) {
                 gf_log (this->name, GF_LOG_WARNING, "rpc not initialized");
                 goto fail;
         }
-        conn = &conf->rpc->conn;
+        conn = &rpc->conn;
 
         if (conf->opt.ping_timeout == 0) {
                 gf_log (this->name, GF_LOG_INFO, "ping timeout is 0, returning");
@@ -201,7 +208,7 @@ client_start_ping (void *data)
                 conn->ping_timer =
                         gf_timer_call_after (this->ctx, timeout,
                                              rpc_client_ping_timer_expired,
-                                             (void *) this);
+                                             (void *) chan);
 
                 if (conn->ping_timer == NULL) {
                         gf_log (this->name, GF_LOG_WARNING,
@@ -216,9 +223,12 @@ client_start_ping (void *data)
         if (!frame)
                 goto fail;
 
-        ret = client_submit_request (this, NULL, frame, conf->handshake,
-                                     GF_HNDSK_PING, client_ping_cbk, NULL,
-                                     NULL, 0, NULL, 0, NULL, (xdrproc_t)NULL);
+        frame->cookie = chan;
+
+        ret = client_submit_channel_request (this, chan, rpc, NULL, frame,
+                                             conf->handshake, GF_HNDSK_PING,
+                                             client_ping_cbk,
+                                             (xdrproc_t)NULL);
         if (ret) {
                 gf_log (THIS->name, GF_LOG_ERROR,
                         "failed to start ping timer");
@@ -244,6 +254,7 @@ client_ping_cbk (struct rpc_req *req, struct iovec *iov, int count,
         struct timespec        timeout = {0, };
         call_frame_t          *frame   = NULL;
         clnt_conf_t           *conf    = NULL;
+        clnt_channel_t        *chan    = NULL;
 
         if (!myframe) {
                 gf_log (THIS->name, GF_LOG_WARNING,
@@ -259,7 +270,12 @@ client_ping_cbk (struct rpc_req *req, struct iovec *iov, int count,
         }
 
         conf = this->private;
-        conn = &conf->rpc->conn;
+        chan = frame->cookie;
+        if (!chan->rpc) {
+                /* the channel was closed meanwhile */
+                goto out;
+        }
+        conn = &chan->rpc->conn;
 
         pthread_mutex_lock (&conn->lock);
         {
@@ -288,7 +304,7 @@ client_ping_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
                 conn->ping_timer =
                         gf_timer_call_after (this->ctx, timeout,
-                                             client_start_ping, (void *)this);
+                                             client_start_ping, (void *)chan);
 
                 if (conn->ping_timer == NULL)
                         gf_log (this->name, GF_LOG_WARNING,
@@ -1339,6 +1355,7 @@ client_setvolume_cbk (struct rpc_req *req, struct iovec *iov, int count, void *m
         int32_t               op_errno      = 0;
         gf_boolean_t          auth_fail     = _gf_false;
         uint32_t              lk_ver        = 0;
+        struct timeval        now           = {0,};
 
         frame = myframe;
         this  = frame->this;
@@ -1450,10 +1467,23 @@ client_setvolume_cbk (struct rpc_req *req, struct iovec *iov, int count, void *m
         }
         */
 
-        gf_log (this->name, GF_LOG_INFO,
-                "Connected to %s, attached to remote volume '%s'.",
-                conf->rpc->conn.trans->peerinfo.identifier,
-                remote_subvol);
+        if (conf->parent_up_ts.tv_sec) {
+                gettimeofday (&now, NULL);
+                gf_log (this->name, GF_LOG_INFO,
+                        "Connected to %s, attached to remote volume '%s' "
+                        "%"PRId64" ms after parent up.",
+                        conf->rpc->conn.trans->peerinfo.identifier,
+                        remote_subvol,
+                        (int64_t) (now.tv_sec - conf->parent_up_ts.tv_sec) *
+                        1000 + (now.tv_usec - conf->parent_up_ts.tv_usec) /
+                        1000);
+                conf->parent_up_ts.tv_sec = 0;
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "Connected to %s, attached to remote volume '%s'.",
+                        conf->rpc->conn.trans->peerinfo.identifier,
+                        remote_subvol);
+        }
 
         rpc_clnt_set_connected (&conf->rpc->conn);
 
@@ -1463,6 +1493,8 @@ client_setvolume_cbk (struct rpc_req *req, struct iovec *iov, int count, void *m
 
         conf->need_different_port = 0;
 
+        client_channels_start (this);
+
         if (lk_ver != client_get_lk_ver (conf)) {
                 gf_log (this->name, GF_LOG_INFO, "Server and Client "
                         "lk-version numbers are not same, reopening the fds");
@@ -1514,6 +1546,74 @@ out:
         return ret;
 }
 
+/* A channel other than 0 is attached: the server found the client_t of
+   channel 0 by the process-uuid, the fds and locks are shared. */
+int
+client_channel_setvolume_cbk (struct rpc_req *req, struct iovec *iov,
+                              int count, void *myframe)
+{
+        call_frame_t         *frame    = NULL;
+        clnt_channel_t       *chan     = NULL;
+        clnt_conf_t          *conf     = NULL;
+        xlator_t             *this     = NULL;
+        gf_setvolume_rsp      rsp      = {0,};
+        int                   ret      = -1;
+
+        frame = myframe;
+        this  = frame->this;
+        conf  = this->private;
+        chan  = frame->cookie;
+
+        if (-1 == req->rpc_status) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "channel %d: received RPC status error", chan->index);
+                goto out;
+        }
+
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gf_setvolume_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "channel %d: XDR decoding failed", chan->index);
+                goto out;
+        }
+
+        if (-1 == rsp.op_ret) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "channel %d: SETVOLUME on remote-host failed (%s)",
+                        chan->index,
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+                ret = -1;
+                goto out;
+        }
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                /* channel 0 may have gone away while this one attached */
+                if (conf->connected && chan->rpc &&
+                    req->conn == &chan->rpc->conn) {
+                        rpc_clnt_set_connected (&chan->rpc->conn);
+                        chan->ready = 1;
+
+                        gf_log (this->name, GF_LOG_INFO,
+                                "channel %d connected to %s", chan->index,
+                                chan->rpc->conn.trans->peerinfo.identifier);
+                }
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        ret = 0;
+out:
+        /* try again with the next reconnect */
+        if (ret && req->conn)
+                rpc_transport_disconnect (req->conn->trans);
+
+        free (rsp.dict.dict_val);
+
+        STACK_DESTROY (frame->root);
+
+        return 0;
+}
+
 int
 client_setvolume (xlator_t *this, struct rpc_clnt *rpc)
 {
@@ -1523,10 +1623,22 @@ client_setvolume (xlator_t *this, struct rpc_clnt *rpc)
         char             *process_uuid_xl = NULL;
         clnt_conf_t      *conf            = NULL;
         dict_t           *options         = NULL;
+        clnt_channel_t   *chan            = NULL;
+        fop_cbk_fn_t      cbkfn           = client_setvolume_cbk;
 
         options = this->options;
         conf    = this->private;
 
+        chan = &conf->channels[0];
+        if (rpc != conf->rpc) {
+                chan = client_channel_find (this, rpc);
+                if (!chan) {
+                        ret = -1;
+                        goto fail;
+                }
+                cbkfn = client_channel_setvolume_cbk;
+        }
+
         if (conf->fops) {
                 ret = dict_set_int32 (options, "fops-version",
                                       conf->fops->prognum);
@@ -1620,10 +1732,12 @@ client_setvolume (xlator_t *this, struct rpc_clnt *rpc)
         if (!fr)
                 goto fail;
 
-        ret = client_submit_request (this, &req, fr, conf->handshake,
-                                     GF_HNDSK_SETVOLUME, client_setvolume_cbk,
-                                     NULL, NULL, 0, NULL, 0, NULL,
-                                     (xdrproc_t)xdr_gf_setvolume_req);
+        fr->cookie = chan;
+
+        ret = client_submit_channel_request (this, chan, rpc, &req, fr,
+                                             conf->handshake,
+                                             GF_HNDSK_SETVOLUME, cbkfn,
+                                             (xdrproc_t)xdr_gf_setvolume_req);
 
 fail:
         GF_FREE (req.dict.dict_val);
@@ -177,7 +177,6 @@ unserialize_rsp_direntp (xlator_t *this, fd_t *fd,
                          struct gfs3_readdirp_rsp *rsp, gf_dirent_t *entries)
 {
         struct gfs3_dirplist *trav      = NULL;
-        char                 *buf       = NULL;
 	gf_dirent_t          *entry     = NULL;
         inode_table_t        *itable    = NULL;
         int                   entry_len = 0;
@@ -204,23 +203,22 @@ unserialize_rsp_direntp (xlator_t *this, fd_t *fd,
                 strcpy (entry->d_name, trav->name);
 
                 if (trav->dict.dict_val) {
-                        /* Dictionary is sent along with response */
-                        buf = memdup (trav->dict.dict_val, trav->dict.dict_len);
-                        if (!buf)
-                                goto out;
-
+                        /* Dictionary is sent along with response, it
+                           takes over the buffer allocated by the rpc lib */
                         entry->dict = dict_new ();
+                        if (!entry->dict)
+                                goto out;
 
-                        ret = dict_unserialize (buf, trav->dict.dict_len,
-                                                &entry->dict);
+                        ret = dict_unserialize_nocopy (trav->dict.dict_val,
+                                                       trav->dict.dict_len,
+                                                       &entry->dict, 1);
+                        trav->dict.dict_val = NULL;
                         if (ret < 0) {
                                 gf_log (THIS->name, GF_LOG_WARNING,
                                         "failed to unserialize xattr dict");
                                 errno = EINVAL;
                                 goto out;
                         }
-                        entry->dict->extra_free = buf;
-                        buf = NULL;
                 }
 
                 entry->inode = inode_find (itable, entry->d_stat.ia_gfid);
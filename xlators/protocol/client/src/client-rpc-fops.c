@@ -30,19 +30,20 @@ client_submit_vec_request (xlator_t  *this, void *req, call_frame_t  *frame,
                            struct iovec  *payload, int payloadcnt,
                            struct iobref *iobref, xdrproc_t xdrproc)
 {
-        int             ret        = 0;
-        clnt_conf_t    *conf       = NULL;
-        struct iovec    iov        = {0, };
-        struct iobuf   *iobuf      = NULL;
-        int             count      = 0;
-        int             start_ping = 0;
-        struct iobref  *new_iobref = NULL;
-        ssize_t         xdr_size   = 0;
-        struct rpc_req  rpcreq     = {0, };
+        int              ret        = 0;
+        struct iovec     iov        = {0, };
+        struct iobuf    *iobuf      = NULL;
+        int              count      = 0;
+        int              start_ping = 0;
+        struct iobref   *new_iobref = NULL;
+        ssize_t          xdr_size   = 0;
+        struct rpc_req   rpcreq     = {0, };
+        clnt_channel_t  *chan       = NULL;
+        struct rpc_clnt *rpc        = NULL;
 
         start_ping = 0;
 
-        conf = this->private;
+        chan = client_channel_get (this, prog, procnum, req, &rpc);
 
         if (req && xdrproc) {
                 xdr_size = xdr_sizeof (xdrproc, req);
@@ -88,7 +89,7 @@ client_submit_vec_request (xlator_t  *this, void *req, call_frame_t  *frame,
         }
 
         /* Send the msg */
-        ret = rpc_clnt_submit (conf->rpc, prog, procnum, cbkfn, &iov, count,
+        ret = rpc_clnt_submit (rpc, prog, procnum, cbkfn, &iov, count,
                                payload, payloadcnt, new_iobref, frame, NULL, 0,
                                NULL, 0, NULL);
         if (ret < 0) {
@@ -96,17 +97,19 @@ client_submit_vec_request (xlator_t  *this, void *req, call_frame_t  *frame,
         }
 
         if (ret == 0) {
-                pthread_mutex_lock (&conf->rpc->conn.lock);
+                pthread_mutex_lock (&rpc->conn.lock);
                 {
-                        if (!conf->rpc->conn.ping_started) {
+                        if (!rpc->conn.ping_started) {
                                 start_ping = 1;
                         }
                 }
-                pthread_mutex_unlock (&conf->rpc->conn.lock);
+                pthread_mutex_unlock (&rpc->conn.lock);
         }
 
         if (start_ping)
-                client_start_ping ((void *) this);
+                client_start_ping ((void *) chan);
+
+        client_channel_put (chan, rpc);
 
         if (new_iobref)
                 iobref_unref (new_iobref);
@@ -117,6 +120,8 @@ client_submit_vec_request (xlator_t  *this, void *req, call_frame_t  *frame,
         return ret;
 
 unwind:
+        client_channel_put (chan, rpc);
+
         rpcreq.rpc_status = -1;
         cbkfn (&rpcreq, NULL, 0, frame);
 
@@ -173,9 +178,9 @@ client3_3_symlink_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.postparent, &postparent);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -244,9 +249,9 @@ client3_3_mknod_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.postparent, &postparent);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -310,9 +315,9 @@ client3_3_mkdir_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.postparent, &postparent);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -452,9 +457,9 @@ client3_3_open_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 }
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -509,9 +514,9 @@ client3_3_stat_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.stat, &iatt);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -563,9 +568,9 @@ client3_3_readlink_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.buf, &iatt);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -625,9 +630,9 @@ client3_3_unlink_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.postparent, &postparent);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -685,9 +690,9 @@ client3_3_rmdir_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.postparent, &postparent);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -742,9 +747,9 @@ client3_3_truncate_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.poststat, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -797,9 +802,9 @@ client3_3_statfs_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_statfs_to_statfs (&rsp.statfs, &statfs);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -856,9 +861,9 @@ client3_3_writev_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.poststat, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -917,9 +922,9 @@ client3_3_flush_cbk (struct rpc_req *req, struct iovec *iov, int count,
                         lkowner_utoa (&local->owner), ret);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -974,9 +979,9 @@ client3_3_fsync_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.poststat, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1024,9 +1029,9 @@ client3_3_setxattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         op_errno = gf_error_to_errno (rsp.op_errno);
@@ -1081,15 +1086,16 @@ client3_3_getxattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
         op_errno = gf_error_to_errno (rsp.op_errno);
         if (-1 != rsp.op_ret) {
-                GF_PROTOCOL_DICT_UNSERIALIZE (frame->this, dict,
-                                              (rsp.dict.dict_val),
-                                              (rsp.dict.dict_len), rsp.op_ret,
-                                              op_errno, out);
+                GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->this, dict,
+                                                     (rsp.dict.dict_val),
+                                                     (rsp.dict.dict_len),
+                                                     rsp.op_ret,
+                                                     op_errno, out);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1153,14 +1159,15 @@ client3_3_fgetxattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
         op_errno = gf_error_to_errno (rsp.op_errno);
         if (-1 != rsp.op_ret) {
-                GF_PROTOCOL_DICT_UNSERIALIZE (frame->this, dict,
-                                              (rsp.dict.dict_val),
-                                              (rsp.dict.dict_len), rsp.op_ret,
-                                              op_errno, out);
+                GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->this, dict,
+                                                     (rsp.dict.dict_val),
+                                                     (rsp.dict.dict_len),
+                                                     rsp.op_ret,
+                                                     op_errno, out);
         }
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1213,9 +1220,9 @@ client3_3_removexattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1263,9 +1270,9 @@ client3_3_fremovexattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1311,9 +1318,9 @@ client3_3_fsyncdir_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1359,9 +1366,9 @@ client3_3_access_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1415,9 +1422,9 @@ client3_3_ftruncate_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.poststat, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1469,9 +1476,9 @@ client3_3_fstat_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.stat, &stat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1518,9 +1525,9 @@ client3_3_inodelk_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if ((rsp.op_ret == -1) &&
@@ -1568,9 +1575,9 @@ client3_3_finodelk_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if ((rsp.op_ret == -1) &&
@@ -1620,9 +1627,9 @@ client3_3_entrylk_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if ((rsp.op_ret == -1) &&
@@ -1670,9 +1677,9 @@ client3_3_fentrylk_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if ((rsp.op_ret == -1) &&
@@ -1726,15 +1733,16 @@ client3_3_xattrop_cbk (struct rpc_req *req, struct iovec *iov, int count,
 
         op_errno = rsp.op_errno;
         if (-1 != rsp.op_ret) {
-                GF_PROTOCOL_DICT_UNSERIALIZE (frame->this, dict,
-                                              (rsp.dict.dict_val),
-                                              (rsp.dict.dict_len), rsp.op_ret,
-                                              op_errno, out);
+                GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->this, dict,
+                                                     (rsp.dict.dict_val),
+                                                     (rsp.dict.dict_len),
+                                                     rsp.op_ret,
+                                                     op_errno, out);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1793,16 +1801,17 @@ client3_3_fxattrop_cbk (struct rpc_req *req, struct iovec *iov, int count,
         }
         op_errno = rsp.op_errno;
         if (-1 != rsp.op_ret) {
-                GF_PROTOCOL_DICT_UNSERIALIZE (frame->this, dict,
-                                              (rsp.dict.dict_val),
-                                              (rsp.dict.dict_len), rsp.op_ret,
-                                              op_errno, out);
+                GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->this, dict,
+                                                     (rsp.dict.dict_val),
+                                                     (rsp.dict.dict_len),
+                                                     rsp.op_ret,
+                                                     op_errno, out);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->this, xdata,
-                                      (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), rsp.op_ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->this, xdata,
+                                             (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), rsp.op_ret,
+                                             op_errno, out);
 out:
 
         if (rsp.op_ret == -1) {
@@ -1857,9 +1866,9 @@ client3_3_fsetxattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         op_errno = gf_error_to_errno (rsp.op_errno);
@@ -1915,9 +1924,9 @@ client3_3_fsetattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.statpost, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -1971,9 +1980,9 @@ client3_3_fallocate_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.statpost, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2026,9 +2035,9 @@ client3_3_discard_cbk(struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.statpost, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2081,9 +2090,9 @@ client3_3_zerofill_cbk(struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.statpost, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2139,9 +2148,9 @@ client3_3_setattr_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.statpost, &poststat);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2212,9 +2221,9 @@ client3_3_create_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 }
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2266,9 +2275,9 @@ client3_3_rchecksum_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 goto out;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2344,9 +2353,9 @@ client3_3_lk_cbk (struct rpc_req *req, struct iovec *iov, int count,
         }
         */
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if ((rsp.op_ret == -1) &&
@@ -2405,10 +2414,10 @@ client3_3_readdir_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 unserialize_rsp_dirent (&rsp, &entries);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->this, xdata,
-                                      (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), rsp.op_ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->this, xdata,
+                                             (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), rsp.op_ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2471,9 +2480,9 @@ client3_3_readdirp_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 unserialize_rsp_direntp (this, local->fd, &rsp, &entries);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2541,9 +2550,9 @@ client3_3_rename_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.postnewparent, &postnewparent);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2607,9 +2616,9 @@ client3_3_link_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 gf_stat_to_iatt (&rsp.postparent, &postparent);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2677,9 +2686,9 @@ client3_3_opendir_cbk (struct rpc_req *req, struct iovec *iov, int count,
                 }
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 out:
         if (rsp.op_ret == -1) {
@@ -2744,9 +2753,10 @@ client3_3_lookup_cbk (struct rpc_req *req, struct iovec *iov, int count,
         rsp.op_ret = -1;
         gf_stat_to_iatt (&rsp.stat, &stbuf);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), rsp.op_ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->this, xdata,
+                                             (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), rsp.op_ret,
+                                             op_errno, out);
 
         if ((!uuid_is_null (inode->gfid))
             && (uuid_compare (stbuf.ia_gfid, inode->gfid) != 0)) {
@@ -2828,9 +2838,9 @@ client3_3_readv_cbk (struct rpc_req *req, struct iovec *iov, int count,
                         vector[0].iov_base = req->rsp[1].iov_base;
                 rspcount = 1;
         }
-        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
-                                      (rsp.xdata.xdata_len), ret,
-                                      rsp.op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (this, xdata, (rsp.xdata.xdata_val),
+                                             (rsp.xdata.xdata_len), ret,
+                                             rsp.op_errno, out);
 
 #ifdef GF_TESTING_IO_XDATA
         dict_dump (xdata);
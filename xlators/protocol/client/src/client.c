@@ -19,6 +19,8 @@
 #include "defaults.h"
 #include "glusterfs.h"
 #include "statedump.h"
+#include "metrics.h"
+#include "syncop.h"
 #include "compat-errno.h"
 
 #include "glusterfs3.h"
@@ -28,6 +30,7 @@ extern rpc_clnt_prog_t clnt_dump_prog;
 extern struct rpcclnt_cb_program gluster_cbk_prog;
 
 int client_handshake (xlator_t *this, struct rpc_clnt *rpc);
+int client_setvolume (xlator_t *this, struct rpc_clnt *rpc);
 void client_start_ping (void *data);
 int client_init_rpc (xlator_t *this);
 int client_destroy_rpc (xlator_t *this);
@@ -142,13 +145,170 @@ out:
         return ret;
 }
 
-int
-client_submit_request (xlator_t *this, void *req, call_frame_t *frame,
-                       rpc_clnt_prog_t *prog, int procnum, fop_cbk_fn_t cbkfn,
-                       struct iobref *iobref,  struct iovec *rsphdr,
-                       int rsphdr_count, struct iovec *rsp_payload,
-                       int rsp_payload_count, struct iobref *rsp_iobref,
-                       xdrproc_t xdrproc)
+/* Where the gfid a fop is spread over the channels by lives in its
+   request.  Named lookups go by their parent; fops whose request has no
+   gfid (fsetattr, rchecksum) always go over channel 0. */
+struct client_channel_key {
+        char    keyed;
+        size_t  gfid;
+        char    has_pargfid;
+        size_t  pargfid;
+};
+
+#define CLIENT_CHANNEL_KEY(type, field)                         \
+        { 1, offsetof (type, field), 0, 0 }
+#define CLIENT_CHANNEL_KEY2(type, field, parfield)              \
+        { 1, offsetof (type, field), 1, offsetof (type, parfield) }
+
+static const struct client_channel_key
+client_channel_keys[GFS3_OP_MAXVALUE] = {
+        [GFS3_OP_STAT]         = CLIENT_CHANNEL_KEY (gfs3_stat_req, gfid),
+        [GFS3_OP_READLINK]     = CLIENT_CHANNEL_KEY (gfs3_readlink_req, gfid),
+        [GFS3_OP_MKNOD]        = CLIENT_CHANNEL_KEY (gfs3_mknod_req, pargfid),
+        [GFS3_OP_MKDIR]        = CLIENT_CHANNEL_KEY (gfs3_mkdir_req, pargfid),
+        [GFS3_OP_UNLINK]       = CLIENT_CHANNEL_KEY (gfs3_unlink_req, pargfid),
+        [GFS3_OP_RMDIR]        = CLIENT_CHANNEL_KEY (gfs3_rmdir_req, pargfid),
+        [GFS3_OP_SYMLINK]      = CLIENT_CHANNEL_KEY (gfs3_symlink_req,
+                                                     pargfid),
+        [GFS3_OP_RENAME]       = CLIENT_CHANNEL_KEY (gfs3_rename_req, oldgfid),
+        [GFS3_OP_LINK]         = CLIENT_CHANNEL_KEY (gfs3_link_req, oldgfid),
+        [GFS3_OP_TRUNCATE]     = CLIENT_CHANNEL_KEY (gfs3_truncate_req, gfid),
+        [GFS3_OP_OPEN]         = CLIENT_CHANNEL_KEY (gfs3_open_req, gfid),
+        [GFS3_OP_READ]         = CLIENT_CHANNEL_KEY (gfs3_read_req, gfid),
+        [GFS3_OP_WRITE]        = CLIENT_CHANNEL_KEY (gfs3_write_req, gfid),
+        [GFS3_OP_STATFS]       = CLIENT_CHANNEL_KEY (gfs3_statfs_req, gfid),
+        [GFS3_OP_FLUSH]        = CLIENT_CHANNEL_KEY (gfs3_flush_req, gfid),
+        [GFS3_OP_FSYNC]        = CLIENT_CHANNEL_KEY (gfs3_fsync_req, gfid),
+        [GFS3_OP_SETXATTR]     = CLIENT_CHANNEL_KEY (gfs3_setxattr_req, gfid),
+        [GFS3_OP_GETXATTR]     = CLIENT_CHANNEL_KEY (gfs3_getxattr_req, gfid),
+        [GFS3_OP_REMOVEXATTR]  = CLIENT_CHANNEL_KEY (gfs3_removexattr_req,
+                                                     gfid),
+        [GFS3_OP_OPENDIR]      = CLIENT_CHANNEL_KEY (gfs3_opendir_req, gfid),
+        [GFS3_OP_FSYNCDIR]     = CLIENT_CHANNEL_KEY (gfs3_fsyncdir_req, gfid),
+        [GFS3_OP_ACCESS]       = CLIENT_CHANNEL_KEY (gfs3_access_req, gfid),
+        [GFS3_OP_CREATE]       = CLIENT_CHANNEL_KEY (gfs3_create_req, pargfid),
+        [GFS3_OP_FTRUNCATE]    = CLIENT_CHANNEL_KEY (gfs3_ftruncate_req, gfid),
+        [GFS3_OP_FSTAT]        = CLIENT_CHANNEL_KEY (gfs3_fstat_req, gfid),
+        [GFS3_OP_LK]           = CLIENT_CHANNEL_KEY (gfs3_lk_req, gfid),
+        [GFS3_OP_LOOKUP]       = CLIENT_CHANNEL_KEY2 (gfs3_lookup_req, gfid,
+                                                      pargfid),
+        [GFS3_OP_READDIR]      = CLIENT_CHANNEL_KEY (gfs3_readdir_req, gfid),
+        [GFS3_OP_INODELK]      = CLIENT_CHANNEL_KEY (gfs3_inodelk_req, gfid),
+        [GFS3_OP_FINODELK]     = CLIENT_CHANNEL_KEY (gfs3_finodelk_req, gfid),
+        [GFS3_OP_ENTRYLK]      = CLIENT_CHANNEL_KEY (gfs3_entrylk_req, gfid),
+        [GFS3_OP_FENTRYLK]     = CLIENT_CHANNEL_KEY (gfs3_fentrylk_req, gfid),
+        [GFS3_OP_XATTROP]      = CLIENT_CHANNEL_KEY (gfs3_xattrop_req, gfid),
+        [GFS3_OP_FXATTROP]     = CLIENT_CHANNEL_KEY (gfs3_fxattrop_req, gfid),
+        [GFS3_OP_FGETXATTR]    = CLIENT_CHANNEL_KEY (gfs3_fgetxattr_req, gfid),
+        [GFS3_OP_FSETXATTR]    = CLIENT_CHANNEL_KEY (gfs3_fsetxattr_req, gfid),
+        [GFS3_OP_READDIRP]     = CLIENT_CHANNEL_KEY (gfs3_readdirp_req, gfid),
+        [GFS3_OP_RELEASE]      = CLIENT_CHANNEL_KEY (gfs3_release_req, gfid),
+        [GFS3_OP_RELEASEDIR]   = CLIENT_CHANNEL_KEY (gfs3_releasedir_req,
+                                                     gfid),
+        [GFS3_OP_FREMOVEXATTR] = CLIENT_CHANNEL_KEY (gfs3_fremovexattr_req,
+                                                     gfid),
+        [GFS3_OP_SETATTR]      = CLIENT_CHANNEL_KEY (gfs3_setattr_req, gfid),
+        [GFS3_OP_FALLOCATE]    = CLIENT_CHANNEL_KEY (gfs3_fallocate_req, gfid),
+        [GFS3_OP_DISCARD]      = CLIENT_CHANNEL_KEY (gfs3_discard_req, gfid),
+        [GFS3_OP_ZEROFILL]     = CLIENT_CHANNEL_KEY (gfs3_zerofill_req, gfid),
+};
+
+
+/* Pick the channel for a request: fops on the same gfid always hash to
+   the same channel, so they stay ordered with respect to each other.  A
+   channel that is not attached falls back to channel 0.  While a channel
+   attaches or goes away, fops on its gfids still in flight on the old
+   channel are not waited for, so their order is not kept then.  The rpc
+   returned in @rpc must be given back with client_channel_put (). */
+clnt_channel_t *
+client_channel_get (xlator_t *this, rpc_clnt_prog_t *prog, int procnum,
+                    void *req, struct rpc_clnt **rpc)
+{
+        clnt_conf_t                     *conf = NULL;
+        clnt_channel_t                  *chan = NULL;
+        const struct client_channel_key *key  = NULL;
+        unsigned char                   *gfid = NULL;
+        uint32_t                         hash = 0;
+
+        conf = this->private;
+        chan = &conf->channels[0];
+        *rpc = conf->rpc;
+
+        if (conf->channel_count < 2 || !req || !prog ||
+            prog->prognum != GLUSTER_FOP_PROGRAM ||
+            procnum <= 0 || procnum >= GFS3_OP_MAXVALUE)
+                goto out;
+
+        key = &client_channel_keys[procnum];
+        if (!key->keyed)
+                goto out;
+
+        gfid = (unsigned char *)req + key->gfid;
+        if (uuid_is_null (gfid) && key->has_pargfid)
+                gfid = (unsigned char *)req + key->pargfid;
+        if (uuid_is_null (gfid))
+                goto out;
+
+        /* gfids are random, their last bytes spread well enough */
+        memcpy (&hash, gfid + sizeof (uuid_t) - sizeof (hash), sizeof (hash));
+        hash %= conf->channel_count;
+        if (hash == 0)
+                goto out;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                if (conf->channels[hash].ready) {
+                        chan = &conf->channels[hash];
+                        *rpc = rpc_clnt_ref (chan->rpc);
+                }
+        }
+        pthread_mutex_unlock (&conf->lock);
+out:
+        return chan;
+}
+
+
+void
+client_channel_put (clnt_channel_t *chan, struct rpc_clnt *rpc)
+{
+        if (chan->index)
+                rpc_clnt_unref (rpc);
+}
+
+
+clnt_channel_t *
+client_channel_find (xlator_t *this, struct rpc_clnt *rpc)
+{
+        clnt_conf_t    *conf = NULL;
+        clnt_channel_t *chan = NULL;
+        int             i    = 0;
+
+        conf = this->private;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                for (i = 1; i < conf->channel_count; i++) {
+                        if (conf->channels[i].rpc == rpc) {
+                                chan = &conf->channels[i];
+                                break;
+                        }
+                }
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        return chan;
+}
+
+
+static int
+client_submit_rpc_request (xlator_t *this, clnt_channel_t *chan,
+                           struct rpc_clnt *rpc, void *req,
+                           call_frame_t *frame, rpc_clnt_prog_t *prog,
+                           int procnum, fop_cbk_fn_t cbkfn,
+                           struct iobref *iobref,  struct iovec *rsphdr,
+                           int rsphdr_count, struct iovec *rsp_payload,
+                           int rsp_payload_count, struct iobref *rsp_iobref,
+                           xdrproc_t xdrproc)
 {
         int             ret        = -1;
         clnt_conf_t    *conf       = NULL;
@@ -226,7 +386,7 @@ client_submit_request (xlator_t *this, void *req, call_frame_t *frame,
         }
 
         /* Send the msg */
-        ret = rpc_clnt_submit (conf->rpc, prog, procnum, cbkfn, &iov, count,
+        ret = rpc_clnt_submit (rpc, prog, procnum, cbkfn, &iov, count,
                                NULL, 0, new_iobref, frame, rsphdr, rsphdr_count,
                                rsp_payload, rsp_payload_count, rsp_iobref);
 
@@ -235,17 +395,17 @@ client_submit_request (xlator_t *this, void *req, call_frame_t *frame,
         }
 
         if (ret == 0) {
-                pthread_mutex_lock (&conf->rpc->conn.lock);
+                pthread_mutex_lock (&rpc->conn.lock);
                 {
-                        if (!conf->rpc->conn.ping_started) {
+                        if (!rpc->conn.ping_started) {
                                 start_ping = 1;
                         }
                 }
-                pthread_mutex_unlock (&conf->rpc->conn.lock);
+                pthread_mutex_unlock (&rpc->conn.lock);
         }
 
         if (start_ping)
-                client_start_ping ((void *) this);
+                client_start_ping ((void *) chan);
 
         ret = 0;
 
@@ -272,6 +432,46 @@ out:
 }
 
 
+int
+client_submit_request (xlator_t *this, void *req, call_frame_t *frame,
+                       rpc_clnt_prog_t *prog, int procnum, fop_cbk_fn_t cbkfn,
+                       struct iobref *iobref,  struct iovec *rsphdr,
+                       int rsphdr_count, struct iovec *rsp_payload,
+                       int rsp_payload_count, struct iobref *rsp_iobref,
+                       xdrproc_t xdrproc)
+{
+        int              ret  = 0;
+        clnt_channel_t  *chan = NULL;
+        struct rpc_clnt *rpc  = NULL;
+
+        chan = client_channel_get (this, prog, procnum, req, &rpc);
+
+        ret = client_submit_rpc_request (this, chan, rpc, req, frame, prog,
+                                         procnum, cbkfn, iobref, rsphdr,
+                                         rsphdr_count, rsp_payload,
+                                         rsp_payload_count, rsp_iobref,
+                                         xdrproc);
+
+        client_channel_put (chan, rpc);
+
+        return ret;
+}
+
+
+/* handshake and ping requests, which belong to one particular channel */
+int
+client_submit_channel_request (xlator_t *this, clnt_channel_t *chan,
+                               struct rpc_clnt *rpc, void *req,
+                               call_frame_t *frame, rpc_clnt_prog_t *prog,
+                               int procnum, fop_cbk_fn_t cbkfn,
+                               xdrproc_t xdrproc)
+{
+        return client_submit_rpc_request (this, chan, rpc, req, frame, prog,
+                                          procnum, cbkfn, NULL, NULL, 0, NULL,
+                                          0, NULL, xdrproc);
+}
+
+
 int32_t
 client_forget (xlator_t *this, inode_t *inode)
 {
@@ -2190,6 +2390,10 @@ client_rpc_notify (struct rpc_clnt *rpc, void *mydata, rpc_clnt_event_t event,
                 break;
         }
         case RPC_CLNT_DISCONNECT:
+                /* the server drops the fds and locks of a client only once
+                   all of its connections are gone */
+                client_channels_stop (this);
+
                 if (!conf->lk_heal)
                         client_mark_fd_bad (this);
                 else
@@ -2255,6 +2459,192 @@ out:
 }
 
 
+static int
+client_channel_notify (struct rpc_clnt *rpc, void *mydata,
+                       rpc_clnt_event_t event, void *data)
+{
+        clnt_channel_t *chan  = NULL;
+        xlator_t       *this  = NULL;
+        clnt_conf_t    *conf  = NULL;
+        char            stale = 0;
+        char            ready = 0;
+        int             ret   = 0;
+
+        chan = mydata;
+        this = chan->this;
+        conf = this->private;
+        if (!conf)
+                goto out;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                stale = (chan->rpc != rpc);
+                ready = chan->ready;
+                if (!stale && event == RPC_CLNT_DISCONNECT)
+                        chan->ready = 0;
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        /* events of a channel client_channels_stop () already dropped */
+        if (stale)
+                goto out;
+
+        switch (event) {
+        case RPC_CLNT_CONNECT:
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "channel %d connected, attaching", chan->index);
+
+                ret = client_setvolume (this, rpc);
+                if (ret)
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "channel %d: SETVOLUME returned %d",
+                                chan->index, ret);
+                break;
+
+        case RPC_CLNT_DISCONNECT:
+                /* the rpc reconnects by itself; until it is attached again
+                   its fops go over channel 0 */
+                if (ready)
+                        gf_log (this->name, GF_LOG_INFO,
+                                "channel %d disconnected from %s",
+                                chan->index,
+                                rpc->conn.trans->peerinfo.identifier);
+                break;
+
+        default:
+                gf_log (this->name, GF_LOG_TRACE,
+                        "channel %d: got some other RPC event %d",
+                        chan->index, event);
+                break;
+        }
+
+out:
+        return 0;
+}
+
+
+/* Called once channel 0 is attached: open the other channels to the port
+   it found the brick on. */
+int
+client_channels_start (xlator_t *this)
+{
+        clnt_conf_t            *conf   = NULL;
+        clnt_channel_t         *chan   = NULL;
+        struct rpc_clnt        *rpc    = NULL;
+        struct rpc_clnt_config  config = {0, };
+        int                     i      = 0;
+        int                     ret    = 0;
+
+        conf = this->private;
+
+        config.remote_port = conf->rpc->conn.config.remote_port;
+
+        for (i = 1; i < conf->channel_count; i++) {
+                chan = &conf->channels[i];
+                if (chan->rpc)
+                        continue;
+
+                rpc = rpc_clnt_new (this->options, this->ctx, this->name, 0);
+                if (!rpc) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "failed to initialize RPC of channel %d", i);
+                        ret = -1;
+                        continue;
+                }
+
+                rpc_clnt_reconfig (rpc, &config);
+                rpc_clnt_register_notify (rpc, client_channel_notify, chan);
+                rpcclnt_cbk_program_register (rpc, &gluster_cbk_prog, this);
+
+                pthread_mutex_lock (&conf->lock);
+                {
+                        chan->rpc   = rpc;
+                        chan->ready = 0;
+                }
+                pthread_mutex_unlock (&conf->lock);
+
+                rpc_clnt_start (rpc);
+        }
+
+        return ret;
+}
+
+
+void
+client_channels_stop (xlator_t *this)
+{
+        clnt_conf_t     *conf = NULL;
+        clnt_channel_t  *chan = NULL;
+        struct rpc_clnt *rpc  = NULL;
+        int              i    = 0;
+
+        conf = this->private;
+
+        for (i = 1; i < conf->channel_count; i++) {
+                chan = &conf->channels[i];
+
+                pthread_mutex_lock (&conf->lock);
+                {
+                        rpc = chan->rpc;
+                        chan->rpc   = NULL;
+                        chan->ready = 0;
+                }
+                pthread_mutex_unlock (&conf->lock);
+
+                if (!rpc)
+                        continue;
+
+                rpc_clnt_disable (rpc);
+
+                /* cleanup the saved-frames before last unref */
+                rpc_clnt_connection_cleanup (&rpc->conn);
+                rpc_clnt_unref (rpc);
+        }
+}
+
+
+/* Resolving the brick address and connecting may block for a while; run
+   from the syncenv, the clients of a graph connect concurrently instead of
+   one after the other in the PARENT_UP walk. */
+static int
+client_start_task (void *data)
+{
+        xlator_t        *this = data;
+        clnt_conf_t     *conf = this->private;
+        char             parent_down = 0;
+
+        pthread_mutex_lock (&conf->lock);
+        {
+                parent_down = conf->parent_down;
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (parent_down)
+                return 0;
+
+        rpc_clnt_start (conf->rpc);
+
+        /* PARENT_DOWN may have disabled the rpc before the start */
+        pthread_mutex_lock (&conf->lock);
+        {
+                parent_down = conf->parent_down;
+        }
+        pthread_mutex_unlock (&conf->lock);
+
+        if (parent_down)
+                rpc_clnt_disable (conf->rpc);
+
+        return 0;
+}
+
+
+static int
+client_start_done (int ret, call_frame_t *frame, void *data)
+{
+        return 0;
+}
+
+
 int
 notify (xlator_t *this, int32_t event, void *data, ...)
 {
@@ -2271,7 +2661,12 @@ notify (xlator_t *this, int32_t event, void *data, ...)
                         "parent translators are ready, attempting connect "
                         "on transport");
 
-                rpc_clnt_start (conf->rpc);
+                gettimeofday (&conf->parent_up_ts, NULL);
+
+                if (!this->ctx->env ||
+                    synctask_new (this->ctx->env, client_start_task,
+                                  client_start_done, NULL, this) != 0)
+                        rpc_clnt_start (conf->rpc);
                 break;
         }
 
@@ -2301,6 +2696,22 @@ notify (xlator_t *this, int32_t event, void *data, ...)
         return 0;
 }
 
+/* With lk-heal the server releases the internal locks of a client when
+   any of its connections goes away, so one flapping extra channel would
+   drop locks still held through the others: stay on one channel then. */
+static int
+client_channel_count (xlator_t *this, clnt_conf_t *conf)
+{
+        if (conf->opt.channels > 1 && conf->lk_heal) {
+                gf_log (this->name, GF_LOG_WARNING, "lk-heal is on, "
+                        "ignoring channels %d", conf->opt.channels);
+                return 1;
+        }
+
+        return conf->opt.channels;
+}
+
+
 int
 build_client_config (xlator_t *this, clnt_conf_t *conf)
 {
@@ -2327,6 +2738,9 @@ build_client_config (xlator_t *this, clnt_conf_t *conf)
         GF_OPTION_INIT ("filter-O_DIRECT", conf->filter_o_direct,
                         bool, out);
 
+        GF_OPTION_INIT ("channels", conf->opt.channels, int32, out);
+        conf->channel_count = client_channel_count (this, conf);
+
         ret = 0;
 out:
         return ret;
@@ -2363,10 +2777,13 @@ client_destroy_rpc (xlator_t *this)
                 goto out;
 
         if (conf->rpc) {
+                client_channels_stop (this);
+
                 /* cleanup the saved-frames before last unref */
                 rpc_clnt_connection_cleanup (&conf->rpc->conn);
 
                 conf->rpc = rpc_clnt_unref (conf->rpc);
+                conf->channels[0].rpc = NULL;
                 ret = 0;
                 gf_log (this->name, GF_LOG_DEBUG,
                         "Client rpc conn destroyed");
@@ -2408,6 +2825,8 @@ client_init_rpc (xlator_t *this)
                 goto out;
         }
 
+        conf->channels[0].rpc = conf->rpc;
+
         conf->handshake = &clnt_handshake_prog;
         conf->dump      = &clnt_dump_prog;
 
@@ -2518,6 +2937,14 @@ reconfigure (xlator_t *this, dict_t *options)
         if (ret)
                 goto out;
 
+        /* the channels are opened with the connection, a new count needs
+           a new graph */
+        GF_OPTION_RECONF ("channels", conf->opt.channels, options, int32, out);
+        if (client_channel_count (this, conf) != conf->channel_count) {
+                ret = 1;
+                goto out;
+        }
+
         ret = 0;
 out:
 	return ret;
@@ -2530,6 +2957,7 @@ init (xlator_t *this)
 {
         int          ret = -1;
         clnt_conf_t *conf = NULL;
+        int          i    = 0;
 
         if (this->children) {
                 gf_log (this->name, GF_LOG_ERROR,
@@ -2550,6 +2978,12 @@ init (xlator_t *this)
         pthread_mutex_init (&conf->lock, NULL);
         INIT_LIST_HEAD (&conf->saved_fds);
 
+        conf->channel_count = 1;
+        for (i = 0; i < CLIENT_MAX_CHANNELS; i++) {
+                conf->channels[i].this  = this;
+                conf->channels[i].index = i;
+        }
+
         /* Initialize parameters for lock self healing*/
         conf->lk_version         = 1;
         conf->grace_timer        = NULL;
@@ -2602,6 +3036,9 @@ fini (xlator_t *this)
         clnt_conf_t *conf = NULL;
 
         conf = this->private;
+        if (conf)
+                client_channels_stop (this);
+
         this->private = NULL;
 
         if (conf) {
@@ -2711,6 +3148,18 @@ client_priv_dump (xlator_t *this)
 
                 gf_proc_dump_write("total_bytes_written", "%"PRIu64,
                                    conf->rpc->conn.trans->total_bytes_write);
+
+                gf_proc_dump_write("total_msgs_written", "%"PRIu64,
+                                   conf->rpc->conn.trans->total_msgs_write);
+
+                gf_proc_dump_write("total_write_calls", "%"PRIu64,
+                                   conf->rpc->conn.trans->total_write_calls);
+        }
+
+        gf_proc_dump_write("channels", "%d", conf->channel_count);
+        for (i = 1; i < conf->channel_count; i++) {
+                sprintf (key, "channel.%d.ready", i);
+                gf_proc_dump_write(key, "%d", conf->channels[i].ready);
         }
         pthread_mutex_unlock(&conf->lock);
 
@@ -2718,6 +3167,45 @@ client_priv_dump (xlator_t *this)
 
 }
 
+int32_t
+client_metrics (xlator_t *this, gf_metrics_t *m)
+{
+        clnt_conf_t           *conf = NULL;
+        rpc_clnt_connection_t *conn = NULL;
+
+        conf = this->private;
+        if (!conf)
+                return -1;
+
+        gf_metrics_int (m, "connecting", conf->connecting);
+        if (!conf->rpc)
+                return 0;
+
+        conn = &conf->rpc->conn;
+
+        gf_metrics_begin (m, "rpc");
+        pthread_mutex_lock (&conn->lock);
+        {
+                gf_metrics_int (m, "connected", conn->connected);
+                gf_metrics_int (m, "saved_frames", conn->saved_frames ?
+                                conn->saved_frames->count : 0);
+                if (conn->trans) {
+                        gf_metrics_uint (m, "total_bytes_read",
+                                         conn->trans->total_bytes_read);
+                        gf_metrics_uint (m, "total_bytes_written",
+                                         conn->trans->total_bytes_write);
+                        gf_metrics_uint (m, "total_msgs_written",
+                                         conn->trans->total_msgs_write);
+                        gf_metrics_uint (m, "total_write_calls",
+                                         conn->trans->total_write_calls);
+                }
+        }
+        pthread_mutex_unlock (&conn->lock);
+        gf_metrics_end (m);
+
+        return 0;
+}
+
 int32_t
 client_inodectx_dump (xlator_t *this, inode_t *inode)
 {
@@ -2793,6 +3281,7 @@ struct xlator_fops fops = {
 struct xlator_dumpops dumpops = {
         .priv      =  client_priv_dump,
         .inodectx  =  client_inodectx_dump,
+        .metrics   =  client_metrics,
 };
 
 
@@ -2835,6 +3324,17 @@ struct volume_options options[] = {
           .description = "Time duration for which the client waits to "
                          "check if the server is responsive."
         },
+        { .key   = {"channels"},
+          .type  = GF_OPTION_TYPE_INT,
+          .min   = 1,
+          .max   = CLIENT_MAX_CHANNELS,
+          .default_value = "1",
+          .description = "Number of connections to the brick.  Fops are "
+                         "spread over them by the gfid they act on, so "
+                         "fops on one file keep their order, except while "
+                         "a connection is being set up or lost.  Only one "
+                         "connection is used when lk-heal is on."
+        },
         { .key   = {"client-bind-insecure"},
           .type  = GF_OPTION_TYPE_BOOL
         },
@@ -28,6 +28,7 @@
 #define CLIENT_DUMP_LOCKS     "trusted.glusterfs.clientlk-dump"
 #define GF_MAX_SOCKET_WINDOW_SIZE  (1 * GF_UNIT_MB)
 #define GF_MIN_SOCKET_WINDOW_SIZE  (0)
+#define CLIENT_MAX_CHANNELS        16
 
 typedef enum {
         GF_LK_HEAL_IN_PROGRESS,
@@ -67,8 +68,20 @@ typedef enum {
 struct clnt_options {
         char *remote_subvolume;
         int   ping_timeout;
+        int   channels;
 };
 
+/* One connection to the brick.  Channel 0 is conf->rpc, which does the
+   portmap query, the handshake and the fd/lock recovery; the others are
+   opened once it is attached to the remote volume, attach with the same
+   process-uuid (so the server sees one client) and only carry fops. */
+typedef struct clnt_channel {
+        xlator_t              *this;
+        struct rpc_clnt       *rpc;
+        int                    index;
+        char                   ready; /* SETVOLUME done, may carry fops */
+} clnt_channel_t;
+
 typedef struct clnt_conf {
         struct rpc_clnt       *rpc;
         struct clnt_options    opt;
@@ -120,6 +133,12 @@ typedef struct clnt_conf {
 						*/
         gf_boolean_t           filter_o_direct; /* if set, filter O_DIRECT from
                                                    the flags list of open() */
+        struct timeval         parent_up_ts; /* when the first connect was
+                                                started, cleared once it is
+                                                attached to the remote
+                                                volume */
+        int                    channel_count;
+        clnt_channel_t         channels[CLIENT_MAX_CHANNELS];
 } clnt_conf_t;
 
 typedef struct _client_fd_ctx {
@@ -216,6 +235,18 @@ int client_submit_request (xlator_t *this, void *req,
                            struct iovec *rsphdr, int rsphdr_count,
                            struct iovec *rsp_payload, int rsp_count,
                            struct iobref *rsp_iobref, xdrproc_t xdrproc);
+int client_submit_channel_request (xlator_t *this, clnt_channel_t *chan,
+                                   struct rpc_clnt *rpc, void *req,
+                                   call_frame_t *frame, rpc_clnt_prog_t *prog,
+                                   int procnum, fop_cbk_fn_t cbk,
+                                   xdrproc_t xdrproc);
+clnt_channel_t *client_channel_get (xlator_t *this, rpc_clnt_prog_t *prog,
+                                    int procnum, void *req,
+                                    struct rpc_clnt **rpc);
+void client_channel_put (clnt_channel_t *chan, struct rpc_clnt *rpc);
+clnt_channel_t *client_channel_find (xlator_t *this, struct rpc_clnt *rpc);
+int client_channels_start (xlator_t *this);
+void client_channels_stop (xlator_t *this);
 
 int unserialize_rsp_dirent (struct gfs3_readdir_rsp *rsp, gf_dirent_t *entries);
 int unserialize_rsp_direntp (xlator_t *this, fd_t *fd,
@@ -3127,11 +3127,11 @@ server3_3_stat (rpcsvc_request_t *req)
         state->resolve.type  = RESOLVE_MUST;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
 
         ret = 0;
@@ -3188,11 +3188,11 @@ server3_3_setattr (rpcsvc_request_t *req)
         gf_stat_to_iatt (&args.stbuf, &state->stbuf);
         state->valid = args.valid;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_setattr_resume);
@@ -3247,11 +3247,11 @@ server3_3_fsetattr (rpcsvc_request_t *req)
         gf_stat_to_iatt (&args.stbuf, &state->stbuf);
         state->valid = args.valid;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fsetattr_resume);
@@ -3308,11 +3308,11 @@ server3_3_fallocate(rpcsvc_request_t *req)
         state->size = args.size;
         memcpy(state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fallocate_resume);
@@ -3369,11 +3369,11 @@ server3_3_discard(rpcsvc_request_t *req)
         state->size = args.size;
         memcpy(state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_discard_resume);
@@ -3430,10 +3430,11 @@ server3_3_zerofill(rpcsvc_request_t *req)
         state->size = args.size;
         memcpy(state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl, state->xdata,
-                                      (args.xdata.xdata_val),
-                                      (args.xdata.xdata_len), ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             (args.xdata.xdata_val),
+                                             (args.xdata.xdata_len), ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_zerofill_resume);
@@ -3487,11 +3488,11 @@ server3_3_readlink (rpcsvc_request_t *req)
 
         state->size  = args.size;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_readlink_resume);
@@ -3557,11 +3558,11 @@ server3_3_create (rpcsvc_request_t *req)
         }
 
         /* TODO: can do alloca for xdata field instead of stdalloc */
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_create_resume);
@@ -3616,11 +3617,11 @@ server3_3_open (rpcsvc_request_t *req)
 
         state->flags = gf_flags_to_flags (args.flags);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_open_resume);
@@ -3676,11 +3677,11 @@ server3_3_readv (rpcsvc_request_t *req)
 
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_readv_resume);
@@ -3756,11 +3757,11 @@ server3_3_writev (rpcsvc_request_t *req)
                 state->size += state->payload_vector[i].iov_len;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
 #ifdef GF_TESTING_IO_XDATA
         dict_dump (state->xdata);
@@ -3959,11 +3960,11 @@ server3_3_fsync (rpcsvc_request_t *req)
         state->flags         = args.data;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fsync_resume);
@@ -4017,11 +4018,11 @@ server3_3_flush (rpcsvc_request_t *req)
         state->resolve.fd_no = args.fd;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_flush_resume);
@@ -4076,11 +4077,11 @@ server3_3_ftruncate (rpcsvc_request_t *req)
         state->offset         = args.offset;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_ftruncate_resume);
@@ -4133,11 +4134,11 @@ server3_3_fstat (rpcsvc_request_t *req)
         state->resolve.fd_no   = args.fd;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fstat_resume);
@@ -4190,11 +4191,11 @@ server3_3_truncate (rpcsvc_request_t *req)
         memcpy (state->resolve.gfid, args.gfid, 16);
         state->offset        = args.offset;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_truncate_resume);
@@ -4252,11 +4253,11 @@ server3_3_unlink (rpcsvc_request_t *req)
 
         state->flags = args.xflags;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_unlink_resume);
@@ -4323,11 +4324,11 @@ server3_3_setxattr (rpcsvc_request_t *req)
         /* There can be some commands hidden in key, check and proceed */
         gf_server_check_setxattr_cmd (frame, dict);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_setxattr_resume);
@@ -4397,11 +4398,11 @@ server3_3_fsetxattr (rpcsvc_request_t *req)
 
         state->dict = dict;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fsetxattr_resume);
@@ -4471,11 +4472,11 @@ server3_3_fxattrop (rpcsvc_request_t *req)
 
         state->dict = dict;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fxattrop_resume);
@@ -4546,11 +4547,11 @@ server3_3_xattrop (rpcsvc_request_t *req)
 
         state->dict = dict;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_xattrop_resume);
@@ -4615,11 +4616,11 @@ server3_3_getxattr (rpcsvc_request_t *req)
                 gf_server_check_getxattr_cmd (frame, state->name);
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_getxattr_resume);
@@ -4676,11 +4677,11 @@ server3_3_fgetxattr (rpcsvc_request_t *req)
         if (args.namelen)
                 state->name = gf_strdup (args.name);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fgetxattr_resume);
@@ -4736,11 +4737,11 @@ server3_3_removexattr (rpcsvc_request_t *req)
         memcpy (state->resolve.gfid, args.gfid, 16);
         state->name           = gf_strdup (args.name);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_removexattr_resume);
@@ -4795,11 +4796,11 @@ server3_3_fremovexattr (rpcsvc_request_t *req)
         memcpy (state->resolve.gfid, args.gfid, 16);
         state->name           = gf_strdup (args.name);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fremovexattr_resume);
@@ -4853,11 +4854,11 @@ server3_3_opendir (rpcsvc_request_t *req)
         state->resolve.type   = RESOLVE_MUST;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_opendir_resume);
@@ -4924,11 +4925,11 @@ server3_3_readdirp (rpcsvc_request_t *req)
         memcpy (state->resolve.gfid, args.gfid, 16);
 
         /* here, dict itself works as xdata */
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->dict,
-                                      (args.dict.dict_val),
-                                      (args.dict.dict_len), ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->dict,
+                                             (args.dict.dict_val),
+                                             (args.dict.dict_len), ret,
+                                             op_errno, out);
 
 
         ret = 0;
@@ -4994,11 +4995,11 @@ server3_3_readdir (rpcsvc_request_t *req)
         state->offset = args.offset;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_readdir_resume);
@@ -5051,11 +5052,11 @@ server3_3_fsyncdir (rpcsvc_request_t *req)
         state->flags = args.data;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fsyncdir_resume);
@@ -5115,11 +5116,11 @@ server3_3_mknod (rpcsvc_request_t *req)
         state->dev   = args.dev;
         state->umask = args.umask;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_mknod_resume);
@@ -5181,11 +5182,11 @@ server3_3_mkdir (rpcsvc_request_t *req)
         state->umask = args.umask;
 
         /* TODO: can do alloca for xdata field instead of stdalloc */
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_mkdir_resume);
@@ -5243,11 +5244,11 @@ server3_3_rmdir (rpcsvc_request_t *req)
 
         state->flags = args.xflags;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_rmdir_resume);
@@ -5333,11 +5334,11 @@ server3_3_inodelk (rpcsvc_request_t *req)
                 break;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_inodelk_resume);
@@ -5422,11 +5423,11 @@ server3_3_finodelk (rpcsvc_request_t *req)
                 break;
         }
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_finodelk_resume);
@@ -5490,11 +5491,11 @@ server3_3_entrylk (rpcsvc_request_t *req)
         state->cmd            = args.cmd;
         state->type           = args.type;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_entrylk_resume);
@@ -5555,11 +5556,11 @@ server3_3_fentrylk (rpcsvc_request_t *req)
                 state->name = gf_strdup (args.name);
         state->volume = gf_strdup (args.volume);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_fentrylk_resume);
@@ -5611,11 +5612,11 @@ server3_3_access (rpcsvc_request_t *req)
         memcpy (state->resolve.gfid, args.gfid, 16);
         state->mask          = args.mask;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_access_resume);
@@ -5674,11 +5675,11 @@ server3_3_symlink (rpcsvc_request_t *req)
         state->name           = gf_strdup (args.linkname);
         state->umask          = args.umask;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_symlink_resume);
@@ -5738,11 +5739,11 @@ server3_3_link (rpcsvc_request_t *req)
         state->resolve2.bname  = gf_strdup (args.newbname);
         memcpy (state->resolve2.pargfid, args.newgfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_link_resume);
@@ -5802,11 +5803,11 @@ server3_3_rename (rpcsvc_request_t *req)
         state->resolve2.bname = gf_strdup (args.newbname);
         memcpy (state->resolve2.pargfid, args.newgfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_rename_resume);
@@ -5905,11 +5906,11 @@ server3_3_lk (rpcsvc_request_t *req)
         }
 
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_lk_resume);
@@ -5965,11 +5966,11 @@ server3_3_rchecksum (rpcsvc_request_t *req)
         state->offset        = args.offset;
         state->size          = args.len;
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_rchecksum_resume);
@@ -6103,11 +6104,11 @@ server3_3_statfs (rpcsvc_request_t *req)
         state->resolve.type   = RESOLVE_MUST;
         memcpy (state->resolve.gfid, args.gfid, 16);
 
-        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
-                                      state->xdata,
-                                      args.xdata.xdata_val,
-                                      args.xdata.xdata_len, ret,
-                                      op_errno, out);
+        GF_PROTOCOL_DICT_UNSERIALIZE_NOCOPY (frame->root->client->bound_xl,
+                                             state->xdata,
+                                             args.xdata.xdata_val,
+                                             args.xdata.xdata_len, ret,
+                                             op_errno, out);
 
         ret = 0;
         resolve_and_resume (frame, server_statfs_resume);
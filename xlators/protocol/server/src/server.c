@@ -23,6 +23,7 @@
 #include "glusterfs3-xdr.h"
 #include "call-stub.h"
 #include "statedump.h"
+#include "metrics.h"
 #include "defaults.h"
 #include "authenticate.h"
 
@@ -286,6 +287,8 @@ server_priv (xlator_t *this)
         char              key[GF_DUMP_MAX_BUF_LEN] = {0,};
         uint64_t          total_read = 0;
         uint64_t          total_write = 0;
+        uint64_t          total_msgs = 0;
+        uint64_t          total_calls = 0;
         int32_t           ret  = -1;
 
         GF_VALIDATE_OR_GOTO ("server", this, out);
@@ -304,6 +307,8 @@ server_priv (xlator_t *this)
                 list_for_each_entry (xprt, &conf->xprt_list, list) {
                         total_read  += xprt->total_bytes_read;
                         total_write += xprt->total_bytes_write;
+                        total_msgs  += xprt->total_msgs_write;
+                        total_calls += xprt->total_write_calls;
                 }
         }
         pthread_mutex_unlock (&conf->mutex);
@@ -314,6 +319,13 @@ server_priv (xlator_t *this)
         gf_proc_dump_build_key(key, "server", "total-bytes-write");
         gf_proc_dump_write(key, "%"PRIu64, total_write);
 
+        /* replies coalesced into one writev show as fewer calls than msgs */
+        gf_proc_dump_build_key(key, "server", "total-msgs-write");
+        gf_proc_dump_write(key, "%"PRIu64, total_msgs);
+
+        gf_proc_dump_build_key(key, "server", "total-write-calls");
+        gf_proc_dump_write(key, "%"PRIu64, total_calls);
+
         ret = 0;
 out:
         if (ret)
@@ -325,6 +337,45 @@ out:
 }
 
 
+int
+server_metrics (xlator_t *this, gf_metrics_t *m)
+{
+        server_conf_t    *conf = NULL;
+        rpc_transport_t  *xprt = NULL;
+        uint64_t          total_read = 0;
+        uint64_t          total_write = 0;
+        uint64_t          total_msgs = 0;
+        uint64_t          total_calls = 0;
+        int               connections = 0;
+
+        conf = this->private;
+        if (!conf)
+                return 0;
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                list_for_each_entry (xprt, &conf->xprt_list, list) {
+                        total_read  += xprt->total_bytes_read;
+                        total_write += xprt->total_bytes_write;
+                        total_msgs  += xprt->total_msgs_write;
+                        total_calls += xprt->total_write_calls;
+                        connections++;
+                }
+        }
+        pthread_mutex_unlock (&conf->mutex);
+
+        gf_metrics_begin (m, "rpc");
+        gf_metrics_int (m, "connections", connections);
+        gf_metrics_uint (m, "total_bytes_read", total_read);
+        gf_metrics_uint (m, "total_bytes_written", total_write);
+        gf_metrics_uint (m, "total_msgs_written", total_msgs);
+        gf_metrics_uint (m, "total_write_calls", total_calls);
+        gf_metrics_end (m);
+
+        return 0;
+}
+
+
 static int
 get_auth_types (dict_t *this, char *key, data_t *value, void *data)
 {
@@ -1006,6 +1057,7 @@ struct xlator_dumpops dumpops = {
         .priv_to_dict   = server_priv_to_dict,
         .fd_to_dict     = gf_client_dump_fdtables_to_dict,
         .inode_to_dict  = gf_client_dump_inodes_to_dict,
+        .metrics        = server_metrics,
 };
 
 
@@ -4446,6 +4446,8 @@ posix_rchecksum (call_frame_t *frame, xlator_t *this,
         int32_t                 weak_checksum   = 0;
         unsigned char           strong_checksum[MD5_DIGEST_LENGTH] = {0};
         struct posix_private    *priv           = NULL;
+        char                    *strong_hash    = NULL;
+        dict_t                  *rsp_xdata      = NULL;
 
         VALIDATE_OR_GOTO (frame, out);
         VALIDATE_OR_GOTO (this, out);
@@ -4491,14 +4493,30 @@ posix_rchecksum (call_frame_t *frame, xlator_t *this,
                 goto out;
 
         weak_checksum = gf_rsync_weak_checksum ((unsigned char *) buf, (size_t) len);
-        gf_rsync_strong_checksum ((unsigned char *) buf, (size_t) len, (unsigned char *) strong_checksum);
+
+        if (xdata &&
+            !dict_get_str (xdata, GF_RSYNC_STRONG_HASH_KEY, &strong_hash) &&
+            !strcmp (strong_hash, GF_RSYNC_STRONG_HASH_MURMUR3))
+                rsp_xdata = dict_new ();
+
+        if (rsp_xdata &&
+            !dict_set_str (rsp_xdata, GF_RSYNC_STRONG_HASH_KEY,
+                           GF_RSYNC_STRONG_HASH_MURMUR3)) {
+                gf_rsync_murmur3_checksum ((unsigned char *) buf, (size_t) len,
+                                           (unsigned char *) strong_checksum);
+        } else {
+                gf_rsync_strong_checksum ((unsigned char *) buf, (size_t) len,
+                                          (unsigned char *) strong_checksum);
+        }
 
         op_ret = 0;
 out:
         STACK_UNWIND_STRICT (rchecksum, frame, op_ret, op_errno,
-                             weak_checksum, strong_checksum, NULL);
+                             weak_checksum, strong_checksum, rsp_xdata);
 
         GF_FREE (alloc_buf);
+        if (rsp_xdata)
+                dict_unref (rsp_xdata);
 
         return 0;
 }